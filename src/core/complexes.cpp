@@ -2,7 +2,6 @@
 
 #include <QDir>
 #include <QAudioFormat>
-#include <cstring>
 
 #ifdef WAKKAQT_FFMPEG_NATIVE
 #include "ffmpegnative.h"
@@ -54,7 +53,9 @@ bool mediaHasVideoStream(const QString &filePath)
 }
 
 // FFMpeg filter_complexes
-    const QString _audioEnhance = "aformat=channel_layouts=mono,";
+    // Stereo, not mono: VocalEnhancer keeps the channels apart and runs its
+    // analysis on their mid itself (see VocalEnhancer::setPreserveStereo)
+    const QString _audioEnhance = "aformat=channel_layouts=stereo,";
     const QString _filterEcho = "aecho=0.8:0.7:32|64:0.21|0.13,";
     const QString _audioMasterization = "deesser,speechnorm,acompressor=threshold=0.5:ratio=4,highpass=f=200";
 
@@ -205,7 +206,6 @@ const QVector<VideoEffectPreset> videoEffectPresets = {
     QString webcamRecorded = QDir::temp().filePath("WakkaQt_tmp_recording.mkv");
     QString audioRecorded = QDir::temp().filePath("WakkaQt_tmp_recording.wav");
     QString tunedRecorded = QDir::temp().filePath("WakkaQt_tmp_tuned.wav");
-    QString extractedPlayback = QDir::temp().filePath("WakkaQt_playback.wav");
     QString extractedTmpPlayback = QDir::temp().filePath("WakkaQt_tmp_playback.wav");
 
 namespace {
@@ -255,178 +255,6 @@ bool isSingleYouTubeVideoUrl(const QUrl& url) {
 }
 
 
-// utility function to write the WAVE headers
-void writeWavHeader(QFile &file, const QAudioFormat &format, qint64 dataSize, const QByteArray &pcmData)
-{
-    // Prepare header values
-    qint32 sampleRate = format.sampleRate(); 
-    qint16 numChannels = format.channelCount(); 
-    qint16 bitsPerSample = format.bytesPerSample() * 8; // Convert bytes to bits
-    qint32 byteRate = sampleRate * numChannels * (bitsPerSample / 8); // Calculate byte rate
-    qint16 blockAlign = numChannels * (bitsPerSample / 8); // Calculate block align
-    qint16 audioFormatValue = 1; // 1 for PCM format
-
-    // Create header
-    QByteArray header;
-    header.append("RIFF");                                         // Chunk ID
-    qint32 chunkSize = dataSize + 36;                            // Data size + 36 bytes for the header
-    header.append(reinterpret_cast<const char*>(&chunkSize), sizeof(chunkSize)); // Chunk Size
-    header.append("WAVE");                                         // Format
-    header.append("fmt ");                                         // Subchunk 1 ID
-    qint32 subchunk1Size = 16;                                   // Subchunk 1 Size (16 for PCM)
-    header.append(reinterpret_cast<const char*>(&subchunk1Size), sizeof(subchunk1Size)); // Subchunk 1 Size
-    header.append(reinterpret_cast<const char*>(&audioFormatValue), sizeof(audioFormatValue)); // Audio Format
-    header.append(reinterpret_cast<const char*>(&numChannels), sizeof(numChannels));        // Channels
-    header.append(reinterpret_cast<const char*>(&sampleRate), sizeof(sampleRate));          // Sample Rate
-    header.append(reinterpret_cast<const char*>(&byteRate), sizeof(byteRate));                // Byte Rate
-    header.append(reinterpret_cast<const char*>(&blockAlign), sizeof(blockAlign));            // Block Align
-    header.append(reinterpret_cast<const char*>(&bitsPerSample), sizeof(bitsPerSample));      // Bits per Sample
-    header.append("data");                                         // Subchunk 2 ID
-    qint32 subchunk2Size = pcmData.size();                       // Size of the audio data
-    header.append(reinterpret_cast<const char*>(&subchunk2Size), sizeof(subchunk2Size)); // Subchunk2 Size
-
-    // Write the header and audio data to the file in one go
-    file.write(header);
-    file.write(pcmData); // Write audio data after the header
-
-    qDebug() << "WAV header and audio data written.";
-}
-
-// See complexes.h. Walks actual RIFF chunks instead of assuming a fixed
-// 44-byte header, so a "fmt " chunk extension or an extra chunk (e.g. a
-// LIST/INFO block some encoders prepend before "data") doesn't shift the
-// payload out from under a fixed-offset read — and, critically, the
-// returned samples never include header bytes that would otherwise get
-// treated as (and, for anything routed straight to a QAudioSink, audibly
-// played as) audio.
-PcmBuffer parseWavPcm(const QByteArray &wavBytes)
-{
-    PcmBuffer result;
-
-    if (wavBytes.size() < 12
-        || wavBytes.mid(0, 4) != "RIFF"
-        || wavBytes.mid(8, 4) != "WAVE") {
-        qWarning() << "parseWavPcm: not a RIFF/WAVE buffer (size" << wavBytes.size() << ")";
-        return result;
-    }
-
-    quint16 audioFormatTag = 0, numChannels = 0, bitsPerSample = 0, blockAlign = 0;
-    quint32 sampleRate = 0, byteRate = 0;
-    bool haveFmt = false;
-
-    qint64 pos = 12;
-    while (pos + 8 <= wavBytes.size()) {
-        const QByteArray chunkId = wavBytes.mid(pos, 4);
-        quint32 chunkSize = 0;
-        memcpy(&chunkSize, wavBytes.constData() + pos + 4, 4);
-        const qint64 dataStart = pos + 8;
-
-        if (dataStart + qint64(chunkSize) > wavBytes.size()) {
-            qWarning() << "parseWavPcm: chunk" << chunkId << "size" << chunkSize
-                       << "runs past end of buffer, stopping";
-            break;
-        }
-
-        if (chunkId == "fmt ") {
-            if (chunkSize < 16) {
-                qWarning() << "parseWavPcm: 'fmt ' chunk too small:" << chunkSize;
-                return result;
-            }
-            const char *fmt = wavBytes.constData() + dataStart;
-            memcpy(&audioFormatTag, fmt + 0, 2);
-            memcpy(&numChannels,    fmt + 2, 2);
-            memcpy(&sampleRate,     fmt + 4, 4);
-            memcpy(&byteRate,       fmt + 8, 4);
-            memcpy(&blockAlign,     fmt + 12, 2);
-            memcpy(&bitsPerSample,  fmt + 14, 2);
-
-            // WAVE_FORMAT_EXTENSIBLE (0xFFFE) defers the real format to a
-            // SubFormat GUID appended after the base 16-byte struct — its
-            // first two bytes are the actual format tag (1=PCM, 3=IEEE
-            // float), same convention as the plain tag field.
-            if (audioFormatTag == 0xFFFE) {
-                if (chunkSize < 40) {
-                    qWarning() << "parseWavPcm: WAVE_FORMAT_EXTENSIBLE 'fmt ' chunk too small:" << chunkSize;
-                    return result;
-                }
-                quint16 subFormatTag = 0;
-                memcpy(&subFormatTag, fmt + 24, 2);
-                audioFormatTag = subFormatTag;
-            }
-            haveFmt = true;
-        } else if (chunkId == "data") {
-            if (!haveFmt) {
-                qWarning() << "parseWavPcm: 'data' chunk arrived before 'fmt '";
-                return result;
-            }
-
-            // Only uncompressed PCM (tag 1) or IEEE float (tag 3) actually
-            // store raw samples in the data chunk — anything else (ADPCM,
-            // mu-law/A-law, MP3-in-WAV, etc.) packs its bytes in a
-            // codec-specific way and must not be read as if it were PCM
-            // just because bitsPerSample happens to match a PCM width.
-            if (audioFormatTag != 1 && audioFormatTag != 3) {
-                qWarning() << "parseWavPcm: unsupported compressed format tag" << audioFormatTag
-                           << "— only uncompressed PCM/IEEE-float WAV is supported";
-                return result;
-            }
-
-            QAudioFormat::SampleFormat sampleFormat = QAudioFormat::Unknown;
-            if (audioFormatTag == 3 && bitsPerSample == 32) sampleFormat = QAudioFormat::Float;
-            else if (audioFormatTag == 1 && bitsPerSample == 16) sampleFormat = QAudioFormat::Int16;
-            else if (audioFormatTag == 1 && bitsPerSample == 32) sampleFormat = QAudioFormat::Int32;
-            else if (audioFormatTag == 1 && bitsPerSample == 8)  sampleFormat = QAudioFormat::UInt8;
-
-            if (sampleFormat == QAudioFormat::Unknown || numChannels == 0 || sampleRate == 0) {
-                qWarning() << "parseWavPcm: unsupported/invalid fmt —"
-                           << "tag=" << audioFormatTag << "bits=" << bitsPerSample
-                           << "channels=" << numChannels << "rate=" << sampleRate;
-                return result;
-            }
-
-            // Cross-check blockAlign/byteRate against what the declared
-            // format actually implies — a mismatch means a malformed or
-            // hand-edited header, which is exactly the kind of file that
-            // would otherwise get silently misread as valid PCM.
-            const int bytesPerSample = bitsPerSample / 8;
-            const quint32 expectedBlockAlign = quint32(numChannels) * quint32(bytesPerSample);
-            if (blockAlign != 0 && blockAlign != expectedBlockAlign) {
-                qWarning() << "parseWavPcm: blockAlign" << blockAlign << "!= expected"
-                           << expectedBlockAlign << "(channels * bytesPerSample) — malformed fmt chunk";
-                return result;
-            }
-            const quint32 expectedByteRate = sampleRate * expectedBlockAlign;
-            if (byteRate != 0 && byteRate != expectedByteRate) {
-                qWarning() << "parseWavPcm: byteRate" << byteRate << "!= expected"
-                           << expectedByteRate << "— malformed fmt chunk";
-                return result;
-            }
-
-            QByteArray samples = wavBytes.mid(dataStart, int(chunkSize));
-            const int frameBytes = numChannels * bytesPerSample;
-            if (frameBytes > 0 && samples.size() % frameBytes != 0) {
-                const int trimmed = samples.size() - (samples.size() % frameBytes);
-                qWarning() << "parseWavPcm: data chunk size" << samples.size()
-                           << "is not a whole number of" << frameBytes << "-byte frames; trimming"
-                           << (samples.size() - trimmed) << "trailing byte(s)";
-                samples.truncate(trimmed);
-            }
-
-            result.samples = samples;
-            result.format.setSampleRate(int(sampleRate));
-            result.format.setChannelCount(int(numChannels));
-            result.format.setSampleFormat(sampleFormat);
-            return result;
-        }
-
-        // Chunks are word-aligned: an odd-sized chunk has one pad byte after it.
-        pos = dataStart + qint64(chunkSize) + (chunkSize & 1);
-    }
-
-    qWarning() << "parseWavPcm: no 'data' chunk found";
-    return result;
-}
-
 static bool isYouTubeHost(const QString& host) {
     const QString h = host.toLower();
     return h.contains("youtube.com") || h.contains("youtu.be");
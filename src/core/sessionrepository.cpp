@@ -1,4 +1,5 @@
 #include "sessionrepository.h"
+#include "pitchtrack.h"
 #include "complexes.h" // webcamRecorded/audioRecorded/extractedTmpPlayback fixed tmp paths + parseWavPcm()/mediaHasVideoStream()
 
 #include <QDir>
@@ -133,6 +134,15 @@ SaveResult SessionRepository::saveSession(const SessionSnapshot &snapshot)
     }
     // tuned.wav is intentionally NOT saved: it is always re-generated by
     // PreviewDialog from audio.wav with the user's current enhancement settings.
+    // The enhancer's pitch track is, when the take has one: it spares a
+    // restored render's pitch overlay from analysing audio.wav again. Only
+    // a cache, so failing to copy it doesn't fail the save.
+    const QString pitchTrack = PitchTrack::sidecarPathFor(audioRecorded);
+    if (QFile::exists(pitchTrack)
+        && !copyFile(pitchTrack, PitchTrack::sidecarPathFor(partialDir + "/audio.wav"))) {
+        qWarning() << "SessionRepository: pitch track not saved, a restored render will re-analyse";
+        QFile::remove(PitchTrack::sidecarPathFor(partialDir + "/audio.wav"));
+    }
 
     // offsets.json — store qint64 as strings to avoid double precision loss.
     // QSaveFile writes to a temp file next to the target and only replaces it
@@ -504,6 +514,15 @@ RestoreResult SessionRepository::restoreSession(const QString &id)
         qDebug() << "SessionRepository: restored" << items[i].srcName << "->" << dst;
     }
 
+    // The enhancer's pitch track, if the session has one, goes next to the
+    // restored audio.wav where PitchTrack::sidecarPathFor() looks for it.
+    // Best effort, like saving it: without it a render analyses audio.wav.
+    if (!result.audioPath.isEmpty()) {
+        const QString src = PitchTrack::sidecarPathFor(audioPath);
+        if (QFile::exists(src) && !QFile::copy(src, PitchTrack::sidecarPathFor(result.audioPath)))
+            qWarning() << "SessionRepository::restoreSession: pitch track not restored, a render will re-analyse";
+    }
+
     // playback.wav: prefer the session's own validated local copy; fall back
     // to snapshot.currentVideoFile (already confirmed to exist above) for
     // older sessions saved before playback.wav became mandatory. Without
@@ -0,0 +1,188 @@
+#include "wavfile.h"
+
+#include <QDebug>
+#include <cstring>
+
+// utility function to write the WAVE headers
+void writeWavHeader(QFile &file, const QAudioFormat &format, qint64 dataSize, const QByteArray &pcmData)
+{
+    // Prepare header values
+    qint32 sampleRate = format.sampleRate(); 
+    qint16 numChannels = format.channelCount(); 
+    qint16 bitsPerSample = format.bytesPerSample() * 8; // Convert bytes to bits
+    qint32 byteRate = sampleRate * numChannels * (bitsPerSample / 8); // Calculate byte rate
+    qint16 blockAlign = numChannels * (bitsPerSample / 8); // Calculate block align
+    qint16 audioFormatValue = format.sampleFormat() == QAudioFormat::Float ? 3 : 1; // IEEE float or PCM
+
+    // Create header
+    QByteArray header;
+    header.append("RIFF");                                         // Chunk ID
+    qint32 chunkSize = dataSize + 36;                            // Data size + 36 bytes for the header
+    header.append(reinterpret_cast<const char*>(&chunkSize), sizeof(chunkSize)); // Chunk Size
+    header.append("WAVE");                                         // Format
+    header.append("fmt ");                                         // Subchunk 1 ID
+    qint32 subchunk1Size = 16;                                   // Subchunk 1 Size (16 for PCM)
+    header.append(reinterpret_cast<const char*>(&subchunk1Size), sizeof(subchunk1Size)); // Subchunk 1 Size
+    header.append(reinterpret_cast<const char*>(&audioFormatValue), sizeof(audioFormatValue)); // Audio Format
+    header.append(reinterpret_cast<const char*>(&numChannels), sizeof(numChannels));        // Channels
+    header.append(reinterpret_cast<const char*>(&sampleRate), sizeof(sampleRate));          // Sample Rate
+    header.append(reinterpret_cast<const char*>(&byteRate), sizeof(byteRate));                // Byte Rate
+    header.append(reinterpret_cast<const char*>(&blockAlign), sizeof(blockAlign));            // Block Align
+    header.append(reinterpret_cast<const char*>(&bitsPerSample), sizeof(bitsPerSample));      // Bits per Sample
+    header.append("data");                                         // Subchunk 2 ID
+    qint32 subchunk2Size = pcmData.size();                       // Size of the audio data
+    header.append(reinterpret_cast<const char*>(&subchunk2Size), sizeof(subchunk2Size)); // Subchunk2 Size
+
+    // Write the header and audio data to the file in one go
+    file.write(header);
+    file.write(pcmData); // Write audio data after the header
+
+    qDebug() << "WAV header and audio data written.";
+}
+
+// See wavfile.h. Walks actual RIFF chunks instead of assuming a fixed
+// 44-byte header, so a "fmt " chunk extension or an extra chunk (e.g. a
+// LIST/INFO block some encoders prepend before "data") doesn't shift the
+// payload out from under a fixed-offset read — and, critically, the
+// returned samples never include header bytes that would otherwise get
+// treated as (and, for anything routed straight to a QAudioSink, audibly
+// played as) audio.
+WavLayout parseWavLayout(const char *bytes, qint64 size)
+{
+    WavLayout result;
+
+    if (size < 12
+        || memcmp(bytes, "RIFF", 4) != 0
+        || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        qWarning() << "parseWavLayout: not a RIFF/WAVE buffer (size" << size << ")";
+        return result;
+    }
+
+    quint16 audioFormatTag = 0, numChannels = 0, bitsPerSample = 0, blockAlign = 0;
+    quint32 sampleRate = 0, byteRate = 0;
+    bool haveFmt = false;
+
+    qint64 pos = 12;
+    while (pos + 8 <= size) {
+        const QByteArray chunkId(bytes + pos, 4);
+        quint32 chunkSize = 0;
+        memcpy(&chunkSize, bytes + pos + 4, 4);
+        const qint64 dataStart = pos + 8;
+
+        if (dataStart + qint64(chunkSize) > size) {
+            qWarning() << "parseWavLayout: chunk" << chunkId << "size" << chunkSize
+                       << "runs past end of buffer, stopping";
+            break;
+        }
+
+        if (chunkId == "fmt ") {
+            if (chunkSize < 16) {
+                qWarning() << "parseWavLayout: 'fmt ' chunk too small:" << chunkSize;
+                return result;
+            }
+            const char *fmt = bytes + dataStart;
+            memcpy(&audioFormatTag, fmt + 0, 2);
+            memcpy(&numChannels,    fmt + 2, 2);
+            memcpy(&sampleRate,     fmt + 4, 4);
+            memcpy(&byteRate,       fmt + 8, 4);
+            memcpy(&blockAlign,     fmt + 12, 2);
+            memcpy(&bitsPerSample,  fmt + 14, 2);
+
+            // WAVE_FORMAT_EXTENSIBLE (0xFFFE) defers the real format to a
+            // SubFormat GUID appended after the base 16-byte struct — its
+            // first two bytes are the actual format tag (1=PCM, 3=IEEE
+            // float), same convention as the plain tag field.
+            if (audioFormatTag == 0xFFFE) {
+                if (chunkSize < 40) {
+                    qWarning() << "parseWavLayout: WAVE_FORMAT_EXTENSIBLE 'fmt ' chunk too small:" << chunkSize;
+                    return result;
+                }
+                quint16 subFormatTag = 0;
+                memcpy(&subFormatTag, fmt + 24, 2);
+                audioFormatTag = subFormatTag;
+            }
+            haveFmt = true;
+        } else if (chunkId == "data") {
+            if (!haveFmt) {
+                qWarning() << "parseWavLayout: 'data' chunk arrived before 'fmt '";
+                return result;
+            }
+
+            // Only uncompressed PCM (tag 1) or IEEE float (tag 3) actually
+            // store raw samples in the data chunk — anything else (ADPCM,
+            // mu-law/A-law, MP3-in-WAV, etc.) packs its bytes in a
+            // codec-specific way and must not be read as if it were PCM
+            // just because bitsPerSample happens to match a PCM width.
+            if (audioFormatTag != 1 && audioFormatTag != 3) {
+                qWarning() << "parseWavLayout: unsupported compressed format tag" << audioFormatTag
+                           << "— only uncompressed PCM/IEEE-float WAV is supported";
+                return result;
+            }
+
+            QAudioFormat::SampleFormat sampleFormat = QAudioFormat::Unknown;
+            if (audioFormatTag == 3 && bitsPerSample == 32) sampleFormat = QAudioFormat::Float;
+            else if (audioFormatTag == 1 && bitsPerSample == 16) sampleFormat = QAudioFormat::Int16;
+            else if (audioFormatTag == 1 && bitsPerSample == 32) sampleFormat = QAudioFormat::Int32;
+            else if (audioFormatTag == 1 && bitsPerSample == 8)  sampleFormat = QAudioFormat::UInt8;
+
+            if (sampleFormat == QAudioFormat::Unknown || numChannels == 0 || sampleRate == 0) {
+                qWarning() << "parseWavLayout: unsupported/invalid fmt —"
+                           << "tag=" << audioFormatTag << "bits=" << bitsPerSample
+                           << "channels=" << numChannels << "rate=" << sampleRate;
+                return result;
+            }
+
+            // Cross-check blockAlign/byteRate against what the declared
+            // format actually implies — a mismatch means a malformed or
+            // hand-edited header, which is exactly the kind of file that
+            // would otherwise get silently misread as valid PCM.
+            const int bytesPerSample = bitsPerSample / 8;
+            const quint32 expectedBlockAlign = quint32(numChannels) * quint32(bytesPerSample);
+            if (blockAlign != 0 && blockAlign != expectedBlockAlign) {
+                qWarning() << "parseWavLayout: blockAlign" << blockAlign << "!= expected"
+                           << expectedBlockAlign << "(channels * bytesPerSample) — malformed fmt chunk";
+                return result;
+            }
+            const quint32 expectedByteRate = sampleRate * expectedBlockAlign;
+            if (byteRate != 0 && byteRate != expectedByteRate) {
+                qWarning() << "parseWavLayout: byteRate" << byteRate << "!= expected"
+                           << expectedByteRate << "— malformed fmt chunk";
+                return result;
+            }
+
+            qint64 dataSize = qint64(chunkSize);
+            const int frameBytes = numChannels * bytesPerSample;
+            if (frameBytes > 0 && dataSize % frameBytes != 0) {
+                const qint64 trimmed = dataSize - (dataSize % frameBytes);
+                qWarning() << "parseWavLayout: data chunk size" << dataSize
+                           << "is not a whole number of" << frameBytes << "-byte frames; trimming"
+                           << (dataSize - trimmed) << "trailing byte(s)";
+                dataSize = trimmed;
+            }
+
+            result.dataOffset = dataStart;
+            result.dataSize   = dataSize;
+            result.format.setSampleRate(int(sampleRate));
+            result.format.setChannelCount(int(numChannels));
+            result.format.setSampleFormat(sampleFormat);
+            return result;
+        }
+
+        // Chunks are word-aligned: an odd-sized chunk has one pad byte after it.
+        pos = dataStart + qint64(chunkSize) + (chunkSize & 1);
+    }
+
+    qWarning() << "parseWavLayout: no 'data' chunk found";
+    return result;
+}
+
+PcmBuffer parseWavPcm(const QByteArray &wavBytes)
+{
+    PcmBuffer result;
+    const WavLayout layout = parseWavLayout(wavBytes.constData(), wavBytes.size());
+    if (!layout.isValid())
+        return result;
+    result.samples = wavBytes.mid(layout.dataOffset, layout.dataSize);
+    result.format  = layout.format;
+    return result;
+}
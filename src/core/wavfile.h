@@ -0,0 +1,46 @@
+#ifndef WAVFILE_H
+#define WAVFILE_H
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QFile>
+
+// RIFF/WAVE reading and writing. Its own file (and, with atomicfilecommit.*,
+// its own library, wakkaqt_fileio) because wakkaqt_media needs it as much as
+// the app does, and wakkaqt_media can't link wakkaqt_core — the dependency
+// runs the other way. complexes.h still includes it for everyone else.
+
+void writeWavHeader(QFile &file, const QAudioFormat &format, qint64 dataSize, const QByteArray &pcmData);
+
+// A decoded WAV file's payload, kept explicitly separate from the RIFF
+// container it came out of — samples never includes the header/chunk bytes.
+// isValid() is false if parseWavPcm() couldn't make sense of the input.
+struct PcmBuffer {
+    QByteArray samples;
+    QAudioFormat format;
+    bool isValid() const { return !samples.isEmpty() && format.sampleRate() > 0; }
+};
+
+// Parses a RIFF/WAVE byte buffer by walking its actual chunk structure —
+// not by assuming a fixed 44-byte header, which silently breaks on any file
+// with extra chunks before "data" (e.g. a LIST/INFO chunk some encoders
+// add, or an extended "fmt " chunk) and, worse, leaves the header's own
+// bytes attached to what callers then treat as raw PCM samples. Returns an
+// invalid (empty-samples) PcmBuffer if `wavBytes` isn't a well-formed
+// PCM/IEEE-float WAV file.
+PcmBuffer parseWavPcm(const QByteArray &wavBytes);
+
+// Where parseWavPcm() finds the samples, without copying them out: the
+// "data" chunk's offset into `bytes` and its length (trimmed to whole
+// frames). For callers that map the file rather than read it, e.g.
+// DecodedAudioStore. dataOffset is -1 if the buffer isn't a well-formed
+// PCM/IEEE-float WAV file.
+struct WavLayout {
+    QAudioFormat format;
+    qint64 dataOffset = -1;
+    qint64 dataSize = 0;
+    bool isValid() const { return dataOffset >= 0 && dataSize > 0 && format.sampleRate() > 0; }
+};
+WavLayout parseWavLayout(const char *bytes, qint64 size);
+
+#endif // WAVFILE_H
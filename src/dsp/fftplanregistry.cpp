@@ -0,0 +1,296 @@
+#include "fftplanregistry.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <cstdlib>
+
+namespace {
+
+// Guards the plan tables, the settings and the patient queue. Never held
+// while FFTW plans, so a lookup of a size that's already planned never
+// waits on a search.
+QMutex s_mutex;
+// Serializes FFTW's planner and its wisdom import/export (neither is
+// thread-safe), and the wisdom file settings they read.
+QMutex s_plannerMutex;
+
+QHash<quint64, fftw_plan>  s_plans64;
+QHash<quint64, fftwf_plan> s_plans32;
+
+FftPlanRegistry::Effort s_effort      = FftPlanRegistry::Effort::Patient;
+bool                    s_pathSet     = false;
+QString                 s_wisdomPath;
+bool                    s_wisdomRead  = false;
+
+// Keys planned with Measure at Patient effort, for the background pass to
+// search patiently: (key, single precision)
+QList<QPair<quint64, bool>> s_patientQueue;
+bool                        s_patientRunning = false;
+QWaitCondition              s_patientIdle;
+
+quint64 keyOf(int n, FftPlanRegistry::Direction dir) {
+    return (quint64(quint32(n)) << 1) | (dir == FftPlanRegistry::Direction::Inverse ? 1u : 0u);
+}
+
+// The rigor of wisdom a lookup accepts
+unsigned wisdomFlags(FftPlanRegistry::Effort effort) {
+    switch (effort) {
+    case FftPlanRegistry::Effort::Estimate: return FFTW_ESTIMATE;
+    case FftPlanRegistry::Effort::Measure:  return FFTW_MEASURE;
+    case FftPlanRegistry::Effort::Patient:  break;
+    }
+    return FFTW_PATIENT;
+}
+
+// The rigor a plan is made with on demand when no wisdom has it. Never more
+// than Measure: plans are made from whatever thread first wants the size —
+// the pitch monitor's detector is built on the GUI thread — and a patient
+// search there stalls the UI for seconds on a first launch. The patient
+// search is left to the background pass.
+unsigned plannerFlags(FftPlanRegistry::Effort effort) {
+    return effort == FftPlanRegistry::Effort::Estimate ? FFTW_ESTIMATE : FFTW_MEASURE;
+}
+
+QString currentPath() {
+    return s_pathSet ? s_wisdomPath : QDir::homePath() + "/.WakkaQt/fftw.wisdom";
+}
+
+// ----------------------
+// Wisdom file
+// ----------------------
+// fftw and fftwf keep separate wisdom, each exported as one balanced
+// s-expression ("(fftw-3.3.x fftw_wisdom ...)" / "(... fftwf_wisdom ...)").
+// The file is simply both of them, one after the other; reading splits it
+// back at the top-level parentheses and hands each to its own importer.
+// Both run under s_plannerMutex.
+void importWisdom() {
+    s_wisdomRead = true;
+    const QString path = currentPath();
+    if (path.isEmpty()) return;
+
+    QFile f(path);
+    if (!f.exists()) return;
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning() << "FftPlanRegistry: cannot read wisdom" << path << f.errorString();
+        return;
+    }
+    const QByteArray all = f.readAll();
+
+    int depth = 0, start = -1;
+    for (int i = 0; i < all.size(); ++i) {
+        if (all[i] == '(') {
+            if (depth++ == 0) start = i;
+        } else if (all[i] == ')' && depth > 0 && --depth == 0) {
+            const QByteArray part = all.mid(start, i - start + 1);
+            const bool single = part.left(64).contains("fftwf_wisdom");
+            const int ok = single ? fftwf_import_wisdom_from_string(part.constData())
+                                  : fftw_import_wisdom_from_string(part.constData());
+            if (!ok)   // e.g. written by another FFTW version — just replan
+                qWarning() << "FftPlanRegistry: ignoring stale" << (single ? "fftwf" : "fftw")
+                           << "wisdom in" << path;
+        }
+    }
+}
+
+void exportWisdom() {
+    const QString path = currentPath();
+    if (path.isEmpty()) return;
+
+    QByteArray all;
+    for (char* s : { fftw_export_wisdom_to_string(), fftwf_export_wisdom_to_string() }) {
+        if (!s) continue;
+        all.append(s);
+        all.append('\n');
+        std::free(s);
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly) || f.write(all) != all.size() || !f.commit())
+        qWarning() << "FftPlanRegistry: cannot write wisdom" << path << f.errorString();
+}
+
+// Where a plan came from: wisdom of the rigor asked for, wisdom of the
+// planner's lower rigor, or a search just now
+enum class Source { Wisdom, LowerWisdom, Planned };
+
+// One precision's planner entry points
+template <typename Plan, typename Real, typename Complex>
+struct Planner {
+    Real*    (*allocReal)(size_t);
+    Complex* (*allocComplex)(size_t);
+    void     (*release)(void*);
+    Plan     (*r2c)(int, Real*, Complex*, unsigned);
+    Plan     (*c2r)(int, Complex*, Real*, unsigned);
+
+    // Under s_plannerMutex. Planning overwrites its arrays, so it runs on
+    // throwaway ones of the right alignment.
+    Plan make(int n, FftPlanRegistry::Direction dir, unsigned wisdom, unsigned planner,
+              Source& source) const {
+        Plan p = nullptr;
+        Real*    re = allocReal(size_t(n));
+        Complex* cx = allocComplex(size_t(n / 2 + 1));
+        if (re && cx) {
+            const bool fwd = (dir == FftPlanRegistry::Direction::Forward);
+            auto plan = [&](unsigned flags) { return fwd ? r2c(n, re, cx, flags) : c2r(n, cx, re, flags); };
+            source = Source::Wisdom;
+            p = plan(wisdom | FFTW_WISDOM_ONLY);
+            if (!p && planner != wisdom) {
+                source = Source::LowerWisdom;
+                p = plan(planner | FFTW_WISDOM_ONLY);
+            }
+            if (!p) {
+                source = Source::Planned;
+                p = plan(planner);
+            }
+        }
+        release(re);
+        release(cx);
+        return p;
+    }
+};
+
+const Planner<fftw_plan, double, fftw_complex> kDouble = {
+    fftw_alloc_real, fftw_alloc_complex, fftw_free,
+    fftw_plan_dft_r2c_1d, fftw_plan_dft_c2r_1d };
+const Planner<fftwf_plan, float, fftwf_complex> kSingle = {
+    fftwf_alloc_real, fftwf_alloc_complex, fftwf_free,
+    fftwf_plan_dft_r2c_1d, fftwf_plan_dft_c2r_1d };
+
+void startPatientPass();
+
+// Looks the key up, planning (and persisting new wisdom) on a miss. A plan
+// made below the configured effort queues its key for the patient pass.
+template <typename Plan, typename Real, typename Complex>
+Plan lookup(QHash<quint64, Plan>& plans, bool single, int n, FftPlanRegistry::Direction dir,
+            const Planner<Plan, Real, Complex>& planner) {
+    if (n <= 0) return nullptr;
+    const quint64 key = keyOf(n, dir);
+    FftPlanRegistry::Effort effort;
+    {
+        QMutexLocker lk(&s_mutex);
+        auto it = plans.constFind(key);
+        if (it != plans.constEnd())
+            return it.value();
+        effort = s_effort;
+    }
+
+    QMutexLocker plk(&s_plannerMutex);
+    {
+        // Another thread may have planned it while this one waited
+        QMutexLocker lk(&s_mutex);
+        auto it = plans.constFind(key);
+        if (it != plans.constEnd())
+            return it.value();
+    }
+    if (!s_wisdomRead) importWisdom();
+
+    Source source = Source::Planned;
+    const unsigned flags = plannerFlags(effort);
+    Plan p = planner.make(n, dir, wisdomFlags(effort), flags, source);
+    if (p && source == Source::Planned && flags != FFTW_ESTIMATE)
+        exportWisdom();   // estimates add no wisdom
+    // A failed plan isn't cached: nullptr tells the caller to bail out, and
+    // the next request (maybe after memory frees up) tries again.
+    if (!p) return nullptr;
+
+    QMutexLocker lk(&s_mutex);
+    plans.insert(key, p);
+    if (effort == FftPlanRegistry::Effort::Patient && source != Source::Wisdom) {
+        s_patientQueue.append({key, single});
+        startPatientPass();
+    }
+    return p;
+}
+
+// ----------------------
+// Patient pass
+// ----------------------
+// Runs the FFTW_PATIENT search for queued keys on a pool thread at the
+// lowest priority, one key at a time, and saves the wisdom after each. The
+// plans already handed out stay in use for this run; the next launch (and
+// any detector or enhancer that asks for a size planned from here on) gets
+// the patient plan straight from wisdom. A size that's new while a search
+// is running waits for it — once per size per machine.
+void startPatientPass() {   // under s_mutex
+    if (s_patientRunning || s_patientQueue.isEmpty()) return;
+    s_patientRunning = true;
+    QThreadPool::globalInstance()->start([]() {
+        QThread::currentThread()->setPriority(QThread::LowestPriority);
+        for (;;) {
+            QPair<quint64, bool> next;
+            {
+                QMutexLocker lk(&s_mutex);
+                if (s_patientQueue.isEmpty()) {
+                    s_patientRunning = false;
+                    s_patientIdle.wakeAll();
+                    break;
+                }
+                next = s_patientQueue.takeFirst();
+            }
+            const int  n   = int(next.first >> 1);
+            const auto dir = (next.first & 1) ? FftPlanRegistry::Direction::Inverse
+                                              : FftPlanRegistry::Direction::Forward;
+            QMutexLocker plk(&s_plannerMutex);
+            Source source = Source::Wisdom;
+            if (next.second) {
+                if (fftwf_plan p = kSingle.make(n, dir, FFTW_PATIENT, FFTW_PATIENT, source))
+                    fftwf_destroy_plan(p);
+            } else {
+                if (fftw_plan p = kDouble.make(n, dir, FFTW_PATIENT, FFTW_PATIENT, source))
+                    fftw_destroy_plan(p);
+            }
+            if (source == Source::Planned) exportWisdom();
+        }
+        // Pool threads are reused for other work
+        QThread::currentThread()->setPriority(QThread::NormalPriority);
+    });
+}
+
+} // namespace
+
+fftw_plan FftPlanRegistry::plan(int n, Direction dir) {
+    return lookup(s_plans64, false, n, dir, kDouble);
+}
+
+fftwf_plan FftPlanRegistry::planF(int n, Direction dir) {
+    return lookup(s_plans32, true, n, dir, kSingle);
+}
+
+void FftPlanRegistry::waitForPatientPass() {
+    QMutexLocker lk(&s_mutex);
+    while (s_patientRunning)
+        s_patientIdle.wait(&s_mutex);
+}
+
+void FftPlanRegistry::setEffort(Effort effort) {
+    QMutexLocker lk(&s_mutex);
+    s_effort = effort;
+}
+
+FftPlanRegistry::Effort FftPlanRegistry::effort() {
+    QMutexLocker lk(&s_mutex);
+    return s_effort;
+}
+
+void FftPlanRegistry::setWisdomPath(const QString& path) {
+    QMutexLocker lk(&s_plannerMutex);
+    s_pathSet    = true;
+    s_wisdomPath = path;
+    s_wisdomRead = false;
+}
+
+QString FftPlanRegistry::wisdomPath() {
+    QMutexLocker lk(&s_plannerMutex);
+    return currentPath();
+}
@@ -0,0 +1,60 @@
+#ifndef FFTPLANREGISTRY_H
+#define FFTPLANREGISTRY_H
+
+#include <QString>
+#include <fftw3.h>
+
+// Process-wide FFTW plans for 1-D real transforms, keyed by size, direction
+// and precision, shared by every VocalEnhancer (PreviewDialog alone holds
+// two), PitchDetector and the separator's STFT/iSTFT — each used to plan
+// its own copy of the same handful of sizes, and the separator replanned on
+// every call.
+//
+// Plans are made once per key and live until the process exits. FFTW wisdom
+// is imported from wisdomPath() before the first plan and written back
+// whenever a plan had to be searched for, so the search is paid once per
+// machine rather than on every launch or dialog open. A key the wisdom has
+// at the configured effort (Patient by default) gets that plan. One it
+// hasn't is measured (FFTW_MEASURE) on the spot — the first plan of a size
+// can be asked for on the GUI thread — and, at Patient effort, queued for a
+// FFTW_PATIENT search on a low-priority pool thread, whose wisdom serves
+// every later launch.
+//
+// Every plan is out-of-place and was made on fftw_malloc'd arrays: callers
+// run it through the new-array interface (fftw_execute_dft_r2c/c2r) on their
+// own fftw_malloc'd, non-overlapping buffers. That interface is thread-safe,
+// so one plan serves any number of threads at once. FFTW's planner is not —
+// nothing else in the app may create or destroy plans except through here.
+class FftPlanRegistry
+{
+public:
+    enum class Direction { Forward, Inverse };        // r2c, c2r (unnormalised)
+    enum class Effort    { Estimate, Measure, Patient };
+
+    // nullptr if FFTW couldn't plan (or allocate for planning) that size
+    static fftw_plan  plan(int n, Direction dir);
+    static fftwf_plan planF(int n, Direction dir);
+
+    // Rigor of the wisdom used for plans made after the call; plans the
+    // wisdom doesn't cover are made at min(effort, Measure), and searched
+    // patiently in the background at Patient. Wisdom of at least the
+    // requested rigor is always used, so lowering this never undoes what an
+    // earlier patient search already found.
+    static void   setEffort(Effort effort);
+    static Effort effort();
+
+    // Blocks until the background patient searches queued so far are done
+    // and their wisdom saved (tests)
+    static void   waitForPatientPass();
+
+    // Both precisions' wisdom, in one file. Defaults to ~/.WakkaQt/fftw.wisdom;
+    // an empty path keeps wisdom in memory only (tests). Setting it re-imports
+    // from the new path before the next plan is made.
+    static void    setWisdomPath(const QString& path);
+    static QString wisdomPath();
+
+private:
+    FftPlanRegistry() = delete;
+};
+
+#endif // FFTPLANREGISTRY_H
@@ -0,0 +1,234 @@
+#include "pitchdetector.h"
+#include "fftplanregistry.h"
+
+#include <cmath>
+#include <algorithm>
+
+static int nextPow2(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// ======================
+// Per-thread scratch
+// ======================
+// Buffers for the correlation FFTs, grown on demand and reused for every
+// call on this thread. fftw_malloc gives the alignment the plans were made
+// with, which the new-array execute functions require.
+namespace {
+struct Scratch {
+    int           cap  = 0;
+    double*       a    = nullptr;   // first W/2 samples, zero-padded
+    double*       b    = nullptr;   // W/2 + maxTau samples, zero-padded
+    double*       corr = nullptr;   // IFFT output: cross-correlation r(τ)·L
+    fftw_complex* A    = nullptr;
+    fftw_complex* B    = nullptr;
+    QVector<double> energy;         // prefix sums of x² over the analysed block
+    QVector<double> d;
+    QVector<double> cmnd;
+
+    ~Scratch() { release(); }
+
+    bool ensure(int L) {
+        if (L <= cap) return true;
+        release();
+        a    = fftw_alloc_real(L);
+        b    = fftw_alloc_real(L);
+        corr = fftw_alloc_real(L);
+        A    = fftw_alloc_complex(L / 2 + 1);
+        B    = fftw_alloc_complex(L / 2 + 1);
+        if (!a || !b || !corr || !A || !B) { release(); return false; }
+        cap = L;
+        return true;
+    }
+
+    void release() {
+        fftw_free(a); fftw_free(b); fftw_free(corr);
+        fftw_free(A); fftw_free(B);
+        a = b = corr = nullptr;
+        A = B = nullptr;
+        cap = 0;
+    }
+};
+thread_local Scratch t_scratch;
+} // namespace
+
+// ----------------------
+// Constructor / destructor
+// ----------------------
+PitchDetector::PitchDetector(const Params& params)
+    : m_params(params)
+{
+    m_params.sampleRate = std::max(1, m_params.sampleRate);
+    m_params.maxWindow  = std::max(4, m_params.maxWindow);
+    m_params.minWindow  = std::clamp(m_params.minWindow, 4, m_params.maxWindow);
+
+    // Every correlation size a block of minWindow..maxWindow samples can
+    // need — a few powers of two — resolved once here and kept, so
+    // analyse() (called from every detection worker at once) never goes
+    // back to the registry and its lock.
+    auto fftSizeFor = [this](int W) {
+        const int h      = W / 2;
+        const int maxTau = std::min(h, int(double(m_params.sampleRate) / std::max(1.0, m_params.minHz)));
+        return nextPow2(h + maxTau);
+    };
+    m_minFftSize = fftSizeFor(m_params.minWindow);
+    for (int L = m_minFftSize; L <= fftSizeFor(m_params.maxWindow); L <<= 1) {
+        // Shared with every other detector (and the enhancer's 2048-point PV)
+        m_plans.append({ FftPlanRegistry::plan(L, FftPlanRegistry::Direction::Forward),
+                         FftPlanRegistry::plan(L, FftPlanRegistry::Direction::Inverse) });
+    }
+}
+
+PitchDetector::Plans PitchDetector::plansFor(int L) const {
+    int i = 0;
+    for (int size = m_minFftSize; size < L; size <<= 1)
+        ++i;
+    return i < m_plans.size() ? m_plans[i] : Plans();
+}
+
+// ======================
+// YIN
+// ======================
+template <typename T>
+PitchDetector::Result PitchDetector::analyseImpl(SampleSpan<T> x) const {
+    const Params& P = m_params;
+    const int n = int(x.size());
+    const int W = std::min(n, P.maxWindow);
+    if (W < P.minWindow) return {};
+
+    const int sr     = P.sampleRate;
+    const int minTau = std::max(2, int(double(sr) / std::max(1.0, P.maxHz)));
+    const int maxTau = std::min(W / 2, int(double(sr) / std::max(1.0, P.minHz)));
+    if (minTau >= maxTau) return {};
+
+    // Choose the block with the highest RMS (or simply the first W samples)
+    int    bestStart = (n - W) / 2;
+    double bestRms   = 0.0;
+    if (P.loudestBlock) {
+        for (int i = 0; i + W <= n; i += std::max(1, W / 4)) {
+            double rms = 0.0;
+            for (int j = 0; j < W; ++j) rms += double(x[i + j]) * double(x[i + j]);
+            rms = std::sqrt(rms / W);
+            if (rms > bestRms) { bestRms = rms; bestStart = i; }
+        }
+        if (bestRms < P.silenceRms) return {};  // silence
+    } else {
+        bestStart = 0;
+        if (P.silenceRms > 0.0) {
+            for (int j = 0; j < W; ++j) bestRms += double(x[j]) * double(x[j]);
+            if (std::sqrt(bestRms / W) < P.silenceRms) return {};
+        }
+    }
+
+    // Step 1: Difference function d[τ] = Σ_{j<W/2} (x[j] − x[j+τ])²
+    //                                  = e(0) + e(τ) − 2·r(τ)
+    const int half = W / 2;
+    const int span = half + maxTau;              // samples the lags reach into
+    const int L    = nextPow2(span);             // no circular wrap for τ ≤ maxTau
+    const Plans plans = plansFor(L);
+    Scratch& s = t_scratch;
+    if (!plans.fwd || !plans.inv || !s.ensure(L)) return {};
+
+    const T* src = x.data() + bestStart;
+    s.energy.resize(span + 1);
+    s.energy[0] = 0.0;
+    for (int j = 0; j < span; ++j) {
+        const double v = double(src[j]);
+        s.b[j] = v;
+        s.a[j] = (j < half) ? v : 0.0;
+        s.energy[j + 1] = s.energy[j] + v * v;
+    }
+    std::fill(s.a + span, s.a + L, 0.0);
+    std::fill(s.b + span, s.b + L, 0.0);
+
+    fftw_execute_dft_r2c(plans.fwd, s.a, s.A);
+    fftw_execute_dft_r2c(plans.fwd, s.b, s.B);
+    // Cross-correlation: conj(A)·B
+    for (int k = 0; k <= L / 2; ++k) {
+        const double ar = s.A[k][0], ai = -s.A[k][1];
+        const double br = s.B[k][0], bi =  s.B[k][1];
+        s.A[k][0] = ar * br - ai * bi;
+        s.A[k][1] = ar * bi + ai * br;
+    }
+    fftw_execute_dft_c2r(plans.inv, s.A, s.corr);
+
+    const double e0 = s.energy[half];
+    s.d.fill(0.0, maxTau + 1);
+    for (int tau = 1; tau <= maxTau; ++tau) {
+        const double eTau = s.energy[tau + half] - s.energy[tau];
+        const double r    = s.corr[tau] / L;
+        s.d[tau] = std::max(0.0, e0 + eTau - 2.0 * r);
+    }
+
+    // Step 2: Cumulative Mean Normalized Difference (CMND)
+    QVector<double>& cmnd = s.cmnd;
+    cmnd.fill(1.0, maxTau + 1);
+    double cumSum = 0.0;
+    for (int tau = 1; tau <= maxTau; ++tau) {
+        cumSum += s.d[tau];
+        cmnd[tau] = (cumSum > 1e-12) ? s.d[tau] * double(tau) / cumSum : 1.0;
+    }
+
+    // Step 3: First tau below threshold, advanced to the bottom of that dip
+    int bestTau = -1;
+    for (int tau = minTau; tau < maxTau; ++tau) {
+        if (cmnd[tau] < P.threshold) {
+            while (tau + 1 <= maxTau && cmnd[tau + 1] <= cmnd[tau])
+                ++tau;
+            bestTau = tau;
+            break;
+        }
+    }
+
+    // Fallback: global minimum in range
+    if (bestTau < 1) {
+        if (P.fallbackMaxCmnd <= 0.0) return {};
+        int minIdx = minTau;
+        for (int tau = minTau + 1; tau <= maxTau; ++tau)
+            if (cmnd[tau] < cmnd[minIdx]) minIdx = tau;
+        if (cmnd[minIdx] > P.fallbackMaxCmnd) return {}; // unreliable, treat as unvoiced
+        bestTau = minIdx;
+    }
+
+    // Step 4: Parabolic interpolation
+    double refinedTau = double(bestTau);
+    if (bestTau > minTau && bestTau < maxTau) {
+        const double y0 = cmnd[bestTau - 1];
+        const double y1 = cmnd[bestTau];
+        const double y2 = cmnd[bestTau + 1];
+        const double denom = y0 - 2.0 * y1 + y2;
+        if (std::abs(denom) > 1e-12)
+            refinedTau = double(bestTau) + 0.5 * (y0 - y2) / denom;
+    }
+
+    Result r;
+    const double freq = double(sr) / std::max(refinedTau, 1.0);
+    r.cmnd = cmnd[bestTau];
+    r.hz   = (freq > P.minValidHz && freq < P.maxValidHz) ? freq : 0.0;
+    return r;
+}
+
+template <typename T>
+QVector<PitchDetector::Result> PitchDetector::analyseFramesImpl(SampleSpan<T> x,
+                                                                int frameLen, int hop) const {
+    QVector<Result> out;
+    if (frameLen <= 0 || hop <= 0 || x.size() < frameLen) return out;
+    out.reserve(int((x.size() - frameLen) / hop + 1));
+    for (qsizetype pos = 0; pos + frameLen <= x.size(); pos += hop)
+        out.append(analyseImpl(x.mid(pos, frameLen)));
+    return out;
+}
+
+PitchDetector::Result PitchDetector::analyse(SampleSpan<double> input) const { return analyseImpl(input); }
+PitchDetector::Result PitchDetector::analyse(SampleSpan<float>  input) const { return analyseImpl(input); }
+
+QVector<PitchDetector::Result> PitchDetector::analyseFrames(SampleSpan<double> input,
+                                                            int frameLen, int hop) const {
+    return analyseFramesImpl(input, frameLen, hop);
+}
+QVector<PitchDetector::Result> PitchDetector::analyseFrames(SampleSpan<float> input,
+                                                            int frameLen, int hop) const {
+    return analyseFramesImpl(input, frameLen, hop);
+}
@@ -0,0 +1,108 @@
+#ifndef PITCHDETECTOR_H
+#define PITCHDETECTOR_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <algorithm>
+#include <fftw3.h>
+
+// Read-only view over contiguous samples — a C++17 stand-in for
+// std::span<const T>, so callers can hand over a slice of a larger buffer
+// (a stream's pending input, a decoded track at some hop position) without
+// first copying it into a QVector of its own.
+template <typename T>
+struct SampleSpan {
+    const T*  ptr = nullptr;
+    qsizetype len = 0;
+
+    SampleSpan() = default;
+    SampleSpan(const T* data, qsizetype size) : ptr(data), len(size) {}
+    SampleSpan(const QVector<T>& v) : ptr(v.constData()), len(v.size()) {}
+
+    const T*  data()  const { return ptr; }
+    qsizetype size()  const { return len; }
+    bool      isEmpty() const { return len <= 0; }
+    const T&  operator[](qsizetype i) const { return ptr[i]; }
+    const T*  begin() const { return ptr; }
+    const T*  end()   const { return ptr + len; }
+
+    // Clipped to this span, like QVector::mid()
+    SampleSpan mid(qsizetype pos, qsizetype n = -1) const {
+        pos = std::clamp<qsizetype>(pos, 0, len);
+        if (n < 0 || pos + n > len) n = len - pos;
+        return SampleSpan(ptr + pos, n);
+    }
+};
+
+// YIN monophonic pitch detector (de Cheveigne & Kawahara 2002), shared by
+// VocalEnhancer's pitch map, the render pitch overlay and the live
+// PitchMonitorWidget — all three used to carry their own brute-force copy.
+//
+// The difference function d(τ) = Σ (x[j] − x[j+τ])² is expanded as
+// e(0) + e(τ) − 2·r(τ): the energy terms come from a running sum of squares
+// and the cross term r(τ) from one FFT correlation, O(W log W) instead of
+// the O(W·τ) double loop. Plans come from FftPlanRegistry (shared
+// process-wide, per FFT size), fetched once by the constructor for every
+// size the detector can need, and scratch buffers are per thread, so a
+// single detector can be shared by several threads calling detect() at once
+// without any locking.
+class PitchDetector
+{
+public:
+    struct Params {
+        int    sampleRate      = 44100;
+        int    maxWindow       = 2048;   // analysed block W; lags integrate over W/2
+        int    minWindow       = 512;    // shorter inputs are reported unvoiced
+        double minHz           = 80.0;   // → maxTau (also capped at W/2)
+        double maxHz           = 1100.0; // → minTau (never below 2)
+        double threshold       = 0.12;   // CMND absolute threshold (paper: 0.10–0.15)
+        double fallbackMaxCmnd = 0.50;   // accept the global CMND minimum up to this; <= 0 disables
+        double silenceRms      = 1e-4;   // quieter blocks are unvoiced without analysis
+        bool   loudestBlock    = true;   // analyse the highest-RMS W-block of a longer input
+        double minValidHz      = 50.0;   // results outside (minValidHz, maxValidHz) → 0
+        double maxValidHz      = 1200.0;
+    };
+
+    struct Result {
+        double hz   = 0.0;   // 0 = unvoiced / unreliable
+        double cmnd = 1.0;   // CMND value at the chosen lag (lower = more periodic)
+    };
+
+    explicit PitchDetector(const Params& params);
+
+    PitchDetector(const PitchDetector&) = delete;
+    PitchDetector& operator=(const PitchDetector&) = delete;
+
+    const Params& params() const { return m_params; }
+
+    // Pitch of one block (up to maxWindow samples; see loudestBlock for longer
+    // inputs). Thread-safe.
+    Result analyse(SampleSpan<double> input) const;
+    Result analyse(SampleSpan<float>  input) const;
+    double detect(SampleSpan<double> input) const { return analyse(input).hz; }
+    double detect(SampleSpan<float>  input) const { return analyse(input).hz; }
+
+    // Batch entry point: one result per frame [k·hop, k·hop + frameLen) for
+    // every frame that fits entirely inside `input`.
+    QVector<Result> analyseFrames(SampleSpan<double> input, int frameLen, int hop) const;
+    QVector<Result> analyseFrames(SampleSpan<float>  input, int frameLen, int hop) const;
+
+private:
+    struct Plans {
+        fftw_plan fwd = nullptr;
+        fftw_plan inv = nullptr;
+    };
+
+    template <typename T> Result analyseImpl(SampleSpan<T> input) const;
+    template <typename T> QVector<Result> analyseFramesImpl(SampleSpan<T> input,
+                                                            int frameLen, int hop) const;
+    Plans plansFor(int fftSize) const;   // one of m_plans; null if out of range
+
+    Params m_params;
+    // Registry plans for each power-of-two correlation size from
+    // m_minFftSize up, resolved by the constructor
+    int            m_minFftSize = 1;
+    QVector<Plans> m_plans;
+};
+
+#endif // PITCHDETECTOR_H
@@ -0,0 +1,127 @@
+#include "pitchtrack.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+
+// Layout (little endian): magic, version, the recording's size and head/tail
+// hash, originMs, frame count, then 13 bytes per frame — ms (u32), hz and
+// confidence (f32), target note (i8). A five-minute take is about 50 KB.
+static constexpr quint32 kMagic      = 0x54505157;   // "WQPT"
+static constexpr quint16 kVersion    = 1;
+static constexpr int     kFrameBytes = 4 + 4 + 4 + 1;
+static constexpr qint64  kSampleSpan = 64 * 1024;    // bytes hashed at each end
+
+// Size and SHA-1 of the first and last kSampleSpan bytes: cheap on a long
+// WAV, and a new take at the same path differs in both (header sizes, audio)
+static bool fingerprint(const QString &recordingPath, qint64 *size, QByteArray *hash)
+{
+    QFile f(recordingPath);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    *size = f.size();
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(f.read(kSampleSpan));
+    if (*size > kSampleSpan) {
+        if (!f.seek(std::max(kSampleSpan, *size - kSampleSpan)))
+            return false;
+        h.addData(f.readAll());
+    }
+    *hash = h.result();
+    return true;
+}
+
+static void setUpStream(QDataStream &s)
+{
+    s.setByteOrder(QDataStream::LittleEndian);
+    s.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+QString PitchTrack::sidecarPathFor(const QString &recordingPath)
+{
+    const QFileInfo fi(recordingPath);
+    return fi.dir().filePath(fi.completeBaseName() + ".pitch");
+}
+
+bool PitchTrack::save(const QString &path, const QString &recordingPath) const
+{
+    qint64 size = 0;
+    QByteArray hash;
+    if (!fingerprint(recordingPath, &size, &hash)) {
+        qWarning() << "PitchTrack: cannot read" << recordingPath;
+        return false;
+    }
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning() << "PitchTrack: cannot write" << path;
+        return false;
+    }
+    QDataStream s(&f);
+    setUpStream(s);
+    s << kMagic << kVersion << size;
+    s.writeRawData(hash.constData(), hash.size());
+    s << originMs << quint32(frames.size());
+    for (const Frame &fr : frames)
+        s << quint32(std::max<qint64>(0, fr.ms)) << fr.hz << fr.confidence << fr.targetMidi;
+
+    if (s.status() != QDataStream::Ok || !f.commit()) {
+        qWarning() << "PitchTrack: writing" << path << "failed";
+        return false;
+    }
+    return true;
+}
+
+bool PitchTrack::load(const QString &path, const QString &recordingPath, PitchTrack *out)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream s(&f);
+    setUpStream(s);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64  size = -1;
+    s >> magic >> version >> size;
+    if (magic != kMagic || version != kVersion) {
+        qWarning() << "PitchTrack: not a pitch track (or another version):" << path;
+        return false;
+    }
+    QByteArray hash(QCryptographicHash::hashLength(QCryptographicHash::Sha1), '\0');
+    if (s.readRawData(hash.data(), hash.size()) != hash.size())
+        return false;
+
+    qint64 recSize = 0;
+    QByteArray recHash;
+    if (!fingerprint(recordingPath, &recSize, &recHash) || recSize != size || recHash != hash) {
+        qInfo() << "PitchTrack:" << path << "belongs to another recording, ignoring it";
+        return false;
+    }
+
+    PitchTrack track;
+    quint32 count = 0;
+    s >> track.originMs >> count;
+    if (s.status() != QDataStream::Ok || qint64(count) * kFrameBytes > f.bytesAvailable()) {
+        qWarning() << "PitchTrack: truncated" << path;
+        return false;
+    }
+    track.frames.resize(count);
+    for (Frame &fr : track.frames) {
+        quint32 ms = 0;
+        s >> ms >> fr.hz >> fr.confidence >> fr.targetMidi;
+        fr.ms = ms;
+    }
+    if (s.status() != QDataStream::Ok) {
+        qWarning() << "PitchTrack: truncated" << path;
+        return false;
+    }
+    *out = std::move(track);
+    return true;
+}
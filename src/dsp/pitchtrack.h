@@ -0,0 +1,50 @@
+#ifndef PITCHTRACK_H
+#define PITCHTRACK_H
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// The pitch analysis VocalEnhancer already does on its way to correcting a
+// take, kept so the render's pitch overlay doesn't decode the raw vocal and
+// run YIN over it a second time. PreviewDialog writes it after every full
+// enhancement as a small binary sidecar next to the raw recording (see
+// sidecarPathFor()), SessionRepository carries it into and out of the
+// library, and FFmpegNative::renderVideo() reads it back — analysing the
+// recording itself only when there is no usable sidecar.
+//
+// The file fingerprints the recording it was analysed from (size plus a
+// hash of its head and tail), since the live recording sits at a fixed /tmp
+// path that every new take overwrites: a sidecar left behind by an earlier
+// take simply fails to load().
+struct PitchTrack
+{
+    // One per enhancer detection window (~80 ms apart)
+    struct Frame {
+        qint64 ms         = 0;     // window start, from the first sample the enhancer saw
+        float  hz         = 0.0f;  // smoothed pitch; 0 = unvoiced
+        float  confidence = 0.0f;  // autocorrelation confidence of the raw detection
+        qint8  targetMidi = -1;    // note the correction pulls towards; -1 = none
+    };
+
+    // Where the enhancer's ms 0 falls in the raw recording. PreviewDialog
+    // enhances the take with its start trimmed by the audio offset; the
+    // enhancer itself can't know that, so it leaves this at 0.
+    qint64         originMs = 0;
+    QVector<Frame> frames;
+
+    bool isEmpty() const { return frames.isEmpty(); }
+
+    // "<dir>/<base>.pitch" for recording "<dir>/<base>.<ext>"
+    static QString sidecarPathFor(const QString &recordingPath);
+
+    // Written through QSaveFile, so a reader never sees half a file.
+    // False if recordingPath can't be read or the write fails.
+    bool save(const QString &path, const QString &recordingPath) const;
+
+    // False, leaving *out untouched, if path is missing, malformed, of
+    // another format version or fingerprints a different recording.
+    static bool load(const QString &path, const QString &recordingPath, PitchTrack *out);
+};
+
+#endif // PITCHTRACK_H
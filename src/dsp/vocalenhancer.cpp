@@ -1,10 +1,16 @@
 #include "vocalenhancer.h"
+#include "fftplanregistry.h"
 
 #include <QDebug>
+#include <QHash>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
 #include <cmath>
 #include <complex>
 #include <algorithm>
 #include <cstring>
+#include <numeric>
+#include <vector>
 #include <fftw3.h>
 
 static constexpr double kPi = 3.1415926535897932384626433832795;
@@ -16,6 +22,15 @@ static inline double principalArg(double phase) {
     return phase - kPi;
 }
 
+// Float twin for the single-precision kernels: subtracting the nearest
+// multiple of 2π is branch-free and vectorises, where fmod() does neither
+// and was the costliest call in the phase-vocoder bin loop.
+static inline float principalArg(float phase) {
+    constexpr float twoPi    = float(2.0 * kPi);
+    constexpr float invTwoPi = float(1.0 / (2.0 * kPi));
+    return phase - twoPi * std::nearbyint(phase * invTwoPi);
+}
+
 // Zero-Crossing Rate — crude voicing cue (higher on unvoiced consonants/noise)
 static double zeroCrossingRate(const QVector<double>& x) {
     if (x.size() < 2) return 0.0;
@@ -33,6 +48,615 @@ static inline double lerpParam(double a, double b, double t) {
     return a + (b - a) * std::clamp(t, 0.0, 1.0);
 }
 
+// ----------------------
+// Spectral kernels (double or float)
+// ----------------------
+// The spectral gate and the phase vocoder account for nearly all of
+// enhance()'s runtime. Their per-frame work is written once over the sample
+// type R and instantiated for double (fftw_*) and float (fftwf_*); see
+// setPrecision(). Only the FFT buffers and per-bin state change type — the
+// overlap-add accumulators and everything between stages stay double, so the
+// two paths differ by float rounding inside a frame and nothing more.
+template <typename R> struct Fftw;
+template <> struct Fftw<double> {
+    using Complex = fftw_complex;
+    using Plan    = fftw_plan;
+    static void r2c(Plan p, double* in, Complex* out) { fftw_execute_dft_r2c(p, in, out); }
+    static void c2r(Plan p, Complex* in, double* out) { fftw_execute_dft_c2r(p, in, out); }
+    static double*  allocReal(int n)    { return fftw_alloc_real(n); }
+    static Complex* allocComplex(int n) { return fftw_alloc_complex(n); }
+    static void     free(void* p)       { fftw_free(p); }
+};
+template <> struct Fftw<float> {
+    using Complex = fftwf_complex;
+    using Plan    = fftwf_plan;
+    static void r2c(Plan p, float* in, Complex* out) { fftwf_execute_dft_r2c(p, in, out); }
+    static void c2r(Plan p, Complex* in, float* out) { fftwf_execute_dft_c2r(p, in, out); }
+    static float*   allocReal(int n)    { return fftwf_alloc_real(n); }
+    static Complex* allocComplex(int n) { return fftwf_alloc_complex(n); }
+    static void     free(void* p)       { fftwf_free(p); }
+};
+
+// One r2c/c2r plan pair (shared, see FftPlanRegistry) and the buffers this
+// enhancer runs it on (not owning)
+template <typename R>
+struct SpectralPlans {
+    using Complex = typename Fftw<R>::Complex;
+    R*       in   = nullptr;
+    Complex* out  = nullptr;
+    Complex* spec = nullptr;
+    R*       ifft = nullptr;
+    typename Fftw<R>::Plan fwd = nullptr;
+    typename Fftw<R>::Plan inv = nullptr;
+
+    bool ok() const { return in && out && spec && ifft && fwd && inv; }
+};
+
+// Per-bin state of the spectral gate. `frameGains` holds one call's worth
+// of per-frame masks in stereo mode (see synthesiseLanes()).
+template <typename R>
+struct GateBins {
+    QVector<R> window, noiseMag, prevGain, magBuf, magSm, mask, frameGains;
+
+    void reset(const QVector<double>& win) {
+        const int bins = win.size() / 2 + 1;
+        window = QVector<R>(win.begin(), win.end());
+        noiseMag.fill(R(0), bins);
+        prevGain.fill(R(1), bins);
+        magBuf.fill(R(0), bins);
+        magSm.fill(R(0), bins);
+        mask.fill(R(1), bins);
+        frameGains.clear();
+    }
+};
+
+// Per-bin state of the phase vocoder (`frameGains`: per-frame rotations)
+template <typename R>
+struct PvBins {
+    QVector<R> window, omega, prevPhase, sumPhase, mag, phase, frameGains;
+
+    void reset(const QVector<double>& win) {
+        const int N    = win.size();
+        const int bins = N / 2 + 1;
+        window = QVector<R>(win.begin(), win.end());
+        omega.resize(bins);
+        for (int k = 0; k < bins; ++k)
+            omega[k] = R(2.0 * kPi * k / N);
+        prevPhase.fill(R(0), bins);
+        sumPhase.fill(R(0), bins);
+        mag.fill(R(0), bins);
+        phase.fill(R(0), bins);
+        frameGains.clear();
+    }
+};
+
+// FFT buffers of one channel lane. The plans are shared; each lane runs them
+// on its own arrays through FFTW's new-array execute functions, which are
+// thread-safe, so the lanes of a stereo take can be synthesised at once.
+// fftw_alloc gives the alignment the plans were created with.
+template <typename R>
+struct LaneScratch {
+    using Complex = typename Fftw<R>::Complex;
+    R*       in   = nullptr;
+    Complex* spec = nullptr;
+    R*       ifft = nullptr;
+
+    explicit LaneScratch(int N)
+        : in(Fftw<R>::allocReal(N)), spec(Fftw<R>::allocComplex(N / 2 + 1)),
+          ifft(Fftw<R>::allocReal(N)) {}
+    LaneScratch(LaneScratch&& o) noexcept : in(o.in), spec(o.spec), ifft(o.ifft) {
+        o.in = nullptr; o.spec = nullptr; o.ifft = nullptr;
+    }
+    LaneScratch(const LaneScratch&) = delete;
+    LaneScratch& operator=(const LaneScratch&) = delete;
+    ~LaneScratch() { Fftw<R>::free(in); Fftw<R>::free(spec); Fftw<R>::free(ifft); }
+
+    bool ok() const { return in && spec && ifft; }
+};
+
+// The kernels below only index raw local pointers (FFTW's complex arrays
+// viewed as interleaved re/im): with -fno-strict-aliasing, going through
+// fft.out[k] or a QVector's operator[] makes the compiler reload the base
+// pointer after every store, which is enough to keep a loop scalar.
+template <typename R>
+static inline R* interleaved(typename Fftw<R>::Complex* c) { return &c[0][0]; }
+
+// Magnitude of each bin of `X` (+ floor), as its own pass so it vectorises
+template <typename R>
+static void binMagnitudes(const R* X, R* mag, int bins, R floor) {
+    for (int k = 0; k < bins; ++k)
+        mag[k] = std::sqrt(X[2 * k] * X[2 * k] + X[2 * k + 1] * X[2 * k + 1]) + floor;
+}
+
+// Windowed copy of x[0..N) into the forward plan's input
+template <typename R>
+static void loadFrame(const double* x, const R* window, R* in, int N) {
+    for (int i = 0; i < N; ++i)
+        in[i] = R(x[i]) * window[i];
+}
+
+// Overlap-adds the inverse plan's (unnormalised) output, windowed again,
+// plus the squared window for the later normalisation
+template <typename R>
+static void overlapAdd(const R* ifft, const R* window, double* o, double* w, int N) {
+    const R invN = R(1) / R(N);
+    for (int i = 0; i < N; ++i) {
+        o[i] += double((ifft[i] * invN) * window[i]);
+        w[i] += double(window[i] * window[i]);
+    }
+}
+
+// Adds one windowed frame's magnitudes to the noise estimate (learning phase)
+template <typename R>
+static void gateLearnFrame(const double* x, GateBins<R>& b, const SpectralPlans<R>& fft) {
+    const int N    = b.window.size();
+    const int bins = N / 2 + 1;
+    R* mag   = b.magBuf.data();
+    R* noise = b.noiseMag.data();
+    loadFrame<R>(x, b.window.constData(), fft.in, N);
+    Fftw<R>::r2c(fft.fwd, fft.in, fft.out);
+    binMagnitudes<R>(interleaved<R>(fft.out), mag, bins, R(1e-12));
+    for (int k = 0; k < bins; ++k)
+        noise[k] += mag[k];
+}
+
+// Turns the accumulated learning-phase magnitudes into their average
+template <typename R>
+static void gateFinishLearning(GateBins<R>& b, int frames) {
+    for (int k = 0; k < b.noiseMag.size(); ++k) {
+        if (frames > 0) b.noiseMag[k] /= R(frames);
+        if (b.noiseMag[k] <= R(0)) b.noiseMag[k] = R(1e-12);
+    }
+}
+
+// Spectral-subtraction gain of one frame x[0..N) into mask[0..bins) (the
+// bins nearest DC floored), leaving the frame's spectrum in fft.out. The
+// noise model and per-bin gain smoothing live in `b`.
+template <typename R>
+static void gateMask(const double* x, R* mask, GateBins<R>& b, const SpectralPlans<R>& fft,
+                     double overSub, double gFloor, double adaptivity, double lowEnergyDb) {
+    const int N    = b.window.size();
+    const int bins = N / 2 + 1;
+    const R* window = b.window.constData();
+    R* X        = interleaved<R>(fft.out);
+    R* mag      = b.magBuf.data();
+    R* magSm    = b.magSm.data();
+    R* noiseMag = b.noiseMag.data();
+    R* prevGain = b.prevGain.data();
+
+    double frameRmsAcc = 0.0;
+    for (int i = 0; i < N; ++i)
+        frameRmsAcc += x[i] * x[i];
+    const double frameRms = std::sqrt(frameRmsAcc / N);
+    const double frameDbFS = 20.0 * std::log10(std::max(frameRms, 1e-12)); // approximate dBFS
+
+    loadFrame<R>(x, window, fft.in, N);
+    Fftw<R>::r2c(fft.fwd, fft.in, fft.out);
+
+    // Magnitudes
+    binMagnitudes<R>(X, mag, bins, R(1e-12));
+
+    // A tiny 3-bin frequency smoothing kernel tames isolated spikes (bins is
+    // kNgN/2 + 1, never below 2)
+    magSm[0] = R(0.75) * mag[0] + R(0.25) * mag[1];
+    for (int k = 1; k < bins - 1; ++k)
+        magSm[k] = R(0.25) * mag[k - 1] + R(0.5) * mag[k] + R(0.25) * mag[k + 1];
+    magSm[bins - 1] = R(0.25) * mag[bins - 2] + R(0.75) * mag[bins - 1];
+
+    // Temporal smoothing constants for gain (0..1). Larger = more smoothing.
+    const R atk     = R(0.60);  // when gain needs to go down (more suppression)
+    const R rel     = R(0.85);  // when gain can go up (less suppression)
+    const R floorG  = R(gFloor);
+    const R dcFloor = R(0.5 * gFloor);
+    const R over    = R(overSub);
+
+    // Compute gains (branch-free per bin, so the loop vectorises)
+    for (int k = 0; k < bins; ++k) {
+        const R m  = std::max(magSm[k], R(1e-12));
+        const R nz = std::max(noiseMag[k], R(1e-12));
+
+        // Simple spectral subtraction style gain
+        R G = R(1) - over * (nz / m);
+        G = std::min(std::max(G, floorG), R(1));
+
+        // Temporal smoothing (per bin)
+        const R gPrev = prevGain[k];
+        const R c     = (G < gPrev) ? atk : rel;          // faster down, slower up
+        const R gSm   = c * gPrev + (R(1) - c) * G;
+        prevGain[k]   = gSm;
+        mask[k]       = gSm;
+    }
+    // Avoid blowing away bins near DC completely
+    for (int k = 0; k < std::min(bins, 3); ++k)
+        mask[k] = std::max(prevGain[k], dcFloor);
+
+    // Slow noise model adaptation during low-energy frames
+    // Helps when noise changes between sentences/phrases
+    if (frameDbFS < lowEnergyDb && adaptivity > 1e-6) {
+        const double a = std::clamp(adaptivity, 0.0, 0.5); // keep small
+        const R keep = R(1.0 - a), take = R(a);
+        for (int k = 0; k < bins; ++k) {
+            // Smoothly track downwards and (very) slowly upwards
+            const R nz  = keep * noiseMag[k] + take * magSm[k];
+            noiseMag[k] = (nz <= R(1e-12)) ? R(1e-12) : nz;
+        }
+    }
+}
+
+// Y = X · mask, per bin (interleaved complex X/Y, real mask)
+template <typename R>
+static void applyMask(const R* X, const R* mask, R* Y, int bins) {
+    for (int k = 0; k < bins; ++k) {
+        Y[2 * k]     = X[2 * k]     * mask[k];
+        Y[2 * k + 1] = X[2 * k + 1] * mask[k];
+    }
+}
+
+// One spectral-subtraction frame: x[0..N) in, windowed result overlap-added
+// into o/w.
+template <typename R>
+static void gateFrame(const double* x, double* o, double* w,
+                      GateBins<R>& b, const SpectralPlans<R>& fft,
+                      double overSub, double gFloor, double adaptivity, double lowEnergyDb) {
+    const int N    = b.window.size();
+    const int bins = N / 2 + 1;
+    gateMask<R>(x, b.mask.data(), b, fft, overSub, gFloor, adaptivity, lowEnergyDb);
+    applyMask<R>(interleaved<R>(fft.out), b.mask.constData(), interleaved<R>(fft.spec), bins);
+    Fftw<R>::c2r(fft.inv, fft.spec, fft.ifft);
+
+    // Overlap-add with squared window compensation
+    overlapAdd<R>(fft.ifft, b.window.constData(), o, w, N);
+}
+
+// Phase-vocoder analysis of one frame at hop Ha, pitch scaled by `ratio`:
+// leaves |X| in b.mag, arg X in b.phase and the synthesis phase in
+// b.sumPhase.
+template <typename R>
+static void pvAdvance(const double* x, double ratio, int Ha,
+                      PvBins<R>& b, const SpectralPlans<R>& fft) {
+    const int N    = b.window.size();
+    const int bins = N / 2 + 1;
+    const R   r    = R(ratio);
+    const R*  omega     = b.omega.constData();
+    R*        X         = interleaved<R>(fft.out);
+    R*        mag       = b.mag.data();
+    R*        phase     = b.phase.data();
+    R*        prevPhase = b.prevPhase.data();
+    R*        sumPhase  = b.sumPhase.data();
+
+    // ── Analysis FFT ──────────────────────────────────────────────────────
+    loadFrame<R>(x, b.window.constData(), fft.in, N);
+    Fftw<R>::r2c(fft.fwd, fft.in, fft.out);
+
+    // Instantaneous frequency → scale by ratio → accumulate phase. One
+    // simple pass per step: with -ffast-math each maps onto libmvec's vector
+    // atan2/sin/cos instead of a scalar libm call per bin.
+    binMagnitudes<R>(X, mag, bins, R(0));
+    for (int k = 0; k < bins; ++k)
+        phase[k] = std::atan2(X[2 * k + 1], X[2 * k]);
+    for (int k = 0; k < bins; ++k) {
+        const R ph = phase[k];
+
+        R delta = ph - prevPhase[k] - omega[k] * Ha;
+        delta   = principalArg(delta);
+        const R trueFreq = omega[k] + delta / Ha;
+        prevPhase[k]     = ph;
+
+        // Wrap sumPhase into [-π, π] every frame to prevent precision loss
+        // in cos/sin as sumPhase grows to millions of radians over long songs.
+        sumPhase[k] = principalArg(sumPhase[k] + trueFreq * r * Ha);
+    }
+}
+
+// One phase-vocoder frame at hop Ha, pitch scaled by `ratio`, overlap-added
+// into o/w at the input position (Ha == Hs)
+template <typename R>
+static void pvFrame(const double* x, double ratio, int Ha, double* o, double* w,
+                    PvBins<R>& b, const SpectralPlans<R>& fft) {
+    const int N    = b.window.size();
+    const int bins = N / 2 + 1;
+    const R*  mag      = b.mag.constData();
+    const R*  sumPhase = b.sumPhase.constData();
+    R*        Y        = interleaved<R>(fft.spec);
+
+    pvAdvance<R>(x, ratio, Ha, b, fft);
+
+    // ── Synthesis IFFT ────────────────────────────────────────────────────
+    for (int k = 0; k < bins; ++k) {
+        Y[2 * k]     = mag[k] * std::cos(sumPhase[k]);
+        Y[2 * k + 1] = mag[k] * std::sin(sumPhase[k]);
+    }
+    Fftw<R>::c2r(fft.inv, fft.spec, fft.ifft);
+
+    // OLA — output position == input position (Ha == Hs)
+    overlapAdd<R>(fft.ifft, b.window.constData(), o, w, N);
+}
+
+// Stereo twin of pvFrame()'s synthesis step: the rotation e^{i(φs − φa)}
+// per bin (interleaved re/im into rot) that takes the analysed frame's
+// phase φa to its pitch-shifted phase φs. Applied to the mid frame it
+// reproduces pvFrame()'s |X|·e^{iφs}; applied to each channel's own
+// spectrum it shifts that channel by the same amount while keeping its
+// level and phase offset against the mid, i.e. the stereo image.
+template <typename R>
+static void pvRotation(const double* x, double ratio, int Ha, R* rot,
+                       PvBins<R>& b, const SpectralPlans<R>& fft) {
+    const int N    = b.window.size();
+    const int bins = N / 2 + 1;
+    R* d = b.mag.data();   // magnitudes aren't needed here — reuse as scratch
+
+    pvAdvance<R>(x, ratio, Ha, b, fft);
+    const R* phase    = b.phase.constData();
+    const R* sumPhase = b.sumPhase.constData();
+    for (int k = 0; k < bins; ++k)
+        d[k] = sumPhase[k] - phase[k];
+    for (int k = 0; k < bins; ++k) {
+        rot[2 * k]     = std::cos(d[k]);
+        rot[2 * k + 1] = std::sin(d[k]);
+    }
+}
+
+// Window energy of one frame, for lanes whose signal is overlap-added
+// separately (synthesiseLane())
+template <typename R>
+static void addWindowEnergy(const R* window, double* w, int N) {
+    for (int i = 0; i < N; ++i)
+        w[i] += double(window[i] * window[i]);
+}
+
+// Runs `frames` consecutive frames (hop H) of one channel through
+// forward FFT → per-bin gain → inverse FFT → windowed overlap-add into o.
+// `gains` holds each frame's gains back to back: real masks (Rotate =
+// false, `bins` per frame) or interleaved complex rotations (Rotate = true,
+// 2·bins per frame). The window energy is the caller's, shared by all lanes.
+template <typename R, bool Rotate>
+static void synthesiseLane(const double* x, double* o, int frames, int H, const R* gains,
+                           const R* window, int N, const SpectralPlans<R>& fft, LaneScratch<R>& s) {
+    const int bins   = N / 2 + 1;
+    const int stride = Rotate ? 2 * bins : bins;
+    R*        Y      = interleaved<R>(s.spec);
+    const R   invN   = R(1) / R(N);
+
+    for (int f = 0; f < frames; ++f) {
+        const R* g = gains + qsizetype(f) * stride;
+        loadFrame<R>(x + qsizetype(f) * H, window, s.in, N);
+        Fftw<R>::r2c(fft.fwd, s.in, s.spec);
+        if (Rotate) {
+            for (int k = 0; k < bins; ++k) {
+                const R re = Y[2 * k], im = Y[2 * k + 1];
+                Y[2 * k]     = re * g[2 * k] - im * g[2 * k + 1];
+                Y[2 * k + 1] = re * g[2 * k + 1] + im * g[2 * k];
+            }
+        } else {
+            applyMask<R>(Y, g, Y, bins);
+        }
+        Fftw<R>::c2r(fft.inv, s.spec, s.ifft);
+
+        double* out = o + qsizetype(f) * H;
+        for (int i = 0; i < N; ++i)
+            out[i] += double((s.ifft[i] * invN) * window[i]);
+    }
+}
+
+// synthesiseLane() for every lane at once, one lane per pool thread: the
+// per-frame analysis (mask / phase advance) was already done once on the
+// mid signal, so what's left per channel is two FFTs and a bin multiply.
+template <typename R, bool Rotate>
+static void synthesiseLanes(const QVector<QVector<double>>& in, QVector<QVector<double>>& ola,
+                            int off, int frames, int H, const QVector<R>& gains,
+                            const QVector<R>& window, const SpectralPlans<R>& fft,
+                            std::vector<LaneScratch<R>>& scratch) {
+    if (frames <= 0) return;
+    QVector<int> lanes(int(in.size()));
+    std::iota(lanes.begin(), lanes.end(), 0);
+    QtConcurrent::blockingMap(lanes, [&](int c) {
+        synthesiseLane<R, Rotate>(in[c].constData() + off, ola[c].data() + off, frames, H,
+                                  gains.constData(), window.constData(), window.size(), fft, scratch[c]);
+    });
+}
+
+// ----------------------
+// Streaming state
+// ----------------------
+// Per-stage state, rebuilt by begin(). The gate and pitch stages keep their
+// pending input, overlap-add accumulator and window-energy sum in parallel
+// buffers whose element 0 is absolute sample `base`; samples are popped off
+// the front as soon as no later frame can still add into them, so each
+// buffer stays at roughly (lookahead + one block) samples.
+//
+// Every stage runs on `lanes` channel buffers: one (the mono downmix) or,
+// in stereo mode, one per channel. Stereo stages also keep `mid`, the mean
+// of their input lanes, which every analysis step (noise model, gate mask,
+// pitch map, phase advance) runs on exactly once; only applying the result
+// is per lane.
+struct VocalEnhancer::StreamState {
+    const std::atomic<bool> *cancelled = nullptr;
+    QByteArray carry;            // trailing partial PCM frame from the last process()
+    bool       singlePrecision = false;  // gate/PV kernels run on m_f32's float plans
+    int        lanes       = 1;
+    qint64     totalFrames = 0;  // progress only; 0 = unknown
+    qint64     framesOut   = 0;
+
+    // Per-lane FFT buffers for stereo synthesis (sized kPvN, which also
+    // covers the gate's kNgN); only the one matching singlePrecision is used
+    std::vector<LaneScratch<double>> scratch64;
+    std::vector<LaneScratch<float>>  scratch32;
+
+    // Input normalisation
+    bool    gainKnown = false;
+    double  gain      = 1.0;
+    Planar  normHold;            // held back until the gain is known
+
+    // Spectral gate (N=kNgN, H=kNgHop)
+    struct Gate {
+        double overSub     = 0.0;
+        double gFloor      = 0.0;
+        double adaptivity  = 0.0;
+        double lowEnergyDb = 0.0;
+        int    learnFrames = 1;
+        bool   learned     = false;
+        qint64 base = 0;   // absolute index of in[0]/ola[0]/wsum[0]
+        qint64 pos  = 0;   // absolute start of the next frame
+        Planar          in, ola;
+        QVector<double> mid, wsum;
+        GateBins<double> f64;   // only the one matching singlePrecision is used
+        GateBins<float>  f32;
+    } gate;
+
+    // Pitch map + phase vocoder (N=kPvN, Ha=N/8)
+    struct Pitch {
+        double deadZoneCents      = 0.0;
+        double maxCorrectionCents = 0.0;
+        double strength           = 0.0;
+        double maxSlewPerFrame    = 0.0;
+        double emaAlpha           = 0.0;
+        int    detStepFrames        = 1;
+        int    resetAfterDetections = 1;
+        int    detBatch             = 1;   // detection windows per parallel dispatch
+        // Analysis results (pitch, confidence) waiting for the smoothing pass
+        struct Detection {
+            double pitch    = 0.0;
+            double conf     = 0.0;
+            bool   analysed = false;   // false: window too short to analyse
+        };
+        QVector<Detection> det;
+        qint64 detFrame = 0;   // PV frame of the next detection to analyse
+        PitchTrack track;      // every smoothed detection so far (lastPitchTrack())
+        // Smoothing state carried from one detection to the next
+        double smoothedPitch    = 0.0;
+        double prevTargetCents  = 0.0;
+        bool   voiced           = false;
+        int    unvoicedDetCount = 0;
+        qint64 base  = 0;
+        qint64 pos   = 0;
+        qint64 frame = 0;
+        Planar          in, ola;
+        QVector<double> mid, wsum;
+        PvBins<double> f64;
+        PvBins<float>  f32;
+    } pitch;
+
+    // Compressor + band-limited exciter (gain linked across lanes)
+    struct Dynamics {
+        double      atk = 0.0, rel = 0.0, env = 0.0;
+        long double preAcc = 0.0, postAcc = 0.0;
+        qint64      n = 0;
+        double      target = 1.0, makeUp = 1.0, makeUpCoef = 0.0;
+        double      hpA = 0.0;
+        QVector<double> hpPrev, xPrev;   // exciter high-pass state, per lane
+    } dyn;
+
+    // Freeverb / Schroeder, one tank per lane
+    struct Reverb {
+        double feedback = 0.0, damp = 0.0;
+        struct Tank {
+            QVector<double> combLine[8];
+            int             combPos[8]   = {};
+            double          combStore[8] = {};
+            QVector<double> apLine[2];
+            int             apPos[2] = {};
+        };
+        QVector<Tank>   tank;
+        QVector<double> wet;
+    } reverb;
+
+    // Output level match against the gated (pre-pitch) signal
+    struct LevelMatch {
+        Planar          ref;     // gated samples not yet matched against output
+        long double     refAcc = 0.0, outAcc = 0.0;
+        qint64          n = 0;
+        double          target = 1.0, gain = 1.0, coef = 0.0;
+    } level;
+
+    // Stage cache: `replay` says which cached stage result stands in for
+    // the stages up to it (see streamReplay()); `rec` is what this run
+    // leaves for the next one, committed to m_cache by finish().
+    enum class Replay { None, Gated, Shaped };
+    Replay                     replay    = Replay::None;
+    qint64                     replayPos = 0;   // cached samples handed on so far
+    QScopedPointer<StageCache> rec;
+    qint64                     recBytes  = 0;
+};
+
+// ----------------------
+// Stage cache
+// ----------------------
+// Each stage result is keyed by the input and only the settings that stage
+// reads: the gated signal (and the pitch detections, which only look at the
+// gated mid) by the take, its level, the lane count, the precision and the
+// noise amount; the shaped signal — pitch-corrected and through the
+// parameterless compressor/exciter — additionally by the tuning settings.
+struct VocalEnhancer::StageCache {
+    struct GateKey {
+        quint64 input  = 0;
+        qint64  frames = 0;
+        int     lanes  = 0;
+        bool    single = false;
+        double  rms = 0.0, peak = 0.0, noise = 0.0;
+
+        bool operator==(const GateKey& o) const {
+            return input == o.input && frames == o.frames && lanes == o.lanes && single == o.single
+                && rms == o.rms && peak == o.peak && noise == o.noise;
+        }
+    };
+    struct PitchKey {
+        double       correction = 0.0, retuneMs = 0.0;
+        int          keyNote = 0;
+        QVector<int> scale;
+
+        bool operator==(const PitchKey& o) const {
+            return correction == o.correction && retuneMs == o.retuneMs
+                && keyNote == o.keyNote && scale == o.scale;
+        }
+    };
+
+    GateKey  gateKey;
+    PitchKey pitchKey;
+    Planar   gated;                                    // streamNoiseGate() output
+    QVector<StreamState::Pitch::Detection> det;        // every detection window, in order
+    Planar   shaped;                                   // streamDynamics() output; may be absent
+    PitchTrack track;                                  // replaying `shaped` skips the smoothing that builds it
+
+    bool complete() const {
+        auto full = [this](const Planar& x) {
+            return !x.isEmpty() && x.first().size() == gateKey.frames;
+        };
+        return full(gated) && (shaped.isEmpty() || full(shaped));
+    }
+};
+
+// ----------------------
+// Single-precision plans
+// ----------------------
+// fftwf_* twins of the PV and gate buffers, allocated by the first
+// setPrecision(Precision::Float) and used by every enhance() after that.
+struct VocalEnhancer::FloatPlans {
+    SpectralPlans<float> pv, ng;
+
+    FloatPlans() {
+        make(pv, kPvN);
+        make(ng, kNgN);
+    }
+    ~FloatPlans() {
+        release(pv);
+        release(ng);
+    }
+
+    static void make(SpectralPlans<float>& s, int N) {
+        s.in   = fftwf_alloc_real(N);
+        s.out  = fftwf_alloc_complex(N / 2 + 1);
+        s.spec = fftwf_alloc_complex(N / 2 + 1);
+        s.ifft = fftwf_alloc_real(N);
+        s.fwd  = FftPlanRegistry::planF(N, FftPlanRegistry::Direction::Forward);
+        s.inv  = FftPlanRegistry::planF(N, FftPlanRegistry::Direction::Inverse);
+    }
+    static void release(SpectralPlans<float>& s) {
+        fftwf_free(s.in);   fftwf_free(s.out);
+        fftwf_free(s.spec); fftwf_free(s.ifft);
+        s = SpectralPlans<float>();
+    }
+};
+
 // ----------------------
 // Constructor (QT6)
 // ----------------------
@@ -85,51 +709,50 @@ VocalEnhancer::VocalEnhancer(const QAudioFormat& format, QObject *parent)
     // Fixed 40ms analysis window
     m_numSamples = qMax(1, (m_sampleRate * m_blockSizeMs) / 1000);
 
-    // ── Pre-allocate cached FFTW plans ────────────────────────────────────
+    // ── FFT buffers and shared plans ──────────────────────────────────────
+    // The plans come from FftPlanRegistry — planned once per process (and,
+    // through its wisdom file, measured once per machine), so the second
+    // enhancer PreviewDialog creates costs nothing to set up.
+    using Dir = FftPlanRegistry::Direction;
+
     // Phase vocoder (N=2048)
     m_pvIn   = (double*)      fftw_malloc(sizeof(double)       * kPvN);
     m_pvOut  = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (kPvN/2 + 1));
     m_pvSpec = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (kPvN/2 + 1));
     m_pvIfft = (double*)      fftw_malloc(sizeof(double)       * kPvN);
-    if (m_pvIn && m_pvOut && m_pvSpec && m_pvIfft) {
-        m_pvFwd = fftw_plan_dft_r2c_1d(kPvN, m_pvIn,   m_pvOut,  FFTW_MEASURE);
-        m_pvInv = fftw_plan_dft_c2r_1d(kPvN, m_pvSpec, m_pvIfft, FFTW_MEASURE);
-    }
+    m_pvFwd  = FftPlanRegistry::plan(kPvN, Dir::Forward);
+    m_pvInv  = FftPlanRegistry::plan(kPvN, Dir::Inverse);
 
     // Noise gate (N=1024)
     m_ngIn   = (double*)      fftw_malloc(sizeof(double)       * kNgN);
     m_ngOut  = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (kNgN/2 + 1));
     m_ngSpec = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (kNgN/2 + 1));
     m_ngIfft = (double*)      fftw_malloc(sizeof(double)       * kNgN);
-    if (m_ngIn && m_ngOut && m_ngSpec && m_ngIfft) {
-        m_ngFwd = fftw_plan_dft_r2c_1d(kNgN, m_ngIn,   m_ngOut,  FFTW_MEASURE);
-        m_ngInv = fftw_plan_dft_c2r_1d(kNgN, m_ngSpec, m_ngIfft, FFTW_MEASURE);
-    }
-
-    // Pitch detection (N=4096) — pre-allocated to avoid per-call plan creation
-    m_detIn  = (double*)      fftw_malloc(sizeof(double)       * kDetN);
-    m_detOut = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (kDetN/2 + 1));
-    if (m_detIn && m_detOut)
-        m_detFwd = fftw_plan_dft_r2c_1d(kDetN, m_detIn, m_detOut, FFTW_ESTIMATE);
+    m_ngFwd  = FftPlanRegistry::plan(kNgN, Dir::Forward);
+    m_ngInv  = FftPlanRegistry::plan(kNgN, Dir::Inverse);
+
+    // Pitch detection (N=4096); detectPitch() brings its own buffers
+    m_detFwd = FftPlanRegistry::plan(kDetN, Dir::Forward);
+
+    PitchDetector::Params yin;
+    yin.sampleRate = std::max(1, m_sampleRate);
+    yin.maxWindow  = 2048;
+    yin.minWindow  = 512;
+    yin.minHz      = 80.0;
+    yin.maxHz      = 1100.0;
+    yin.threshold  = 0.12;
+    yin.silenceRms = 1e-4;
+    m_yin.reset(new PitchDetector(yin));
+
+    setPrecision(defaultPrecision());
 }
 
 VocalEnhancer::~VocalEnhancer() {
-    // Destroy cached PV plans
-    if (m_pvFwd)  fftw_destroy_plan(m_pvFwd);
-    if (m_pvInv)  fftw_destroy_plan(m_pvInv);
+    // The plans belong to FftPlanRegistry; only the buffers are ours
     fftw_free(m_pvIn);   fftw_free(m_pvOut);
     fftw_free(m_pvSpec); fftw_free(m_pvIfft);
-
-    // Destroy cached noise-gate plans
-    if (m_ngFwd)  fftw_destroy_plan(m_ngFwd);
-    if (m_ngInv)  fftw_destroy_plan(m_ngInv);
     fftw_free(m_ngIn);   fftw_free(m_ngOut);
     fftw_free(m_ngSpec); fftw_free(m_ngIfft);
-
-    // Destroy cached pitch detection plan
-    if (m_detFwd) fftw_destroy_plan(m_detFwd);
-    fftw_free(m_detIn);
-    fftw_free(m_detOut);
     // Note: fftw_cleanup() intentionally omitted — it destroys all global FFTW
     // state and can cause crashes if any other FFTW operation is still in flight.
 }
@@ -168,8 +791,47 @@ void VocalEnhancer::writeInt24LE(uint8_t* dst, int32_t v) {
 }
 
 // ----------------------
-// PCM → double (MONO)
+// PCM → double
 // ----------------------
+// One sample in this enhancer's format → [-1..+1]
+double VocalEnhancer::sampleToDouble(const uint8_t* s) const {
+    double x = 0.0;
+
+    if (m_isFloat && m_bytesPerSample == 4) {
+        float v;
+        memcpy(&v, s, 4);
+        x = double(v);
+    }
+    else if (m_bytesPerSample == 1 && !m_isSignedInt) {
+        uint8_t v = s[0];
+        x = (double(v) / 255.0) * 2.0 - 1.0;
+    }
+    else if (m_bytesPerSample == 2 && m_isSignedInt) {
+        int16_t v = int16_t(s[0] | (s[1] << 8));
+        x = double(v) / 32768.0;
+    }
+    else if (m_bytesPerSample == 3) {
+        int32_t v = readInt24LE(s[0], s[1], s[2]);
+        x = double(v) / double(1 << 23);
+    }
+    else if (m_bytesPerSample == 4 && m_isSignedInt) {
+        int32_t v = int32_t(s[0] | (s[1]<<8) | (s[2]<<16) | (s[3]<<24));
+        x = double(v) / 2147483648.0;
+    }
+
+    return x;
+}
+
+// One interleaved frame → the mean of its channels in [-1..+1].
+double VocalEnhancer::frameToMono(const uint8_t* frame) const {
+    double sum = 0.0;
+
+    for (int ch = 0; ch < m_channels; ++ch)
+        sum += sampleToDouble(frame + ch * m_bytesPerSample);
+
+    return sum / m_channels;
+}
+
 QVector<double> VocalEnhancer::convertToDoubleArray(const QByteArray& input) {
     if (input.isEmpty() || m_frameBytes <= 0) return {};
 
@@ -178,48 +840,65 @@ QVector<double> VocalEnhancer::convertToDoubleArray(const QByteArray& input) {
 
     const uint8_t* ptr = reinterpret_cast<const uint8_t*>(input.constData());
 
-    for (int f = 0; f < totalFrames; ++f) {
-        const uint8_t* frame = ptr + f * m_frameBytes;
-        double sum = 0.0;
+    for (int f = 0; f < totalFrames; ++f)
+        mono[f] = frameToMono(ptr + f * m_frameBytes);
 
-        for (int ch = 0; ch < m_channels; ++ch) {
-            const uint8_t* s = frame + ch * m_bytesPerSample;
-            double x = 0.0;
+    return mono;
+}
 
-            if (m_isFloat && m_bytesPerSample == 4) {
-                float v;
-                memcpy(&v, s, 4);
-                x = double(v);
-            }
-            else if (m_bytesPerSample == 1 && !m_isSignedInt) {
-                uint8_t v = s[0];
-                x = (double(v) / 255.0) * 2.0 - 1.0;
-            }
-            else if (m_bytesPerSample == 2 && m_isSignedInt) {
-                int16_t v = int16_t(s[0] | (s[1] << 8));
-                x = double(v) / 32768.0;
-            }
-            else if (m_bytesPerSample == 3) {
-                int32_t v = readInt24LE(s[0], s[1], s[2]);
-                x = double(v) / double(1 << 23);
-            }
-            else if (m_bytesPerSample == 4 && m_isSignedInt) {
-                int32_t v = int32_t(s[0] | (s[1]<<8) | (s[2]<<16) | (s[3]<<24));
-                x = double(v) / 2147483648.0;
-            }
+// One buffer per lane: the mono downmix alone, or each channel de-interleaved
+VocalEnhancer::Planar VocalEnhancer::convertToPlanar(const QByteArray& input, int lanes) {
+    if (lanes <= 1) return Planar{ convertToDoubleArray(input) };
+    if (input.isEmpty() || m_frameBytes <= 0) return Planar(lanes);
 
-            sum += x;
-        }
+    const int totalFrames = input.size() / m_frameBytes;
+    Planar out(lanes, QVector<double>(totalFrames, 0.0));
 
-        mono[f] = sum / m_channels;
-    }
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(input.constData());
 
-    return mono;
+    for (int ch = 0; ch < lanes; ++ch) {
+        double* dst = out[ch].data();
+        for (int f = 0; f < totalFrames; ++f)
+            dst[f] = sampleToDouble(ptr + f * m_frameBytes + ch * m_bytesPerSample);
+    }
+    return out;
 }
 
 // ----------------------
-// double → PCM (replica mono → canais)
+// double → PCM
 // ----------------------
+// `x` is already clamped to [-1..+1]
+void VocalEnhancer::writeSample(uint8_t* s, double x) const {
+    if (m_isFloat) {
+        float v = float(x);
+        memcpy(s, &v, 4);
+    }
+    else if (m_bytesPerSample == 1) {
+        uint8_t v = uint8_t((x * 0.5 + 0.5) * 255.0);
+        s[0] = v;
+    }
+    else if (m_bytesPerSample == 2) {
+        int32_t v = int32_t(std::lround(x * 32767.0));
+        s[0] = uint8_t(v & 0xFF);
+        s[1] = uint8_t((v >> 8) & 0xFF);
+    }
+    else if (m_bytesPerSample == 3) {
+        int32_t v = int32_t(std::llround(x * double(1 << 23)));
+        writeInt24LE(s, v);
+    }
+    else if (m_bytesPerSample == 4) {
+        int64_t v = int64_t(std::llround(x * 2147483647.0));
+        uint32_t uv = uint32_t(int32_t(std::clamp<int64_t>(v,
+                          -2147483648LL, 2147483647LL)));
+
+        s[0] = uint8_t(uv & 0xFF);
+        s[1] = uint8_t((uv >> 8) & 0xFF);
+        s[2] = uint8_t((uv >> 16) & 0xFF);
+        s[3] = uint8_t((uv >> 24) & 0xFF);
+    }
+}
+
+// Mono result (replica mono → canais)
 void VocalEnhancer::convertToQByteArray(const QVector<double>& inputData,
                                         QByteArray& output)
 {
@@ -232,37 +911,31 @@ void VocalEnhancer::convertToQByteArray(const QVector<double>& inputData,
     for (int f = 0; f < totalFrames; ++f) {
         double x = std::clamp(inputData[f], -1.0, 1.0);
 
-        for (int ch = 0; ch < m_channels; ++ch) {
-            uint8_t* s = out + f * m_frameBytes + ch * m_bytesPerSample;
+        for (int ch = 0; ch < m_channels; ++ch)
+            writeSample(out + f * m_frameBytes + ch * m_bytesPerSample, x);
+    }
+}
 
-            if (m_isFloat) {
-                float v = float(x);
-                memcpy(s, &v, 4);
-            }
-            else if (m_bytesPerSample == 1) {
-                uint8_t v = uint8_t((x * 0.5 + 0.5) * 255.0);
-                s[0] = v;
-            }
-            else if (m_bytesPerSample == 2) {
-                int32_t v = int32_t(std::lround(x * 32767.0));
-                s[0] = uint8_t(v & 0xFF);
-                s[1] = uint8_t((v >> 8) & 0xFF);
-            }
-            else if (m_bytesPerSample == 3) {
-                int32_t v = int32_t(std::llround(x * double(1 << 23)));
-                writeInt24LE(s, v);
-            }
-            else if (m_bytesPerSample == 4) {
-                int64_t v = int64_t(std::llround(x * 2147483647.0));
-                uint32_t uv = uint32_t(int32_t(std::clamp<int64_t>(v,
-                                  -2147483648LL, 2147483647LL)));
-
-                s[0] = uint8_t(uv & 0xFF);
-                s[1] = uint8_t((uv >> 8) & 0xFF);
-                s[2] = uint8_t((uv >> 16) & 0xFF);
-                s[3] = uint8_t((uv >> 24) & 0xFF);
-            }
-        }
+// Per-lane result: one lane is replicated as above, otherwise lane c is
+// channel c, interleaved back into frames.
+void VocalEnhancer::convertToQByteArray(const Planar& lanes, QByteArray& output)
+{
+    if (lanes.size() == 1) {
+        convertToQByteArray(lanes.first(), output);
+        return;
+    }
+
+    const int totalFrames = lanes.isEmpty() ? 0 : lanes.first().size();
+    if (output.size() < totalFrames * m_frameBytes)
+        output.resize(totalFrames * m_frameBytes);
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(output.data());
+
+    for (int ch = 0; ch < std::min<int>(lanes.size(), m_channels); ++ch) {
+        const double* src = lanes[ch].constData();
+        for (int f = 0; f < totalFrames; ++f)
+            writeSample(out + f * m_frameBytes + ch * m_bytesPerSample,
+                        std::clamp(src[f], -1.0, 1.0));
     }
 }
 
@@ -271,91 +944,411 @@ void VocalEnhancer::convertToQByteArray(const QVector<double>& inputData,
 // ======================
 static double chunkRMS(const QVector<double>& x, int start, int len);
 
+// Noise-gate hop (75% overlap on kNgN) and the Freeverb reference delay
+// lengths at 44100 Hz, shared by begin() (line allocation) and the stages.
+static constexpr int kNgHop    = 256;
+// Make-up / level-match targets are re-estimated every kGainHop samples.
+static constexpr int kGainHop  = 1024;
+static constexpr int kCombD[8] = {1116,1188,1277,1356,1422,1491,1557,1617};
+static constexpr int kApD[2]   = {556, 441};
+// Freeverb's stereo spread: each further channel's tank is this many
+// samples longer, which decorrelates the tails across the image.
+static constexpr int kStereoSpread = 23;
+
+// Mean of the lanes' first n samples — the mid signal every stereo analysis
+// runs on. A single lane is returned as is.
+static QVector<double> laneMean(const QVector<QVector<double>>& x, int n) {
+    if (x.size() == 1) return x.first().mid(0, n);
+    QVector<double> mid(n, 0.0);
+    double* m = mid.data();
+    for (const QVector<double>& lane : x) {
+        const double* s = lane.constData();
+        for (int i = 0; i < n; ++i) m[i] += s[i];
+    }
+    const double inv = 1.0 / x.size();
+    for (int i = 0; i < n; ++i) m[i] *= inv;
+    return mid;
+}
+
+// Input normalisation gain: boost quiet takes toward kTargetRMS (never cut),
+// capped so the loudest peak stays below full scale. 1.0 = leave as is.
+static double normalisationGain(double rms, double peak) {
+    if (rms <= 1e-6) return 1.0;
+    constexpr double kTargetRMS = 0.18;
+    const double gain = std::clamp(kTargetRMS / rms, 1.0, 20.0);
+    const double safeGain = (peak > 1e-9) ? std::min(gain, 0.99 / peak) : gain;
+    return (safeGain > 1.01) ? safeGain : 1.0;
+}
+
 QByteArray VocalEnhancer::enhance(const QByteArray& input, const std::atomic<bool> *cancelled) {
     qWarning() << "VocalEnhancer Input Data Size:" << input.size();
     if (input.isEmpty() || m_frameBytes <= 0) return QByteArray();
     if (cancelled && cancelled->load()) return QByteArray();
 
+    begin(measureInput(input), cancelled);
+    QByteArray output = process(input);
+    output.append(finish());
+
+    if (cancelled && cancelled->load()) return QByteArray();
+    return output;
+}
+
+// ======================
+// Streaming pipeline
+// ======================
+bool VocalEnhancer::streamCancelled() const {
+    return m_stream && m_stream->cancelled && m_stream->cancelled->load();
+}
+
+VocalEnhancer::InputLevel VocalEnhancer::measureInput(const QByteArray& input) const {
+    InputLevel level;
+    if (input.isEmpty() || m_frameBytes <= 0) return level;
+
+    const qint64 totalFrames = input.size() / m_frameBytes;
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(input.constData());
+
+    long double sum = 0.0;
+    double peak = 0.0;
+    for (qint64 f = 0; f < totalFrames; ++f) {
+        const double x = frameToMono(ptr + f * m_frameBytes);
+        sum += (long double)x * (long double)x;
+        peak = std::max(peak, std::abs(x));
+    }
+    level.rms         = totalFrames > 0 ? std::sqrt((double)(sum / totalFrames)) : 0.0;
+    level.peak        = peak;
+    level.totalFrames = totalFrames;
+    level.hash        = qHashBits(input.constData(), size_t(totalFrames * m_frameBytes));
+    return level;
+}
+
+void VocalEnhancer::begin(const InputLevel& level, const std::atomic<bool> *cancelled) {
     // Reset PV phase state so each recording starts with coherent phases
     resetPVState();
+    m_stream.reset(new StreamState);
+    m_lastTrack = {};
+    StreamState& st = *m_stream;
+    st.cancelled   = cancelled;
+    st.totalFrames = level.totalFrames;
+    st.singlePrecision = (m_precision == Precision::Float && m_f32 && m_f32->pv.ok() && m_f32->ng.ok());
+    st.lanes = (m_preserveStereo && m_channels > 1) ? m_channels : 1;
+    if (st.lanes > 1) {
+        bool ok = true;
+        for (int c = 0; c < st.lanes; ++c) {
+            if (st.singlePrecision) { st.scratch32.emplace_back(kPvN); ok = ok && st.scratch32.back().ok(); }
+            else                    { st.scratch64.emplace_back(kPvN); ok = ok && st.scratch64.back().ok(); }
+        }
+        if (!ok) {   // out of memory for the lane buffers — fall back to the downmix
+            st.scratch32.clear();
+            st.scratch64.clear();
+            st.lanes = 1;
+        }
+    }
+    const int lanes = st.lanes;
+    st.normHold  = Planar(lanes);
+    st.gate.in   = st.gate.ola  = Planar(lanes);
+    st.pitch.in  = st.pitch.ola = Planar(lanes);
+    st.level.ref = Planar(lanes);
+    setStatus("Begin Vocal Enhancement", 0.0);
 
-    // Convert to mono double [-1..+1]
-    QVector<double> data = convertToDoubleArray(input);
+    const int    sr       = std::max(1, m_sampleRate);
+    const double oneSecond = double(sr);
 
     // ── Input normalisation ───────────────────────────────────────────────
-    {
-        const double rms = chunkRMS(data, 0, data.size());
-        if (rms > 1e-6) {
-            constexpr double kTargetRMS = 0.18;
-            const double gain = std::clamp(kTargetRMS / rms, 1.0, 20.0);
-            const double peak = *std::max_element(
-                data.begin(), data.end(),
-                [](double a, double b){ return std::abs(a) < std::abs(b); });
-            const double safeGain = (std::abs(peak) > 1e-9)
-                                  ? std::min(gain, 0.99 / std::abs(peak))
-                                  : gain;
-            if (safeGain > 1.01)
-                applyMakeupGain(data, safeGain);
-            qWarning() << "Input normalise: rms=" << rms
-                       << " gain=" << safeGain;
-        }
+    if (level.rms >= 0.0) {
+        st.gain      = normalisationGain(level.rms, level.peak);
+        st.gainKnown = true;
+        qWarning() << "Input normalise: rms=" << level.rms << " gain=" << st.gain;
     }
 
+    // ── Spectral gate ─────────────────────────────────────────────────────
     const double noiseAmount = std::clamp(m_noiseReductionAmount, 0.0, 1.0);
-    const double overSub       = lerpParam(0.50, 0.85, noiseAmount);
-    const double floorDb       = lerpParam(-8.0, -16.0, noiseAmount);
+    StreamState::Gate& g = st.gate;
+    g.overSub     = lerpParam(0.50, 0.85, noiseAmount);
+    g.gFloor      = std::clamp(dbToLinear(lerpParam(-8.0, -16.0, noiseAmount)), 0.0, 1.0);
+    g.adaptivity  = lerpParam(0.015, 0.004, noiseAmount);
+    g.lowEnergyDb = lerpParam(-50.0, -46.0, noiseAmount);
     const double noiseLearnSec = lerpParam(0.30, 0.50, noiseAmount);
-    const double adaptivity    = lerpParam(0.015, 0.004, noiseAmount);
-    const double lowEnergyDb   = lerpParam(-50.0, -46.0, noiseAmount);
-
-    reduceNoiseSpectralGate(
-        data,
-        1024,
-        256,
-        overSub,
-        floorDb,
-        noiseLearnSec,
-        adaptivity,
-        lowEnergyDb,
-        cancelled
-    );
-    if (cancelled && cancelled->load()) return QByteArray();
+    g.learnFrames = std::max(1, int((noiseLearnSec * m_sampleRate) / kNgHop));
+    if (st.singlePrecision) g.f32.reset(createHannWindow(kNgN));
+    else                    g.f64.reset(createHannWindow(kNgN));
 
-    // Snapshot RMS after noise reduction, before pitch processing.
-    // Used at the end to restore output level regardless of scale/correction amount.
-    const double preProcessRMS = chunkRMS(data, 0, data.size());
+    // ── Pitch map / phase vocoder ─────────────────────────────────────────
+    const int N  = kPvN;
+    const int Ha = N / 8;
+    const double correctionAmount = std::clamp(m_pitchCorrectionAmount, 0.0, 1.0);
+    const double slewCentsPerSec  = std::min(9000.0, 100000.0 / std::max(1.0, m_retuneSpeedMs));
+    const double frameDurSec      = double(Ha) / oneSecond;
+    StreamState::Pitch& p = st.pitch;
+    p.deadZoneCents      = lerpParam(30.0, 12.0, correctionAmount);
+    p.maxCorrectionCents = lerpParam(100.0, 160.0, correctionAmount);
+    p.strength           = lerpParam(0.30, 0.72, correctionAmount);
+    p.maxSlewPerFrame    = slewCentsPerSec * frameDurSec;
+    // Detect pitch every ~80 ms (≈14 PV frames at 44100 Hz / Ha=256)
+    p.detStepFrames      = std::max(1, int(0.080 / frameDurSec));
+    // EMA for vibrato preservation: τ = 60 ms
+    p.emaAlpha           = std::exp(-frameDurSec / 0.060);
+    // Reset smoothedPitch after ~400 ms of consecutive unvoiced detections so
+    // section transitions don't carry a stale pitch into the next voiced phrase.
+    p.resetAfterDetections = std::max(1, int(0.400 / (frameDurSec * p.detStepFrames)));
+    // A few windows per core per dispatch; ≈1.3 s of extra lookahead on 8 cores
+    p.detBatch             = std::max(4, 2 * QThread::idealThreadCount());
+    if (st.singlePrecision) p.f32.reset(createHannWindow(N));
+    else                    p.f64.reset(createHannWindow(N));
+
+    // ── Dynamics (compressor 0.82 / 2:1, exciter above ~3 kHz) ────────────
+    StreamState::Dynamics& d = st.dyn;
+    d.atk        = std::exp(-1.0 / (0.005 * oneSecond));   // 5 ms
+    d.rel        = std::exp(-1.0 / (0.060 * oneSecond));   // 60 ms
+    d.makeUpCoef = 1.0 - std::exp(-1.0 / (0.300 * oneSecond));
+    d.hpA        = 1.0 / (1.0 + 2.0 * kPi * 3000.0 / oneSecond);
+    d.hpPrev.fill(0.0, lanes);
+    d.xPrev.fill(0.0, lanes);
+
+    // ── Reverb ────────────────────────────────────────────────────────────
+    // Room size maps to feedback coefficient (0.28 … 0.96), decay to damping
+    const double sRatio = oneSecond / 44100.0;
+    StreamState::Reverb& r = st.reverb;
+    r.feedback = 0.28 + m_reverbRoomSize * 0.68;
+    r.damp     = 1.0 - m_reverbDecay * 0.85;
+    r.tank.resize(lanes);
+    for (int l = 0; l < lanes; ++l) {
+        StreamState::Reverb::Tank& t = r.tank[l];
+        for (int c = 0; c < 8; ++c)
+            t.combLine[c].fill(0.0, std::max(1, int((kCombD[c] + l * kStereoSpread) * sRatio)));
+        for (int a = 0; a < 2; ++a)
+            t.apLine[a].fill(0.0, std::max(1, int((kApD[a] + l * kStereoSpread) * sRatio)));
+    }
 
-    processPitchCorrection(data, cancelled);
-    if (cancelled && cancelled->load()) return QByteArray();
+    // ── Level match ───────────────────────────────────────────────────────
+    st.level.coef = 1.0 - std::exp(-1.0 / (0.500 * oneSecond));
 
-    // ── Single-pass dynamics and exciter (run once, after all pitch work) ────
-    // Previously these lived inside processPitchCorrection and compounded on
-    // every re-enhance, causing progressive distortion and volume fluctuation.
-    // Running them here, once, on the final pitch-corrected signal is clean.
-    compressDynamics(data, 0.82, 2.0);
-    harmonicExciter(data, 1.08, 0.14);
-
-    // Reverb is applied after pitch correction so the wet signal is also pitch-corrected
-    applyReverb(data);
-
-    // Final level match: ensure output loudness equals pre-pitch-correction level.
-    // Tighter cap (4×) avoids over-boosting quiet inputs after compression+exciter.
-    if (preProcessRMS > 1e-6) {
-        const double postRMS = chunkRMS(data, 0, data.size());
-        if (postRMS > 1e-9) {
-            const double makeup = std::clamp(preProcessRMS / postRMS, 0.5, 4.0);
-            if (makeup > 1.02 || makeup < 0.98) {
-                applyMakeupGain(data, makeup);
-            }
+    // ── Stage cache ───────────────────────────────────────────────────────
+    if (level.hash == 0 || m_stageCacheLimit <= 0) {
+        m_cache.reset();
+        return;
+    }
+    st.rec.reset(new StageCache);
+    StageCache& rec = *st.rec;
+    rec.gateKey  = { level.hash, level.totalFrames, lanes, st.singlePrecision,
+                     level.rms, level.peak, noiseAmount };
+    rec.pitchKey = { correctionAmount, m_retuneSpeedMs, m_keyNote, m_scaleIntervals };
+    if (!m_cache || !(m_cache->gateKey == rec.gateKey)) {
+        m_cache.reset();   // a different take — no use holding on to it during this run
+        return;
+    }
+    // The recording inherits what it replays (implicitly shared, no copy)
+    rec.gated = m_cache->gated;
+    rec.det   = m_cache->det;
+    if (!m_cache->shaped.isEmpty() && m_cache->pitchKey == rec.pitchKey) {
+        st.replay  = StreamState::Replay::Shaped;
+        rec.shaped = m_cache->shaped;
+        st.pitch.track = m_cache->track;
+    } else {
+        st.replay  = StreamState::Replay::Gated;
+    }
+    st.recBytes = qint64(sizeof(double)) * lanes * level.totalFrames
+                * (rec.shaped.isEmpty() ? 1 : 2);
+    qWarning() << "VocalEnhancer: replaying cached"
+               << (st.replay == StreamState::Replay::Shaped ? "pitch correction" : "noise gate/pitch map");
+}
+
+QByteArray VocalEnhancer::process(const QByteArray& block) {
+    if (!m_stream || m_frameBytes <= 0) return QByteArray();
+    StreamState& st = *m_stream;
+
+    // Re-attach whatever partial frame the previous call left over
+    QByteArray joined;
+    const QByteArray* src = &block;
+    if (!st.carry.isEmpty()) {
+        joined = st.carry + block;
+        st.carry.clear();
+        src = &joined;
+    }
+
+    const qsizetype usable = src->size() - src->size() % m_frameBytes;
+    const qsizetype step   = qsizetype(kStreamBlockFrames) * m_frameBytes;
+
+    QByteArray output;
+    for (qsizetype off = 0; off < usable; off += step) {
+        if (streamCancelled()) return QByteArray();
+        const qsizetype len = std::min(step, usable - off);
+        if (st.replay != StreamState::Replay::None) {
+            output.append(streamReplay(len / m_frameBytes, false));
+            continue;
         }
+        const Planar lanes = convertToPlanar(
+            QByteArray::fromRawData(src->constData() + off, len), st.lanes);
+        output.append(streamRun(lanes, false));
+    }
+    if (usable < src->size())
+        st.carry = src->mid(usable);
+    return output;
+}
+
+QByteArray VocalEnhancer::finish() {
+    if (!m_stream) return QByteArray();
+    const StreamState::Replay replay = m_stream->replay;
+    const QByteArray output = (replay == StreamState::Replay::None)
+                            ? streamRun(Planar(m_stream->lanes), true)
+                            : streamReplay(0, true);
+    const bool wasCancelled = streamCancelled();
+    const qint64 frames = m_stream->pitch.frame;
+    if (!wasCancelled)
+        m_lastTrack = m_stream->pitch.track;
+    if (!wasCancelled && m_stream->rec && m_stream->rec->complete()) {
+        m_stream->rec->track = m_lastTrack;
+        m_cache.reset(m_stream->rec.take());
     }
-    applyLimiter(data, 0.98); // single final clip guard
+    m_stream.reset(); // drop every stage buffer now rather than on the next begin()
 
-    QByteArray output(data.size() * m_frameBytes, 0);
-    convertToQByteArray(data, output);
+    if (wasCancelled) {
+        setStatus("Cancelled", 1.0);
+        return QByteArray();
+    }
+    if (replay == StreamState::Replay::Shaped)
+        setStatus("Done: cached pitch correction, reverb/level re-applied", 1.0);
+    else if (replay == StreamState::Replay::Gated)
+        setStatus(QString("Done: cached gate/pitch map, single-pass PV, %1 frames").arg(frames), 1.0);
+    else
+        setStatus(QString("Done: single-pass PV, %1 frames").arg(frames), 1.0);
     return output;
 }
 
+// One block through every stage, in the same order the whole-buffer
+// pipeline used: normalise → gate → pitch map/PV → compressor+exciter →
+// reverb (so the wet signal is pitch-corrected too) → level match/limiter.
+QByteArray VocalEnhancer::streamRun(const Planar& block, bool flush) {
+    StreamState& st = *m_stream;
+
+    Planar normalised = block;
+    streamNormalise(normalised, flush);
+
+    Planar gated(st.lanes);
+    streamNoiseGate(normalised, gated, flush);
+    if (st.rec) streamRecord(st.rec->gated, gated);
+
+    Planar tuned(st.lanes);
+    streamPitchCorrection(gated, tuned, flush);
+    if (streamCancelled()) return QByteArray();
+
+    streamDynamics(tuned);
+    if (st.rec) streamRecord(st.rec->shaped, tuned);
+    return streamOutput(tuned);
+}
+
+// Stands in for the stages a cached result covers (see StageCache), handing
+// on as many cached samples as `frames` input frames would have produced —
+// everything left on flush. The stages after it run exactly as in
+// streamRun(), so the output is the same a full run would give.
+QByteArray VocalEnhancer::streamReplay(qint64 frames, bool flush) {
+    StreamState& st = *m_stream;
+    const StageCache& cache = *m_cache;
+    const qint64 left = cache.gateKey.frames - st.replayPos;
+    const qint64 n    = std::clamp<qint64>(flush ? left : frames, 0, left);
+
+    auto slice = [&](const Planar& x) {
+        Planar part(st.lanes);
+        for (int c = 0; c < st.lanes; ++c)
+            part[c] = x[c].mid(st.replayPos, n);
+        return part;
+    };
+
+    Planar tuned(st.lanes);
+    if (st.replay == StreamState::Replay::Gated) {
+        streamPitchCorrection(slice(cache.gated), tuned, flush);
+        if (streamCancelled()) return QByteArray();
+        streamDynamics(tuned);
+        if (st.rec) streamRecord(st.rec->shaped, tuned);
+    } else {
+        tuned = slice(cache.shaped);
+        // ...and the level-match reference the pitch stage would have queued
+        const Planar ref = slice(cache.gated);
+        for (int c = 0; c < st.lanes; ++c)
+            st.level.ref[c].append(ref[c]);
+    }
+    st.replayPos += n;
+    return streamOutput(tuned);
+}
+
+// Reverb, level match and PCM conversion — the stages no cache entry covers
+QByteArray VocalEnhancer::streamOutput(Planar& tuned) {
+    StreamState& st = *m_stream;
+
+    streamReverb(tuned);
+    streamLevelMatch(tuned);
+
+    st.framesOut += tuned.first().size();
+    if (st.totalFrames > 0) {
+        QMutexLocker lk(&m_stateMutex);
+        progressValue = std::clamp(double(st.framesOut) / double(st.totalFrames), 0.0, 0.99);
+    }
+
+    QByteArray output;
+    convertToQByteArray(tuned, output);
+    return output;
+}
+
+// Applies the whole-take normalisation gain. Without a measured level from
+// begin(), holds the first kNormLookaheadSec seconds back, estimates the gain
+// from those alone (on the mid signal, like measureInput()), then releases
+// them and passes everything after through. One gain for every lane.
+void VocalEnhancer::streamNormalise(Planar& x, bool flush) {
+    StreamState& st = *m_stream;
+
+    if (!st.gainKnown) {
+        const int lookahead = std::max(1, int(kNormLookaheadSec * m_sampleRate));
+        for (int c = 0; c < st.lanes; ++c) {
+            st.normHold[c].append(x[c]);
+            x[c].clear();
+        }
+        if (!flush && st.normHold.first().size() < lookahead)
+            return;
+
+        // Exactly the first `lookahead` samples, however the input was sliced
+        const int len = std::min<int>(st.normHold.first().size(), lookahead);
+        const QVector<double> mid = laneMean(st.normHold, len);
+        double peak = 0.0;
+        for (int i = 0; i < len; ++i) peak = std::max(peak, std::abs(mid[i]));
+        const double rms = chunkRMS(mid, 0, len);
+        st.gain      = normalisationGain(rms, peak);
+        st.gainKnown = true;
+        qWarning() << "Input normalise (estimated): rms=" << rms << " gain=" << st.gain;
+
+        x.swap(st.normHold);
+        st.normHold = Planar(st.lanes);
+    }
+
+    if (st.gain != 1.0)
+        for (QVector<double>& lane : x)
+            applyMakeupGain(lane, st.gain);
+}
+
+// Appends one stage's block to this run's cache recording; a take that
+// outgrows m_stageCacheLimit just isn't cached (the run itself carries on).
+void VocalEnhancer::streamRecord(Planar& stage, const Planar& block) {
+    StreamState& st = *m_stream;
+    if (block.first().isEmpty()) return;
+
+    st.recBytes += qint64(sizeof(double)) * st.lanes * block.first().size();
+    if (st.recBytes > m_stageCacheLimit) {
+        qWarning() << "VocalEnhancer: take exceeds the stage cache limit, not caching it";
+        st.rec.reset();
+        return;
+    }
+    if (stage.isEmpty()) stage = Planar(st.lanes);
+    for (int c = 0; c < st.lanes; ++c)
+        stage[c].append(block[c]);
+}
+
+void VocalEnhancer::setStageCacheLimit(qint64 bytes) {
+    m_stageCacheLimit = std::max<qint64>(0, bytes);
+    if (m_stageCacheLimit == 0) m_cache.reset();
+}
+
+void VocalEnhancer::clearStageCache() {
+    m_cache.reset();
+}
+
 int VocalEnhancer::getProgress() const {
     QMutexLocker lk(&m_stateMutex);
     return int(progressValue * 100.0);
@@ -382,6 +1375,20 @@ double VocalEnhancer::getNoiseReductionAmount() const {
     return m_noiseReductionAmount;
 }
 
+VocalEnhancer::Precision VocalEnhancer::defaultPrecision() {
+#ifdef WAKKAQT_DSP_FLOAT32
+    return Precision::Float;
+#else
+    return Precision::Double;
+#endif
+}
+
+void VocalEnhancer::setPrecision(Precision precision) {
+    m_precision = precision;
+    if (precision == Precision::Float && !m_f32)
+        m_f32.reset(new FloatPlans);
+}
+
 // ======================
 // Scale / Key / Retune Speed setters
 // ======================
@@ -425,7 +1432,7 @@ void VocalEnhancer::setRetuneSpeed(double ms) {
 // ======================
 // Pitch Detection (HPS on log spectrum)
 // ======================
-double VocalEnhancer::detectPitch(const QVector<double>& inputData) const {
+double VocalEnhancer::detectPitch(SampleSpan<double> inputData) const {
     const int N = inputData.size();
     if (N < 1024) return 0.0;
 
@@ -474,18 +1481,26 @@ double VocalEnhancer::detectPitch(const QVector<double>& inputData) const {
     for (int i = 0; i < fftN; ++i) mean += inputData[start + i];
     mean /= fftN;
 
-    // Use the pre-allocated cached detection plan (thread-safe: no new plan creation)
-    if (!m_detFwd || !m_detIn || !m_detOut) return 0.0;
-    fftw_complex* fftOut = m_detOut;
+    // The shared detection plan runs on per-call buffers via the new-array
+    // execute interface: the pitch stage runs detections on several threads
+    // at once. fftw_malloc gives the alignment the plan was created with.
+    if (!m_detFwd) return 0.0;
+    const int bins = fftN / 2 + 1;
+    double*       fftIn  = fftw_alloc_real(fftN);
+    fftw_complex* fftOut = fftw_alloc_complex(bins);
+    if (!fftIn || !fftOut) {
+        fftw_free(fftIn);
+        fftw_free(fftOut);
+        return 0.0;
+    }
 
     for (int i = 0; i < fftN; ++i) {
         double x = inputData[start + i] - mean;
-        m_detIn[i] = x * window[i];
+        fftIn[i] = x * window[i];
     }
 
-    fftw_execute(m_detFwd);
+    fftw_execute_dft_r2c(m_detFwd, fftIn, fftOut);
 
-    const int bins = fftN / 2 + 1;
     QVector<double> logMag(bins);
 
     // Log magnitude for stability
@@ -495,6 +1510,8 @@ double VocalEnhancer::detectPitch(const QVector<double>& inputData) const {
         double mag = std::sqrt(re*re + im*im);
         logMag[k] = std::log(mag + 1e-12);
     }
+    fftw_free(fftIn);
+    fftw_free(fftOut);
 
     // Harmonic Product Spectrum in log-domain (sum of shifted logs)
     QVector<double> hps = logMag;
@@ -544,86 +1561,16 @@ double VocalEnhancer::detectPitch(const QVector<double>& inputData) const {
 // YIN Pitch Detection (de Cheveigne & Kawahara 2002)
 // More accurate than HPS for monophonic vocals; fewer octave errors.
 // ======================
-double VocalEnhancer::detectPitchYIN(const QVector<double>& data) const {
-    // Use the highest-RMS block of up to 2048 samples
-    const int W = std::min<int>(data.size(), 2048);
-    if (W < 512) return 0.0;
-
-    const int minTau = std::max(2, int(double(m_sampleRate) / 1100.0)); // ~1100 Hz max
-    const int maxTau = std::min(W / 2, int(double(m_sampleRate) / 80.0)); // 80 Hz min
-    if (minTau >= maxTau) return 0.0;
-
-    // Choose the block with the highest RMS
-    int bestStart = int(data.size() - W) / 2;
-    double bestRms = 0.0;
-    for (int i = 0; i + W <= int(data.size()); i += W / 4) {
-        double rms = 0.0;
-        for (int j = 0; j < W; ++j) rms += data[i + j] * data[i + j];
-        rms = std::sqrt(rms / W);
-        if (rms > bestRms) { bestRms = rms; bestStart = i; }
-    }
-    if (bestRms < 1e-4) return 0.0;  // silence
-
-    // Step 1: Difference function d[tau] = Σ(x[j] - x[j+tau])^2 for j=0..W/2-1
-    const int half = W / 2;
-    QVector<double> d(maxTau + 1, 0.0);
-    for (int tau = 1; tau <= maxTau; ++tau) {
-        double sum = 0.0;
-        for (int j = 0; j < half; ++j) {
-            const double diff = data[bestStart + j] - data[bestStart + j + tau];
-            sum += diff * diff;
-        }
-        d[tau] = sum;
-    }
-
-    // Step 2: Cumulative Mean Normalized Difference (CMND)
-    QVector<double> cmnd(maxTau + 1, 1.0);
-    double cumSum = 0.0;
-    for (int tau = 1; tau <= maxTau; ++tau) {
-        cumSum += d[tau];
-        cmnd[tau] = (cumSum > 1e-12) ? d[tau] * double(tau) / cumSum : 1.0;
-    }
-
-    // Step 3: Find first tau below threshold (YIN paper recommends 0.10-0.15)
-    constexpr double kYinThreshold = 0.12;
-    int bestTau = -1;
-    for (int tau = minTau; tau < maxTau; ++tau) {
-        if (cmnd[tau] < kYinThreshold) {
-            // Local minimum: advance while still descending
-            while (tau + 1 <= maxTau && cmnd[tau + 1] <= cmnd[tau])
-                ++tau;
-            bestTau = tau;
-            break;
-        }
-    }
-
-    // Fallback: global minimum in range
-    if (bestTau < 1) {
-        int minIdx = minTau;
-        for (int tau = minTau + 1; tau <= maxTau; ++tau)
-            if (cmnd[tau] < cmnd[minIdx]) minIdx = tau;
-        if (cmnd[minIdx] > 0.50) return 0.0; // unreliable, treat as unvoiced
-        bestTau = minIdx;
-    }
-
-    // Step 4: Parabolic interpolation
-    double refinedTau = double(bestTau);
-    if (bestTau > minTau && bestTau < maxTau) {
-        const double y0 = cmnd[bestTau - 1];
-        const double y1 = cmnd[bestTau];
-        const double y2 = cmnd[bestTau + 1];
-        const double denom = y0 - 2.0*y1 + y2;
-        if (std::abs(denom) > 1e-12)
-            refinedTau = double(bestTau) + 0.5 * (y0 - y2) / denom;
-    }
-
-    const double freq = double(m_sampleRate) / std::max(refinedTau, 1.0);
-    qWarning() << "YIN detected pitch:" << freq << "Hz  (cmnd=" << cmnd[bestTau] << ")";
-    return (freq > 50.0 && freq < 1200.0) ? freq : 0.0;
+double VocalEnhancer::detectPitchYIN(SampleSpan<double> data) const {
+    if (!m_yin) return 0.0;
+    const PitchDetector::Result r = m_yin->analyse(data);
+    if (r.hz > 0.0)
+        qWarning() << "YIN detected pitch:" << r.hz << "Hz  (cmnd=" << r.cmnd << ")";
+    return r.hz;
 }
 
 // Hybrid: try YIN first; fall back to HPS if YIN returns nothing.
-double VocalEnhancer::detectPitchBest(const QVector<double>& data) const {
+double VocalEnhancer::detectPitchBest(SampleSpan<double> data) const {
     const double yin = detectPitchYIN(data);
     if (yin > 0.0) return yin;
     return detectPitch(data);  // HPS fallback
@@ -631,7 +1578,7 @@ double VocalEnhancer::detectPitchBest(const QVector<double>& data) const {
 
 // Normalized autocorrelation confidence at the detected pitch period.
 // Returns value in [-1, 1]; confident voicing when > 0.45.
-double VocalEnhancer::computeAutocorrConfidence(const QVector<double>& data,
+double VocalEnhancer::computeAutocorrConfidence(SampleSpan<double> data,
                                                  double pitchHz) const {
     if (pitchHz <= 0.0 || m_sampleRate <= 0) return 0.0;
     const int tau = int(std::round(double(m_sampleRate) / pitchHz));
@@ -694,7 +1641,7 @@ static constexpr double kMaxCorrectionCents = 100.0;  // capped: avoids over-cor
 static constexpr double kStrength           = 0.30;   // slightly reduced: natural but audible
 static constexpr double kBypassEps          = 4e-3;   // skip PV if ratio ~1
 
-// Compute chunk RMS (used both here and in processPitchCorrection)
+// Compute chunk RMS (used both here and in streamPitchCorrection)
 static double chunkRMS(const QVector<double>& x, int start, int len) {
     long double sum = 0.0;
     const int end = std::min<int>(start + len, x.size());
@@ -799,154 +1746,251 @@ double VocalEnhancer::correctPitchChunk(QVector<double>& chunk, double prevRatio
 }
 
 // ======================
-// Main pitch correction pipeline — single-pass phase vocoder
+// Main pitch correction stage — single-pass phase vocoder
 // ======================
 // The old outer-OLA-chunked approach fed separate signal buffers to the PV per
-// chunk, causing double-windowing artifacts ("bubbles", cracks).  This version
-// builds a smooth per-PV-frame ratio array first, then runs pitchShiftContinuous()
-// exactly once over the whole signal — no outer OLA, no phase discontinuities.
-void VocalEnhancer::processPitchCorrection(QVector<double>& data, const std::atomic<bool> *cancelled) {
-
-    if (chunkRMS(data, 0, data.size()) < 1e-6) {
-        setStatus("Enhancer: silence (bypass)", 1.0);
-        return;
+// chunk, causing double-windowing artifacts ("bubbles", cracks). This stage
+// runs one continuous PV over the whole take instead — no outer OLA, no phase
+// discontinuities — and builds the per-PV-frame ratio curve right alongside
+// it: each frame's ratio only depends on detections at or before it, so the
+// stage only has to hold back one batch of detection windows (detBatch × 80 ms
+// plus 3·N ≈ 140 ms) of lookahead instead of a full-length ratio array and
+// output buffer.
+//
+// Ha == Hs always, so duration is preserved exactly — pitch is shifted by
+// scaling each bin's instantaneous frequency before accumulating it into
+// sumPhase (sumPhase[k] += trueFreq[k] * ratio * Ha), without moving any
+// samples in time.
+//
+// In stereo mode detection, the ratio map and the phase advance all run on
+// the gated mid signal; each channel then gets the mid frame's phase
+// rotation (pvRotation()) applied to its own spectrum, in parallel.
+void VocalEnhancer::streamPitchCorrection(const Planar& in, Planar& out, bool flush) {
+    StreamState& st = *m_stream;
+    StreamState::Pitch& p = st.pitch;
+
+    const int N      = kPvN;   // 2048 — PV frame size
+    const int Ha     = N / 8;  // 256  — analysis hop = synthesis hop
+    const int detWin = 3 * N;  // detection window ≈ 140 ms
+    const int bins   = N / 2 + 1;
+
+    for (int c = 0; c < st.lanes; ++c) {
+        p.in[c].append(in[c]);
+        p.ola[c].resize(p.in[c].size(), 0.0);
     }
-
-    const int totalSamples = data.size();
-    const int N  = kPvN;   // 2048 — PV frame size (matches pitchShiftContinuous)
-    const int Ha = N / 8;  // 256  — analysis hop
-
-    if (totalSamples < N) {
-        // Too short for PV — apply a soft limiter only; dynamics/exciter are
-        // handled by enhance() on the full signal after pitch correction.
-        applyLimiter(data, 0.98);
-        setStatus("Done (short clip)", 1.0);
-        return;
+    const bool stereo = st.lanes > 1;
+    if (stereo) p.mid.append(laneMean(in, in.first().size()));
+    const QVector<double>& ana = stereo ? p.mid : p.in.first();
+    p.wsum.resize(ana.size(), 0.0);
+    const qint64 end = p.base + ana.size();
+
+    const bool single = st.singlePrecision;
+    const SpectralPlans<double> pv64{m_pvIn, m_pvOut, m_pvSpec, m_pvIfft, m_pvFwd, m_pvInv};
+    const bool plansOk = single || pv64.ok();   // begin() only picks float if its plans exist
+
+    // ── Parallel analysis ─────────────────────────────────────────────────
+    // Detection windows only read input samples, so every window whose
+    // lookahead has arrived can be analysed up front, across the thread pool;
+    // only the cheap EMA/slew smoothing below has to walk them in order.
+    // Windows are batched (p.detBatch) so each pool dispatch has enough work
+    // to spread over the cores; on flush the window is simply clipped at the
+    // end of the take instead.
+    if (plansOk) {
+        QVector<qint64> starts;
+        for (qint64 f = p.detFrame; ; f += p.detStepFrames) {
+            const qint64 pos = f * Ha;
+            if (pos + N > end || (!flush && pos + detWin > end)) break;
+            starts.append(pos);
+        }
+        // Replaying the gated signal: its detections are cached as well
+        const QVector<StreamState::Pitch::Detection>* cached =
+            (st.replay == StreamState::Replay::Gated) ? &m_cache->det : nullptr;
+        if (!starts.isEmpty() && (flush || cached || starts.size() >= p.detBatch)) {
+            const QVector<double>& src = ana;
+            const qint64 base = p.base;
+            auto analyse = [this, &src, base, end, detWin](qint64 pos) {
+                StreamState::Pitch::Detection det;
+                const int wLen = int(std::min<qint64>(end - pos, detWin));
+                if (wLen >= 1024) {
+                    const SampleSpan<double> buf(src.constData() + (pos - base), wLen);
+                    det.pitch    = detectPitchBest(buf);
+                    det.conf     = computeAutocorrConfidence(buf, det.pitch);
+                    det.analysed = true;
+                }
+                return det;
+            };
+            const qsizetype firstDet = qsizetype(p.detFrame / p.detStepFrames);
+            if (cached && firstDet + starts.size() <= cached->size()) {
+                p.det.append(cached->mid(firstDet, starts.size()));
+            } else {
+                const QVector<StreamState::Pitch::Detection> found =
+                    QtConcurrent::blockingMapped(starts, analyse);
+                p.det.append(found);
+                if (st.rec && !cached) st.rec->det.append(found);
+            }
+            p.detFrame += qint64(starts.size()) * p.detStepFrames;
+        }
     }
 
-    // ── Correction parameters ─────────────────────────────────────────────
-    const double correctionAmount   = std::clamp(m_pitchCorrectionAmount, 0.0, 1.0);
-    const double deadZoneCents      = lerpParam(30.0, 12.0, correctionAmount);
-    const double maxCorrectionCents = lerpParam(100.0, 160.0, correctionAmount);
-    const double strength           = lerpParam(0.30, 0.72, correctionAmount);
-    const double slewCentsPerSec    = std::min(9000.0,
-                                        100000.0 / std::max(1.0, m_retuneSpeedMs));
-    const double frameDurSec        = double(Ha) / double(std::max(1, m_sampleRate));
-    const double maxSlewPerFrame    = slewCentsPerSec * frameDurSec;
-
-    // ── Per-PV-frame ratio array ──────────────────────────────────────────
-    // Number of frames must match what pitchShiftContinuous() will iterate.
-    const int numFrames = (totalSamples - N) / Ha + 1;
-    QVector<double> frameRatios(numFrames, 1.0);
-
-    // Detect pitch every ~80 ms (≈14 PV frames at 44100 Hz / Ha=256)
-    const int detStepFrames = std::max(1, int(0.080 / frameDurSec));
-    // Detection window: 3 * N ≈ 140 ms (same size the old chunker used)
-    const int detWin = std::min(totalSamples, 3 * N);
-
-    // EMA for vibrato preservation: τ = 60 ms
-    const double emaAlpha = std::exp(-frameDurSec / 0.060);
-
-    double smoothedPitch    = 0.0;
-    double prevTargetCents  = 0.0;
-    bool   voiced           = false;
-    int    unvoicedDetCount = 0;   // consecutive unvoiced detection events
-    // Reset smoothedPitch after ~400 ms of consecutive unvoiced detections so
-    // section transitions don't carry a stale pitch into the next voiced phrase.
-    const int kResetAfterDetections = std::max(1, int(0.400 / (frameDurSec * detStepFrames)));
-
-    setStatus("Building pitch correction map...");
-
-    for (int f = 0; f < numFrames; ++f) {
-        if (cancelled && cancelled->load()) {
+    // A detection frame waits for its analysis result; frames in between
+    // only need their own N samples. Stereo frames leave their rotation in
+    // frameGains for the per-lane pass after the loop.
+    const int first    = int(p.pos - p.base);
+    const int maxFrames = (p.pos + N <= end) ? int((end - N - p.pos) / Ha) + 1 : 0;
+    if (stereo) {
+        if (single) p.f32.frameGains.resize(maxFrames * 2 * bins);
+        else        p.f64.frameGains.resize(maxFrames * 2 * bins);
+    }
+    int frames = 0;
+    while (plansOk && p.pos + N <= end) {
+        const bool detectionFrame = (p.frame % p.detStepFrames == 0);
+        if (detectionFrame && p.det.isEmpty())
+            break;
+        if (streamCancelled()) {
             setStatus("Cancelled", 1.0);
             return;
         }
-        const int pos = f * Ha;
+        const int off = int(p.pos - p.base);
 
-        // ── Periodic pitch detection ──────────────────────────────────────
-        if (f % detStepFrames == 0) {
-            const int wEnd = std::min(totalSamples, pos + detWin);
-            if (wEnd - pos >= 1024) {
-                QVector<double> buf(data.begin() + pos, data.begin() + wEnd);
-                double rawPitch = detectPitchBest(buf);
-                const double conf = computeAutocorrConfidence(buf, rawPitch);
+        // ── Sequential smoothing of the detection results ─────────────────
+        if (detectionFrame) {
+            const StreamState::Pitch::Detection det = p.det.first();
+            p.det.remove(0, 1);
+            if (det.analysed) {
+                double rawPitch   = det.pitch;
+                const double conf = det.conf;
 
                 if (rawPitch > 0.0 && conf > 0.30) {
                     // ── Octave-error guard ────────────────────────────────
                     // If the new detection is an octave away from the EMA and
                     // confidence is borderline, prefer the octave-corrected value.
-                    if (smoothedPitch > 0.0 && conf < 0.55) {
-                        const double ratio = rawPitch / smoothedPitch;
+                    if (p.smoothedPitch > 0.0 && conf < 0.55) {
+                        const double ratio = rawPitch / p.smoothedPitch;
                         if (ratio > 1.7 && ratio < 2.3)       rawPitch = rawPitch * 0.5;
                         else if (ratio > 0.43 && ratio < 0.6) rawPitch = rawPitch * 2.0;
                     }
 
-                    if (smoothedPitch <= 0.0) smoothedPitch = rawPitch;
-                    else smoothedPitch = emaAlpha * smoothedPitch
-                                      + (1.0 - emaAlpha) * rawPitch;
-                    voiced = true;
-                    unvoicedDetCount = 0;
+                    if (p.smoothedPitch <= 0.0) p.smoothedPitch = rawPitch;
+                    else p.smoothedPitch = p.emaAlpha * p.smoothedPitch
+                                         + (1.0 - p.emaAlpha) * rawPitch;
+                    p.voiced = true;
+                    p.unvoicedDetCount = 0;
                 } else {
-                    voiced = false;
-                    ++unvoicedDetCount;
+                    p.voiced = false;
+                    ++p.unvoicedDetCount;
                     // After sustained silence, clear stale pitch so the next
                     // phrase starts with fresh detection instead of wrong slew.
-                    if (unvoicedDetCount >= kResetAfterDetections) {
-                        smoothedPitch    = 0.0;
-                        prevTargetCents  = 0.0;
-                        unvoicedDetCount = 0;
+                    if (p.unvoicedDetCount >= p.resetAfterDetections) {
+                        p.smoothedPitch    = 0.0;
+                        p.prevTargetCents  = 0.0;
+                        p.unvoicedDetCount = 0;
                     }
                 }
-                setStatus(
-                    QString("Pitch map %1/%2  det=%3 Hz  conf=%4")
-                        .arg(f + 1).arg(numFrames)
-                        .arg(rawPitch, 0, 'f', 1)
-                        .arg(conf,     0, 'f', 2),
-                    0.60 * double(f) / double(numFrames));
+                setStatus(QString("Pitch map frame %1  det=%2 Hz  conf=%3")
+                              .arg(p.frame + 1)
+                              .arg(rawPitch, 0, 'f', 1)
+                              .arg(conf,     0, 'f', 2));
+            }
+
+            PitchTrack::Frame tf;
+            tf.ms         = p.pos * 1000 / std::max(1, m_sampleRate);
+            tf.confidence = float(det.conf);
+            if (p.voiced && p.smoothedPitch > 0.0) {
+                const double target = findClosestNoteFrequency(p.smoothedPitch);
+                const long   midi   = std::lround(69.0 + 12.0 * std::log2(target / 440.0));
+                tf.hz         = float(p.smoothedPitch);
+                tf.targetMidi = qint8(std::clamp<long>(midi, 0, 127));
             }
+            p.track.frames.append(tf);
         }
 
-        // ── Silence / unvoiced gate ───────────────────────────────────────
-        const double rms = chunkRMS(data, pos, std::min(N, totalSamples - pos));
-        if (!voiced || rms < 5e-4 || smoothedPitch <= 0.0) {
+        // ── Correction ratio for this frame ───────────────────────────────
+        const double rms = chunkRMS(ana, off, N);
+        if (!p.voiced || rms < 5e-4 || p.smoothedPitch <= 0.0) {
             // Smoothly release pitch correction toward zero (no sudden jump)
-            prevTargetCents += std::clamp(-prevTargetCents,
-                                          -maxSlewPerFrame, +maxSlewPerFrame);
-            frameRatios[f]   = std::pow(2.0, prevTargetCents / 1200.0);
-            continue;
-        }
+            p.prevTargetCents += std::clamp(-p.prevTargetCents,
+                                            -p.maxSlewPerFrame, +p.maxSlewPerFrame);
+        } else {
+            const double targetFreq = findClosestNoteFrequency(p.smoothedPitch);
+            double cents = 1200.0 * std::log2(targetFreq / p.smoothedPitch);
 
-        // ── Correction cents for this frame ──────────────────────────────
-        const double targetFreq = findClosestNoteFrequency(smoothedPitch);
-        double cents = 1200.0 * std::log2(targetFreq / smoothedPitch);
+            if (std::abs(cents) < p.deadZoneCents)
+                cents = 0.0;
+            else
+                cents = std::clamp(cents, -p.maxCorrectionCents, p.maxCorrectionCents) * p.strength;
 
-        if (std::abs(cents) < deadZoneCents)
-            cents = 0.0;
-        else
-            cents = std::clamp(cents, -maxCorrectionCents, maxCorrectionCents) * strength;
+            // Slew rate: ratio can move at most maxSlewPerFrame cents per frame
+            const double delta = cents - p.prevTargetCents;
+            p.prevTargetCents += std::clamp(delta, -p.maxSlewPerFrame, +p.maxSlewPerFrame);
+        }
+        const double ratio = std::pow(2.0, p.prevTargetCents / 1200.0);
+
+        // ── Analysis / phase advance / synthesis (see pvFrame) ───────────
+        const double* x = ana.constData() + off;
+        double*       w = p.wsum.data() + off;
+        if (!stereo) {
+            double* o = p.ola.first().data() + off;
+            if (single) pvFrame(x, ratio, Ha, o, w, p.f32, m_f32->pv);
+            else        pvFrame(x, ratio, Ha, o, w, p.f64, pv64);
+        } else if (single) {
+            pvRotation(x, ratio, Ha, p.f32.frameGains.data() + frames * 2 * bins, p.f32, m_f32->pv);
+            addWindowEnergy(p.f32.window.constData(), w, N);
+        } else {
+            pvRotation(x, ratio, Ha, p.f64.frameGains.data() + frames * 2 * bins, p.f64, pv64);
+            addWindowEnergy(p.f64.window.constData(), w, N);
+        }
 
-        // Slew rate: ratio can move at most maxSlewPerFrame cents per frame
-        const double delta = cents - prevTargetCents;
-        prevTargetCents   += std::clamp(delta, -maxSlewPerFrame, +maxSlewPerFrame);
-        frameRatios[f]     = std::pow(2.0, prevTargetCents / 1200.0);
+        p.pos += Ha;
+        ++p.frame;
+        ++frames;
     }
-
-    if (cancelled && cancelled->load()) {
-        setStatus("Cancelled", 1.0);
-        return;
+    if (stereo) {
+        if (single) synthesiseLanes<float, true>(p.in, p.ola, first, frames, Ha, p.f32.frameGains,
+                                                 p.f32.window, m_f32->pv, st.scratch32);
+        else        synthesiseLanes<double, true>(p.in, p.ola, first, frames, Ha, p.f64.frameGains,
+                                                  p.f64.window, pv64, st.scratch64);
     }
-    setStatus("Applying single-pass pitch shift...", 0.60);
-
-    // ── Single-pass PV: no outer OLA, no double windowing ────────────────
-    data = pitchShiftContinuous(data, frameRatios, cancelled);
 
-    // Soft-limit after PV to prevent inter-sample spikes; dynamics and harmonic
-    // exciter are applied by enhance() on the fully processed signal so they
-    // run exactly once and never compound with pitch-correction iterations.
-    applyLimiter(data, 0.98);
+    // Everything before the next frame's start can't change any more.
+    // Normalise by window weight; where coverage is low (edges of the take)
+    // blend with the dry signal so the edges never go silent — a well-covered
+    // sample has winSum ≥ ~0.5, below that we cross-fade the dry signal in.
+    const qint64 ready = (flush || !plansOk) ? end : std::min(p.pos, end);
+    const int    n     = int(ready - p.base);
+    if (n <= 0) return;
+
+    constexpr double minCoverage = 0.5;
+    for (int c = 0; c < st.lanes; ++c) {
+        const QVector<double>& dry = p.in[c];
+        const QVector<double>& ola = p.ola[c];
+
+        // The dry (gated) samples are also the level-match reference; queueing
+        // them here keeps it sample-aligned with the output it's compared to.
+        st.level.ref[c].append(QVector<double>(dry.begin(), dry.begin() + n));
+
+        QVector<double> done(n);
+        for (int i = 0; i < n; ++i) {
+            const double ws = p.wsum[i];
+            if (ws >= minCoverage) {
+                done[i] = ola[i] / ws;
+            } else if (ws > 1e-10) {
+                const double wet = ws / minCoverage;   // 0→1 as coverage grows
+                done[i] = (ola[i] / ws) * wet + dry[i] * (1.0 - wet);
+            } else {
+                done[i] = dry[i];  // no coverage at all — pass dry
+            }
+        }
+        p.in[c].remove(0, n);
+        p.ola[c].remove(0, n);
 
-    setStatus(QString("Done: single-pass PV, %1 frames").arg(numFrames), 1.0);
+        // Soft-limit after PV to prevent inter-sample spikes; dynamics and the
+        // exciter run once, downstream, on the fully processed signal.
+        applyLimiter(done, 0.98);
+        out[c].append(done);
+    }
+    if (stereo) p.mid.remove(0, n);
+    p.wsum.remove(0, n);
+    p.base = ready;
 }
 
 
@@ -976,64 +2020,67 @@ void VocalEnhancer::applyLimiter(QVector<double>& x, double ceiling) {
 // Reverb — Freeverb / Schroeder
 // ======================
 // 8 parallel feedback comb filters (with high-frequency damping) summed,
-// then passed through 2 series allpass filters.
-// Delay lengths are Freeverb constants scaled to the actual sample rate.
-void VocalEnhancer::applyReverb(QVector<double>& data) {
-    if (m_reverbMix < 0.005 || data.isEmpty()) return;
-
-    const int    N      = data.size();
-    const double sRatio = double(std::max(1, m_sampleRate)) / 44100.0;
-
-    // Freeverb reference delay lengths at 44100 Hz
-    static constexpr int kCombD[8] = {1116,1188,1277,1356,1422,1491,1557,1617};
-    static constexpr int kApD[2]   = {556, 441};
-
-    // Room size maps to feedback coefficient (0.28 … 0.96)
-    const double feedback = 0.28 + m_reverbRoomSize * 0.68;
-    // Decay maps to damping coefficient (how fast high freqs die)
-    const double damp = 1.0 - m_reverbDecay * 0.85;
-
-    // ── 8 parallel comb filters ───────────────────────────────────────────
-    QVector<double> wet(N, 0.0);
-
-    for (int c = 0; c < 8; ++c) {
-        const int D = std::max(1, int(kCombD[c] * sRatio));
-        QVector<double> line(D, 0.0);
-        double filterStore = 0.0;
-        int wp = 0;
-
-        for (int n = 0; n < N; ++n) {
-            const double out = line[wp];
-            // Low-pass damp: simulates air absorption of high frequencies
-            filterStore = out * (1.0 - damp) + filterStore * damp;
-            line[wp] = data[n] + filterStore * feedback;
-            if (++wp >= D) wp = 0;
-            wet[n] += out;
+// then passed through 2 series allpass filters. Delay lengths are Freeverb
+// constants scaled to the actual sample rate (allocated in begin()); the
+// delay lines and their write positions persist across blocks, so a stream
+// gets exactly the tail a single whole-take pass would. Each lane has its own
+// tank (kStereoSpread apart), so a stereo take gets a stereo tail.
+void VocalEnhancer::streamReverb(Planar& lanes) {
+    if (m_reverbMix < 0.005) return;
+
+    StreamState::Reverb& r = m_stream->reverb;
+    for (int l = 0; l < lanes.size(); ++l) {
+        QVector<double>& data = lanes[l];
+        StreamState::Reverb::Tank& t = r.tank[l];
+        const int N = data.size();
+        if (N == 0) continue;
+
+        // ── 8 parallel comb filters ───────────────────────────────────────
+        QVector<double>& wet = r.wet;
+        wet.fill(0.0, N);
+
+        for (int c = 0; c < 8; ++c) {
+            QVector<double>& line = t.combLine[c];
+            const int D = line.size();
+            double filterStore = t.combStore[c];
+            int wp = t.combPos[c];
+
+            for (int n = 0; n < N; ++n) {
+                const double out = line[wp];
+                // Low-pass damp: simulates air absorption of high frequencies
+                filterStore = out * (1.0 - r.damp) + filterStore * r.damp;
+                line[wp] = data[n] + filterStore * r.feedback;
+                if (++wp >= D) wp = 0;
+                wet[n] += out;
+            }
+            t.combStore[c] = filterStore;
+            t.combPos[c]   = wp;
         }
-    }
-    for (auto& s : wet) s *= (1.0 / 8.0);
-
-    // ── 2 series allpass filters ──────────────────────────────────────────
-    for (int a = 0; a < 2; ++a) {
-        const int    D = std::max(1, int(kApD[a] * sRatio));
-        const double g = 0.5;
-        QVector<double> line(D, 0.0);
-        int wp = 0;
-
-        for (int n = 0; n < N; ++n) {
-            const double delayed = line[wp];
-            const double w       = wet[n] + g * delayed;   // w[n] = x[n] + g*w[n-D]
-            line[wp] = w;
-            if (++wp >= D) wp = 0;
-            wet[n] = delayed - g * w;                      // y[n] = w[n-D] - g*w[n]
+        for (auto& s : wet) s *= (1.0 / 8.0);
+
+        // ── 2 series allpass filters ──────────────────────────────────────
+        for (int a = 0; a < 2; ++a) {
+            QVector<double>& line = t.apLine[a];
+            const int    D = line.size();
+            const double g = 0.5;
+            int wp = t.apPos[a];
+
+            for (int n = 0; n < N; ++n) {
+                const double delayed = line[wp];
+                const double w       = wet[n] + g * delayed;   // w[n] = x[n] + g*w[n-D]
+                line[wp] = w;
+                if (++wp >= D) wp = 0;
+                wet[n] = delayed - g * w;                      // y[n] = w[n-D] - g*w[n]
+            }
+            t.apPos[a] = wp;
         }
-    }
 
-    // ── Wet / dry mix ─────────────────────────────────────────────────────
-    const double wetGain = m_reverbMix;
-    const double dryGain = 1.0 - wetGain;
-    for (int n = 0; n < N; ++n)
-        data[n] = std::clamp(dryGain * data[n] + wetGain * wet[n], -1.0, 1.0);
+        // ── Wet / dry mix ─────────────────────────────────────────────────
+        const double wetGain = m_reverbMix;
+        const double dryGain = 1.0 - wetGain;
+        for (int n = 0; n < N; ++n)
+            data[n] = std::clamp(dryGain * data[n] + wetGain * wet[n], -1.0, 1.0);
+    }
 }
 
 void VocalEnhancer::applyMakeupGain(QVector<double>& x, double gain) {
@@ -1041,75 +2088,120 @@ void VocalEnhancer::applyMakeupGain(QVector<double>& x, double gain) {
     for (auto& s : x) s *= gain;
 }
 
-void VocalEnhancer::compressDynamics(QVector<double>& x, double threshold, double ratio) {
-    // Feed-forward compressor with peak-like envelope follower
-    threshold = std::clamp(threshold, 0.0, 0.999);
-    ratio = std::max(1.0, ratio);
-
-    const double atkMs = 5.0;
-    const double relMs = 60.0;
-    const double atk = std::exp(-1.0 / ((atkMs / 1000.0) * m_sampleRate));
-    const double rel = std::exp(-1.0 / ((relMs / 1000.0) * m_sampleRate));
+// Feed-forward compressor (threshold 0.82, 2:1, peak-like envelope follower)
+// followed by a band-limited harmonic exciter.
+//
+// The compressor's automatic make-up gain restores loudness lost to gain
+// reduction. A whole-take pass could derive one gain from the take's overall
+// pre/post RMS; a stream only knows the take so far, so the make-up glides
+// (τ ≈ 300 ms) toward the ratio measured up to the current sample instead —
+// clamped conservatively, same as before, to avoid over-driving the limiter.
+// The target is refreshed every kGainHop samples of the take (not per call),
+// so the result doesn't depend on how the caller sliced the input.
+//
+// Exciter: only saturate the high-mid shelf (>= ~3 kHz). Running tanh over
+// the full spectrum adds harmonics to sibilants (S/T), making them harsh and
+// fatiguing. A first-order high-pass isolates the upper partials that benefit
+// from excitation, leaving the fundamental and low harmonics clean:
+//   y[n] = a*(y[n-1] + x[n] - x[n-1]),  a = 1 / (1 + 2π·fc/fs)
+//
+// With several lanes the compressor is linked: the envelope follows the
+// loudest channel and every channel gets the same gain, so compression
+// never shifts the image; only the exciter's filter state is per channel.
+void VocalEnhancer::streamDynamics(Planar& x) {
+    StreamState::Dynamics& d = m_stream->dyn;
+
+    constexpr double threshold = 0.82;
+    constexpr double ratio     = 2.0;
+    constexpr double drive     = 1.08;
+    constexpr double mix       = 0.14;
+
+    const int lanes = x.size();
+    const int n     = x.first().size();
+    QVector<double*> ch(lanes);
+    for (int c = 0; c < lanes; ++c) ch[c] = x[c].data();
+
+    for (int i = 0; i < n; ++i) {
+        long double pre = 0.0;
+        double      a   = 0.0;
+        for (int c = 0; c < lanes; ++c) {
+            const double s = ch[c][i];
+            pre += (long double)s * s;
+            a = std::max(a, std::abs(s));
+        }
+        d.preAcc += pre;
+        d.env = (a > d.env) ? (d.atk * d.env + (1.0 - d.atk) * a)
+                            : (d.rel * d.env + (1.0 - d.rel) * a);
+
+        double gr = 1.0;
+        if (d.env > threshold) {
+            const double over = d.env / threshold;
+            gr = std::pow(over, 1.0 - 1.0 / ratio);
+        }
+        long double post = 0.0;
+        for (int c = 0; c < lanes; ++c) {
+            double& s = ch[c][i];
+            if (gr != 1.0) s /= gr;
+            post += (long double)s * s;
+        }
+        d.postAcc += post;
 
-    // Measure RMS before compression for make-up gain calculation
-    long double rmsAccPre = 0.0;
-    for (double s : x) rmsAccPre += (long double)s * s;
-    const double rmsPre = std::sqrt((double)(rmsAccPre / std::max<int>(1, x.size())));
+        if (d.n++ % kGainHop == 0 && d.postAcc > 1e-18L && d.preAcc > 1e-18L)
+            d.target = std::clamp(std::sqrt((double)(d.preAcc / d.postAcc)), 1.0, 2.5);
+        d.makeUp += (d.target - d.makeUp) * d.makeUpCoef;
 
-    double env = 0.0;
-    for (auto& s : x) {
-        double a = std::abs(s);
-        env = (a > env) ? (atk * env + (1.0 - atk) * a)
-                        : (rel * env + (1.0 - rel) * a);
+        for (int c = 0; c < lanes; ++c) {
+            double& s = ch[c][i];
+            s *= d.makeUp;
 
-        if (env > threshold) {
-            double over = env / threshold;
-            double gr = std::pow(over, 1.0 - 1.0 / ratio);
-            s /= gr;
+            // High-pass the input, saturate only that, blend back over the dry
+            const double hp = d.hpA * (d.hpPrev[c] + s - d.xPrev[c]);
+            d.hpPrev[c] = hp;
+            d.xPrev[c]  = s;
+            s = s + std::tanh(hp * drive) * mix;
         }
     }
-
-    // Automatic make-up gain: restore loudness lost to gain reduction.
-    // Clamped conservatively to avoid over-driving the limiter downstream.
-    long double rmsAccPost = 0.0;
-    for (double s : x) rmsAccPost += (long double)s * s;
-    const double rmsPost = std::sqrt((double)(rmsAccPost / std::max<int>(1, x.size())));
-
-    if (rmsPost > 1e-9 && rmsPre > 1e-9) {
-        const double makeUp = std::clamp(rmsPre / rmsPost, 1.0, 2.5);
-        for (auto& s : x) s *= makeUp;
-    }
 }
 
-void VocalEnhancer::harmonicExciter(QVector<double>& x, double drive, double mix) {
-    drive = std::max(0.0, drive);
-    mix   = std::clamp(mix, 0.0, 1.0);
-
-    // Band-limited exciter: only saturate the high-mid shelf (>= ~3 kHz).
-    // Running tanh over the full spectrum adds harmonics to sibilants (S/T),
-    // making them harsh and fatiguing. A first-order high-pass isolates the
-    // upper partials that benefit from excitation, leaving the fundamental
-    // and low harmonics clean.
-    //
-    // First-order IIR high-pass: y[n] = a*(y[n-1] + x[n] - x[n-1])
-    //   a = 1 / (1 + 2π·fc/fs)  — bilinear approximation
-    const double fc = 3000.0;  // Hz — crossover
-    const double a  = 1.0 / (1.0 + 2.0 * kPi * fc / std::max(1, m_sampleRate));
-
-    double hpPrev  = 0.0;  // HP filter state
-    double xPrev   = 0.0;  // previous input sample
-
-    for (auto& s : x) {
-        // High-pass the input
-        const double hp = a * (hpPrev + s - xPrev);
-        hpPrev = hp;
-        xPrev  = s;
-
-        // Saturate only the high-passed signal
-        const double excited = std::tanh(hp * drive);
-
-        // Blend: original dry + band-limited saturation
-        s = s + excited * mix;
+// Final level match: keep output loudness at the gated, pre-pitch-correction
+// level regardless of scale/correction amount — tracked as running RMS of
+// both signals (the reference queued sample-aligned by the pitch stage),
+// with the gain gliding (τ ≈ 500 ms) toward their ratio. The 4× cap avoids
+// over-boosting quiet inputs after compression+exciter; a single soft
+// limiter is the final clip guard. Both sums run over every lane and the one
+// gain is applied to all of them.
+void VocalEnhancer::streamLevelMatch(Planar& x) {
+    StreamState::LevelMatch& l = m_stream->level;
+    const int lanes = x.size();
+    const int n = std::min<int>(x.first().size(), l.ref.first().size());
+
+    for (int i = 0; i < n; ++i) {
+        long double ref = 0.0, out = 0.0;
+        for (int c = 0; c < lanes; ++c) {
+            const double r = l.ref[c][i], s = x[c][i];
+            ref += (long double)r * r;
+            out += (long double)s * s;
+        }
+        l.refAcc += ref;
+        l.outAcc += out;
+
+        if (l.n++ % kGainHop == 0) {
+            const double refRms = std::sqrt((double)(l.refAcc / l.n));
+            const double outRms = std::sqrt((double)(l.outAcc / l.n));
+            l.target = 1.0;
+            if (refRms > 1e-6 && outRms > 1e-9) {
+                const double makeup = std::clamp(refRms / outRms, 0.5, 4.0);
+                if (makeup > 1.02 || makeup < 0.98)
+                    l.target = makeup;
+            }
+        }
+        l.gain += (l.target - l.gain) * l.coef;
+        for (int c = 0; c < lanes; ++c)
+            x[c][i] *= l.gain;
+    }
+    for (int c = 0; c < lanes; ++c) {
+        l.ref[c].remove(0, n);
+        applyLimiter(x[c], 0.98);
     }
 }
 
@@ -1257,224 +2349,125 @@ double VocalEnhancer::cubicInterpolate(double v0, double v1, double v2, double v
 
 /////////// NOISE REDUCTION (SPECTRAL GATE)
 
-void VocalEnhancer::reduceNoiseSpectralGate(QVector<double>& x,
-                                            int fftSize,
-                                            int hopSize,
-                                            double overSub,
-                                            double floorDb,
-                                            double noiseLearnSec,
-                                            double adaptivity,
-                                            double lowEnergyDb,
-                                            const std::atomic<bool> *cancelled)
-{
-    if (x.isEmpty()) return;
-
-    const int N = (fftSize > 0 ? fftSize : 1024);
-    const int H = (hopSize > 0 ? hopSize : N / 4);
-    if (N < 256 || H < 1) return;
-
-    // Windows and overlap-add buffers
-    QVector<double> window = createHannWindow(N);
-
-    // Output will be same length as input (with a little padding)
-    const int outCap = x.size() + N + H + 4;
-    QVector<double> out(outCap, 0.0);
-    QVector<double> winSum(outCap, 0.0);
-
-    // Use cached plans when the caller requests the standard N=1024 size.
-    // For any other fftSize fall back to a temporary allocation.
-    const bool useCached = (N == kNgN) && m_ngFwd && m_ngInv;
-
-    double*       fftIn  = useCached ? m_ngIn   : (double*)      fftw_malloc(sizeof(double)       * N);
-    fftw_complex* fftOut = useCached ? m_ngOut  : (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (N/2+1));
-    fftw_complex* spec   = useCached ? m_ngSpec : (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (N/2+1));
-    double*       ifftOut= useCached ? m_ngIfft : (double*)      fftw_malloc(sizeof(double)       * N);
+// Spectral-subtraction gate, N=kNgN with 75% overlap. The noise profile is
+// learned from the first learnFrames frames of the take (an average of a few
+// frames is fine as an initial guess even if it isn't purely noise; the
+// model adapts slowly during low-energy frames afterwards), so the stage
+// holds output back until those have arrived; after that it only keeps one
+// frame of overlap resident.
+void VocalEnhancer::streamNoiseGate(const Planar& in, Planar& out, bool flush) {
+    StreamState& st = *m_stream;
+    StreamState::Gate& g = st.gate;
+
+    const int N    = kNgN;
+    const int H    = kNgHop;
+    const int bins = N / 2 + 1;
 
-    if (!fftIn || !fftOut || !spec || !ifftOut) {
-        if (!useCached) {
-            fftw_free(fftIn); fftw_free(fftOut);
-            fftw_free(spec);  fftw_free(ifftOut);
+    for (int c = 0; c < st.lanes; ++c) {
+        g.in[c].append(in[c]);
+        g.ola[c].resize(g.in[c].size(), 0.0);
+    }
+    const bool stereo = st.lanes > 1;
+    if (stereo) g.mid.append(laneMean(in, in.first().size()));
+    const QVector<double>& ana = stereo ? g.mid : g.in.first();   // what the gate listens to
+    g.wsum.resize(ana.size(), 0.0);
+    const qint64 end = g.base + ana.size();
+
+    const bool single = st.singlePrecision;
+    const SpectralPlans<double> ng64{m_ngIn, m_ngOut, m_ngSpec, m_ngIfft, m_ngFwd, m_ngInv};
+    const bool plansOk = single || ng64.ok();
+    if (!plansOk) {
+        // No FFTW — pass the signal through ungated rather than dropping it
+        for (int c = 0; c < st.lanes; ++c) {
+            out[c].append(g.in[c]);
+            g.in[c].clear(); g.ola[c].clear();
         }
+        g.base = end;
+        g.mid.clear(); g.wsum.clear();
         return;
     }
 
-    fftw_plan fwd = useCached ? m_ngFwd : fftw_plan_dft_r2c_1d(N, fftIn, fftOut, FFTW_ESTIMATE);
-    fftw_plan inv = useCached ? m_ngInv : fftw_plan_dft_c2r_1d(N, spec,  ifftOut, FFTW_ESTIMATE);
-
-    const int bins = N / 2 + 1;
-
-    // Noise profile (magnitude per bin)
-    QVector<double> noiseMag(bins, 0.0);
-    QVector<int>    noiseCnt(bins, 0);
-
-    // Gain smoothing to reduce musical noise (per-bin)
-    QVector<double> prevGain(bins, 1.0);
-
-    // Floor in linear gain
-    const double Gfloor = std::clamp(dbToLinear(floorDb), 0.0, 1.0);
-
-    // How many frames to learn the initial noise profile
-    const int learnFramesTarget = std::max(1, int((noiseLearnSec * m_sampleRate) / H));
-
-    // =============== First pass: learn noise from the first frames ===============
-    int inPos = 0;
-    int frames = 0;
-
-    while (inPos + N <= x.size() && frames < learnFramesTarget) {
-        // Copy & window
-        double frameRmsAcc = 0.0;
-        for (int i = 0; i < N; ++i) {
-            double s = x[inPos + i];
-            frameRmsAcc += s * s;
-            fftIn[i] = s * window[i];
-        }
-
-        const double frameRms = std::sqrt(frameRmsAcc / N);
-
-        // Shortcuts: even if it's not purely noise, an average of a few frames
-        // is fine as an initial guess; we’ll adapt slowly later on.
-        fftw_execute(fwd);
-
-        for (int k = 0; k < bins; ++k) {
-            const double re = fftOut[k][0];
-            const double im = fftOut[k][1];
-            const double mag = std::sqrt(re * re + im * im) + 1e-12;
+    // =============== Learn noise from the first frames ===============
+    if (!g.learned) {
+        if (!flush && end < qint64(g.learnFrames - 1) * H + N)
+            return;
 
-            noiseMag[k] += mag;
-            noiseCnt[k] += 1;
+        int frames = 0;
+        for (qint64 p = 0; p + N <= end && frames < g.learnFrames; p += H, ++frames) {
+            const double* x = ana.constData() + p;   // base is still 0 here
+            if (single) gateLearnFrame(x, g.f32, m_f32->ng);
+            else        gateLearnFrame(x, g.f64, ng64);
         }
-
-        inPos += H;
-        frames += 1;
+        // Average the accumulated noise magnitude
+        if (single) gateFinishLearning(g.f32, frames);
+        else        gateFinishLearning(g.f64, frames);
+        g.learned = true;
     }
 
-    // Average the accumulated noise magnitude
-    for (int k = 0; k < bins; ++k) {
-        if (noiseCnt[k] > 0) noiseMag[k] /= double(noiseCnt[k]);
-        if (noiseMag[k] <= 0.0) noiseMag[k] = 1e-12;
+    // =============== Apply spectral gating ===============
+    // Stereo: each frame's mask comes from the mid signal and is kept in
+    // frameGains; the lanes then apply them all in one parallel pass below.
+    const int first  = int(g.pos - g.base);
+    const int frames = (g.pos + N <= end) ? int((end - N - g.pos) / H) + 1 : 0;
+    if (stereo) {
+        if (single) g.f32.frameGains.resize(frames * bins);
+        else        g.f64.frameGains.resize(frames * bins);
     }
-
-    // Reset for full processing pass
-    inPos = 0;
-    int outPos = 0;
-    frames = 0;
-
-    // Temporal smoothing constants for gain (0..1). Larger = more smoothing.
-    const double atk = 0.60;  // when gain needs to go down (more suppression)
-    const double rel = 0.85;  // when gain can go up (less suppression)
-
-    // A tiny 3-bin frequency smoothing kernel can tame isolated spikes
-    auto smooth3 = [&](const QVector<double>& v, QVector<double>& y) {
-        y.resize(v.size());
-        if (v.size() == 1) { y[0] = v[0]; return; }
-        y[0] = 0.75 * v[0] + 0.25 * v[1];
-        for (int k = 1; k < v.size() - 1; ++k)
-            y[k] = 0.25 * v[k - 1] + 0.5 * v[k] + 0.25 * v[k + 1];
-        y[v.size() - 1] = 0.25 * v[v.size() - 2] + 0.75 * v[v.size() - 1];
-    };
-
-    QVector<double> magBuf(bins), magSm(bins);
-
-    // =============== Second pass: apply spectral gating ===============
-    while (inPos + N <= x.size() && outPos + N < out.size()) {
-        if (cancelled && cancelled->load())
-            break; // leave partial `out`; caller discards it on cancellation anyway
-        double frameRmsAcc = 0.0;
-        for (int i = 0; i < N; ++i) {
-            double s = x[inPos + i];
-            frameRmsAcc += s * s;
-            fftIn[i] = s * window[i];
-        }
-        const double frameRms = std::sqrt(frameRmsAcc / N);
-        const double frameDbFS = 20.0 * std::log10(std::max(frameRms, 1e-12)); // approximate dBFS
-
-        fftw_execute(fwd);
-
-        // Magnitudes
-        for (int k = 0; k < bins; ++k) {
-            const double re = fftOut[k][0];
-            const double im = fftOut[k][1];
-            magBuf[k] = std::sqrt(re * re + im * im) + 1e-12;
-        }
-
-        // Optional small frequency smoothing
-        smooth3(magBuf, magSm);
-
-        // Compute gains
-        for (int k = 0; k < bins; ++k) {
-            const double mag   = std::max(magSm[k], 1e-12);
-            const double noise = std::max(noiseMag[k], 1e-12);
-
-            // Simple spectral subtraction style gain
-            double G = 1.0 - overSub * (noise / mag);
-            G = std::clamp(G, Gfloor, 1.0);
-
-            // Temporal smoothing (per bin)
-            double gPrev = prevGain[k];
-            double gSm   = (G < gPrev)
-                           ? (atk * gPrev + (1.0 - atk) * G)   // faster down
-                           : (rel * gPrev + (1.0 - rel) * G);  // slower up
-            prevGain[k] = gSm;
-
-            // Re-apply with phase
-            const double re = fftOut[k][0];
-            const double im = fftOut[k][1];
-
-            // Avoid blowing away bins near DC completely
-            double gUse = gSm;
-            if (k <= 2) gUse = std::max(gUse, 0.5 * Gfloor);
-
-            spec[k][0] = re * gUse;
-            spec[k][1] = im * gUse;
-        }
-
-        // Slow noise model adaptation during low-energy frames
-        // Helps when noise changes between sentences/phrases
-        if (frameDbFS < lowEnergyDb && adaptivity > 1e-6) {
-            const double a = std::clamp(adaptivity, 0.0, 0.5); // keep small
-            for (int k = 0; k < bins; ++k) {
-                // Smoothly track downwards and (very) slowly upwards
-                noiseMag[k] = (1.0 - a) * noiseMag[k] + a * magSm[k];
-                if (noiseMag[k] <= 1e-12) noiseMag[k] = 1e-12;
-            }
-        }
-
-        // IFFT
-        fftw_execute(inv);
-
-        // Overlap-add with squared window compensation
-        for (int i = 0; i < N; ++i) {
-            double s = (ifftOut[i] / N) * window[i];
-            int idx = outPos + i;
-            out[idx]    += s;
-            winSum[idx] += window[i] * window[i];
+    for (int f = 0; f < frames; ++f) {
+        if (streamCancelled())
+            return; // caller discards everything on cancellation anyway
+        const int off = int(g.pos - g.base);
+
+        const double* x = ana.constData() + off;
+        double*       w = g.wsum.data() + off;
+        if (!stereo) {
+            double* o = g.ola.first().data() + off;
+            if (single) gateFrame(x, o, w, g.f32, m_f32->ng, g.overSub, g.gFloor, g.adaptivity, g.lowEnergyDb);
+            else        gateFrame(x, o, w, g.f64, ng64,      g.overSub, g.gFloor, g.adaptivity, g.lowEnergyDb);
+        } else if (single) {
+            gateMask(x, g.f32.frameGains.data() + f * bins, g.f32, m_f32->ng,
+                     g.overSub, g.gFloor, g.adaptivity, g.lowEnergyDb);
+            addWindowEnergy(g.f32.window.constData(), w, N);
+        } else {
+            gateMask(x, g.f64.frameGains.data() + f * bins, g.f64, ng64,
+                     g.overSub, g.gFloor, g.adaptivity, g.lowEnergyDb);
+            addWindowEnergy(g.f64.window.constData(), w, N);
         }
 
-        inPos += H;
-        outPos += H;
-        frames += 1;
+        g.pos += H;
     }
-
-    // Normalize by window energy
-    for (int i = 0; i < out.size(); ++i) {
-        if (winSum[i] > 1e-12) out[i] /= winSum[i];
+    if (stereo) {
+        if (single) synthesiseLanes<float, false>(g.in, g.ola, first, frames, H, g.f32.frameGains,
+                                                  g.f32.window, m_f32->ng, st.scratch32);
+        else        synthesiseLanes<double, false>(g.in, g.ola, first, frames, H, g.f64.frameGains,
+                                                   g.f64.window, ng64, st.scratch64);
     }
 
-    // Copy back to x (trim to original length)
-    x.resize(std::min<int>(x.size(), out.size()));
-    for (int i = 0; i < x.size(); ++i) x[i] = std::clamp(out[i], -1.0, 1.0);
-
-    // Cleanup — only free if we allocated locally (not using cached plans)
-    if (!useCached) {
-        fftw_destroy_plan(fwd);
-        fftw_destroy_plan(inv);
-        fftw_free(fftIn);
-        fftw_free(fftOut);
-        fftw_free(spec);
-        fftw_free(ifftOut);
+    // Samples before the next frame's start are final: normalise by window
+    // energy and hand them on. Samples no frame covered (the tail after the
+    // last full frame) come out silent, as they always have.
+    const qint64 ready = flush ? end : std::min(g.pos, end);
+    const int    n     = int(ready - g.base);
+    if (n <= 0) return;
+
+    for (int c = 0; c < st.lanes; ++c) {
+        QVector<double>& dst = out[c];
+        const QVector<double>& ola = g.ola[c];
+        const int at = dst.size();
+        dst.resize(at + n);
+        for (int i = 0; i < n; ++i) {
+            const double v = (g.wsum[i] > 1e-12) ? ola[i] / g.wsum[i] : ola[i];
+            dst[at + i] = std::clamp(v, -1.0, 1.0);
+        }
+        g.in[c].remove(0, n);
+        g.ola[c].remove(0, n);
     }
+    if (stereo) g.mid.remove(0, n);
+    g.wsum.remove(0, n);
+    g.base = ready;
 
-    setStatus("Noise reduction (spectral gate) applied");
+    if (flush)
+        setStatus("Noise reduction (spectral gate) applied");
 }
 
 // ======================
@@ -1542,7 +2535,7 @@ QVector<double> VocalEnhancer::timeStretchPhaseVocoder(const QVector<double>& in
         for (int i = 0; i < N; ++i)
             fftIn[i] = in[inPos + i] * window[i];
 
-        fftw_execute(fwd);
+        fftw_execute_dft_r2c(fwd, fftIn, fftOut);
 
         // ── Instantaneous frequency estimation ────────────────────────────
         for (int k = 0; k < bins; ++k) {
@@ -1571,7 +2564,7 @@ QVector<double> VocalEnhancer::timeStretchPhaseVocoder(const QVector<double>& in
             spec[k][1] = mag[k] * std::sin(sumPhase[k]);
         }
 
-        fftw_execute(inv);
+        fftw_execute_dft_c2r(inv, spec, ifftOut);
 
         // Overlap-add with per-sample window weight tracking
         for (int i = 0; i < N; ++i) {
@@ -1596,121 +2589,6 @@ QVector<double> VocalEnhancer::timeStretchPhaseVocoder(const QVector<double>& in
     return out;
 }
 
-// ─────────────────────────────────────────────────────────────────────────────
-// Continuous pitch shift — one PV pass, per-frame ratio curve, no restarts
-// ─────────────────────────────────────────────────────────────────────────────
-QVector<double> VocalEnhancer::pitchShiftContinuous(const QVector<double>& in,
-                                                     const QVector<double>& frameRatio,
-                                                     const std::atomic<bool> *cancelled)
-{
-    if (in.isEmpty() || frameRatio.isEmpty()) return in;
-
-    // ── Fixed analysis AND synthesis hop ──────────────────────────────────
-    // Ha == Hs always. Duration is preserved exactly — no resample needed,
-    // no time drift, no chipmunk effect from accumulated Hs rounding error.
-    //
-    // Pitch is shifted by scaling the instantaneous frequency before
-    // accumulating into sumPhase:
-    //   sumPhase[k] += trueFreq[k] * ratio * Ha
-    // This rotates spectral bins upward/downward by `ratio` each frame
-    // without moving any samples in time.
-    const int N  = kPvN;
-    const int Ha = N / 8;   // analysis hop = synthesis hop = 256
-
-    QVector<double> window = createHannWindow(N);
-    const int bins = N / 2 + 1;
-
-    QVector<double> out   (in.size(), 0.0);
-    QVector<double> winSum(in.size(), 0.0);
-
-    QVector<double> prevPhase(bins, 0.0);
-    QVector<double> sumPhase (bins, 0.0);
-    QVector<double> mag      (bins, 0.0);
-
-    QVector<double> omega(bins);
-    for (int k = 0; k < bins; ++k)
-        omega[k] = 2.0 * kPi * k / N;
-
-    double*       fftIn  = m_pvIn;
-    fftw_complex* fftOut = m_pvOut;
-    fftw_complex* spec   = m_pvSpec;
-    double*       ifftOut = m_pvIfft;
-
-    if (!fftIn || !fftOut || !spec || !ifftOut || !m_pvFwd || !m_pvInv)
-        return in;
-
-    int inPos = 0;
-    int frame = 0;
-
-    while (inPos + N <= in.size()) {
-        if (cancelled && cancelled->load())
-            break; // leave partial `out`; caller discards it on cancellation anyway
-        const double ratio = (frame < frameRatio.size())
-                           ? frameRatio[frame] : frameRatio.last();
-
-        // Analysis FFT
-        for (int i = 0; i < N; ++i)
-            fftIn[i] = in[inPos + i] * window[i];
-        fftw_execute(m_pvFwd);
-
-        // Instantaneous frequency → scale by ratio → accumulate phase
-        for (int k = 0; k < bins; ++k) {
-            const double re = fftOut[k][0];
-            const double im = fftOut[k][1];
-            mag[k]          = std::sqrt(re * re + im * im);
-            const double ph = std::atan2(im, re);
-
-            double delta    = ph - prevPhase[k] - omega[k] * Ha;
-            delta           = principalArg(delta);
-            const double trueFreq = omega[k] + delta / Ha;
-            prevPhase[k]    = ph;
-
-            // Multiply trueFreq by ratio: shifts pitch, preserves time.
-            // Wrap sumPhase into [-π, π] every frame to prevent precision loss
-            // in cos/sin as sumPhase grows to millions of radians over long songs.
-            sumPhase[k] = principalArg(sumPhase[k] + trueFreq * ratio * Ha);
-        }
-
-        // Synthesis IFFT
-        for (int k = 0; k < bins; ++k) {
-            spec[k][0] = mag[k] * std::cos(sumPhase[k]);
-            spec[k][1] = mag[k] * std::sin(sumPhase[k]);
-        }
-        fftw_execute(m_pvInv);
-
-        // OLA — output position == input position (Ha == Hs)
-        for (int i = 0; i < N; ++i) {
-            const int idx = inPos + i;
-            if (idx < in.size()) {
-                out[idx]    += (ifftOut[i] / N) * window[i];
-                winSum[idx] += window[i] * window[i];
-            }
-        }
-
-        inPos += Ha;
-        ++frame;
-    }
-
-    // Normalise by window weight; where coverage is low (edges of buffer)
-    // blend with the original dry signal to avoid attenuation artifacts.
-    // A well-covered sample has winSum ≥ ~0.5; below that we cross-fade in
-    // the dry signal so the edges never go silent.
-    const double minCoverage = 0.5;
-    for (int i = 0; i < in.size(); ++i) {
-        if (winSum[i] >= minCoverage) {
-            out[i] /= winSum[i];
-        } else if (winSum[i] > 1e-10) {
-            const double wet = winSum[i] / minCoverage;   // 0→1 as coverage grows
-            out[i] = (out[i] / winSum[i]) * wet + in[i] * (1.0 - wet);
-        } else {
-            out[i] = in[i];  // no coverage at all — pass dry
-        }
-    }
-
-    // No resample needed — output is exactly in.size() samples
-    return out;
-}
-
 QVector<double> VocalEnhancer::pitchShiftPhaseVocoder(const QVector<double>& in, double ratio) {
     if (in.isEmpty() || ratio <= 0.0) return in;
 
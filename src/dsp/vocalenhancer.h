@@ -5,12 +5,16 @@
 #include <QAudioFormat>
 #include <QByteArray>
 #include <QMutex>
+#include <QScopedPointer>
 #include <QString>
 #include <QVector>
 #include <algorithm>
 #include <atomic>
 #include <fftw3.h>
 
+#include "pitchdetector.h"
+#include "pitchtrack.h"
+
 class VocalEnhancer : public QObject
 {
     Q_OBJECT
@@ -26,7 +30,53 @@ public:
     // closeEvent() — instead of QFutureWatcher::waitForFinished() blocking
     // the GUI thread for however long the (uninterruptible) computation was
     // going to take anyway. Null means "never cancel", the previous behaviour.
+    //
+    // Thin wrapper over the streaming API below (begin/process/finish over
+    // the whole buffer), so the only full-length allocations are `input`
+    // itself and the returned PCM.
     QByteArray enhance(const QByteArray& input, const std::atomic<bool> *cancelled = nullptr);
+
+    // ── Streaming (bounded-memory) API ─────────────────────────────────────
+    // begin() resets every stage; process() accepts any amount of PCM in this
+    // enhancer's format (a trailing partial frame is carried over to the next
+    // call) and returns whatever tuned PCM the chain has finalised so far;
+    // finish() flushes the tail. The gate, pitch map/phase vocoder, dynamics
+    // and reverb all run over kStreamBlockFrames-sized blocks with only their
+    // own lookahead/overlap kept resident, so peak memory no longer grows
+    // with the length of the take. Output lags input by that lookahead
+    // (~0.6 s at start-up for noise learning, then one batch of pitch
+    // detection windows — about a second on a typical desktop).
+    //
+    // The input normalisation stage needs the take's overall level, which a
+    // stream can't know up front: pass measureInput() of the full buffer when
+    // the caller already has it (enhance() does), or a default-constructed
+    // InputLevel to estimate the gain from the first kNormLookaheadSec
+    // seconds instead.
+    //
+    // measureInput() also fingerprints the take for the stage cache: a run
+    // over the same input as the previous complete one replays whatever
+    // stages the settings changed since then don't reach (see
+    // setStageCacheLimit()). A caller-built InputLevel (hash 0) never caches.
+    struct InputLevel {
+        double  rms         = -1.0; // < 0 = unknown
+        double  peak        = -1.0;
+        qint64  totalFrames = 0;    // progress reporting; also part of the cache key
+        quint64 hash        = 0;    // content hash of the take; 0 = unknown
+    };
+    static constexpr int    kStreamBlockFrames = 8192;
+    static constexpr double kNormLookaheadSec  = 3.0;
+
+    InputLevel measureInput(const QByteArray& input) const;
+    void       begin(const InputLevel& level, const std::atomic<bool> *cancelled = nullptr);
+    QByteArray process(const QByteArray& block);
+    QByteArray finish();
+
+    // Pitch analysis of the last run that finished (not cancelled): one frame
+    // per detection window, smoothed exactly as the correction saw it, with
+    // the note it pulled towards. Empty before that, and after a run whose
+    // phase vocoder couldn't start. originMs is left at 0 — see PitchTrack.
+    const PitchTrack& lastPitchTrack() const { return m_lastTrack; }
+
     int getProgress() const;
     QString getBanner() const;
 
@@ -36,6 +86,49 @@ public:
     void setNoiseReductionAmount(double amount);
     double getNoiseReductionAmount() const;
 
+    // Working precision of the spectral gate and phase vocoder, the two
+    // stages that dominate enhance()'s runtime. Float halves their memory
+    // traffic and doubles SIMD width (fftwf_* plans, float per-bin state) at
+    // no audible cost for 16-bit microphone input; everything between stages
+    // stays double either way. The default comes from the build
+    // (-DWAKKAQT_DSP_FLOAT32=ON → Float); takes effect at the next begin().
+    enum class Precision { Double, Float };
+    void      setPrecision(Precision precision);
+    Precision getPrecision() const { return m_precision; }
+    static Precision defaultPrecision();
+
+    // Stereo (multichannel) mode. On: the noise profile, pitch detection and
+    // ratio map are computed once, on the mid (mean) signal, and each
+    // frame's gate mask and phase-vocoder phase advance are then applied to
+    // every channel — so a stereo or dual-mic take keeps its image, at the
+    // cost of two FFTs per channel per frame on top of the shared analysis.
+    // Off: the take is downmixed to mono and the result copied to every
+    // channel. No effect on mono formats; takes effect at the next begin().
+    void setPreserveStereo(bool enabled) { m_preserveStereo = enabled; }
+    bool getPreserveStereo() const       { return m_preserveStereo; }
+
+    // Stage cache. PreviewDialog re-enhances the whole take on every slider
+    // change; most of that time goes into the gate's noise learning and the
+    // pitch map, which a reverb or key change doesn't affect. The last
+    // complete run keeps the gated signal and its pitch detections (keyed by
+    // the input and the noise setting) and the pitch-corrected signal (also
+    // keyed by correction amount, retune speed, key and scale), so the next
+    // run over the same take only recomputes the stages downstream of what
+    // changed — a reverb-only tweak reruns just the reverb and the final
+    // level match. The output is identical to a cold run either way.
+    //
+    // Recording those stages costs two full-length copies of the take in
+    // double, so it is off by default (limit 0): a one-shot enhance() or a
+    // batch run would pay for them and never replay them. PreviewJob, whose
+    // re-enhance loop does replay them, turns it on with
+    // kPreviewStageCacheBytes; a take that would outgrow the limit simply
+    // isn't cached.
+    static constexpr qint64 kDefaultStageCacheBytes = 0;
+    static constexpr qint64 kPreviewStageCacheBytes = qint64(256) << 20;
+    void   setStageCacheLimit(qint64 bytes);
+    qint64 getStageCacheLimit() const { return m_stageCacheLimit; }
+    void   clearStageCache();
+
     // Scale / key-aware correction
     void    setScale(int keyNote, const QVector<int>& intervals);
     void    setScalePreset(const QString& name, int keyNote = 0);
@@ -71,10 +164,10 @@ private:
     int m_blockSizeMs = 40;
     int m_numSamples = 0;
 
-    // ── Cached FFTW plans ──────────────────────────────────────────────────
+    // ── FFTW plans and buffers ─────────────────────────────────────────────
     // Phase vocoder uses N=2048 (fixed); noise gate uses N=1024 (fixed).
-    // Plans are created once in the constructor with FFTW_MEASURE and reused
-    // across all chunks, avoiding repeated allocation on long recordings.
+    // The plans are FftPlanRegistry's, shared with every other enhancer and
+    // executed on these per-instance buffers through the new-array interface.
 
     // PV plans (N=2048)
     static constexpr int kPvN = 2048;
@@ -94,11 +187,27 @@ private:
     fftw_plan     m_ngFwd   = nullptr;
     fftw_plan     m_ngInv   = nullptr;
 
-    // Pitch detection plan (N=4096) — mutable so detectPitch() can remain const
+    // Pitch detection plan (N=4096). detectPitch() executes it on per-call
+    // buffers so it can run on several threads at once.
     static constexpr int kDetN = 4096;
-    mutable double*       m_detIn  = nullptr;
-    mutable fftw_complex* m_detOut = nullptr;
-    mutable fftw_plan     m_detFwd = nullptr;
+    fftw_plan     m_detFwd = nullptr;
+
+    // YIN detector (80–1100 Hz over up to 2048 samples); owns its own plans
+    QScopedPointer<PitchDetector> m_yin;
+
+    // Single-precision PV/gate plans, created on the first switch to Float
+    Precision                m_precision = Precision::Double;
+    struct FloatPlans;
+    QScopedPointer<FloatPlans> m_f32;
+
+    bool m_preserveStereo = true;
+
+    // Stage results of the last complete run (see setStageCacheLimit())
+    struct StageCache;
+    QScopedPointer<StageCache> m_cache;
+    qint64                     m_stageCacheLimit = kDefaultStageCacheBytes;
+
+    PitchTrack m_lastTrack;
 
     // ── Persistent PV phase state ─────────────────────────────────────────
     QVector<double> m_pvPrevPhase;
@@ -132,25 +241,31 @@ private:
     // ── Vibrato EMA state ──────────────────────────────────────────────────
     double m_emaSmoothedPitch = 0.0;   // reset in resetPVState()
 
+    // One sample buffer per channel lane (see StreamState::lanes)
+    using Planar = QVector<QVector<double>>;
+
     // PCM conversion
     QVector<double> convertToDoubleArray(const QByteArray& input);
+    Planar convertToPlanar(const QByteArray& input, int lanes);
     void convertToQByteArray(const QVector<double>& inputData, QByteArray& output);
+    void convertToQByteArray(const Planar& lanes, QByteArray& output);
+    double sampleToDouble(const uint8_t* sample) const;
+    void   writeSample(uint8_t* sample, double value) const;
 
     static inline int32_t readInt24LE(uint8_t b0, uint8_t b1, uint8_t b2);
     static inline void writeInt24LE(uint8_t* dst, int32_t value);
 
     // Pitch detection
-    double detectPitch(const QVector<double>& data) const;        // existing HPS
-    double detectPitchYIN(const QVector<double>& data) const;     // new YIN
-    double detectPitchBest(const QVector<double>& data) const;    // YIN→HPS fallback
-    double computeAutocorrConfidence(const QVector<double>& data, double pitchHz) const;
+    double detectPitch(SampleSpan<double> data) const;        // existing HPS
+    double detectPitchYIN(SampleSpan<double> data) const;     // shared FFT YIN (m_yin)
+    double detectPitchBest(SampleSpan<double> data) const;    // YIN→HPS fallback
+    double computeAutocorrConfidence(SampleSpan<double> data, double pitchHz) const;
 
     double findClosestNoteFrequency(double frequency) const;
 
     // Pitch correction
     double correctPitchChunk(QVector<double>& chunk, double prevRatio,
                              double pitchHzHint = 0.0);
-    void processPitchCorrection(QVector<double>& data, const std::atomic<bool> *cancelled = nullptr);
 
     // Windowing / interpolation
     QVector<double> createHannWindow(int size) const;
@@ -168,17 +283,12 @@ private:
 
     // Phase vocoder
     void            resetPVState();
-    QVector<double> pitchShiftContinuous(const QVector<double>& in, const QVector<double>& frameRatio,
-                                          const std::atomic<bool> *cancelled = nullptr);
     QVector<double> timeStretchPhaseVocoder(const QVector<double>& in, double stretch);
     QVector<double> pitchShiftPhaseVocoder(const QVector<double>& in, double ratio);
 
     // Dynamics / timbre
     void applyMakeupGain(QVector<double>& data, double gain);
     void applyLimiter(QVector<double>& data, double ceiling);
-    void compressDynamics(QVector<double>& data, double threshold, double ratio);
-    void harmonicExciter(QVector<double>& data, double drive, double mix);
-    void applyReverb(QVector<double>& data);
 
     // Echo
     void applyEcho(QVector<double>& data,
@@ -189,17 +299,27 @@ private:
                    double feedback1,
                    double feedback2);
 
-    // Noise reduction
-    void reduceNoiseSpectralGate(QVector<double>& x,
-                    int    fftSize       = 1024,
-                    int    hopSize       = 256,
-                    double overSub       = 0.65,
-                    double floorDb       = -10.0,
-                    double noiseLearnSec = 0.40,
-                    double adaptivity    = 0.03,
-                    double lowEnergyDb   = -45.0,
-                    const std::atomic<bool> *cancelled = nullptr
-                    );
+    // ── Streaming stages ──────────────────────────────────────────────────
+    // Each consumes the previous stage's output block and appends whatever
+    // samples it has finalised to `out`; `flush` (from finish()) drains the
+    // lookahead/overlap it was still holding. Blocks hold one equally long
+    // buffer per lane. State lives in m_stream.
+    struct StreamState;
+    QScopedPointer<StreamState> m_stream;
+
+    void streamNormalise(Planar& block, bool flush);
+    void streamNoiseGate(const Planar& in, Planar& out, bool flush);
+    void streamPitchCorrection(const Planar& in, Planar& out, bool flush);
+    void streamDynamics(Planar& block);
+    void streamReverb(Planar& block);
+    void streamLevelMatch(Planar& block);
+    QByteArray streamRun(const Planar& block, bool flush);
+    QByteArray streamReplay(qint64 frames, bool flush);
+    QByteArray streamOutput(Planar& tuned);
+    void       streamRecord(Planar& stage, const Planar& block);
+    bool streamCancelled() const;
+
+    double frameToMono(const uint8_t* frame) const;
 
     inline double dbToLinear(double db) const {
         return std::pow(10.0, db / 20.0);
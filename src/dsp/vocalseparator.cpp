@@ -2,15 +2,41 @@
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QSaveFile>
 #include <QCryptographicHash>
 #include <QProcess>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QThread>
+#include <QThreadPool>
+#include <QSysInfo>
+#include <QCoreApplication>
+#include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
 
 #include <cmath>
 #include <cstring>
 #include <vector>
 #include <algorithm>
 #include <array>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <fftw3.h>
+#ifdef Q_OS_WIN
+#include <QSettings>
+#endif
+#ifdef Q_OS_MACOS
+#include <sys/sysctl.h>
+#endif
+
+#include "fftplanregistry.h"
 
 #ifdef WAKKAQT_ONNX
 #if __has_include(<onnxruntime/onnxruntime_cxx_api.h>)
@@ -20,8 +46,8 @@
 #else
 #  error "onnxruntime_cxx_api.h not found"
 #endif
-#include <fftw3.h>
 #ifdef WAKKAQT_FFMPEG_NATIVE
+#  include "decodedaudiostore.h"
 #  include "ffmpegnative.h"
 #endif
 #endif
@@ -41,9 +67,16 @@ static const char *MODEL_FILE = "UVR-MDX-NET-Inst_HQ_3.onnx";
 static const char *MODEL_SHA256 =
     "317554b07fe1ea5279a77f2b1520a41ea4b93432560c4ffd08792c30fddf9adc";
 
-static bool verifyModelHash(const QByteArray &bytes) {
-    return QCryptographicHash::hash(bytes, QCryptographicHash::Sha256).toHex() == MODEL_SHA256;
-}
+// Set from the UI thread, read when the engine is (re)built on a worker
+static std::atomic<bool> s_optimizedModelCache{true};
+
+static QMutex                    s_chunkingMutex;
+static VocalSeparator::Chunking  s_chunking;
+
+// Pinned by setInference(); unset means "tuned, else defaults"
+static QMutex                    s_inferenceMutex;
+static bool                      s_inferencePinned = false;
+static VocalSeparator::Inference s_inference;
 
 // Waits for the fallback ffmpeg CLI's decode/write process in short slices
 // instead of one big blocking QProcess::waitForFinished(maxMs) call, so a
@@ -98,22 +131,607 @@ QString VocalSeparator::modelSha256() {
     return QString::fromLatin1(MODEL_SHA256);
 }
 
+void VocalSeparator::setOptimizedModelCacheEnabled(bool enabled) {
+    s_optimizedModelCache = enabled;
+}
+
+bool VocalSeparator::optimizedModelCacheEnabled() {
+    return s_optimizedModelCache.load();
+}
+
+void VocalSeparator::setChunking(const Chunking &chunking) {
+    QMutexLocker lk(&s_chunkingMutex);
+    s_chunking = chunking;
+}
+
+VocalSeparator::Chunking VocalSeparator::chunking() {
+    QMutexLocker lk(&s_chunkingMutex);
+    return s_chunking;
+}
+
+void VocalSeparator::setInference(const Inference &inference) {
+    QMutexLocker lk(&s_inferenceMutex);
+    s_inference = inference;
+    s_inferencePinned = true;
+}
+
+void VocalSeparator::clearInference() {
+    QMutexLocker lk(&s_inferenceMutex);
+    s_inferencePinned = false;
+}
+
+// ---- verified-hash cache ------------------------------------------------
+//
+// Hashing the model means reading all ~80 MB of it, which used to happen at
+// the start of every separation. The result is now kept in a small sidecar
+// ("<sha256> <size> <mtime ms>") and trusted for as long as the file's size
+// and mtime still match — which catches what the check is really there for
+// (a truncated or interrupted copy, a disk error, someone swapping the
+// file) without the read. Anything that can rewrite the model, keep its
+// size and mtime, and rewrite the sidecar too was never stoppable from
+// inside the same home directory anyway.
+
+struct FileStamp {
+    qint64 size    = -1;   // -1: not a readable regular file
+    qint64 mtimeMs = 0;
+    bool operator==(const FileStamp &o) const { return size == o.size && mtimeMs == o.mtimeMs; }
+};
+
+static FileStamp stampOf(const QString &path) {
+    const QFileInfo fi(path);
+    if (!fi.isFile() || !fi.isReadable()) return {};
+    return {fi.size(), fi.lastModified().toMSecsSinceEpoch()};
+}
+
+static QString sidecarOf(const QString &path) {
+    return path + ".verified";
+}
+
+// Recorded hash (lower-case hex) and stamp; empty hash if there's none
+static QByteArray readSidecar(const QString &path, FileStamp &stamp) {
+    QFile f(sidecarOf(path));
+    if (!f.open(QIODevice::ReadOnly)) return {};
+    const QList<QByteArray> parts = f.readAll().trimmed().split(' ');
+    if (parts.size() != 3) return {};
+    bool okSize = false, okTime = false;
+    stamp.size    = parts[1].toLongLong(&okSize);
+    stamp.mtimeMs = parts[2].toLongLong(&okTime);
+    return (okSize && okTime) ? parts[0] : QByteArray();
+}
+
+static void writeSidecar(const QString &path, const QByteArray &sha, const FileStamp &stamp) {
+    QSaveFile f(sidecarOf(path));
+    const QByteArray line = sha + ' ' + QByteArray::number(stamp.size)
+                          + ' ' + QByteArray::number(stamp.mtimeMs) + '\n';
+    if (!f.open(QIODevice::WriteOnly) || f.write(line) != line.size() || !f.commit())
+        qWarning() << "[VocalSep] cannot record verified hash for" << path << f.errorString();
+}
+
+// Streamed, so the file is never held in memory whole; empty on read error
+static QByteArray sha256Of(const QString &path) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return {};
+    QCryptographicHash h(QCryptographicHash::Sha256);
+    if (!h.addData(&f)) return {};
+    return h.result().toHex();
+}
+
+bool VocalSeparator::verifyFileCached(const QString &path, const QString &sha256Hex) {
+    const FileStamp now = stampOf(path);
+    if (now.size < 0) return false;
+    const QByteArray want = sha256Hex.toLatin1().toLower();
+    if (want.isEmpty()) return false;
+
+    FileStamp seen;
+    if (readSidecar(path, seen) == want && seen == now)
+        return true;
+
+    // Stamped before reading: if the file changes while it's hashed, the
+    // recorded stamp is already stale and the next call simply hashes again.
+    if (sha256Of(path) != want) {
+        QFile::remove(sidecarOf(path));
+        return false;
+    }
+    writeSidecar(path, want, now);
+    return true;
+}
+
+// ---- MDX-Net complex spectrogram, one chunk at a time --------------------
+//
+// MDX-Net input/output: [1, 4, bins, dim_t]
+// Channel layout: 0=L_real, 1=L_imag, 2=R_real, 3=R_imag
+// Tile memory: tile[ch * bins * dim_t + bin * dim_t + t]
+//
+// separate() used to build the whole song's spectrogram up front and a
+// second one for the model output before the iSTFT — 4·bins·frames floats
+// each, well over a gigabyte apiece for a long live recording. Frames are
+// now computed straight into the chunk tensor the model reads, and each
+// output frame is overlap-added into the audio as soon as its chunk comes
+// back, so spectrogram memory is a couple of dim_t-wide tiles regardless of
+// input length.
+//
+// A frame is a column of the tile — 4·bins values dim_t floats apart — so
+// writing one frame at a time touched a different cache line for every
+// value, and the iSTFT gathered its input the same way. Both now move
+// kColumnBlock frames at once: the transforms run into a small frame-major
+// block of spectra, and the block is transposed into (or out of) the tile
+// one row segment at a time, i.e. kColumnBlock consecutive floats — a whole
+// cache line — per channel and bin. Blocks start at fixed column offsets, so
+// writers filling different blocks of one tile never share more than the
+// line at their common edge. The overlap between consecutive chunks' inputs
+// stays a per-row memcpy, and the model reads and writes the tiles in place
+// (separate() wraps them as Ort::Value views, no copies).
+
+static constexpr int kColumnBlock = 16;   // 64 bytes of float per tile row
+
+// Periodic Hann window — matches torch.hann_window(n_fft, periodic=True)
+// which is the convention used when training MDX-Net models.
+// Critical: use n_fft (not n_fft-1) in the denominator. The iSTFT must use
+// this exact window too — overlap-add reconstruction requires identical
+// analysis/synthesis windows. Built once per runChunked() and shared.
+static std::vector<float> mdxWindow(int n_fft) {
+    std::vector<float> win(n_fft);
+    for (int i = 0; i < n_fft; ++i)
+        win[i] = float(0.5 * (1.0 - std::cos(2.0 * M_PI * i / n_fft)));
+    return win;
+}
+
+// Both transforms are single precision — the model reads and writes float32
+// anyway, so the double-precision FFTs only bought digits it discards — and
+// spread a chunk's column blocks over up to laneCount() pool threads
+// ("lanes"). Blocks are independent; each lane owns its scratch, and the
+// shared registry plans run through FFTW's thread-safe new-array interface,
+// so nothing is locked. Batching a block's frames into one plan_many()
+// plan wouldn't buy anything at n_fft = 6144: each transform is already
+// far bigger than the per-call overhead.
+static int laneCount(int blocks) {
+    return std::max(1, std::min(blocks, QThread::idealThreadCount()));
+}
+
+// fn(lane, block) for every block in [0, blocks), lane-strided over the pool
+template <typename Fn>
+static void forEachBlock(int blocks, int lanes, Fn fn) {
+    if (blocks <= 0) return;
+    QVector<int> ids(std::min(blocks, lanes));
+    std::iota(ids.begin(), ids.end(), 0);
+    const int stride = int(ids.size());
+    QtConcurrent::blockingMap(ids, [&](int lane) {
+        for (int blk = lane; blk < blocks; blk += stride)
+            fn(lane, blk);
+    });
+}
+
+// One lane's transform buffers: a real frame and kColumnBlock spectra of
+// one stereo channel, frame-major. `stride` pads each spectrum to a
+// multiple of four complex values, keeping every one as aligned as the
+// arrays the plan was made on.
+struct SpectrumScratch {
+    SpectrumScratch(int n_fft, int stride)
+        : real(fftwf_alloc_real(n_fft)), spectra(fftwf_alloc_complex(size_t(kColumnBlock) * stride)) {}
+    ~SpectrumScratch() { fftwf_free(real); fftwf_free(spectra); }
+    SpectrumScratch(SpectrumScratch &&o) noexcept : real(o.real), spectra(o.spectra) {
+        o.real = nullptr;
+        o.spectra = nullptr;
+    }
+    SpectrumScratch(const SpectrumScratch &) = delete;
+    SpectrumScratch &operator=(const SpectrumScratch &) = delete;
+
+    bool ok() const { return real && spectra; }
+
+    float         *real;
+    fftwf_complex *spectra;
+};
+
+// Forward STFT of interleaved float32 stereo into tile columns.
+// Center-padded: frame f is centred on sample f·hop.
+class StftSource {
+public:
+    StftSource(const float *stereo, int totalSamples, const std::vector<float> &win, int hop,
+               int maxColumns)
+        : m_stereo(stereo), m_win(win), m_nfft(int(win.size())), m_hop(hop),
+          m_bins(m_nfft / 2 + 1), m_stride((m_bins + 3) & ~3), m_total(totalSamples),
+          m_plan(FftPlanRegistry::planF(m_nfft, FftPlanRegistry::Direction::Forward)) {
+        const int lanes = laneCount((maxColumns + kColumnBlock - 1) / kColumnBlock);
+        m_lanes.reserve(lanes);
+        for (int l = 0; l < lanes; ++l)
+            m_lanes.emplace_back(m_nfft, m_stride);
+    }
+
+    bool ok() const {
+        return m_plan && std::all_of(m_lanes.begin(), m_lanes.end(),
+                                     [](const SpectrumScratch &s) { return s.ok(); });
+    }
+    int  frames() const { return (m_total + m_nfft / 2 - 1) / m_hop + 1; }
+
+    // Frames [f0, f0 + n) into columns [t0, t0 + n) of a tile; zeros for
+    // frames outside [0, frames())
+    void columns(int f0, int n, float *tile, int dim_t, int t0) {
+        forEachBlock((n + kColumnBlock - 1) / kColumnBlock, int(m_lanes.size()),
+                     [&](int lane, int blk) {
+            const int j0 = blk * kColumnBlock;
+            block(m_lanes[lane], f0 + j0, std::min(kColumnBlock, n - j0), tile, dim_t, t0 + j0);
+        });
+    }
+
+private:
+    // n ≤ kColumnBlock frames, transformed into the lane's spectra and then
+    // transposed into the tile a row segment at a time, channel by channel
+    void block(SpectrumScratch &s, int f0, int n, float *tile, int dim_t, int t0) const {
+        const int    half  = m_nfft / 2;
+        const size_t plane = size_t(m_bins) * dim_t;
+        for (int c = 0; c < 2; ++c) {
+            for (int j = 0; j < n; ++j) {
+                const int f = f0 + j;
+                fftwf_complex *spec = s.spectra + size_t(j) * m_stride;
+                if (f < 0 || f >= frames()) {
+                    std::memset(spec, 0, sizeof(fftwf_complex) * m_bins);
+                    continue;
+                }
+                const int center = f * m_hop;
+                for (int i = 0; i < m_nfft; ++i) {
+                    const int si = center - half + i;
+                    s.real[i] = (si >= 0 && si < m_total) ? m_stereo[si * 2 + c] * m_win[i] : 0.f;
+                }
+                fftwf_execute_dft_r2c(m_plan, s.real, spec);
+            }
+
+            float *re = tile + (c * 2)     * plane + t0; // ch 0 or 2
+            float *im = tile + (c * 2 + 1) * plane + t0; // ch 1 or 3
+            for (int b = 0; b < m_bins; ++b, re += dim_t, im += dim_t) {
+                const fftwf_complex *src = s.spectra + b;
+                for (int j = 0; j < n; ++j, src += m_stride) {
+                    re[j] = (*src)[0];
+                    im[j] = (*src)[1];
+                }
+            }
+        }
+    }
+
+    const float              *m_stereo;   // m_total interleaved stereo frames
+    const std::vector<float> &m_win;
+    const int m_nfft, m_hop, m_bins, m_stride, m_total;
+    fftwf_plan m_plan;
+    std::vector<SpectrumScratch> m_lanes;
+};
+
+// Inverse STFT by overlap-add of frames [0, frames), in any order of calls;
+// finish() normalises by the squared-window sum and hands the audio over.
+// That sum only depends on the frame grid, so it's worked out per sample at
+// the end instead of being accumulated in a second audio-length buffer.
+//
+// Lanes can't all add into the audio at once — a sample gets n_fft / hop
+// frames' worth of contributions — so each column block overlap-adds into
+// its own short partial buffer, and the partials are added into the audio
+// in block order afterwards. Same sums however many threads ran.
+class IstftSink {
+public:
+    IstftSink(const std::vector<float> &win, int hop, int totalSamples, int frames, int maxColumns)
+        : m_win(win), m_nfft(int(win.size())), m_hop(hop), m_bins(m_nfft / 2 + 1),
+          m_stride((m_bins + 3) & ~3), m_total(totalSamples), m_frames(frames),
+          m_span((kColumnBlock - 1) * hop + m_nfft),
+          m_plan(FftPlanRegistry::planF(m_nfft, FftPlanRegistry::Direction::Inverse)),
+          m_partials((maxColumns + kColumnBlock - 1) / kColumnBlock,
+                     std::vector<float>(size_t(m_span) * 2)),
+          m_audio(size_t(totalSamples) * 2, 0.f) {
+        const int lanes = laneCount(int(m_partials.size()));
+        m_lanes.reserve(lanes);
+        for (int l = 0; l < lanes; ++l)
+            m_lanes.emplace_back(m_nfft, m_stride);
+    }
+
+    bool ok() const {
+        return m_plan && std::all_of(m_lanes.begin(), m_lanes.end(),
+                                     [](const SpectrumScratch &s) { return s.ok(); });
+    }
+
+    // Columns [t0, t0 + n) of a tile are frames [f0, f0 + n)
+    void columns(int f0, int n, const float *tile, int dim_t, int t0) {
+        const int blocks = (n + kColumnBlock - 1) / kColumnBlock;
+        forEachBlock(blocks, int(m_lanes.size()), [&](int lane, int blk) {
+            const int j0 = blk * kColumnBlock;
+            block(m_lanes[lane], m_partials[blk].data(), std::min(kColumnBlock, n - j0),
+                  tile, dim_t, t0 + j0);
+        });
+
+        const int half = m_nfft / 2;
+        for (int blk = 0; blk < blocks; ++blk) {
+            const int start = (f0 + blk * kColumnBlock) * m_hop - half; // sample at partial[0]
+            const int count = std::min(kColumnBlock, n - blk * kColumnBlock);
+            const int len   = (count - 1) * m_hop + m_nfft;
+            const float *p  = m_partials[blk].data();
+            for (int i = std::max(0, -start); i < len && start + i < m_total; ++i) {
+                m_audio[size_t(start + i) * 2]     += p[2 * i];
+                m_audio[size_t(start + i) * 2 + 1] += p[2 * i + 1];
+            }
+        }
+    }
+
+    std::vector<float> finish() {
+        // Normalize by squared-window sum (overlap-add reconstruction),
+        // summed in frame order like the overlap-add itself
+        const int half = m_nfft / 2;
+        for (int si = 0; si < m_total; ++si) {
+            const int fLo = std::max(0, (si + half - m_nfft) / m_hop);
+            const int fHi = std::min(m_frames - 1, (si + half) / m_hop);
+            float norm = 0.f;
+            for (int f = fLo; f <= fHi; ++f) {
+                const int i = si - f * m_hop + half;
+                if (i < 0 || i >= m_nfft) continue;
+                const float w = m_win[i];
+                norm += w * w;
+            }
+            const float w = norm > 1e-9f ? norm : 1.f;
+            m_audio[si * 2]     /= w;
+            m_audio[si * 2 + 1] /= w;
+        }
+        return std::move(m_audio);
+    }
+
+private:
+    // n ≤ kColumnBlock columns transposed into the lane's spectra a row
+    // segment at a time, channel by channel, then inverse-transformed and
+    // overlap-added into `partial` (interleaved stereo from the block's
+    // first frame's first sample on)
+    void block(SpectrumScratch &s, float *partial, int n, const float *tile, int dim_t, int t0) const {
+        const size_t plane = size_t(m_bins) * dim_t;
+        const float  invN  = 1.f / m_nfft;
+        std::fill(partial, partial + size_t((n - 1) * m_hop + m_nfft) * 2, 0.f);
+        for (int c = 0; c < 2; ++c) {
+            const float *re = tile + (c * 2)     * plane + t0;
+            const float *im = tile + (c * 2 + 1) * plane + t0;
+            for (int b = 0; b < m_bins; ++b, re += dim_t, im += dim_t) {
+                fftwf_complex *dst = s.spectra + b;
+                for (int j = 0; j < n; ++j, dst += m_stride) {
+                    (*dst)[0] = re[j];
+                    (*dst)[1] = im[j];
+                }
+            }
+            for (int j = 0; j < n; ++j) {
+                // output = N * IDFT (unnormalized); c2r may clobber the spectrum, which is spent
+                fftwf_execute_dft_c2r(m_plan, s.spectra + size_t(j) * m_stride, s.real);
+                float *dst = partial + size_t(j) * m_hop * 2 + c;
+                for (int i = 0; i < m_nfft; ++i)
+                    dst[2 * i] += s.real[i] * invN * m_win[i];
+            }
+        }
+    }
+
+    const std::vector<float> &m_win;
+    const int m_nfft, m_hop, m_bins, m_stride, m_total, m_frames, m_span;
+    fftwf_plan m_plan;
+    std::vector<SpectrumScratch>     m_lanes;
+    std::vector<std::vector<float>>  m_partials;   // one per column block of a call
+    std::vector<float>               m_audio;
+};
+
+std::vector<float> VocalSeparator::runChunked(const std::vector<float> &stereo,
+                                              int bins, int dim_t, int hop,
+                                              const ChunkModel &model,
+                                              std::function<void(int)> progressFn,
+                                              QString &errorOut,
+                                              const std::atomic<bool> *cancelled,
+                                              const Chunking &chunking) {
+    const size_t tileSize = size_t(4) * bins * dim_t;
+    const BatchModel one = [&model, tileSize](const float *in, float *out, int count) {
+        for (int i = 0; i < count; ++i)
+            model(in + i * tileSize, out + i * tileSize);
+    };
+    return runChunked(stereo, bins, dim_t, hop, one, 1, std::move(progressFn),
+                      errorOut, cancelled, chunking);
+}
+
+std::vector<float> VocalSeparator::runChunked(const std::vector<float> &stereo,
+                                              int bins, int dim_t, int hop,
+                                              const BatchModel &model, int batch,
+                                              std::function<void(int)> progressFn,
+                                              QString &errorOut,
+                                              const std::atomic<bool> *cancelled,
+                                              const Chunking &chunking) {
+    return runChunked(stereo.data(), int(stereo.size()) / 2, bins, dim_t, hop, model, batch,
+                      std::move(progressFn), errorOut, cancelled, chunking);
+}
+
+std::vector<float> VocalSeparator::runChunked(const float *stereo, int totalSamples,
+                                              int bins, int dim_t, int hop,
+                                              const BatchModel &model, int batch,
+                                              std::function<void(int)> progressFn,
+                                              QString &errorOut,
+                                              const std::atomic<bool> *cancelled,
+                                              const Chunking &chunking) {
+    const int n_fft = (bins - 1) * 2;
+    if (bins < 2 || dim_t < 1 || hop < 1) {
+        errorOut = QString("Invalid spectrogram geometry (bins=%1, dim_t=%2, hop=%3)")
+                       .arg(bins).arg(dim_t).arg(hop);
+        return {};
+    }
+
+    const std::vector<float> window = mdxWindow(n_fft);
+    StftSource stft(stereo, totalSamples, window, hop, dim_t);
+    const int  frames = stft.frames();
+    IstftSink  istft(window, hop, totalSamples, frames, dim_t);
+    if (!stft.ok() || !istft.ok()) {
+        errorOut = "Could not set up the STFT (FFTW plan)";
+        return {};
+    }
+
+    // Chunk k's input window is [k·step − lead, k·step − lead + dim_t) in
+    // spectrogram frame indices, zero-padded past either end. Its first
+    // `keep` columns are the last `keep` of chunk k−1's window — copied over
+    // instead of transformed again.
+    //
+    // Trim: TRIM frames on each side give the model temporal context and
+    //    their output is discarded; only the GEN = dim_t − 2·TRIM centre
+    //    frames are used, each frame from exactly one chunk. This matches
+    //    the audio-separator convention and eliminates boundary artefacts.
+    // Crossfade: consecutive chunks share `fade` frames and every output
+    //    frame is used. Across the shared frames the earlier chunk fades out
+    //    and the later one in, with raised-cosine ramps that sum to one.
+    //    The ramp spans the middle half of the shared frames; the outer
+    //    quarter on each side, where the model saw the least context, is
+    //    still cut. The first chunk starts `fade` frames early (into the
+    //    zero padding) so frame 0 isn't on anyone's ramp.
+    const Chunking mode = {chunking.blend, std::clamp(chunking.overlap, 0.0, 0.5)};
+    const bool crossfade = (mode.blend == Chunking::Blend::Crossfade);
+    const int  TRIM = std::max(1, int(dim_t * mode.overlap / 2));
+    const int  fade = std::max(1, int(dim_t * mode.overlap));
+    const int  step = std::max(1, crossfade ? dim_t - fade : dim_t - 2 * TRIM);
+    const int  lead = crossfade ? fade : TRIM;
+    const int  keep = dim_t - step;   // columns shared with the next chunk's input
+
+    const size_t tileSize = size_t(4) * bins * dim_t;
+    const int    totalChunks = crossfade ? (frames + fade + step - 1) / step
+                                         : (frames + step - 1) / step;
+
+    auto pack = [&](int k, float *tile, const float *prev) {
+        const int src_start = k * step - lead;
+        int t0 = 0;
+        if (prev) {
+            for (size_t row = 0; row < size_t(4) * bins; ++row)
+                std::memcpy(tile + row * dim_t, prev + row * dim_t + step, sizeof(float) * keep);
+            t0 = keep;
+        }
+        for (int t = t0; t < dim_t; t += kColumnBlock)
+            stft.columns(src_start + t, std::min(kColumnBlock, dim_t - t), tile, dim_t, t);
+    };
+
+    // Crossfade ramps and the faded-out tail of the previous chunk's output
+    // (4·bins rows of `fade` columns), added onto the next chunk's head
+    std::vector<float> fadeIn, tail;
+    if (crossfade) {
+        const int margin = fade / 4;
+        const int ramp   = fade - 2 * margin;
+        fadeIn.resize(fade);
+        for (int t = 0; t < fade; ++t) {
+            const double s = std::sin(M_PI * std::clamp(t - margin + 0.5, 0.0, double(ramp)) / (2.0 * ramp));
+            fadeIn[t] = float(s * s);
+        }
+        tail.assign(size_t(4) * bins * fade, 0.f);
+    }
+
+    // Trim: each output frame comes from the chunk whose GEN centre holds
+    // it. Crossfade: chunk k owns [k·step − lead, (k + 1)·step − lead) once
+    // its head is blended with chunk k−1's tail. Either way the last
+    // chunk's end is past the end of the input.
+    auto unpack = [&](int k, float *tile) {
+        const int first = k * step - lead;   // frame in column 0
+        if (crossfade) {
+            for (size_t row = 0; row < size_t(4) * bins; ++row) {
+                float *r = tile + row * dim_t;
+                float *z = tail.data() + row * fade;
+                for (int t = 0; t < fade; ++t) {
+                    r[t] = r[t] * fadeIn[t] + z[t];
+                    z[t] = r[step + t] * (1.f - fadeIn[t]);
+                }
+            }
+        }
+        const int f0 = std::max(0, crossfade ? first : k * step);
+        const int f1 = std::min(k * step + (crossfade ? step - lead : step), frames);
+        for (int f = f0; f < f1; f += kColumnBlock)
+            istft.columns(f, std::min(kColumnBlock, f1 - f), tile, dim_t, f - first);
+    };
+
+    // Chunks go to the model `batch` at a time, as consecutive tiles of one
+    // buffer ("group" g holds chunks [g·batch, g·batch + count)). Within a
+    // group each chunk's overlap columns come from the tile before it, the
+    // first one's from the previous group's last tile.
+    const int batchSize   = std::clamp(batch, 1, std::max(1, totalChunks));
+    const int totalGroups = (totalChunks + batchSize - 1) / batchSize;
+    auto groupCount = [&](int g) { return std::min(batchSize, totalChunks - g * batchSize); };
+
+    auto packGroup = [&](int g, float *tiles, const float *prevLast) {
+        for (int j = 0; j < groupCount(g); ++j) {
+            float *tile = tiles + j * tileSize;
+            pack(g * batchSize + j, tile, j ? tile - tileSize : prevLast);
+        }
+    };
+    auto unpackGroup = [&](int g, float *tiles) {
+        for (int j = 0; j < groupCount(g); ++j)
+            unpack(g * batchSize + j, tiles + j * tileSize);
+    };
+
+    // Three-stage pipeline over double-buffered groups: while the model
+    // runs group g on this thread (ONNX Runtime fans it out over its own
+    // pool), group g+1 is packed and group g−1 unpacked on the global pool.
+    // The model only reads in[g % 2] and writes out[g % 2]; packing g+1
+    // reads in[g % 2]'s last tile too and writes the other input buffer;
+    // unpacking g−1 reads the other output buffer. Chunks still pack and
+    // unpack in order, so the result is the same as running the three
+    // steps back to back, one chunk at a time.
+    const size_t groupSize = tileSize * batchSize;
+    std::vector<float> in[2]  = {std::vector<float>(groupSize), std::vector<float>(groupSize)};
+    std::vector<float> out[2] = {std::vector<float>(groupSize), std::vector<float>(groupSize)};
+    packGroup(0, in[0].data(), nullptr);
+
+    for (int g = 0; g < totalGroups; ++g) {
+        if (cancelled && cancelled->load()) {
+            errorOut = "Cancelled";
+            return {};
+        }
+        const int cur = g % 2, other = 1 - cur;
+
+        QFuture<void> packing, unpacking;
+        if (g + 1 < totalGroups)
+            packing = QtConcurrent::run([&, g, cur, other] {
+                packGroup(g + 1, in[other].data(), in[cur].data() + (batchSize - 1) * tileSize);
+            });
+        if (g > 0)
+            unpacking = QtConcurrent::run([&, g, other] { unpackGroup(g - 1, out[other].data()); });
+
+        try {
+            model(in[cur].data(), out[cur].data(), groupCount(g));
+        } catch (...) {
+            // Both tasks reference this frame's buffers — let them finish first
+            packing.waitForFinished();
+            unpacking.waitForFinished();
+            throw;
+        }
+        packing.waitForFinished();
+        unpacking.waitForFinished();
+
+        if (progressFn) progressFn(std::min(totalChunks, (g + 1) * batchSize) * 100 / totalChunks);
+    }
+    unpackGroup(totalGroups - 1, out[(totalGroups - 1) % 2].data());
+    return istft.finish();
+}
+
 // =========================================================================
 #ifdef WAKKAQT_ONNX
 // =========================================================================
 
-// Decode media file → interleaved float32 stereo at 44100 Hz.
-static std::vector<float> decodeToFloat(const QString &input, const QString &workspaceDir,
-                                        QString &err,
-                                        const std::atomic<bool> *cancelled = nullptr) {
+// Interleaved float32 stereo at 44100 Hz of the input. With native FFmpeg
+// that's the input's Float DecodedAudioStore entry, mapped and read in
+// place — decoded once per source, however often it's separated, and the
+// same entry renderVideo() mixes from. Without it, the ffmpeg CLI decodes
+// into memory on every call.
+struct FloatInput {
+#ifdef WAKKAQT_FFMPEG_NATIVE
+    DecodedAudioStore::View view;
+#else
+    std::vector<float> pcm;
+#endif
+    const float *data   = nullptr;
+    int          frames = 0;
+};
+
+static bool decodeToFloat(const QString &input, const QString &workspaceDir, FloatInput &out,
+                          QString &err, const std::atomic<bool> *cancelled = nullptr) {
 #ifdef WAKKAQT_FFMPEG_NATIVE
-    std::vector<float> pcm = FFmpegNative::decodeToFloatStereo(input, cancelled);
-    if (pcm.empty()) {
+    Q_UNUSED(workspaceDir);
+    out.view = DecodedAudioStore::instance().open(input, DecodedAudioStore::Precision::Float,
+                                                  cancelled);
+    if (!out.view.isValid()) {
         err = (cancelled && cancelled->load())
             ? "Cancelled"
-            : "FFmpegNative::decodeToFloatStereo failed for: " + input;
+            : "Cannot decode the audio of: " + input;
+        return false;
     }
-    return pcm;
+    if (out.view.frames() > std::numeric_limits<int>::max()) {
+        err = "Input too long to separate: " + input;
+        return false;
+    }
+    out.data   = reinterpret_cast<const float *>(out.view.data());
+    out.frames = int(out.view.frames());
+    return true;
 #else
     const QString tmp = workspaceDir + "/decode.f32";
     QProcess p;
@@ -123,20 +741,23 @@ static std::vector<float> decodeToFloat(const QString &input, const QString &wor
     if (!waitForProcessCancellable(p, 600000, cancelled)) {
         QFile::remove(tmp);
         err = (cancelled && cancelled->load()) ? "Cancelled" : "ffmpeg decode: timed out";
-        return {};
+        return false;
     }
     if (p.exitCode() != 0) {
         err = "ffmpeg decode: " + QString(p.readAllStandardError()).left(400);
-        return {};
+        return false;
     }
     QFile f(tmp);
-    if (!f.open(QIODevice::ReadOnly)) { err = "Cannot open " + tmp; return {}; }
+    if (!f.open(QIODevice::ReadOnly)) { err = "Cannot open " + tmp; return false; }
     QByteArray bytes = f.readAll();
     f.close();
     QFile::remove(tmp);
-    std::vector<float> pcm(bytes.size() / sizeof(float));
-    std::memcpy(pcm.data(), bytes.constData(), bytes.size());
-    return pcm;
+    out.pcm.resize(bytes.size() / sizeof(float));
+    std::memcpy(out.pcm.data(), bytes.constData(), out.pcm.size() * sizeof(float));
+    out.data   = out.pcm.data();
+    out.frames = int(out.pcm.size() / 2);
+    if (out.frames == 0) { err = "ffmpeg decode: no audio in " + input; return false; }
+    return true;
 #endif
 }
 
@@ -175,141 +796,562 @@ static bool writeFloatWav(const std::vector<float> &pcm,
 #endif
 }
 
-// ---- MDX-Net complex spectrogram ----------------------------------------
+// ---- long-lived ONNX engine ---------------------------------------------
 //
-// MDX-Net input/output: [1, 4, bins, dim_t]
-// Channel layout: 0=L_real, 1=L_imag, 2=R_real, 3=R_imag
-// Memory: spec[ch][bin * frames + frame]
+// separate() used to verify the model, create an Ort::Env and build an
+// Ort::Session with full graph optimisation on every call — seconds of
+// fixed cost per file — and throw it all away at the end. The engine holds
+// all of that for the rest of the process instead. Session::Run() is
+// thread-safe, so overlapping separations share one engine; the shared_ptr
+// keeps it alive for a run that's still going when releaseEngine() (or a
+// rebuild after the model changed on disk) drops the registry's reference.
+
+struct MdxEngine {
+    Ort::Env     env{ORT_LOGGING_LEVEL_WARNING, "MDXSep"};
+    Ort::Session session{nullptr};
+    std::string  inName, outName;
+    int          bins  = 0;
+    int          dim_t = 0;
+    bool         dynamicBatch = false;   // input axis 0 is symbolic
+    FileStamp    model;      // modelPath() as it was when the session was built
+    VocalSeparator::Inference settings;   // what the session was built with
+};
+
+static QMutex                     s_engineMutex;   // guards s_engine and (re)builds
+static std::shared_ptr<MdxEngine> s_engine;
 
-struct MdxSpec {
-    int bins;
-    int frames;
-    std::vector<float> ch[4]; // [L_re, L_im, R_re, R_im][bins * frames]
+static Ort::Session openSession(Ort::Env &env, const QString &path, const Ort::SessionOptions &opts) {
+#ifdef _WIN32
+    const std::wstring p = path.toStdWString();
+#else
+    const std::string p = path.toStdString();
+#endif
+    return Ort::Session(env, p.c_str(), opts);
+}
 
-    MdxSpec(int bins, int frames) : bins(bins), frames(frames) {
-        for (auto &c : ch) c.assign(bins * frames, 0.f);
+static Ort::SessionOptions baseSessionOptions(const VocalSeparator::Inference &inf) {
+    Ort::SessionOptions opts;
+    opts.SetIntraOpNumThreads(std::max(0, inf.intraOpThreads));
+    if (inf.execution == VocalSeparator::Inference::Execution::Parallel) {
+        opts.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+        opts.SetInterOpNumThreads(std::max(0, inf.interOpThreads));
+    } else {
+        opts.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
     }
-};
+    return opts;
+}
 
-// Forward STFT: interleaved float32 stereo → MdxSpec. Stops early (returning
-// a partially-filled spec — the caller checks `cancelled` right after and
-// discards it) if cancelled becomes true mid-transform.
-static MdxSpec computeSTFT(const std::vector<float> &stereo, int n_fft, int hop,
-                           const std::atomic<bool> *cancelled = nullptr) {
-    const int bins  = n_fft / 2 + 1;
-    const int total = int(stereo.size()) / 2; // per-channel samples
-    const int half  = n_fft / 2;
-
-    // Center-padded: first frame center is sample 0
-    const int frames = (total + half - 1) / hop + 1;
-
-    // Periodic Hann window — matches torch.hann_window(n_fft, periodic=True)
-    // which is the convention used when training MDX-Net models.
-    // Critical: use n_fft (not n_fft-1) in the denominator.
-    std::vector<double> win(n_fft);
-    for (int i = 0; i < n_fft; ++i)
-        win[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / n_fft));
+// Session for the (already verified) model: from the saved optimised graph
+// when there is a trustworthy one, otherwise optimised here — and saved for
+// next time if that's enabled. Ort::Session's constructor throws
+// Ort::Exception on failure.
+static void openModelSession(MdxEngine &e) {
+    const bool    cache   = s_optimizedModelCache.load();
+    const QString optPath = VocalSeparator::optimizedModelPath();
+
+    if (cache) {
+        // The sidecar is written only after ONNX Runtime finished writing the
+        // file, so a missing or mismatching one means an interrupted save or
+        // an altered file: drop it and optimise again.
+        FileStamp  ignored;
+        const QByteArray recorded = readSidecar(optPath, ignored);
+        if (!recorded.isEmpty() && VocalSeparator::verifyFileCached(optPath, QString::fromLatin1(recorded))) {
+            try {
+                Ort::SessionOptions opts = baseSessionOptions(e.settings);
+                opts.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                e.session = openSession(e.env, optPath, opts);
+                return;
+            } catch (const Ort::Exception &ex) {
+                qWarning() << "[VocalSep] discarding optimised model" << optPath << ex.what();
+            }
+        }
+        QFile::remove(optPath);
+        QFile::remove(sidecarOf(optPath));
+    }
 
-    std::vector<double> inBuf(n_fft, 0.0);
-    fftw_complex *outBuf =
-        reinterpret_cast<fftw_complex *>(fftw_malloc(sizeof(fftw_complex) * bins));
-    fftw_plan plan = fftw_plan_dft_r2c_1d(n_fft, inBuf.data(), outBuf, FFTW_ESTIMATE);
+    Ort::SessionOptions opts = baseSessionOptions(e.settings);
+    opts.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    if (cache) {
+#ifdef _WIN32
+        const std::wstring o = optPath.toStdWString();
+#else
+        const std::string o = optPath.toStdString();
+#endif
+        Ort::SessionOptions saving = opts.Clone();
+        saving.SetOptimizedModelFilePath(o.c_str());
+        try {
+            e.session = openSession(e.env, VocalSeparator::modelPath(), saving);
+            const QByteArray sha = sha256Of(optPath);
+            if (!sha.isEmpty()) writeSidecar(optPath, sha, stampOf(optPath));
+            return;
+        } catch (const Ort::Exception &ex) {
+            // e.g. a read-only model dir — separation itself doesn't need the file
+            qWarning() << "[VocalSep] cannot save optimised model" << optPath << ex.what();
+            QFile::remove(optPath);
+        }
+    }
+    e.session = openSession(e.env, VocalSeparator::modelPath(), opts);
+}
 
-    MdxSpec spec(bins, frames);
+// The model at `path` is present, readable and still the file
+// downloadModel() verified; errorOut set otherwise.
+static bool checkModel(const QString &path, const FileStamp &now, QString &errorOut) {
+    if (!QFile::exists(path)) {
+        errorOut = "Model not found at: " + path;
+        return false;
+    }
+    if (now.size < 0) {
+        errorOut = "Cannot read model file at: " + path;
+        return false;
+    }
 
-    for (int f = 0; f < frames; ++f) {
-        if (cancelled && cancelled->load())
-            break;
-        const int center = f * hop;
+    // modelExists() only checks the file is present, not that its contents
+    // still match what downloadModel() verified — a model can be truncated
+    // or altered on disk after that (disk error, manual tampering, a copy
+    // that got interrupted). Catch that before it ever reaches the ONNX
+    // Runtime rather than let a corrupt file surface as a cryptic load error.
+    if (!VocalSeparator::verifyFileCached(path, VocalSeparator::modelSha256())) {
+        const QString corruptPath = path + ".corrupt";
+        QFile::remove(corruptPath);
+        QFile::rename(path, corruptPath);
+        errorOut = "Model file failed its integrity check and was moved to "
+                   + corruptPath + " — please re-download it.";
+        return false;
+    }
+    return true;
+}
 
-        for (int stereoIdx = 0; stereoIdx < 2; ++stereoIdx) {
-            for (int i = 0; i < n_fft; ++i) {
-                const int si = center - half + i;
-                inBuf[i] = (si >= 0 && si < total) ? double(stereo[si * 2 + stereoIdx]) * win[i]
-                                                    : 0.0;
-            }
-            fftw_execute(plan);
+// Session for the verified model with the given settings; nullptr with
+// errorOut set on failure.
+static std::shared_ptr<MdxEngine> buildEngine(const FileStamp &model,
+                                              const VocalSeparator::Inference &settings,
+                                              QString &errorOut) {
+    // separate() runs on a QtConcurrent worker thread, where an uncaught
+    // exception calls std::terminate() and crashes the whole app instead of
+    // surfacing as an errorOut string — so nothing from ONNX Runtime may
+    // escape (incompatible/malformed model, unsupported ops, OOM).
+    try {
+        auto e = std::make_shared<MdxEngine>();
+        e->model    = model;
+        e->settings = settings;
+        openModelSession(*e);
 
-            const int reIdx = stereoIdx * 2;     // 0 or 2
-            const int imIdx = stereoIdx * 2 + 1; // 1 or 3
-            for (int b = 0; b < bins; ++b) {
-                spec.ch[reIdx][b * frames + f] = float(outBuf[b][0]);
-                spec.ch[imIdx][b * frames + f] = float(outBuf[b][1]);
-            }
+        // Input shape: [batch, 4, bins, dim_t]
+        auto inputInfo  = e->session.GetInputTypeInfo(0);
+        auto inputShape = inputInfo.GetTensorTypeAndShapeInfo().GetShape();
+        if (inputShape.size() < 4 || inputShape[1] != 4) {
+            errorOut = QString("Unexpected MDX model input shape (expected [1,4,bins,dim_t]), got %1 dims")
+                           .arg(inputShape.size());
+            return {};
         }
+        e->dynamicBatch = inputShape[0] <= 0;
+        e->bins = int(inputShape[2]);
+        const int dim_t_raw = int(inputShape[3]);
+        e->dim_t = (dim_t_raw > 0) ? dim_t_raw : 256; // guard against dynamic axis
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        e->inName  = e->session.GetInputNameAllocated(0, allocator).get();
+        e->outName = e->session.GetOutputNameAllocated(0, allocator).get();
+        return e;
+    } catch (const Ort::Exception &e) {
+        errorOut = QString("ONNX Runtime error: %1").arg(e.what());
+        return {};
     }
+}
 
-    fftw_destroy_plan(plan);
-    fftw_free(outBuf);
-    return spec;
+// Chunks per Run() the engine can actually take
+static int usableBatch(const MdxEngine &e, int batch) {
+    return e.dynamicBatch ? std::max(1, batch) : 1;
 }
 
-// Inverse STFT: MdxSpec → interleaved float32 stereo. Stops early (returning
-// partial audio — the caller checks `cancelled` right after and discards it)
-// if cancelled becomes true mid-transform.
-static std::vector<float> computeISTFT(const MdxSpec &spec, int n_fft, int hop, int totalSamples,
-                                       const std::atomic<bool> *cancelled = nullptr) {
-    const int bins = n_fft / 2 + 1;
-    const int half = n_fft / 2;
+// ---- inference auto-tune ------------------------------------------------
+//
+// The right thread count depends on the machine — four intra-op threads
+// leave most of a 16-core workstation idle and oversubscribe a dual-core
+// laptop next to the STFT lanes — so instead of guessing, a tune times a
+// few settings on a synthetic chunk and keeps the fastest. It never runs
+// inside a separation: until there is a result the engine is built with
+// the defaults, and the tune runs on the pool once no separation is in
+// flight (see TuneRun). The result lives next to the model as
+// "batch intra inter mode cores" (mode 0 = sequential, 1 = parallel;
+// cores = idealThreadCount() at tuning time). The file name carries the
+// ONNX Runtime version and cpuTag(), so an upgrade or a different machine
+// tunes again.
+
+static bool readTuning(VocalSeparator::Inference &inf) {
+    QFile f(VocalSeparator::tuningPath());
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    const QList<QByteArray> parts = f.readAll().trimmed().split(' ');
+    if (parts.size() != 5) return false;
+    bool ok[5];
+    int v[5];
+    for (int i = 0; i < 5; ++i) v[i] = int(parts[i].toLongLong(&ok[i]));
+    if (!std::all_of(std::begin(ok), std::end(ok), [](bool b) { return b; })) return false;
+    if (v[4] != QThread::idealThreadCount() || v[0] < 1 || v[1] < 0 || v[2] < 0) return false;
+    inf.batch          = v[0];
+    inf.intraOpThreads = v[1];
+    inf.interOpThreads = v[2];
+    inf.execution      = v[3] ? VocalSeparator::Inference::Execution::Parallel
+                              : VocalSeparator::Inference::Execution::Sequential;
+    return true;
+}
 
-    // Must match computeSTFT's periodic Hann exactly (n_fft, not n_fft-1) —
-    // overlap-add reconstruction requires identical analysis/synthesis
-    // windows; using the symmetric variant here broke that and introduced
-    // reconstruction artifacts on top of just an amplitude-normalization error.
-    std::vector<double> win(n_fft);
-    for (int i = 0; i < n_fft; ++i)
-        win[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / n_fft));
+static void writeTuning(const VocalSeparator::Inference &inf) {
+    QSaveFile f(VocalSeparator::tuningPath());
+    const QByteArray line = QByteArray::number(inf.batch) + ' '
+        + QByteArray::number(inf.intraOpThreads) + ' ' + QByteArray::number(inf.interOpThreads) + ' '
+        + QByteArray::number(inf.execution == VocalSeparator::Inference::Execution::Parallel ? 1 : 0)
+        + ' ' + QByteArray::number(QThread::idealThreadCount()) + '\n';
+    if (!f.open(QIODevice::WriteOnly) || f.write(line) != line.size() || !f.commit())
+        qWarning() << "[VocalSep] cannot store inference tuning" << f.errorString();
+}
 
-    fftw_complex *inBuf =
-        reinterpret_cast<fftw_complex *>(fftw_malloc(sizeof(fftw_complex) * bins));
-    std::vector<double> outBuf(n_fft);
-    fftw_plan plan = fftw_plan_dft_c2r_1d(n_fft, inBuf, outBuf.data(), FFTW_ESTIMATE);
+// The tuning this process settled on — read from tuningPath(), chosen by a
+// tune, or the defaults after a tune that failed — and the key it holds
+// for: tuningPath() (model, ONNX Runtime version and CPU).
+// Without it a tune that can't store its result, or that fails outright,
+// would run again, and drop the warm engine, on every separate().
+// Guarded by s_inferenceMutex.
+static QString                   s_tunedKey;
+static VocalSeparator::Inference s_tuned;
+
+static QString tuningKey() {
+    return VocalSeparator::tuningPath();
+}
 
-    std::vector<float> audio(totalSamples * 2, 0.f);
-    std::vector<float> norm(totalSamples, 0.f);
+static void rememberTuning(const VocalSeparator::Inference &inf) {
+    QMutexLocker lk(&s_inferenceMutex);
+    s_tunedKey = tuningKey();
+    s_tuned    = inf;
+}
 
-    for (int f = 0; f < spec.frames; ++f) {
-        if (cancelled && cancelled->load())
-            break;
-        const int center = f * hop;
+// Settings the next engine build uses; `tuned` false if nothing is pinned
+// and no tuning applies yet, i.e. these are the defaults and a tune is due
+static VocalSeparator::Inference wantedInference(bool &tuned) {
+    const QString key = tuningKey();
+    {
+        QMutexLocker lk(&s_inferenceMutex);
+        if (s_inferencePinned) {
+            tuned = true;
+            return s_inference;
+        }
+        if (s_tunedKey == key) {
+            tuned = true;
+            return s_tuned;
+        }
+    }
+    VocalSeparator::Inference inf;
+    tuned = readTuning(inf);
+    if (tuned)
+        rememberTuning(inf);
+    return inf;
+}
+
+// Seconds per chunk for `batch` chunks per Run() on a fixed pseudo-random
+// input: one untimed call (first-run allocations), then the best of two.
+static double secondsPerChunk(MdxEngine &e, int batch) {
+    const size_t tileSize = size_t(4) * e.bins * e.dim_t;
+    std::vector<float> in(tileSize * batch), out(tileSize * batch);
+    quint32 r = 1;
+    for (float &x : in) {
+        r = r * 1664525u + 1013904223u;
+        x = float(r >> 8) / float(1 << 24) - 0.5f;
+    }
+    const char *inNames[]  = {e.inName.c_str()};
+    const char *outNames[] = {e.outName.c_str()};
+    auto memInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    const std::array<int64_t, 4> shape = {batch, 4, e.bins, e.dim_t};
+    Ort::Value inTensor  = Ort::Value::CreateTensor<float>(memInfo, in.data(), in.size(),
+                                                           shape.data(), shape.size());
+    Ort::Value outTensor = Ort::Value::CreateTensor<float>(memInfo, out.data(), out.size(),
+                                                           shape.data(), shape.size());
+    double best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        e.session.Run(Ort::RunOptions{nullptr}, inNames, &inTensor, 1, outNames, &outTensor, 1);
+        const double s = timer.nsecsElapsed() * 1e-9 / batch;
+        if (run == 1 || (run > 1 && s < best)) best = s;
+    }
+    return best;
+}
 
-        for (int stereoIdx = 0; stereoIdx < 2; ++stereoIdx) {
-            const int reIdx = stereoIdx * 2;
-            const int imIdx = stereoIdx * 2 + 1;
+// Coordinate search, cheapest dimension last: thread layouts first (each
+// needs its own session), then batch on the winning session (the same
+// session takes any batch). A candidate has to beat the incumbent by 5% —
+// timing noise shouldn't buy a layout more threads or a batch more memory.
+// Returns the winning engine; the caller has checked the model. Takes no
+// engine lock — the candidates are sessions of its own — so separations
+// on the current engine aren't held up by it.
+static std::shared_ptr<MdxEngine> tune(const FileStamp &model, QString &errorOut,
+                                       const std::atomic<bool> *cancelled) {
+    using Inference = VocalSeparator::Inference;
+    const int cores = QThread::idealThreadCount();
+
+    std::vector<Inference> layouts;
+    for (int threads : {4, std::max(1, cores / 2), cores}) {
+        Inference inf;
+        inf.intraOpThreads = threads;
+        if (std::none_of(layouts.begin(), layouts.end(),
+                         [&](const Inference &o) { return o.sameSession(inf); }))
+            layouts.push_back(inf);
+    }
 
-            for (int b = 0; b < bins; ++b) {
-                inBuf[b][0] = spec.ch[reIdx][b * spec.frames + f];
-                inBuf[b][1] = spec.ch[imIdx][b * spec.frames + f];
-            }
-            fftw_execute(plan); // output = N * IDFT (unnormalized)
-
-            for (int i = 0; i < n_fft; ++i) {
-                const int si = center - half + i;
-                if (si < 0 || si >= totalSamples) continue;
-                const float w = float(win[i]);
-                audio[si * 2 + stereoIdx] += float(outBuf[i]) / n_fft * w;
-                if (stereoIdx == 0)
-                    norm[si] += w * w; // computed once per sample
+    std::shared_ptr<MdxEngine> best;
+    double bestTime = 0.0;
+    auto consider = [&](const Inference &inf) -> bool {
+        if (cancelled && cancelled->load()) {
+            errorOut = "Cancelled";
+            return false;
+        }
+        std::shared_ptr<MdxEngine> e = buildEngine(model, inf, errorOut);
+        if (!e) return false;
+        const double t = secondsPerChunk(*e, 1);
+        qInfo() << "[VocalSep] tune: intra" << inf.intraOpThreads << "inter" << inf.interOpThreads
+                << (inf.execution == Inference::Execution::Parallel ? "parallel" : "sequential")
+                << "—" << t * 1000.0 << "ms/chunk";
+        if (!best || t < bestTime * 0.95) {
+            best = std::move(e);
+            bestTime = t;
+        }
+        return true;
+    };
+
+    try {
+        for (const Inference &inf : layouts)
+            if (!consider(inf)) return {};
+
+        // Parallel execution only pays off for graphs with independent
+        // branches; one try on the best intra-op layout settles it
+        Inference parallel = best->settings;
+        parallel.execution      = Inference::Execution::Parallel;
+        parallel.interOpThreads = 2;
+        if (!consider(parallel)) return {};
+
+        if (best->dynamicBatch) {
+            for (int batch : {2, 4}) {
+                if (cancelled && cancelled->load()) {
+                    errorOut = "Cancelled";
+                    return {};
+                }
+                const double t = secondsPerChunk(*best, batch);
+                qInfo() << "[VocalSep] tune: batch" << batch << "—" << t * 1000.0 << "ms/chunk";
+                if (t < bestTime * 0.95) {
+                    best->settings.batch = batch;
+                    bestTime = t;
+                }
             }
         }
+    } catch (const Ort::Exception &e) {
+        errorOut = QString("ONNX Runtime error: %1").arg(e.what());
+        return {};
+    }
+
+    rememberTuning(best->settings);
+    writeTuning(best->settings);
+    qInfo() << "[VocalSep] tuned: batch" << best->settings.batch
+            << "intra" << best->settings.intraOpThreads << "inter" << best->settings.interOpThreads
+            << "—" << bestTime * 1000.0 << "ms/chunk";
+    return best;
+}
+
+// Tunes for the model on disk and hands the winner to the engine — unless
+// the settings it should run with changed meanwhile (e.g. something got
+// pinned) and the tune isn't meant to replace a pin. One tune at a time.
+static QMutex s_tuneMutex;
+
+static bool tuneAndInstall(QString &errorOut, const std::atomic<bool> *cancelled,
+                           bool replacePinned) {
+    QMutexLocker tlk(&s_tuneMutex);
+    const QString path  = VocalSeparator::modelPath();
+    const FileStamp now = stampOf(path);
+    if (!checkModel(path, now, errorOut))
+        return false;
+    std::shared_ptr<MdxEngine> e = tune(now, errorOut, cancelled);
+    if (!e)
+        return false;
+
+    QMutexLocker lk(&s_engineMutex);
+    if (replacePinned) {
+        QMutexLocker ilk(&s_inferenceMutex);
+        s_inferencePinned = false;
+    }
+    bool tuned = false;
+    if (stampOf(path) == now && wantedInference(tuned).sameSession(e->settings))
+        s_engine = std::move(e);
+    return true;
+}
+
+// ---- idle-time tune -------------------------------------------------------
+//
+// A build without a tuning marks the tune due; it starts on the pool when
+// the last separation in flight finishes, so it neither delays a user's
+// separation nor times its candidates against one. A separation that
+// starts meanwhile cancels it, and it starts over once that one is done.
+// s_idleMutex is never held while taking s_engineMutex.
+static QMutex            s_idleMutex;     // guards the three below
+static int               s_activeRuns = 0;
+static QString           s_dueTune;       // tuningKey() a tune is due for; empty if none
+static bool              s_tuneRunning = false;
+static std::atomic<bool> s_tuneCancel{false};
+
+static void startIdleTune() {   // under s_idleMutex
+    if (s_tuneRunning || s_activeRuns > 0 || s_dueTune.isEmpty())
+        return;
+    static bool stopAtExit = false;
+    if (!stopAtExit) {
+        // The global pool waits for its tasks on the way out; don't let it
+        // wait for a whole tune
+        stopAtExit = true;
+        qAddPostRoutine([]() {
+            QMutexLocker lk(&s_idleMutex);
+            s_dueTune.clear();
+            s_tuneCancel = true;
+        });
+    }
+    s_tuneRunning = true;
+    s_tuneCancel  = false;
+    QThreadPool::globalInstance()->start([]() {
+        QString err;
+        const bool ok = tuneAndInstall(err, &s_tuneCancel, false);
+        const bool cancelled = !ok && s_tuneCancel.load();
+        if (!ok && !cancelled) {
+            // Defaults until the key changes or autoTune() is asked for
+            // explicitly, not another tune after every separation
+            qWarning() << "[VocalSep] inference tuning failed, using defaults:" << err;
+            rememberTuning(VocalSeparator::Inference());
+        }
+        QMutexLocker lk(&s_idleMutex);
+        s_tuneRunning = false;
+        if (!cancelled)
+            s_dueTune.clear();
+        startIdleTune();   // if a separation came and went while cancelling
+    });
+}
+
+// Held by separate() for its whole run
+struct TuneRun {
+    TuneRun() {
+        QMutexLocker lk(&s_idleMutex);
+        ++s_activeRuns;
+        if (s_tuneRunning) s_tuneCancel = true;
     }
+    ~TuneRun() {
+        QMutexLocker lk(&s_idleMutex);
+        --s_activeRuns;
+        startIdleTune();
+    }
+};
 
-    fftw_destroy_plan(plan);
-    fftw_free(inBuf);
+// The engine for the model currently on disk, built (or rebuilt) if needed
+// — including when the thread settings it should run with have changed.
+// Without a tuning yet that's the defaults, and a tune is marked due.
+// nullptr with errorOut set on failure.
+static std::shared_ptr<MdxEngine> acquireEngine(QString &errorOut) {
+    QMutexLocker lk(&s_engineMutex);
+    const QString path  = VocalSeparator::modelPath();
+    const FileStamp now = stampOf(path);
+    bool tuned = false;
+    const VocalSeparator::Inference want = wantedInference(tuned);
+    if (!tuned) {
+        QMutexLocker ilk(&s_idleMutex);
+        s_dueTune = tuningKey();
+    }
+    if (s_engine && s_engine->model == now && s_engine->settings.sameSession(want))
+        return s_engine;
+    s_engine.reset();
 
-    // The caller discards this result outright when cancelled (checked right
-    // after computeISTFT() returns) — skip the O(totalSamples) normalization
-    // pass too instead of spending it on a buffer nobody will use.
-    if (cancelled && cancelled->load())
+    if (!checkModel(path, now, errorOut))
         return {};
+    s_engine = buildEngine(now, want, errorOut);
+    return s_engine;
+}
+
+bool VocalSeparator::warmUp(QString &errorOut) {
+    return bool(acquireEngine(errorOut));
+}
+
+void VocalSeparator::releaseEngine() {
+    {
+        // A tune would build sessions again; the next acquire marks it due
+        QMutexLocker lk(&s_idleMutex);
+        s_dueTune.clear();
+        if (s_tuneRunning) s_tuneCancel = true;
+    }
+    QMutexLocker lk(&s_engineMutex);
+    s_engine.reset();
+}
 
-    // Normalize by squared-window sum (overlap-add reconstruction)
-    for (int i = 0; i < totalSamples; ++i) {
-        const float w = norm[i] > 1e-9f ? norm[i] : 1.f;
-        audio[i * 2]     /= w;
-        audio[i * 2 + 1] /= w;
+bool VocalSeparator::autoTune(QString &errorOut, const std::atomic<bool> *cancelled) {
+    {
+        // This tune supersedes an idle-time one
+        QMutexLocker lk(&s_idleMutex);
+        s_dueTune.clear();
+        if (s_tuneRunning) s_tuneCancel = true;
     }
-    return audio;
+    // ...and whatever was pinned
+    return tuneAndInstall(errorOut, cancelled, true);
+}
+
+VocalSeparator::Inference VocalSeparator::inference() {
+    bool tuned = false;
+    return wantedInference(tuned);
+}
+
+// The CPU a tuning and an optimised graph were made for. ONNX Runtime's
+// optimiser picks kernels and layouts for the instruction set it finds,
+// and the best thread layout depends on the cores, so a ~/.WakkaQt copied
+// to another machine optimises and tunes afresh instead of inheriting
+// them. Eight hex digits of the CPU's architecture, model and core count.
+static QString cpuTag() {
+    static const QByteArray model = []() {
+        QByteArray m = QSysInfo::currentCpuArchitecture().toLatin1();
+#if defined(Q_OS_LINUX)
+        QFile f("/proc/cpuinfo");
+        if (f.open(QIODevice::ReadOnly)) {
+            // x86 names the model; ARM gives implementer and part instead
+            QList<QByteArray> seen;
+            for (const QByteArray &line : f.readAll().split('\n')) {
+                const int colon = line.indexOf(':');
+                if (colon < 0) continue;
+                const QByteArray field = line.left(colon).trimmed();
+                if ((field == "model name" || field == "CPU implementer" || field == "CPU part")
+                    && !seen.contains(field)) {
+                    seen << field;
+                    m += ' ' + line.mid(colon + 1).trimmed();
+                }
+            }
+        }
+#elif defined(Q_OS_WIN)
+        const QSettings cpu("HKEY_LOCAL_MACHINE\\HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0",
+                            QSettings::NativeFormat);
+        m += ' ' + cpu.value("ProcessorNameString").toString().trimmed().toUtf8();
+#elif defined(Q_OS_MACOS)
+        char brand[256] = {};
+        size_t len = sizeof(brand) - 1;
+        if (sysctlbyname("machdep.cpu.brand_string", brand, &len, nullptr, 0) == 0)
+            m += ' ' + QByteArray(brand).trimmed();
+#endif
+        return m;
+    }();
+    const QByteArray id = model + ' ' + QByteArray::number(QThread::idealThreadCount());
+    return QString::fromLatin1(QCryptographicHash::hash(id, QCryptographicHash::Sha256).toHex().left(8));
+}
+
+QString VocalSeparator::optimizedModelPath() {
+    return modelDir() + "/" + QFileInfo(MODEL_FILE).completeBaseName()
+         + "." + QString::fromLatin1(MODEL_SHA256).left(12)
+         + ".ort-" + QString::fromLatin1(OrtGetApiBase()->GetVersionString())
+         + ".cpu-" + cpuTag()
+         + ".optimized.onnx";
+}
+
+QString VocalSeparator::tuningPath() {
+    return modelDir() + "/" + QFileInfo(MODEL_FILE).completeBaseName()
+         + "." + QString::fromLatin1(MODEL_SHA256).left(12)
+         + ".ort-" + QString::fromLatin1(OrtGetApiBase()->GetVersionString())
+         + ".cpu-" + cpuTag()
+         + ".tuning";
 }
 
 // ---- main separation routine --------------------------------------------
@@ -319,177 +1361,66 @@ QString VocalSeparator::separate(const QString &inputFile,
                                  std::function<void(int)> progressFn,
                                  QString &errorOut,
                                  const std::atomic<bool> *cancelled) {
-    if (!modelExists()) {
-        errorOut = "Model not found at: " + modelPath();
-        return {};
-    }
-
-    // modelExists() only checks the file is present, not that its contents
-    // still match what downloadModel() verified — a model can be truncated
-    // or altered on disk after that (disk error, manual tampering, a copy
-    // that got interrupted). Catch that before it ever reaches the ONNX
-    // Runtime rather than let a corrupt file surface as a cryptic load error.
-    {
-        QFile modelFile(modelPath());
-        if (!modelFile.open(QIODevice::ReadOnly)) {
-            errorOut = "Cannot read model file at: " + modelPath();
-            return {};
-        }
-        const QByteArray modelBytes = modelFile.readAll();
-        modelFile.close();
-        if (!verifyModelHash(modelBytes)) {
-            const QString corruptPath = modelPath() + ".corrupt";
-            QFile::remove(corruptPath);
-            QFile::rename(modelPath(), corruptPath);
-            errorOut = "Model file failed its integrity check and was moved to "
-                       + corruptPath + " — please re-download it.";
-            return {};
-        }
-    }
+    // Verifies and loads the model on first use (or after it changed);
+    // every later call gets the warm session straight away. Never tunes:
+    // a due tune waits for this run (and any other) to finish.
+    const TuneRun run;
+    const std::shared_ptr<MdxEngine> engine = acquireEngine(errorOut);
+    if (!engine) return {};
 
     if (progressFn) progressFn(0);
 
-    // 1. Decode to interleaved float32 stereo at 44100 Hz
-    std::vector<float> stereo = decodeToFloat(inputFile, workspaceDir, errorOut, cancelled);
-    if (stereo.empty()) return {};
-    const int totalSamples = int(stereo.size()) / 2;
+    // 1. Interleaved float32 stereo at 44100 Hz
+    FloatInput stereo;
+    if (!decodeToFloat(inputFile, workspaceDir, stereo, errorOut, cancelled)) return {};
 
     if (progressFn) progressFn(4);
 
-    // 2-4. Load ONNX model and run chunked inference. Ort::Session's
-    // constructor and session.Run() both throw Ort::Exception on failure
-    // (e.g. an incompatible/malformed model, unsupported ops, OOM) —
-    // separate() runs on a QtConcurrent worker thread, where an uncaught
-    // exception calls std::terminate() and crashes the whole app instead of
-    // surfacing as an errorOut string, so every ONNX Runtime call is
-    // confined to this try block.
-    int n_fft = 0, hop = 1024;
-    MdxSpec outSpec(0, 0);
+    // 2-5. STFT → chunked inference → iSTFT in one streaming pass
+    // (runChunked()) on the engine's session. session.Run() throws
+    // Ort::Exception on failure (e.g. OOM) — see acquireEngine() for why
+    // that must not leave this function.
+    std::vector<float> output;
     try {
-        Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "MDXSep");
-        Ort::SessionOptions opts;
-        opts.SetIntraOpNumThreads(4);
-        opts.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-#ifdef _WIN32
-        std::wstring wModelPath = modelPath().toStdWString();
-        Ort::Session session(env, wModelPath.c_str(), opts);
-#else
-        std::string sModelPath = modelPath().toStdString();
-        Ort::Session session(env, sModelPath.c_str(), opts);
-#endif
-        Ort::AllocatorWithDefaultOptions allocator;
-
-        // Input shape: [1, 4, bins, dim_t]
-        auto inputInfo = session.GetInputTypeInfo(0);
-        auto inputShape = inputInfo.GetTensorTypeAndShapeInfo().GetShape();
-        if (inputShape.size() < 4 || inputShape[1] != 4) {
-            errorOut = QString("Unexpected MDX model input shape (expected [1,4,bins,dim_t]), got %1 dims")
-                           .arg(inputShape.size());
-            return {};
-        }
-        const int bins  = int(inputShape[2]);
-        const int dim_t_raw = int(inputShape[3]);
-        const int dim_t = (dim_t_raw > 0) ? dim_t_raw : 256; // guard against dynamic axis
-        n_fft = (bins - 1) * 2;
-        hop   = 1024; // MDX-Net Inst_HQ_3 training convention
+        const int bins  = engine->bins;
+        const int dim_t = engine->dim_t;
+        const int n_fft = (bins - 1) * 2;
+        const int hop   = 1024; // MDX-Net Inst_HQ_3 training convention
+        const int batch = usableBatch(*engine, inference().batch);
 
         qDebug() << "[VocalSep] n_fft=" << n_fft << "hop=" << hop
-                 << "bins=" << bins << "dim_t=" << dim_t;
+                 << "bins=" << bins << "dim_t=" << dim_t
+                 << "batch=" << batch;
 
-        auto inNamePtr  = session.GetInputNameAllocated(0, allocator);
-        auto outNamePtr = session.GetOutputNameAllocated(0, allocator);
-        const char *inNames[]  = {inNamePtr.get()};
-        const char *outNames[] = {outNamePtr.get()};
+        const char *inNames[]  = {engine->inName.c_str()};
+        const char *outNames[] = {engine->outName.c_str()};
         auto memInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        const size_t tileSize = size_t(4) * bins * dim_t;
 
         if (progressFn) progressFn(6);
 
-        // 3. STFT
-        MdxSpec spec = computeSTFT(stereo, n_fft, hop, cancelled);
-        if (cancelled && cancelled->load()) { errorOut = "Cancelled"; return {}; }
-
-        if (progressFn) progressFn(18);
-
-        // 4. Trim-based chunking with context margin
-        //    Each model call gets dim_t frames.
-        //    TRIM frames on each side provide temporal context — their output is discarded.
-        //    GEN frames are the usable centre output per chunk.
-        //    This matches the audio-separator convention and eliminates boundary artefacts.
-        const int TRIM = std::max(1, dim_t / 8);
-        const int GEN  = dim_t - 2 * TRIM;
-
-        outSpec = MdxSpec(bins, spec.frames);
-        std::vector<float> chunk(4 * bins * dim_t);
-        std::array<int64_t, 4> inShape = {1, 4, bins, dim_t};
-
-        // Count chunks for progress
-        int totalChunks = 0;
-        for (int i = 0; i < spec.frames; i += GEN) ++totalChunks;
-        int chunksDone = 0;
-
-        for (int i = 0; i < spec.frames; i += GEN) {
-            if (cancelled && cancelled->load()) {
-                errorOut = "Cancelled";
-                return {};
-            }
-
-            // Input window [src_start, src_end) in spectrogram frame indices
-            const int src_start = i - TRIM;
-            const int src_end   = i + GEN + TRIM; // = i + dim_t - TRIM
-
-            // Fill chunk — zero-pad at start/end if out of bounds
-            std::fill(chunk.begin(), chunk.end(), 0.f);
-            for (int ch = 0; ch < 4; ++ch) {
-                for (int b = 0; b < bins; ++b) {
-                    for (int t = 0; t < dim_t; ++t) {
-                        const int f = src_start + t;
-                        if (f < 0 || f >= spec.frames) continue;
-                        chunk[ch * bins * dim_t + b * dim_t + t] = spec.ch[ch][b * spec.frames + f];
-                    }
-                }
-            }
-
+        // The model writes straight into runChunked()'s output tiles
+        auto model = [&](const float *in, float *out, int count) {
+            const std::array<int64_t, 4> shape = {count, 4, bins, dim_t};
             Ort::Value inTensor = Ort::Value::CreateTensor<float>(
-                memInfo, chunk.data(), chunk.size(), inShape.data(), inShape.size());
-            auto outTensors = session.Run(Ort::RunOptions{nullptr},
-                                          inNames, &inTensor, 1, outNames, 1);
-
-            const float *outData = outTensors[0].GetTensorData<float>();
-
-            // Copy only the usable GEN frames (skip TRIM on each side)
-            // First chunk has no left context, so start discarding from 0 in output
-            const int out_t0 = (i == 0) ? 0 : TRIM;
-            const int out_t1 = std::min(dim_t, TRIM + GEN + (src_end > spec.frames ? TRIM : 0));
-
-            for (int ch = 0; ch < 4; ++ch) {
-                for (int b = 0; b < bins; ++b) {
-                    for (int t = out_t0; t < out_t1; ++t) {
-                        const int f = i + (t - TRIM);  // output frame index
-                        if (f < 0 || f >= spec.frames) continue;
-                        outSpec.ch[ch][b * outSpec.frames + f] =
-                            outData[ch * bins * dim_t + b * dim_t + t];
-                    }
-                }
-            }
-
-            ++chunksDone;
-            if (progressFn)
-                progressFn(18 + chunksDone * 72 / totalChunks); // 18 → 90
-        }
+                memInfo, const_cast<float *>(in), tileSize * count, shape.data(), shape.size());
+            Ort::Value outTensor = Ort::Value::CreateTensor<float>(
+                memInfo, out, tileSize * count, shape.data(), shape.size());
+            engine->session.Run(Ort::RunOptions{nullptr}, inNames, &inTensor, 1, outNames, &outTensor, 1);
+        };
+        output = runChunked(stereo.data, stereo.frames, bins, dim_t, hop, BatchModel(model), batch,
+                            [&](int p) { if (progressFn) progressFn(6 + p * 88 / 100); }, // 6 → 94
+                            errorOut, cancelled, chunking());
     } catch (const Ort::Exception &e) {
         errorOut = QString("ONNX Runtime error: %1").arg(e.what());
         return {};
     }
-
-    if (progressFn) progressFn(91);
-
-    // 5. iSTFT
-    std::vector<float> output = computeISTFT(outSpec, n_fft, hop, totalSamples, cancelled);
-    if (cancelled && cancelled->load()) { errorOut = "Cancelled"; return {}; }
+    if (output.empty()) return {};   // errorOut set by runChunked()
+    stereo = FloatInput();
 
     if (progressFn) progressFn(96);
 
-    // 8. Write output WAV
+    // 6. Write output WAV
     const QString outPath = workspaceDir + "/instrumental.wav";
     if (!writeFloatWav(output, outPath, workspaceDir, errorOut, cancelled)) return {};
 
@@ -511,4 +1442,31 @@ QString VocalSeparator::separate(const QString &,
     return {};
 }
 
+bool VocalSeparator::warmUp(QString &errorOut) {
+    errorOut = "ONNX Runtime not available. "
+               "Install libonnxruntime-dev and rebuild WakkaQt.";
+    return false;
+}
+
+void VocalSeparator::releaseEngine() {}
+
+QString VocalSeparator::optimizedModelPath() {
+    return {};
+}
+
+bool VocalSeparator::autoTune(QString &errorOut, const std::atomic<bool> *) {
+    errorOut = "ONNX Runtime not available. "
+               "Install libonnxruntime-dev and rebuild WakkaQt.";
+    return false;
+}
+
+VocalSeparator::Inference VocalSeparator::inference() {
+    QMutexLocker lk(&s_inferenceMutex);
+    return s_inferencePinned ? s_inference : Inference();
+}
+
+QString VocalSeparator::tuningPath() {
+    return {};
+}
+
 #endif // WAKKAQT_ONNX
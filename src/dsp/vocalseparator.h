@@ -2,6 +2,52 @@
 #include <QString>
 #include <functional>
 #include <atomic>
+#include <vector>
+
+// How VocalSeparator::runChunked() tiles the spectrogram into model calls.
+// Every call sees dim_t frames; consecutive calls share `overlap`·dim_t of
+// them (clamped to at most half).
+//   Trim       uses only each call's centre and discards overlap/2 of its
+//              frames at either edge — the audio-separator convention the
+//              model was validated with, and the default.
+//   Crossfade  uses every frame, blending the shared ones with
+//              complementary raised-cosine ramps: edge frames, where the
+//              model saw the least context, are faded out rather than cut,
+//              so less overlap gets comparable seam suppression.
+// fast() is Crossfade at 1/8 overlap: 224 new frames per call instead of
+// quality()'s 192, i.e. one in seven Run calls saved.
+struct MdxChunking {
+    enum class Blend { Trim, Crossfade };
+    Blend  blend   = Blend::Trim;
+    double overlap = 0.25;
+
+    static MdxChunking quality() { return {}; }
+    static MdxChunking fast()    { return {Blend::Crossfade, 0.125}; }
+};
+
+// How separate() drives ONNX Runtime on the CPU.
+//   batch           chunks per Run() call, as one [batch, 4, bins, dim_t]
+//                   tensor; only used if the model's batch axis is dynamic
+//                   (a fixed-batch model always gets 1).
+//   intraOpThreads  threads inside one operator (0: ONNX Runtime's default,
+//                   one per physical core).
+//   interOpThreads  threads running independent operators side by side —
+//                   only used by Execution::Parallel (0: default).
+// The defaults are what separate() always used: one chunk per call on four
+// intra-op threads, sequential execution.
+struct MdxInference {
+    enum class Execution { Sequential, Parallel };
+    int       batch          = 1;
+    int       intraOpThreads = 4;
+    int       interOpThreads = 0;
+    Execution execution      = Execution::Sequential;
+
+    // Same ONNX session options (everything but batch)
+    bool sameSession(const MdxInference &o) const {
+        return intraOpThreads == o.intraOpThreads && interOpThreads == o.interOpThreads
+            && execution == o.execution;
+    }
+};
 
 class VocalSeparator {
 public:
@@ -16,6 +62,68 @@ public:
     static QString modelUrl();
     static QString modelSha256();
 
+    // True if the file at `path` hashes to `sha256Hex`. A match is remembered
+    // in a "<path>.verified" sidecar together with the file's size and mtime,
+    // so while those stay put the ~80 MB model isn't read and re-hashed on
+    // every separation (or every launch). A mismatch never leaves a sidecar.
+    static bool verifyFileCached(const QString &path, const QString &sha256Hex);
+
+    // The ONNX session separate() runs on is built once — hash check, model
+    // load, graph optimisation — and kept for the rest of the process, so a
+    // batch of separations pays that cost once instead of per file. It is
+    // rebuilt only if the model file changes on disk. warmUp() builds it
+    // ahead of the first separate() (e.g. while the user is still picking a
+    // track); releaseEngine() drops it to give the memory back. Runs that are
+    // already in flight keep their session until they finish. Both are
+    // thread-safe; warmUp() returns false with errorOut set on failure.
+    static bool warmUp(QString &errorOut);
+    static void releaseEngine();
+
+    // When enabled (the default), the engine saves ONNX Runtime's optimised
+    // graph next to the model the first time it builds a session and loads
+    // that on later launches with graph optimisation off. The file is named
+    // after the model hash, the ONNX Runtime version and the CPU (model and
+    // core count), so a change of any of them just produces a fresh one.
+    // Takes effect on the next (re)build.
+    static void    setOptimizedModelCacheEnabled(bool enabled);
+    static bool    optimizedModelCacheEnabled();
+    static QString optimizedModelPath();
+
+    // Chunk schedule separate() uses from its next call on; quality() by
+    // default. Thread-safe.
+    using Chunking = MdxChunking;
+    static void     setChunking(const Chunking &chunking);
+    static Chunking chunking();
+
+    // ONNX Runtime settings for separate(). Until something is pinned with
+    // setInference(), the engine uses the result of autoTune() stored in
+    // tuningPath(), or the MdxInference defaults while there is none. A
+    // separation never tunes: the first one on a machine (and after an ONNX
+    // Runtime upgrade or a change of CPU) runs on the defaults, and the tune
+    // runs on the thread pool once no separation is in flight — a separation
+    // that starts meanwhile cancels it until it's idle again — and its
+    // result replaces the engine when it's done. A failed tune leaves the
+    // defaults in place for the rest of the process. Thread settings apply
+    // from the next engine build, which acquiring the engine triggers by
+    // itself when they changed; batch applies from the next separate().
+    // inference() is what the next build would use. Thread-safe.
+    using Inference = MdxInference;
+    static void      setInference(const Inference &inference);
+    static void      clearInference();   // back to tuned/default
+    static Inference inference();
+
+    // Benchmarks a few thread and batch settings on a synthetic chunk —
+    // a handful of sessions, each timed over a couple of Run() calls, so a
+    // few seconds to a minute depending on the machine — stores the fastest
+    // in tuningPath() and makes the engine use it, replacing anything
+    // pinned with setInference() and any tune still running in the
+    // background. Blocks for the tune; separations on the current engine
+    // carry on meanwhile. Returns false with errorOut set if the model can't
+    // be loaded or on cancellation; nothing is stored then. tuningPath() is
+    // keyed like optimizedModelPath().
+    static bool    autoTune(QString &errorOut, const std::atomic<bool> *cancelled = nullptr);
+    static QString tuningPath();
+
     // Separate vocals from inputFile. workspaceDir is a caller-owned,
     // caller-created scratch directory (e.g. a fresh per-run temp dir) —
     // the instrumental output and any intermediate files this needs are
@@ -30,4 +138,47 @@ public:
                             std::function<void(int)> progressFn,
                             QString &errorOut,
                             const std::atomic<bool> *cancelled = nullptr);
+
+    // The spectral core of separate(): STFT → chunked model → iSTFT over
+    // interleaved float32 stereo, returning audio of the same length. Frames
+    // are produced for one dim_t-wide chunk (plus its TRIM context) at a
+    // time, handed to `model` as a [4, bins, dim_t] tensor (channels
+    // L_re, L_im, R_re, R_im), and its output is overlap-added into the
+    // result straight away — only one chunk of spectrogram is ever live,
+    // however long the input. `model` fills `out` (same shape) from `in`;
+    // it may throw, and the exception propagates. progressFn gets 0–100 of
+    // this stage. `chunking` picks how chunks overlap (see MdxChunking).
+    // Returns empty with errorOut set on cancellation or if FFTW can't plan
+    // n_fft = (bins − 1)·2.
+    using ChunkModel = std::function<void(const float *in, float *out)>;
+    static std::vector<float> runChunked(const std::vector<float> &stereo,
+                                         int bins, int dim_t, int hop,
+                                         const ChunkModel &model,
+                                         std::function<void(int)> progressFn,
+                                         QString &errorOut,
+                                         const std::atomic<bool> *cancelled = nullptr,
+                                         const Chunking &chunking = Chunking());
+
+    // Same, handing `model` up to `batch` consecutive chunks per call as
+    // `count` tiles back to back ([count, 4, bins, dim_t]); only the last
+    // call can have count < batch. The result is identical to batch 1.
+    using BatchModel = std::function<void(const float *in, float *out, int count)>;
+    static std::vector<float> runChunked(const std::vector<float> &stereo,
+                                         int bins, int dim_t, int hop,
+                                         const BatchModel &model, int batch,
+                                         std::function<void(int)> progressFn,
+                                         QString &errorOut,
+                                         const std::atomic<bool> *cancelled = nullptr,
+                                         const Chunking &chunking = Chunking());
+
+    // Same, over `totalSamples` interleaved stereo frames the caller keeps
+    // alive for the call — e.g. a mapped DecodedAudioStore entry, read in
+    // place rather than copied into a vector first.
+    static std::vector<float> runChunked(const float *stereo, int totalSamples,
+                                         int bins, int dim_t, int hop,
+                                         const BatchModel &model, int batch,
+                                         std::function<void(int)> progressFn,
+                                         QString &errorOut,
+                                         const std::atomic<bool> *cancelled = nullptr,
+                                         const Chunking &chunking = Chunking());
 };
@@ -0,0 +1,472 @@
+#include "batchseparationjob.h"
+#include "vocalseparator.h"
+#include "atomicfilecommit.h"
+#include "sessionrepository.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// What the separator can decode — anything FFmpeg reads, in practice, but
+// a folder of karaoke videos also holds artwork, lyrics and subtitles
+const QStringList kMediaPatterns = {
+    "*.mp4", "*.mkv", "*.webm", "*.avi", "*.mov", "*.flv", "*.m4v",
+    "*.mp3", "*.wav", "*.flac", "*.ogg", "*.opus", "*.m4a", "*.aac",
+};
+
+const char *stateName(BatchSeparationJob::ItemState state)
+{
+    switch (state) {
+    case BatchSeparationJob::ItemState::Pending: return "pending";
+    case BatchSeparationJob::ItemState::Running: return "running";
+    case BatchSeparationJob::ItemState::Done:    return "done";
+    case BatchSeparationJob::ItemState::Failed:  return "failed";
+    }
+    return "pending";
+}
+
+// Copies the separated WAV out of the worker's /tmp workspace to its
+// destination. A byte copy, since the destination may be on another
+// filesystem, into a sidecar that's then committed over the final name —
+// so an interrupted batch never leaves a truncated instrumental behind
+// looking finished.
+QString commitOutput(const QString &tempWavPath, const QString &outputPath)
+{
+    const QString dir = QFileInfo(outputPath).absolutePath();
+    if (!QDir().mkpath(dir))
+        return "Cannot create output folder " + dir;
+    const QString partialPath = sidecarPathFor(outputPath, "partial");
+    QFile::remove(partialPath); // leftover from an interrupted earlier run
+    if (!QFile::copy(tempWavPath, partialPath)) {
+        QFile::remove(partialPath);
+        return "Cannot write " + partialPath;
+    }
+    return commitPartialOverFinal(partialPath, outputPath);
+}
+
+} // namespace
+
+BatchSeparationJob::BatchSeparationJob(const QString &queuePath, QObject *parent)
+    : QObject(parent), m_queuePath(queuePath) {}
+
+BatchSeparationJob::~BatchSeparationJob()
+{
+    cancel();
+    waitForFinished();
+    qDeleteAll(m_workers);
+}
+
+QString BatchSeparationJob::defaultQueuePath()
+{
+    return QDir::homePath() + "/.WakkaQt/batch/queue.json";
+}
+
+QStringList BatchSeparationJob::scanFolder(const QString &dir, bool recursive)
+{
+    QStringList files;
+    QDirIterator it(dir, kMediaPatterns, QDir::Files | QDir::Readable,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext())
+        files << it.next();
+    files.sort();
+    return files;
+}
+
+QStringList BatchSeparationJob::libraryInputs(const QList<SessionEntry> &sessions)
+{
+    QStringList inputs;
+    for (const SessionEntry &s : sessions) {
+        if (!s.playbackFile.isEmpty() && QFileInfo(s.playbackFile).isFile())
+            inputs << s.playbackFile;
+        else if (QFileInfo(s.sessionDir + "/playback.wav").isFile())
+            inputs << s.sessionDir + "/playback.wav";
+    }
+    return inputs;
+}
+
+// ── queue file ───────────────────────────────────────────────────────────
+// The lock covers the whole read-modify-write, not just a run: an edit made
+// while another process holds the queue would be overwritten by that
+// process's next save.
+bool BatchSeparationJob::lockQueue(QString *errorOut)
+{
+    if (m_lock)
+        return true;
+    QDir().mkpath(QFileInfo(m_queuePath).absolutePath());
+    m_lock.reset(new QLockFile(m_queuePath + ".lock"));
+    if (!m_lock->tryLock(0)) {
+        m_lock.reset();
+        if (errorOut)
+            *errorOut = "Another WakkaQt batch is already working on " + m_queuePath;
+        return false;
+    }
+    return true;
+}
+
+void BatchSeparationJob::unlockQueue()
+{
+    if (!m_running)
+        m_lock.reset();
+}
+
+bool BatchSeparationJob::isLockedElsewhere() const
+{
+    if (m_lock)
+        return false;
+    QLockFile probe(m_queuePath + ".lock");
+    return !probe.tryLock(0);
+}
+
+bool BatchSeparationJob::load(QString *errorOut)
+{
+    if (m_running)
+        return true;
+    if (!lockQueue(errorOut)) {
+        m_items.clear();
+        return false;
+    }
+    const bool ok = readQueue(errorOut);
+    unlockQueue();
+    return ok;
+}
+
+// Re-reads the queue under its lock before applying `edit` (unless running,
+// when the lock is already ours and the in-memory queue is the truth), then
+// saves it. False, with nothing changed, if another process holds it.
+bool BatchSeparationJob::editQueue(const std::function<void()> &edit)
+{
+    if (!m_running) {
+        QString err;
+        if (!lockQueue(&err)) {
+            qWarning() << "[BatchSeparation]" << err;
+            return false;
+        }
+        if (!readQueue(&err))
+            qWarning() << "[BatchSeparation]" << err << "— starting from an empty queue";
+    }
+    edit();
+    save();
+    unlockQueue();
+    return true;
+}
+
+bool BatchSeparationJob::readQueue(QString *errorOut)
+{
+    m_items.clear();
+    QFile f(m_queuePath);
+    if (!f.exists())
+        return true;
+    auto fail = [&](const QString &why) {
+        m_items.clear();
+        if (errorOut) *errorOut = why;
+        return false;
+    };
+    if (!f.open(QIODevice::ReadOnly))
+        return fail("Cannot read " + m_queuePath + ": " + f.errorString());
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &parseError);
+    if (!doc.isObject())
+        return fail("Malformed batch queue " + m_queuePath + ": " + parseError.errorString());
+
+    const QJsonArray items = doc.object().value("items").toArray();
+    for (const QJsonValue &v : items) {
+        const QJsonObject o = v.toObject();
+        Item item;
+        item.inputFile  = o.value("input").toString();
+        item.outputPath = o.value("output").toString();
+        item.error      = o.value("error").toString();
+        const QString state = o.value("state").toString();
+        if (item.inputFile.isEmpty() || item.outputPath.isEmpty())
+            return fail("Malformed batch queue " + m_queuePath + ": item without input or output");
+        // "running" means the run that wrote it never got to finish the item
+        item.state = state == "done"   ? ItemState::Done
+                   : state == "failed" ? ItemState::Failed
+                                       : ItemState::Pending;
+        m_items << item;
+    }
+    return true;
+}
+
+bool BatchSeparationJob::save()
+{
+    QJsonArray items;
+    for (const Item &item : m_items) {
+        QJsonObject o;
+        o["input"]  = item.inputFile;
+        o["output"] = item.outputPath;
+        o["state"]  = stateName(item.state);
+        if (!item.error.isEmpty())
+            o["error"] = item.error;
+        items.append(o);
+    }
+    QJsonObject root;
+    root["version"] = 1;
+    root["items"]   = items;
+
+    QDir().mkpath(QFileInfo(m_queuePath).absolutePath());
+    QSaveFile f(m_queuePath);
+    if (!f.open(QIODevice::WriteOnly)
+        || f.write(QJsonDocument(root).toJson()) < 0
+        || !f.commit()) {
+        qWarning() << "[BatchSeparation] cannot save queue" << m_queuePath << f.errorString();
+        return false;
+    }
+    return true;
+}
+
+// ── queue edits ──────────────────────────────────────────────────────────
+int BatchSeparationJob::enqueue(const QStringList &inputs, const QString &outputDir)
+{
+    int added = 0;
+    editQueue([&]() {
+        QSet<QString> queuedInputs, takenOutputs;
+        for (const Item &item : m_items) {
+            queuedInputs.insert(item.inputFile);
+            takenOutputs.insert(item.outputPath);
+        }
+
+        for (const QString &input : inputs) {
+            const QString abs = QFileInfo(input).absoluteFilePath();
+            if (queuedInputs.contains(abs))
+                continue;
+            const QString base = QDir(outputDir).absoluteFilePath(QFileInfo(abs).completeBaseName());
+            QString output = base + ".instrumental.wav";
+            for (int n = 2; takenOutputs.contains(output); ++n)
+                output = QString("%1 (%2).instrumental.wav").arg(base).arg(n);
+
+            Item item;
+            item.inputFile  = abs;
+            item.outputPath = output;
+            m_items << item;
+            queuedInputs.insert(abs);
+            takenOutputs.insert(output);
+            ++added;
+        }
+    });
+    return added;
+}
+
+void BatchSeparationJob::clearFinished()
+{
+    if (m_running)
+        return;
+    editQueue([this]() {
+        m_items.erase(std::remove_if(m_items.begin(), m_items.end(), [](const Item &item) {
+            return item.state == ItemState::Done || item.state == ItemState::Failed;
+        }), m_items.end());
+    });
+}
+
+void BatchSeparationJob::retryFailed()
+{
+    editQueue([this]() {
+        for (Item &item : m_items) {
+            if (item.state == ItemState::Failed) {
+                item.state = ItemState::Pending;
+                item.error.clear();
+            }
+        }
+    });
+}
+
+void BatchSeparationJob::setWorkerCount(int workers)
+{
+    m_workerCount = qMax(1, workers);
+    if (m_running)
+        dispatch();
+}
+
+// ── running ──────────────────────────────────────────────────────────────
+int BatchSeparationJob::busyWorkers() const
+{
+    int busy = 0;
+    for (const Worker *w : m_workers)
+        busy += (w->index >= 0);
+    return busy;
+}
+
+void BatchSeparationJob::start()
+{
+    if (m_running)
+        return;
+    m_cancelling = false;
+
+    QString err;
+    if (!lockQueue(&err)) {
+        emit batchError(err);
+        emitFinished(false);
+        return;
+    }
+    // Whatever another process made of the queue since our last edit
+    if (!readQueue(&err))
+        qWarning() << "[BatchSeparation]" << err << "— starting from an empty queue";
+    m_running = true;
+
+    if (m_testSeparateEngine) {
+        dispatch();
+        return;
+    }
+
+    // Built once here, on the pool, instead of by whichever workers reach
+    // VocalSeparator::separate() first
+    m_warming = true;
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher]() {
+        const QString err = watcher->result();
+        watcher->deleteLater();
+        m_warming = false;
+        if (!err.isEmpty()) {
+            // Nothing to run on; every item stays as it was
+            emit batchError(err);
+            emitFinished(false);
+            return;
+        }
+        dispatch();
+    });
+    watcher->setFuture(QtConcurrent::run([]() {
+        QString err;
+        return VocalSeparator::warmUp(err) ? QString() : err;
+    }));
+}
+
+void BatchSeparationJob::cancel()
+{
+    if (!m_running)
+        return;
+    m_cancelling = true;
+    for (Worker *w : m_workers)
+        if (w->index >= 0)
+            w->job->cancelSeparate();
+    finishIfIdle();
+}
+
+void BatchSeparationJob::waitForFinished()
+{
+    for (Worker *w : m_workers)
+        w->job->waitForFinished();
+    const auto watchers = findChildren<QFutureWatcher<QString> *>();
+    for (QFutureWatcher<QString> *watcher : watchers)
+        watcher->waitForFinished();
+}
+
+void BatchSeparationJob::dispatch()
+{
+    if (!m_running || m_warming)
+        return;
+
+    int next = 0;
+    for (int slot = 0; slot < m_workerCount && !m_cancelling; ++slot) {
+        if (slot == m_workers.size()) {
+            auto *w = new Worker;
+            w->job = new VocalSeparationJob(this);
+            m_workers << w;
+        }
+        Worker *w = m_workers[slot];
+        if (w->index >= 0)
+            continue;
+        while (next < m_items.size() && m_items[next].state != ItemState::Pending)
+            ++next;
+        if (next == m_items.size())
+            break;
+        runItem(*w, next);
+    }
+    finishIfIdle();
+}
+
+void BatchSeparationJob::runItem(Worker &worker, int index)
+{
+    m_items[index].state = ItemState::Running;
+    m_items[index].error.clear();
+    save();
+    worker.index = index;
+    emit itemStarted(index, m_items[index].inputFile);
+    if (m_cancelling) {
+        // A slot cancelled the batch on hearing of this item, before its
+        // separation (and so its cancel token) even existed
+        worker.index = -1;
+        settle(index, ItemState::Pending, QString());
+        return;
+    }
+
+    // Fresh connections per item: the previous item's are gone with the
+    // disconnect below, so a late signal can never be credited to this one
+    VocalSeparationJob *job = worker.job;
+    disconnect(job, nullptr, this, nullptr);
+    job->setSeparateEngineForTesting(m_testSeparateEngine);
+
+    connect(job, &VocalSeparationJob::separationProgress, this, [this, index](int pct) {
+        emit itemProgress(index, pct);
+    });
+    connect(job, &VocalSeparationJob::separationFailed, this,
+            [this, &worker, index](QString error, bool wasCancelled) {
+        worker.index = -1;
+        settle(index, wasCancelled ? ItemState::Pending : ItemState::Failed,
+               wasCancelled ? QString() : error);
+        dispatch();
+    });
+    connect(job, &VocalSeparationJob::separated, this, [this, &worker, index](QString tempWavPath) {
+        const QString outputPath = m_items[index].outputPath;
+        auto *watcher = new QFutureWatcher<QString>(this);
+        connect(watcher, &QFutureWatcher<QString>::finished, this, [this, &worker, index, watcher]() {
+            const QString err = watcher->result();
+            watcher->deleteLater();
+            worker.job->discardWorkspace();
+            worker.index = -1;
+            settle(index, err.isEmpty() ? ItemState::Done : ItemState::Failed, err);
+            dispatch();
+        });
+        watcher->setFuture(QtConcurrent::run(commitOutput, tempWavPath, outputPath));
+    });
+
+    job->separate(m_items[index].inputFile);
+}
+
+void BatchSeparationJob::settle(int index, ItemState state, const QString &error)
+{
+    Item &item = m_items[index];
+    item.state = state;
+    item.error = error;
+    save();
+    if (state == ItemState::Done)
+        emit itemFinished(index, item.outputPath);
+    else if (state == ItemState::Failed)
+        emit itemFailed(index, error);
+}
+
+void BatchSeparationJob::finishIfIdle()
+{
+    if (!m_running || m_warming || busyWorkers() > 0)
+        return;
+    if (!m_cancelling && std::any_of(m_items.begin(), m_items.end(), [](const Item &item) {
+            return item.state == ItemState::Pending;
+        }))
+        return;
+
+    emitFinished(m_cancelling);
+}
+
+void BatchSeparationJob::emitFinished(bool cancelled)
+{
+    m_running = false;
+    m_lock.reset();
+    int done = 0, failed = 0;
+    for (const Item &item : m_items) {
+        done   += (item.state == ItemState::Done);
+        failed += (item.state == ItemState::Failed);
+    }
+    emit finished(done, failed, cancelled);
+}
@@ -0,0 +1,152 @@
+#ifndef BATCHSEPARATIONJOB_H
+#define BATCHSEPARATIONJOB_H
+
+#include "vocalseparationjob.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QScopedPointer>
+#include <functional>
+
+class QLockFile;
+
+struct SessionEntry;
+
+// Separates a whole queue of inputs — a scanned folder, a selection from
+// the session library — into "<name>.instrumental.wav" files, for preparing
+// an evening's catalogue in one go instead of one "Generate Backing Track"
+// at a time. Runs up to workerCount() VocalSeparationJobs side by side; they
+// share the one process-wide ONNX session (see VocalSeparator::warmUp()),
+// which start() builds before the first item so workers don't race to.
+//
+// The queue is a JSON file (queuePath()) rewritten after every state
+// change, so a batch that's interrupted — cancel(), a crash, closing the
+// app — picks up where it left off the next time it's load()ed: finished
+// items stay finished, the ones that were running go back to pending.
+// A lock file next to it keeps two processes (the GUI and a headless run,
+// say) from working the same queue at once: it's held for the whole of a
+// run, and for each load() and edit, which re-read the file under it — so
+// neither process ever saves over items the other added.
+//
+// No UI of its own: MainWindow drives it from a dialog, main.cpp's
+// --separate-batch mode from the command line.
+class BatchSeparationJob : public QObject
+{
+    Q_OBJECT
+public:
+    enum class ItemState { Pending, Running, Done, Failed };
+
+    struct Item {
+        QString   inputFile;
+        QString   outputPath;   // final instrumental WAV
+        ItemState state = ItemState::Pending;
+        QString   error;        // why it failed; empty otherwise
+    };
+
+    explicit BatchSeparationJob(const QString &queuePath = defaultQueuePath(),
+                                QObject *parent = nullptr);
+    ~BatchSeparationJob() override;
+
+    // ~/.WakkaQt/batch/queue.json
+    static QString defaultQueuePath();
+    QString queuePath() const { return m_queuePath; }
+
+    // Media files (by extension) under dir, sorted; subfolders too if
+    // `recursive`.
+    static QStringList scanFolder(const QString &dir, bool recursive = true);
+    // One input per library session: its original playback file if that's
+    // still around, else the session's own playback.wav copy.
+    static QStringList libraryInputs(const QList<SessionEntry> &sessions);
+
+    // Replaces the in-memory queue with the saved one. A missing file is an
+    // empty queue, not an error; an unreadable or malformed one, or one
+    // another process is working on, returns false with errorOut set and
+    // leaves the queue empty. A no-op while running.
+    bool load(QString *errorOut = nullptr);
+    // Whether another process holds the queue right now (load() and the
+    // edits below would be refused).
+    bool isLockedElsewhere() const;
+
+    // The edits work on the queue as saved — re-read first, unless running —
+    // and save it straight after; each does nothing while another process
+    // holds the queue.
+    //
+    // Appends inputs not already queued, each writing
+    // "<outputDir>/<base name>.instrumental.wav" (numbered if two inputs
+    // share a name). Returns how many were added.
+    int  enqueue(const QStringList &inputs, const QString &outputDir);
+    // Drops Done and Failed items; only while idle.
+    void clearFinished();
+    // Failed items back to Pending, to be retried by the next start().
+    void retryFailed();
+    QList<Item> items() const { return m_items; }
+
+    // Concurrent separations, 1 by default. Takes effect from the next
+    // item dispatched.
+    void setWorkerCount(int workers);
+    int  workerCount() const { return m_workerCount; }
+
+    // Re-reads the queue and processes every Pending item in it, then emits
+    // finished(). Does nothing if already running; batchError() and
+    // finished() straight away if another process holds the queue.
+    void start();
+    // Stops dispatching and cancels the running separations; their items go
+    // back to Pending, so the batch resumes from them.
+    void cancel();
+    bool isRunning() const { return m_running; }
+    // Blocks until no separation or output copy is still running on the
+    // pool; their results are delivered by the event loop afterwards.
+    void waitForFinished();
+
+    // Test-only, forwarded to every worker — see
+    // VocalSeparationJob::setSeparateEngineForTesting(). Also skips the
+    // engine warm-up, which has nothing to warm without the real separator.
+    void setSeparateEngineForTesting(VocalSeparationJob::SeparateEngine engine)
+    {
+        m_testSeparateEngine = std::move(engine);
+    }
+
+signals:
+    void itemStarted(int index, QString inputFile);
+    void itemProgress(int index, int percentage);
+    void itemFinished(int index, QString outputPath);
+    void itemFailed(int index, QString error);
+    // The batch couldn't run at all (e.g. the model doesn't load); every
+    // item keeps its state. finished() follows.
+    void batchError(QString error);
+    void finished(int done, int failed, bool cancelled);
+
+private:
+    struct Worker {
+        VocalSeparationJob *job = nullptr;
+        int index = -1;   // item being separated, -1 when idle
+    };
+
+    void dispatch();
+    void runItem(Worker &worker, int index);
+    void settle(int index, ItemState state, const QString &error);
+    void finishIfIdle();
+    void emitFinished(bool cancelled);
+    bool lockQueue(QString *errorOut);
+    void unlockQueue();
+    bool readQueue(QString *errorOut);
+    bool editQueue(const std::function<void()> &edit);
+    bool save();
+    int  busyWorkers() const;
+
+    QString       m_queuePath;
+    QScopedPointer<QLockFile> m_lock;   // held while running, loading or editing
+    QList<Item>   m_items;
+    QVector<Worker *> m_workers;
+    int  m_workerCount = 1;
+    bool m_running    = false;
+    bool m_cancelling = false;
+    bool m_warming    = false;
+
+    VocalSeparationJob::SeparateEngine m_testSeparateEngine;
+};
+
+#endif // BATCHSEPARATIONJOB_H
@@ -0,0 +1,113 @@
+#include "cachedirectory.h"
+#include "atomicfilecommit.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QUuid>
+
+CacheDirectory::CacheDirectory(const QString &root, const QString &extension, qint64 maxBytes,
+                               qint64 staleStagingSecs, int maxAgeDays)
+    : m_root(root), m_extension(extension), m_maxBytes(maxBytes),
+      m_staleStagingSecs(staleStagingSecs), m_maxAgeDays(maxAgeDays) {}
+
+bool CacheDirectory::isEntryName(const QString &fileName) const
+{
+    // "<64 hex><extension>" — anything else in the directory is a staging sidecar
+    return fileName.size() == 64 + m_extension.size() && fileName.endsWith(m_extension);
+}
+
+QString CacheDirectory::entryPath(const QString &key) const
+{
+    return m_root + "/" + key + m_extension;
+}
+
+bool CacheDirectory::touch(const QString &key) const
+{
+    if (key.isEmpty())
+        return false;
+    // Most recently used = newest mtime; see evict()
+    QFile entry(entryPath(key));
+    if (!entry.open(QIODevice::ReadOnly))
+        return false;
+    entry.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+QString CacheDirectory::stagingPathFor(const QString &key) const
+{
+    if (key.isEmpty() || !QDir().mkpath(m_root))
+        return {};
+    return sidecarPathFor(entryPath(key), "partial-" + QUuid::createUuid().toString(QUuid::Id128));
+}
+
+QString CacheDirectory::commit(const QString &key, const QString &stagingPath) const
+{
+    if (key.isEmpty()) {
+        QFile::remove(stagingPath);
+        return "No cache key";
+    }
+    const QString finalPath = entryPath(key);
+    if (QFile::exists(finalPath)) {   // same key — another writer got there first
+        QFile::remove(stagingPath);
+        return {};
+    }
+    const QString err = commitPartialOverFinal(stagingPath, finalPath);
+    if (!err.isEmpty())
+        QFile::remove(stagingPath);
+    return err;
+}
+
+qint64 CacheDirectory::sizeBytes() const
+{
+    qint64 total = 0;
+    const QFileInfoList entries = QDir(m_root).entryInfoList({"*" + m_extension}, QDir::Files);
+    for (const QFileInfo &fi : entries)
+        if (isEntryName(fi.fileName()))
+            total += fi.size();
+    return total;
+}
+
+int CacheDirectory::evict(const QString &keepPath,
+                          const std::function<bool(const QString &path)> &inUse) const
+{
+    // Oldest first
+    const QFileInfoList files = QDir(m_root).entryInfoList({"*" + m_extension}, QDir::Files,
+                                                           QDir::Time | QDir::Reversed);
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QDateTime staleStagingBefore = now.addSecs(-m_staleStagingSecs);
+    const QString keep = QFileInfo(keepPath).fileName();
+    auto evictable = [&](const QFileInfo &fi) {
+        return fi.fileName() != keep && !(inUse && inUse(fi.absoluteFilePath()));
+    };
+
+    int evicted = 0;
+    QFileInfoList live;
+    qint64 total = 0;
+    for (const QFileInfo &fi : files) {
+        if (!isEntryName(fi.fileName())) {
+            if (fi.lastModified() < staleStagingBefore)
+                QFile::remove(fi.absoluteFilePath());
+        } else if (m_maxAgeDays > 0 && fi.lastModified() < now.addDays(-m_maxAgeDays)
+                   && evictable(fi) && QFile::remove(fi.absoluteFilePath())) {
+            ++evicted;
+        } else {
+            live << fi;
+            total += fi.size();
+        }
+    }
+
+    for (const QFileInfo &fi : live) {
+        if (total <= m_maxBytes)
+            break;
+        if (!evictable(fi))
+            continue;
+        const qint64 size = fi.size();
+        if (QFile::remove(fi.absoluteFilePath())) {
+            total -= size;
+            ++evicted;
+        }
+    }
+    return evicted;
+}
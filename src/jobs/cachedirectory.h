@@ -0,0 +1,64 @@
+#ifndef CACHEDIRECTORY_H
+#define CACHEDIRECTORY_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <functional>
+
+// The on-disk bookkeeping SeparationCache, RenderVideoCache and
+// DecodedAudioStore share: one flat directory of "<64 hex key><extension>"
+// entries, written through a uniquely named sibling and moved into place
+// with commitPartialOverFinal(), least recently used first out by mtime
+// (refreshed by touch()). What goes into an entry, and how its key is made,
+// stays with each cache. Cheap to construct — it holds only the settings —
+// and safe to use from any thread.
+class CacheDirectory
+{
+public:
+    // Staging sidecars older than staleStagingSecs belong to a writer that
+    // crashed and are removed by evict(); so are entries unused for
+    // maxAgeDays (0 = entries never expire, only the size cap applies).
+    CacheDirectory(const QString &root, const QString &extension, qint64 maxBytes,
+                   qint64 staleStagingSecs, int maxAgeDays = 0);
+
+    QString root() const { return m_root; }
+    qint64  maxBytes() const { return m_maxBytes; }
+
+    QString entryPath(const QString &key) const;
+
+    // Marks key's entry most recently used. False if there is none.
+    bool touch(const QString &key) const;
+
+    // A fresh path next to key's entry-to-be, unique per call, so two
+    // writers of the same key never share a staging file. Creates the
+    // directory; empty if it can't.
+    QString stagingPathFor(const QString &key) const;
+
+    // Moves the finished stagingPath into place as key's entry. Returns an
+    // empty string on success or a description of what failed; either way
+    // stagingPath is gone afterwards. An entry that already exists wins —
+    // same key, same content — and the staging file is dropped. Doesn't
+    // evict: callers do, once they are done with their own bookkeeping.
+    QString commit(const QString &key, const QString &stagingPath) const;
+
+    // Total size of the entries; staging files never count
+    qint64 sizeBytes() const;
+
+    // Drops stale staging files and expired entries, then the least
+    // recently used entries until the total fits the cap. Never keepPath,
+    // nor any entry `inUse` claims. Returns how many entries went.
+    int evict(const QString &keepPath,
+              const std::function<bool(const QString &path)> &inUse = {}) const;
+
+private:
+    bool isEntryName(const QString &fileName) const;
+
+    QString m_root;
+    QString m_extension;
+    qint64  m_maxBytes;
+    qint64  m_staleStagingSecs;
+    int     m_maxAgeDays;
+};
+
+#endif // CACHEDIRECTORY_H
@@ -243,6 +243,9 @@ bool PreviewJob::enhance(const QByteArray &pcmData, const QAudioFormat &format,
         m_enhancerFormat = format;
         m_hasEnhancerFormat = true;
         m_enhancer.reset(new VocalEnhancer(format, this));
+        // Every slider change re-enhances the same take: keep the stages
+        // the next run can replay
+        m_enhancer->setStageCacheLimit(VocalEnhancer::kPreviewStageCacheBytes);
     }
 
     m_enhancer->setPitchCorrectionAmount(params.pitchCorrectionAmount);
@@ -268,9 +271,38 @@ bool PreviewJob::enhance(const QByteArray &pcmData, const QAudioFormat &format,
         emit enhanced(tunedData);
     });
 
+    // Drives the enhancer's streaming API directly (rather than enhance())
+    // so each ~1 s of tuned audio can be handed on via enhancedBlock() as
+    // soon as it's final; the concatenation is still delivered whole through
+    // enhanced() for callers that only want the finished take.
     VocalEnhancer *enhancer = m_enhancer.data();
-    auto future = QtConcurrent::run([enhancer, pcmData, this]() {
-        return enhancer->enhance(pcmData, &m_enhanceCancelled);
+    const qsizetype blockBytes = std::max<qsizetype>(format.bytesPerFrame(),
+                                                     format.bytesForDuration(1000000));
+    auto future = QtConcurrent::run([enhancer, pcmData, blockBytes, this]() {
+        if (pcmData.isEmpty() || m_enhanceCancelled.load())
+            return QByteArray();
+
+        enhancer->begin(enhancer->measureInput(pcmData), &m_enhanceCancelled);
+        QByteArray tuned;
+        tuned.reserve(pcmData.size());
+        for (qsizetype off = 0; off < pcmData.size(); off += blockBytes) {
+            const QByteArray block = enhancer->process(QByteArray::fromRawData(
+                pcmData.constData() + off, std::min(blockBytes, pcmData.size() - off)));
+            if (m_enhanceCancelled.load())
+                break;
+            if (!block.isEmpty()) {
+                tuned.append(block);
+                emit enhancedBlock(block); // emitted from a worker thread; Qt auto-queues to this' thread
+            }
+        }
+        const QByteArray tail = enhancer->finish();
+        if (m_enhanceCancelled.load())
+            return QByteArray();
+        if (!tail.isEmpty()) {
+            tuned.append(tail);
+            emit enhancedBlock(tail);
+        }
+        return tuned;
     });
     watcher->setFuture(future);
     return true;
@@ -63,6 +63,11 @@ signals:
     // (success, cancelled, errorMessage) shape. reason is empty when cancelled.
     void extractionFailed(QString reason, bool wasCancelled);
     void enhanced(QByteArray tunedPcm);
+    // Tuned PCM as the enhancer finalises it (roughly once per second of
+    // input, lagging it by the DSP lookahead). Blocks arrive in order and
+    // concatenate to exactly what enhanced() then delivers; nothing more is
+    // emitted for a run once it has been cancelled.
+    void enhancedBlock(QByteArray tunedBlock);
 
 private:
     // Fallback (QProcess) path only — the native path folds the equivalent
@@ -4,8 +4,12 @@
 #include <QtConcurrent/QtConcurrentRun>
 #include <QRegularExpression>
 #include <QFile>
+#include <QFileInfo>
+#include <QDebug>
 #ifdef WAKKAQT_FFMPEG_NATIVE
 #include "ffmpegnative.h"
+#include "pitchtrack.h"
+#include "rendervideocache.h"
 #endif
 
 static QString partialPathFor(const QString &finalPath)
@@ -13,6 +17,37 @@ static QString partialPathFor(const QString &finalPath)
     return sidecarPathFor(finalPath, "partial");
 }
 
+#ifdef WAKKAQT_FFMPEG_NATIVE
+// RenderVideoCache key: everything the rendered video stream depends on. The
+// pitch overlay draws the raw vocal's pitch at each frame's time plus
+// audioOffsetMs, so with it on, those count too — as does the enhancer's
+// pitch track when there is one, since it's what the overlay then draws
+// (and its target notes follow the key and scale). The container decides the
+// video codec (VP9 for WebM, H.264 otherwise). Vocal volume, the tuned vocal
+// and the playback only reach the audio — changing them is what reuses.
+static QString videoCacheKeyFor(const RenderJob::Params &params)
+{
+    const bool overlay = !params.rawVocalPath.isEmpty();
+    QStringList inputs{params.webcamPath};
+    if (overlay) {
+        inputs << params.rawVocalPath;
+        const QString track = PitchTrack::sidecarPathFor(params.rawVocalPath);
+        if (QFileInfo::exists(track))
+            inputs << track;
+    }
+    const QStringList settings{
+        "v1",
+        "video-offset=" + QString::number(params.videoOffsetMs),
+        "resolution=" + params.resolution,
+        "effect=" + params.videoEffectChain,
+        "overlay=" + (overlay ? QString("audio-offset %1").arg(params.audioOffsetMs)
+                              : QString("off")),
+        "container=" + QFileInfo(params.outputPath).suffix().toLower(),
+    };
+    return RenderVideoCache::keyFor(inputs, settings.join('\n'));
+}
+#endif
+
 RenderJob::RenderJob(QObject *parent) : QObject(parent) {}
 
 RenderJob::~RenderJob()
@@ -85,15 +120,43 @@ void RenderJob::startNative(const Params &params)
     const QString partialPathForThisRun = partialPathFor(outputPathForThisRun);
     QFile::remove(partialPathForThisRun); // clear any leftover from a previous crashed attempt
 
+    // Re-rendering a take with only audio changes remuxes the video encoded
+    // last time (see RenderVideoCache); a miss has renderVideo() keep a copy
+    // of what it encodes for next time. Not with a test engine, which knows
+    // nothing of either.
+    FFmpegNative::RenderVideoReuse videoReuse;
+    QString videoCacheKey;
+    if (!m_testEngine && params.hasWebcam) {
+        videoCacheKey = videoCacheKeyFor(params);
+        RenderVideoCache cache;
+        videoReuse.readFrom = cache.lookup(videoCacheKey);
+        if (videoReuse.readFrom.isEmpty())
+            videoReuse.writeTo = cache.stagingPathFor(videoCacheKey);
+    }
+    const QString videoStagingPath = videoReuse.writeTo;
+
     QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
     m_watcher = watcher;
     connect(watcher, &QFutureWatcher<bool>::finished, this,
-            [this, watcher, cancelledForThisRun, outputPathForThisRun, partialPathForThisRun]() {
+            [this, watcher, cancelledForThisRun, outputPathForThisRun, partialPathForThisRun,
+             videoCacheKey, videoStagingPath]() {
         const bool ok = watcher->result();
         if (m_watcher == watcher)
             m_watcher = nullptr;
         watcher->deleteLater();
 
+        // Only a render that went all the way through leaves a video worth
+        // reusing (renderVideo() doesn't write one when it had nothing to encode)
+        if (!videoStagingPath.isEmpty()) {
+            if (ok && !cancelledForThisRun->load() && QFile::exists(videoStagingPath)) {
+                const QString cacheErr = RenderVideoCache().insert(videoCacheKey, videoStagingPath);
+                if (!cacheErr.isEmpty())
+                    qWarning() << "RenderJob: video not cached:" << cacheErr;
+            } else {
+                QFile::remove(videoStagingPath);
+            }
+        }
+
         if (cancelledForThisRun->load()) {
             QFile::remove(partialPathForThisRun);
             emit finished(false, true, QString());
@@ -153,7 +216,8 @@ void RenderJob::startNative(const Params &params)
             rawVocalPath,
             cancelledCopy.get(),
             progressCb,
-            videoEffectChain);
+            videoEffectChain,
+            videoReuse);
     });
     watcher->setFuture(future);
 }
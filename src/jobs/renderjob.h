@@ -13,7 +13,9 @@
 // live inline in MainWindow::mixAndRender() — both the native
 // QtConcurrent/FFmpegNative::renderVideo() path and the QProcess+ffmpeg-CLI
 // fallback. MainWindow keeps all UI (progress bar, buttons, dialogs); this
-// class only reports progress/result.
+// class only reports progress/result. The native path also keeps each
+// render's encoded video in RenderVideoCache, so a re-render that only
+// changes audio (vocal volume, say) skips the video work.
 class RenderJob : public QObject
 {
     Q_OBJECT
@@ -0,0 +1,65 @@
+#include "rendervideocache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+// Staging sidecars a day old belong to a render that crashed — nobody will
+// ever commit them. (A day, not SeparationCache's hour: a long render at a
+// high resolution can take a good while.)
+RenderVideoCache::RenderVideoCache(const QString &root, qint64 maxBytes)
+    : m_dir(root, ".mkv", maxBytes, 24 * 3600, kMaxAgeDays) {}
+
+QString RenderVideoCache::cacheRoot()
+{
+    // Same test-only override pattern as SeparationCache::cacheRoot()
+    const QString override = qEnvironmentVariable("WAKKAQT_RENDER_CACHE_OVERRIDE");
+    if (!override.isEmpty())
+        return override;
+    return QDir::homePath() + "/.WakkaQt/cache/render";
+}
+
+QString RenderVideoCache::keyFor(const QStringList &inputFiles, const QString &settings)
+{
+    QCryptographicHash h(QCryptographicHash::Sha256);
+    for (const QString &file : inputFiles) {
+        const QFileInfo fi(file);
+        if (!fi.exists())
+            return {};
+        h.addData(fi.absoluteFilePath().toUtf8());
+        h.addData(QByteArray(1, '\0'));
+        h.addData(QByteArray::number(fi.size()));
+        h.addData(QByteArray(1, '\0'));
+        h.addData(QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+        h.addData(QByteArray(1, '\0'));
+    }
+    h.addData(settings.toUtf8());
+    return QString::fromLatin1(h.result().toHex());
+}
+
+QString RenderVideoCache::lookup(const QString &key)
+{
+    if (!m_dir.touch(key)) {
+        qInfo() << "[RenderVideoCache] miss";
+        return {};
+    }
+    const QString path = m_dir.entryPath(key);
+    qInfo() << "[RenderVideoCache] hit —" << path;
+    return path;
+}
+
+QString RenderVideoCache::stagingPathFor(const QString &key) const
+{
+    return m_dir.stagingPathFor(key);
+}
+
+QString RenderVideoCache::insert(const QString &key, const QString &stagingPath)
+{
+    const QString err = m_dir.commit(key, stagingPath);
+    if (err.isEmpty())
+        m_dir.evict(m_dir.entryPath(key));
+    return err;
+}
@@ -0,0 +1,68 @@
+#ifndef RENDERVIDEOCACHE_H
+#define RENDERVIDEOCACHE_H
+
+#include "cachedirectory.h"
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+// Encoded video streams of past renders, so rendering the same take again
+// after changing only audio — vocal volume, the mix, the output's audio
+// codec — remuxes the video it already has instead of decoding, filtering
+// and re-encoding the webcam recording all over again. Lives under
+// ~/.WakkaQt/cache/render/, one "<key>.mkv" per entry: the video stream
+// alone, with its timestamps exactly as they were muxed into that render.
+// RenderJob decides hit or miss; FFmpegNative::renderVideo() writes the
+// entries and remuxes them (see FFmpegNative::RenderVideoReuse).
+//
+// Invalidation is by key. It covers the input files' identity — absolute
+// path, size and modification time, since the recordings sit at fixed
+// /tmp paths that every new take overwrites — plus a caller-built string of
+// every setting the pixels depend on. A new take or a changed setting is a
+// different key; the entries that orphans are never hit again, so entries
+// unused for kMaxAgeDays are dropped on the next insert, and the least
+// recently used go first whenever the total exceeds the cap.
+//
+// Same commit and eviction mechanics as SeparationCache (CacheDirectory):
+// written through a uniquely named sibling and moved into place with
+// commitPartialOverFinal(), LRU by mtime refreshed on every hit.
+class RenderVideoCache
+{
+public:
+    static constexpr qint64 kDefaultMaxBytes = qint64(2) << 30;
+    static constexpr int    kMaxAgeDays      = 14;
+
+    explicit RenderVideoCache(const QString &root = cacheRoot(),
+                              qint64 maxBytes = kDefaultMaxBytes);
+
+    // ~/.WakkaQt/cache/render (or WAKKAQT_RENDER_CACHE_OVERRIDE)
+    static QString cacheRoot();
+
+    // Key for rendering inputFiles under `settings`. Empty if any input
+    // doesn't exist — callers then just don't cache.
+    static QString keyFor(const QStringList &inputFiles, const QString &settings);
+
+    // The entry's path on a hit, marked most recently used; empty on a miss.
+    // Not a copy (unlike SeparationCache::fetch() — videos are big), so an
+    // eviction elsewhere can still remove it before the caller opens it; a
+    // reader that can't open it must treat that as a miss.
+    QString lookup(const QString &key);
+
+    // A fresh path next to key's entry-to-be, for the renderer to write into
+    // and insert() to commit. Creates the cache directory; empty if it can't.
+    QString stagingPathFor(const QString &key) const;
+
+    // Moves the finished file at stagingPath into place as key's entry, then
+    // evicts. Returns an empty string on success or a description of what
+    // failed; either way stagingPath is gone afterwards.
+    QString insert(const QString &key, const QString &stagingPath);
+
+    qint64 sizeBytes() const { return m_dir.sizeBytes(); }
+    qint64 maxBytes() const { return m_dir.maxBytes(); }
+
+private:
+    CacheDirectory m_dir;
+};
+
+#endif // RENDERVIDEOCACHE_H
@@ -0,0 +1,231 @@
+#include "separationcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace {
+
+std::atomic<quint64> s_hits{0};
+std::atomic<quint64> s_misses{0};
+std::atomic<quint64> s_insertions{0};
+std::atomic<quint64> s_evictions{0};
+
+// Content hash: files up to kWholeFileHashBytes — every audio source and
+// most karaoke videos — are hashed whole. Larger ones are read as kSamples
+// blocks of kBlockBytes spread evenly from the first byte to the last, about
+// 2 MiB at any size, with the modification time folded in: samples alone
+// can't tell apart two same-length files that differ between them (a
+// re-encode, a re-download of a fixed upload), and a full pass over a
+// multi-gigabyte video would cost more than it saves. The size goes in
+// first either way.
+constexpr qint64 kBlockBytes = qint64(64) << 10;
+constexpr int    kSamples    = 32;
+
+QByteArray contentHash(const QString &path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+    const qint64 size = f.size();
+
+    QCryptographicHash h(QCryptographicHash::Sha256);
+    const quint64 sizeLE = qToLittleEndian(quint64(size));
+    h.addData(QByteArrayView(reinterpret_cast<const char *>(&sizeLE), sizeof sizeLE));
+
+    if (size <= SeparationCache::kWholeFileHashBytes) {
+        if (!h.addData(&f))
+            return {};
+        return h.result();
+    }
+    const qint64 mtimeLE = qToLittleEndian(
+        f.fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch());
+    h.addData(QByteArrayView(reinterpret_cast<const char *>(&mtimeLE), sizeof mtimeLE));
+    for (int i = 0; i < kSamples; ++i) {
+        const qint64 at = (size - kBlockBytes) * i / (kSamples - 1);
+        if (!f.seek(at))
+            return {};
+        const QByteArray block = f.read(kBlockBytes);
+        if (block.size() != kBlockBytes)
+            return {};
+        h.addData(block);
+    }
+    return h.result();
+}
+
+// A hit's file for the caller, cheapest first: a reflink (a copy-on-write
+// file of its own, on btrfs or XFS), else a hard link (the entry's own
+// inode — entries are never written to once committed, and the link
+// outlives the entry's eviction), else a byte copy, which is what's left
+// when dest is on another filesystem than the cache.
+bool cloneFile(const QString &src, const QString &dest)
+{
+    const QByteArray srcName = QFile::encodeName(src), destName = QFile::encodeName(dest);
+#ifdef __linux__
+    const int in = ::open(srcName.constData(), O_RDONLY | O_CLOEXEC);
+    if (in >= 0) {
+        bool cloned = false;
+        const int out = ::open(destName.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (out >= 0) {
+            cloned = ::ioctl(out, FICLONE, in) == 0;
+            ::close(out);
+            if (!cloned)
+                ::unlink(destName.constData());
+        }
+        ::close(in);
+        if (cloned)
+            return true;
+    }
+#endif
+#ifdef Q_OS_UNIX
+    if (::link(srcName.constData(), destName.constData()) == 0)
+        return true;
+#endif
+    return QFile::copy(src, dest);
+}
+
+} // namespace
+
+// Staging sidecars an hour old belong to a run that crashed mid-insert —
+// nobody will ever commit them. Entries don't expire: the same source can
+// come back from the library any time. Remembered content hashes do, once
+// unused for kHashMemoDays; they're 64 bytes each, so the cap is only a
+// backstop.
+SeparationCache::SeparationCache(const QString &root, qint64 maxBytes)
+    : m_dir(root, ".wav", maxBytes, 3600),
+      m_hashes(root + "/hashes", ".sha256", qint64(1) << 20, 3600, kHashMemoDays) {}
+
+QString SeparationCache::cacheRoot()
+{
+    // Same test-only override pattern as SessionRepository::libraryRoot()
+    const QString override = qEnvironmentVariable("WAKKAQT_SEPARATION_CACHE_OVERRIDE");
+    if (!override.isEmpty())
+        return override;
+    return QDir::homePath() + "/.WakkaQt/cache/separation";
+}
+
+// The content hash is the one slow part of a lookup, so it's remembered
+// per (path, size, mtime): a repeat lookup of an unchanged file reads back
+// 64 hex digits instead of rehashing up to kWholeFileHashBytes.
+QByteArray SeparationCache::contentHashOf(const QString &inputFile) const
+{
+    const QFileInfo fi(inputFile);
+    if (!fi.isFile())
+        return {};
+    QCryptographicHash id(QCryptographicHash::Sha256);
+    id.addData(fi.absoluteFilePath().toUtf8());
+    id.addData(QByteArray(1, '\0'));
+    id.addData(QByteArray::number(fi.size()) + ' '
+               + QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+    const QString memoKey = QString::fromLatin1(id.result().toHex());
+
+    QFile memo(m_hashes.entryPath(memoKey));
+    if (memo.open(QIODevice::ReadOnly)) {
+        const QByteArray hex = memo.read(64);
+        memo.close();
+        if (hex.size() == 64) {
+            m_hashes.touch(memoKey);
+            return QByteArray::fromHex(hex);
+        }
+    }
+
+    const QByteArray content = contentHash(inputFile);
+    if (content.isEmpty())
+        return {};
+    // Best effort: a memo that can't be written only costs the next lookup
+    // a rehash
+    const QString staging = m_hashes.stagingPathFor(memoKey);
+    QFile f(staging);
+    if (!staging.isEmpty() && f.open(QIODevice::WriteOnly) && f.write(content.toHex()) == 64) {
+        f.close();
+        if (m_hashes.commit(memoKey, staging).isEmpty())
+            m_hashes.evict(m_hashes.entryPath(memoKey));
+    } else if (!staging.isEmpty()) {
+        f.close();
+        QFile::remove(staging);
+    }
+    return content;
+}
+
+QString SeparationCache::keyFor(const QString &inputFile, const QString &modelSha,
+                                const QString &variant) const
+{
+    const QByteArray content = contentHashOf(inputFile);
+    if (content.isEmpty())
+        return {};
+    QCryptographicHash h(QCryptographicHash::Sha256);
+    h.addData(content);
+    h.addData(modelSha.toLatin1().toLower());
+    h.addData(QByteArray(1, '\0'));
+    h.addData(variant.toUtf8());
+    return QString::fromLatin1(h.result().toHex());
+}
+
+bool SeparationCache::fetch(const QString &key, const QString &destPath)
+{
+    if (key.isEmpty() || !cloneFile(m_dir.entryPath(key), destPath)) {
+        const quint64 misses = ++s_misses;
+        qInfo() << "[SeparationCache] miss —" << s_hits.load() << "hits," << misses << "misses";
+        return false;
+    }
+    m_dir.touch(key);
+
+    const quint64 hits = ++s_hits;
+    qInfo() << "[SeparationCache] hit —" << hits << "hits," << s_misses.load() << "misses";
+    return true;
+}
+
+QString SeparationCache::insert(const QString &key, const QString &wavPath)
+{
+    if (key.isEmpty())
+        return "No cache key";
+    const QString finalPath = m_dir.entryPath(key);
+    if (QFile::exists(finalPath))   // same key, same content — another run got there first
+        return {};
+
+    const QString partialPath = m_dir.stagingPathFor(key);
+    if (partialPath.isEmpty())
+        return "Cannot create cache directory " + m_dir.root();
+    if (!QFile::copy(wavPath, partialPath)) {
+        QFile::remove(partialPath);
+        return "Cannot copy " + wavPath + " into the separation cache";
+    }
+    const QString err = m_dir.commit(key, partialPath);
+    if (!err.isEmpty())
+        return err;
+    ++s_insertions;
+    s_evictions += quint64(m_dir.evict(finalPath));
+    return {};
+}
+
+SeparationCache::Stats SeparationCache::stats()
+{
+    Stats s;
+    s.hits       = s_hits.load();
+    s.misses     = s_misses.load();
+    s.insertions = s_insertions.load();
+    s.evictions  = s_evictions.load();
+    return s;
+}
+
+void SeparationCache::resetStats()
+{
+    s_hits = 0;
+    s_misses = 0;
+    s_insertions = 0;
+    s_evictions = 0;
+}
@@ -0,0 +1,87 @@
+#ifndef SEPARATIONCACHE_H
+#define SEPARATIONCACHE_H
+
+#include "cachedirectory.h"
+
+#include <QString>
+#include <QtGlobal>
+
+// Content-addressed store of separated instrumentals, so separating the
+// same karaoke source again — another session, re-opening it from the
+// library, a retried export — copies a finished WAV instead of repeating
+// decode, STFT and inference. Lives under ~/.WakkaQt/cache/separation/,
+// one "<key>.wav" per entry.
+//
+// The key covers everything the output depends on: the input's content
+// (not its path — a renamed or re-downloaded copy still hits), the model's
+// SHA-256 and a caller-chosen variant string for any other setting that
+// changes the result (e.g. the chunking preset). The content part hashes
+// the whole file up to kWholeFileHashBytes. Past that it's sampled — the
+// size, the modification time and evenly spaced 64 KiB blocks — so keying
+// a multi-gigabyte video costs a couple of megabytes of reads, not a full
+// pass; such a file only hits again while its mtime is unchanged (a copy
+// made with its timestamps kept still does).
+//
+// Entries are written to a uniquely named sibling first and moved into
+// place with commitPartialOverFinal() (atomicfilecommit.h), so another
+// WakkaQt instance never sees a half-written WAV. Total size is capped;
+// when an insert goes over, the least recently used entries (by mtime,
+// refreshed on every hit) are evicted — CacheDirectory's mechanics, shared
+// with RenderVideoCache and DecodedAudioStore. Instances are cheap — they hold
+// only the root and the caps — and safe to use from any thread; hit/miss
+// counts are process-wide.
+class SeparationCache
+{
+public:
+    struct Stats {
+        quint64 hits       = 0;
+        quint64 misses     = 0;
+        quint64 insertions = 0;
+        quint64 evictions  = 0;
+    };
+
+    static constexpr qint64 kDefaultMaxBytes    = qint64(4) << 30;
+    static constexpr qint64 kWholeFileHashBytes = qint64(256) << 20;
+    static constexpr int    kHashMemoDays       = 90;
+
+    explicit SeparationCache(const QString &root = cacheRoot(),
+                             qint64 maxBytes = kDefaultMaxBytes);
+
+    // ~/.WakkaQt/cache/separation (or WAKKAQT_SEPARATION_CACHE_OVERRIDE)
+    static QString cacheRoot();
+
+    // Key for separating inputFile with the model whose SHA-256 is
+    // modelSha, under `variant`. Empty if the input can't be read — callers
+    // then just don't cache. The input's content hash is remembered under
+    // "hashes/" by its path, size and mtime, so only the first lookup of a
+    // file reads it; later ones just stat it.
+    QString keyFor(const QString &inputFile, const QString &modelSha,
+                   const QString &variant = QString()) const;
+
+    // On a hit, puts the entry at destPath (which must not exist yet), marks
+    // it most recently used and returns true. A file of the caller's own
+    // rather than the entry's path, because an eviction by this or another
+    // instance may remove the entry while the caller still needs it — but a
+    // reflink or a hard link where the filesystem allows one, a copy only
+    // where it doesn't.
+    bool fetch(const QString &key, const QString &destPath);
+
+    // Stores a copy of wavPath under key, then evicts down to the cap
+    // (never the entry just inserted). Returns an empty string on success
+    // or a description of what failed; either way wavPath is untouched.
+    QString insert(const QString &key, const QString &wavPath);
+
+    qint64 sizeBytes() const { return m_dir.sizeBytes(); }
+    qint64 maxBytes() const { return m_dir.maxBytes(); }
+
+    static Stats stats();
+    static void  resetStats();
+
+private:
+    QByteArray contentHashOf(const QString &inputFile) const;
+
+    CacheDirectory m_dir;
+    CacheDirectory m_hashes;   // remembered content hashes, by path/size/mtime
+};
+
+#endif // SEPARATIONCACHE_H
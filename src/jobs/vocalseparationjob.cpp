@@ -1,8 +1,10 @@
 #include "vocalseparationjob.h"
 #include "vocalseparator.h"
 #include "atomicfilecommit.h"
+#include "separationcache.h"
 
 #include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -16,6 +18,15 @@ static QString partialPathFor(const QString &finalPath)
     return sidecarPathFor(finalPath, "partial");
 }
 
+// SeparationCache variant for the chunk schedule — the only separator
+// setting besides the model that changes the output.
+static QString chunkingVariant(const VocalSeparator::Chunking &chunking)
+{
+    const char *blend = chunking.blend == VocalSeparator::Chunking::Blend::Crossfade
+                            ? "crossfade" : "trim";
+    return QString("%1:%2").arg(blend).arg(chunking.overlap);
+}
+
 VocalSeparationJob::VocalSeparationJob(QObject *parent) : QObject(parent) {}
 
 VocalSeparationJob::~VocalSeparationJob()
@@ -126,9 +137,29 @@ void VocalSeparationJob::separate(const QString &inputFile)
         std::function<void(int)> progressCb = [this](int pct) {
             emit separationProgress(pct); // emitted from a worker thread; Qt auto-queues to this' thread
         };
+
+        // Same source, same model, same chunking => same instrumental, so a
+        // repeat separation is a file copy. An unreadable input gets no key
+        // and just runs (and fails) the normal way.
+        SeparationCache cache;
+        const QString key = cache.keyFor(inputFile, VocalSeparator::modelSha256(),
+                                         chunkingVariant(VocalSeparator::chunking()));
+        const QString cachedPath = workspaceDir + "/instrumental.wav";
+        if (!key.isEmpty() && cache.fetch(key, cachedPath)) {
+            progressCb(100);
+            return {cachedPath, QString()};
+        }
+
         QString path = engineForThisRun
             ? engineForThisRun(inputFile, workspaceDir, progressCb, err, cancelledCopy.get())
             : VocalSeparator::separate(inputFile, workspaceDir, progressCb, err, cancelledCopy.get());
+
+        // A failed insert only costs the next run its shortcut — never this one its result
+        if (!key.isEmpty() && !path.isEmpty()) {
+            const QString cacheErr = cache.insert(key, path);
+            if (!cacheErr.isEmpty())
+                qWarning() << "[VocalSeparationJob] Not caching separation result:" << cacheErr;
+        }
         return {path, err};
     });
     watcher->setFuture(future);
@@ -32,7 +32,9 @@ public:
 
     // Phase 1: runs VocalSeparator::separate() on a worker thread, writing
     // into a private per-run workspace directory this job creates and owns
-    // (see discardWorkspace()) instead of fixed shared /tmp paths.
+    // (see discardWorkspace()) instead of fixed shared /tmp paths. An input
+    // already separated with the same model and chunking is served from
+    // SeparationCache instead — same signals, no inference.
     void separate(const QString &inputFile);
     void cancelSeparate();
     bool isSeparating() const;
@@ -1,7 +1,14 @@
 #include "mainwindow.h"
 #include "Logger.h"
+#include "batchseparationjob.h"
+#include "modeldownloadjob.h"
+#include "sessionrepository.h"
+#include "vocalseparator.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QTextStream>
 #include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
@@ -100,7 +107,111 @@ void messageHandler(QtMsgType type, const QMessageLogContext &context, const QSt
     Logger::instance().logMessage(formatted);
 }
 
+// `WakkaQt --separate-batch …`: separates a queue of files with no window
+// at all — for a headless box, or a script preparing a whole catalogue.
+// Works the same BatchSeparationJob queue as the GUI, so either one resumes
+// what the other left unfinished (Ctrl+C included: the items it
+// interrupted are picked up again next time).
+static int runBatchSeparation(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Separate backing tracks for a queue of files, without the GUI. "
+                                     "With no inputs, resumes the saved queue.");
+    parser.addHelpOption();
+    parser.addOption({"separate-batch", "Run a batch separation and exit."});
+    parser.addOption({"out", "Folder the instrumentals are written to (required when adding inputs).", "dir"});
+    parser.addOption({"jobs", "Separations to run side by side (default 1).", "n", "1"});
+    parser.addOption({"library", "Add every session in the WakkaQt library."});
+    parser.addOption({"retry-failed", "Retry items that failed in an earlier run."});
+    parser.addOption({"clear-finished", "Drop finished and failed items before starting."});
+    parser.addPositionalArgument("inputs", "Folders (scanned recursively) or media files to add.",
+                                 "[inputs…]");
+    parser.process(app);
+
+    BatchSeparationJob job;
+    QString err;
+    if (!job.load(&err)) {
+        out << err << Qt::endl;
+        return 1;
+    }
+    if (parser.isSet("clear-finished"))
+        job.clearFinished();
+    if (parser.isSet("retry-failed"))
+        job.retryFailed();
+
+    QStringList inputs;
+    for (const QString &arg : parser.positionalArguments())
+        inputs << (QFileInfo(arg).isDir() ? BatchSeparationJob::scanFolder(arg) : QStringList{arg});
+    if (parser.isSet("library"))
+        inputs << BatchSeparationJob::libraryInputs(SessionRepository().loadAll());
+    if (!inputs.isEmpty()) {
+        if (!parser.isSet("out")) {
+            out << "--out is required when adding inputs" << Qt::endl;
+            return 1;
+        }
+        const int added = job.enqueue(inputs, parser.value("out"));
+        if (added == 0 && job.isLockedElsewhere()) {
+            out << "Another WakkaQt batch is already working on " << job.queuePath() << Qt::endl;
+            return 1;
+        }
+        out << "Queued " << added << " new file(s)" << Qt::endl;
+    }
+
+    // Same one-time download the GUI offers, minus the question
+    if (!VocalSeparator::modelExists()) {
+        out << "Downloading the separation model to " << VocalSeparator::modelPath() << "…" << Qt::endl;
+        ModelDownloadJob download;
+        QEventLoop loop;
+        bool ok = false;
+        QObject::connect(&download, &ModelDownloadJob::finished, &loop,
+                         [&](bool success, bool, QString errorMessage) {
+            ok = success;
+            err = errorMessage;
+            loop.quit();
+        });
+        download.start(VocalSeparator::modelUrl(), VocalSeparator::modelPath(),
+                       VocalSeparator::modelSha256());
+        loop.exec();
+        if (!ok) {
+            out << "Model download failed: " << err << Qt::endl;
+            return 1;
+        }
+    }
+
+    const int total = job.items().size();
+    job.setWorkerCount(parser.value("jobs").toInt());
+    QObject::connect(&job, &BatchSeparationJob::itemStarted, &app, [&](int index, QString input) {
+        out << "[" << index + 1 << "/" << total << "] " << input << Qt::endl;
+    });
+    QObject::connect(&job, &BatchSeparationJob::itemFinished, &app, [&](int index, QString output) {
+        out << "[" << index + 1 << "/" << total << "] -> " << output << Qt::endl;
+    });
+    QObject::connect(&job, &BatchSeparationJob::itemFailed, &app, [&](int index, QString error) {
+        out << "[" << index + 1 << "/" << total << "] FAILED: " << error << Qt::endl;
+    });
+    QObject::connect(&job, &BatchSeparationJob::batchError, &app, [&](QString error) {
+        out << error << Qt::endl;
+    });
+    int exitCode = 0;
+    QObject::connect(&job, &BatchSeparationJob::finished, &app,
+                     [&](int done, int failed, bool cancelled) {
+        out << done << " done, " << failed << " failed, "
+            << total - done - failed << " pending" << Qt::endl;
+        exitCode = (failed > 0 || cancelled || done + failed < total) ? 1 : 0;
+        app.quit();
+    });
+    QMetaObject::invokeMethod(&job, [&job]() { job.start(); }, Qt::QueuedConnection);
+    app.exec();
+    return exitCode;
+}
+
 int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i)
+        if (qstrcmp(argv[i], "--separate-batch") == 0)
+            return runBatchSeparation(argc, argv);
 
 #ifdef __linux__
      // "wayland" has issues with Ubuntu 24.04  and below, we can force xcb
@@ -20,46 +20,40 @@ AudioAmplifier::AudioAmplifier(const QAudioFormat &format, QObject *parent)
     audioBuffer.reset(new QBuffer());
     playbackBuffer.reset(new QBuffer());
 
-    playbackFile.setFileName(extractedTmpPlayback);
-    if (playbackFile.isOpen())
-        playbackFile.close();
-    if (!playbackFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open playback file!";
-        return;
-    }
-    const QByteArray wavBytes = playbackFile.readAll();
-
-    // parseWavPcm() strips the RIFF/WAV container entirely — playbackData is
-    // pure PCM from here on. It used to keep the 44-byte header attached
-    // (even re-prepending a hand-patched one after resampling below), and
-    // since playbackData is handed straight to playbackBuffer/QAudioSink
-    // with no other decoding step, those header bytes were being played as
-    // an audible transient at the start of every backing track.
-    const PcmBuffer pcm = parseWavPcm(wavBytes);
-    if (!pcm.isValid()) {
+    // Mapped rather than read whole: when no resample is needed below,
+    // playbackData (and the QBuffer fed from it) points straight into the
+    // file. The view finds the "data" chunk by walking the RIFF structure —
+    // playbackData used to keep the 44-byte header attached (even
+    // re-prepending a hand-patched one after resampling below), and since
+    // playbackData is handed straight to playbackBuffer/QAudioSink with no
+    // other decoding step, those header bytes were being played as an
+    // audible transient at the start of every backing track.
+    playbackView = DecodedAudioStore::map(extractedTmpPlayback);
+    if (!playbackView.isValid()) {
         qWarning() << "AudioAmplifier: backing track is not a valid WAV file";
         return;
     }
+    const QAudioFormat pbFormat = playbackView.format();
 
     // The resample below reinterprets the raw bytes as int16_t and the mix
     // clamp in applyAmplification() hardcodes 16-bit range — both silently
     // produce garbage if either side isn't actually Int16. Skip the backing
     // track rather than feed noise into the sink; the vocal path (set up
     // below regardless) is unaffected.
-    const int pbCh      = pcm.format.channelCount();
-    const int pbRate     = pcm.format.sampleRate();
+    const int pbCh      = pbFormat.channelCount();
+    const int pbRate     = pbFormat.sampleRate();
     const int targetRate = audioFormat.sampleRate();
-    if (pcm.format.sampleFormat() != QAudioFormat::Int16 ||
+    if (pbFormat.sampleFormat() != QAudioFormat::Int16 ||
         audioFormat.sampleFormat() != QAudioFormat::Int16) {
         qWarning() << "AudioAmplifier: backing track/vocal PCM is not Int16 (backing:"
-                   << pcm.format.sampleFormat() << ", vocal:" << audioFormat.sampleFormat()
+                   << pbFormat.sampleFormat() << ", vocal:" << audioFormat.sampleFormat()
                    << ") — disabling backing playback";
     } else if (pbCh != audioFormat.channelCount()) {
         qWarning() << "AudioAmplifier: backing track channel count (" << pbCh
                    << ") does not match vocal format (" << audioFormat.channelCount()
                    << ") — disabling backing playback";
     } else {
-        playbackData = pcm.samples;
+        playbackData = playbackView.bytes();
 
         // Resample backing track if its rate doesn't match the vocal format
         // rate. Both streams go through the same QAudioSink; mismatched
@@ -11,6 +11,8 @@
 #include <QTimer>
 #include <QString>
 
+#include "decodedaudiostore.h"
+
 class AudioAmplifier : public QObject
 {
     Q_OBJECT
@@ -44,6 +46,7 @@ private:
     void emitVocalPreviewChunk();
 
     QAudioFormat audioFormat;
+    DecodedAudioStore::View playbackView;   // outlives everything that points into it
     QScopedPointer<QAudioSink> audioSink;
     QScopedPointer<QAudioSink> playbackSink;
     QScopedPointer<QTimer> dataPushTimer;
@@ -52,7 +55,6 @@ private:
     QByteArray originalAudioData;
     QByteArray amplifiedAudioData;
     QByteArray playbackData;
-    QFile playbackFile;
     double volumeFactor;
     qint64 playbackPosition;
     qint64 byteOffset = 0;
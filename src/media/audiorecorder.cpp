@@ -1,5 +1,5 @@
 #include "audiorecorder.h"
-#include "complexes.h"
+#include "wavfile.h"
 
 #include <QApplication>
 
@@ -1,9 +1,7 @@
 #include "audiovizmediaplayer.h"
 #include "audiovisualizerwidget.h"
 #include "complexes.h"
-#ifdef WAKKAQT_FFMPEG_NATIVE
-#include "ffmpegnative.h"
-#endif
+#include "decodedaudiostore.h"
 
 #include <QApplication>
 #include <QAudioFormat>
@@ -42,9 +40,8 @@ AudioVizMediaPlayer::~AudioVizMediaPlayer()
 
     m_visualizer_left->clear();
     m_visualizer_right->clear();
-    m_decodedAudioData->detach();
-    m_decodedAudioData->clear(); // Clear the audio data buffer
-    m_framePositions->detach();
+    m_decodedAudioData->clear(); // Clear the audio data buffer (before the mapping it points into)
+    m_playbackView = DecodedAudioStore::View();
     m_framePositions->clear();
 
     m_decodedAudioData.reset();
@@ -81,13 +78,11 @@ void AudioVizMediaPlayer::setMedia(const QString &source)
     //m_mediaPlayer->setSource(QUrl());
 
     // Reset the audio data
-    m_decodedAudioData->detach();  
     m_decodedAudioData->clear();  // Clear the audio buffer
-    m_framePositions->detach();    
+    m_playbackView = DecodedAudioStore::View();
     m_framePositions->clear();    // Clear frame positions
 
-    QString audioFile = extractedPlayback;
-    extractAudio(source, audioFile);
+    extractAudio(source);
 }
 
 void AudioVizMediaPlayer::play()
@@ -254,48 +249,66 @@ void AudioVizMediaPlayer::updateVisualizer()
 }
 
 
-void AudioVizMediaPlayer::extractAudio(const QString &source, const QString &outputFile)
+void AudioVizMediaPlayer::extractAudio(const QString &source)
 {
     connect(this, &AudioVizMediaPlayer::ffmpegExtractionFinished,
             this, &AudioVizMediaPlayer::loadAudioData, Qt::UniqueConnection);
 
 #ifdef WAKKAQT_FFMPEG_NATIVE
-    // Run natively in a background thread
+    // Decode natively in a background thread, into the shared store: a
+    // source loaded before is a hit, and the recorder reads the same entry
     QThread *thread = new QThread(this);
     connect(thread, &QThread::finished, thread, &QThread::deleteLater);
-    connect(thread, &QThread::started, this, [this, source, outputFile, thread]() {
-        const bool ok = FFmpegNative::extractAudio(source, outputFile);
-        if (!ok)
-            qWarning() << "FFmpegNative::extractAudio failed for" << source;
+    connect(thread, &QThread::started, this, [this, source, thread]() {
+        const DecodedAudioStore::View view = DecodedAudioStore::instance().open(source);
+        if (!view.isValid())
+            qWarning() << "AudioVizMediaPlayer: cannot decode the audio of" << source;
         else
-            emit ffmpegExtractionFinished(outputFile, source);
+            emit ffmpegExtractionFinished(view.path(), source);
         thread->quit();
     }, Qt::DirectConnection);
     thread->start();
 #else
+    // The ffmpeg CLI decodes into a staging file of the same store, so the
+    // entry is shared and pinned the same way as in a native build
+    const QString hit = DecodedAudioStore::instance().lookup(source);
+    if (!hit.isEmpty()) {
+        emit ffmpegExtractionFinished(hit, source);
+        return;
+    }
+    const QString outputFile = DecodedAudioStore::instance().stagingPathFor(source);
+    if (outputFile.isEmpty()) {
+        qWarning() << "Audio Visualizer cannot stage the audio of" << source;
+        return;
+    }
+
     QThread *ffmpegThread = new QThread(this);
     QProcess *ffmpegProcess = new QProcess();
     ffmpegProcess->moveToThread(ffmpegThread);
 
     connect(ffmpegProcess, &QProcess::finished,
             this, [ffmpegProcess, outputFile, source, this]() {
-        QFile file(outputFile);
-        if (!file.exists())
+        if (!QFile::exists(outputFile)) {
             qWarning() << "Audio Visualizer audio file was not created.";
-        else
-            emit ffmpegExtractionFinished(outputFile, source);
+        } else {
+            const DecodedAudioStore::View view = DecodedAudioStore::instance().insert(source, outputFile);
+            if (view.isValid())
+                emit ffmpegExtractionFinished(view.path(), source);
+        }
         ffmpegProcess->deleteLater();
     });
-    connect(ffmpegProcess, &QProcess::errorOccurred, this, [ffmpegProcess]() {
+    connect(ffmpegProcess, &QProcess::errorOccurred, this, [ffmpegProcess, outputFile]() {
         qWarning() << "FFmpeg process error occurred.";
+        QFile::remove(outputFile);
         ffmpegProcess->deleteLater();
     });
     connect(ffmpegThread, &QThread::finished, ffmpegThread, &QThread::deleteLater);
     connect(ffmpegThread, &QThread::started, [ffmpegProcess, source, outputFile]() {
+        // Stereo Int16 at the source's own rate, like the native decode
         QStringList args;
         args << "-threads" << "0" << "-y" << "-i" << source
              << "-vn" << "-ac" << "2"
-             << "-acodec" << "pcm_s16le" << "-ar" << "44100" << outputFile;
+             << "-acodec" << "pcm_s16le" << outputFile;
         ffmpegProcess->start("ffmpeg", args);
         if (!ffmpegProcess->waitForStarted())
             qWarning() << "Failed to start FFmpeg for Audio Visualizer.";
@@ -310,28 +323,20 @@ void AudioVizMediaPlayer::extractAudio(const QString &source, const QString &out
 
 void AudioVizMediaPlayer::loadAudioData(const QString &audioFile, const QString &sourceFile)
 {
-    QFile file(audioFile);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open audio file for reading.";
-        return;
-    }
-
-    const QByteArray wavBytes = file.readAll();
-    file.close();
-
-    // parseWavPcm() walks the actual RIFF chunk structure and returns pure
-    // PCM — m_decodedAudioData used to include the WAV header itself (read
-    // via a fixed 44-byte offset assumption), which shifted every
+    // Mapped, not read: m_decodedAudioData only points into the mapping.
+    // The view finds the "data" chunk by walking the actual RIFF chunk
+    // structure — m_decodedAudioData used to include the WAV header itself
+    // (read via a fixed 44-byte offset assumption), which shifted every
     // downstream byte-position calculation (m_framePositions, the
     // visualizer's chunk slicing) by those 44 bytes.
-    const PcmBuffer pcm = parseWavPcm(wavBytes);
-    if (!pcm.isValid()) {
+    m_decodedAudioData->clear();
+    m_playbackView = DecodedAudioStore::map(audioFile);
+    if (!m_playbackView.isValid()) {
         qWarning() << "AudioVizMediaPlayer: extracted playback audio is not a valid WAV file";
-        m_decodedAudioData->clear();
     } else {
-        *m_decodedAudioData = pcm.samples;
-        m_audioFormat.setSampleRate(pcm.format.sampleRate());
-        m_audioFormat.setChannelCount(pcm.format.channelCount());
+        *m_decodedAudioData = m_playbackView.bytes();
+        m_audioFormat.setSampleRate(m_playbackView.format().sampleRate());
+        m_audioFormat.setChannelCount(m_playbackView.format().channelCount());
     }
 
     m_framePositions->clear();  // Clear any previous data
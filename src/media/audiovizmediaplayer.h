@@ -9,6 +9,8 @@
 #include <QScopedPointer>
 #include <QByteArray>
 
+#include "decodedaudiostore.h"
+
 class AudioVisualizerWidget; // Forward declaration
 
 class AudioVizMediaPlayer : public QObject
@@ -26,12 +28,16 @@ public:
     void mute(bool toggle);
     void seek(qint64 position, bool seekPlayback);
 
+    // The current source's decoded audio; invalid until it is loaded.
+    // Holding a copy keeps the entry on disk under its path().
+    DecodedAudioStore::View playbackView() const { return m_playbackView; }
+
 signals:
     void ffmpegExtractionFinished(const QString &audioFile, const QString &sourceFile);
 
 private:
     void updateVisualizer();
-    void extractAudio(const QString &source, const QString &outputFile);
+    void extractAudio(const QString &source);
     void loadAudioData(const QString &audioFile, const QString &sourceFile);
     qint64 findClosestFramePosition(qint64 targetFrame);
 
@@ -46,7 +52,8 @@ private:
     qint64 m_audioPosition;
 
     QTimer *m_audioTimer;
-    QScopedPointer<QByteArray> m_decodedAudioData; // Store extracted audio data
+    DecodedAudioStore::View m_playbackView;        // Mapped extracted audio
+    QScopedPointer<QByteArray> m_decodedAudioData; // m_playbackView's samples, not a copy
     QScopedPointer<QVector<qint64>> m_framePositions; // Store frame positions
 
     bool is_Mute = false;
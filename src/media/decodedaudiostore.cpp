@@ -0,0 +1,218 @@
+#include "decodedaudiostore.h"
+#include "wavfile.h"
+#ifdef WAKKAQT_FFMPEG_NATIVE
+#include "ffmpegnative.h"
+#endif
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Every file a live View maps, by absolute path. evict() leaves these
+// alone, so a consumer that holds a View can also go on using its path.
+QMutex s_mappedMutex;
+QHash<QString, QList<std::weak_ptr<QFile>>> s_mapped;
+
+void registerMapping(const QString &path, const std::shared_ptr<QFile> &file)
+{
+    QMutexLocker lock(&s_mappedMutex);
+    s_mapped[QFileInfo(path).absoluteFilePath()].append(file);
+}
+
+bool isMapped(const QString &absolutePath)
+{
+    QMutexLocker lock(&s_mappedMutex);
+    auto it = s_mapped.find(absolutePath);
+    if (it == s_mapped.end())
+        return false;
+    it->removeIf([](const std::weak_ptr<QFile> &f) { return f.expired(); });
+    if (it->isEmpty()) {
+        s_mapped.erase(it);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+qint64 DecodedAudioStore::View::frames() const
+{
+    const int frameBytes = m_format.bytesPerFrame();
+    return frameBytes > 0 ? m_size / frameBytes : 0;
+}
+
+QByteArray DecodedAudioStore::View::bytes() const
+{
+    return QByteArray::fromRawData(m_data, m_size);
+}
+
+void DecodedAudioStore::View::releasePages(qint64 offset, qint64 bytes) const
+{
+#ifdef Q_OS_UNIX
+    // Both ends rounded down: a page the next read still needs part of
+    // stays, and goes with that read's release instead
+    static const quintptr page = quintptr(sysconf(_SC_PAGESIZE));
+    offset = qBound<qint64>(0, offset, m_size);
+    bytes  = qBound<qint64>(0, bytes, m_size - offset);
+    const quintptr from = quintptr(m_data + offset) & ~(page - 1);
+    const quintptr to   = quintptr(m_data + offset + bytes) & ~(page - 1);
+    if (m_file && to > from)
+        madvise(reinterpret_cast<void *>(from), to - from, MADV_DONTNEED);
+#else
+    Q_UNUSED(offset);
+    Q_UNUSED(bytes);
+#endif
+}
+
+// A staging sidecar an hour old belongs to a decode that crashed — a song
+// decodes in seconds
+DecodedAudioStore::DecodedAudioStore(const QString &root, qint64 maxBytes)
+    : m_dir(root, ".wav", maxBytes, 3600, kMaxAgeDays)
+    , m_floatDir(root + "/f32", ".wav", maxBytes, 3600, kMaxAgeDays) {}
+
+const CacheDirectory &DecodedAudioStore::dirFor(Precision precision) const
+{
+    return precision == Precision::Float ? m_floatDir : m_dir;
+}
+
+DecodedAudioStore &DecodedAudioStore::instance()
+{
+    static DecodedAudioStore store;
+    return store;
+}
+
+QString DecodedAudioStore::cacheRoot()
+{
+    // Same test-only override pattern as RenderVideoCache::cacheRoot()
+    const QString override = qEnvironmentVariable("WAKKAQT_DECODED_CACHE_OVERRIDE");
+    if (!override.isEmpty())
+        return override;
+    return QDir::homePath() + "/.WakkaQt/cache/decoded";
+}
+
+QString DecodedAudioStore::keyFor(const QString &source)
+{
+    const QFileInfo fi(source);
+    if (!fi.exists())
+        return {};
+    QCryptographicHash h(QCryptographicHash::Sha256);
+    h.addData(fi.absoluteFilePath().toUtf8());
+    h.addData(QByteArray(1, '\0'));
+    h.addData(QByteArray::number(fi.size()));
+    h.addData(QByteArray(1, '\0'));
+    h.addData(QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+    return QString::fromLatin1(h.result().toHex());
+}
+
+DecodedAudioStore::View DecodedAudioStore::map(const QString &wavPath)
+{
+    View view;
+    auto file = std::make_shared<QFile>(wavPath);
+    if (!file->open(QIODevice::ReadOnly) || file->size() <= 0)
+        return view;
+    const char *bytes = reinterpret_cast<const char *>(file->map(0, file->size()));
+    if (!bytes) {
+        qWarning() << "DecodedAudioStore: cannot map" << wavPath << "—" << file->errorString();
+        return view;
+    }
+    const WavLayout layout = parseWavLayout(bytes, file->size());
+    if (!layout.isValid()) {
+        qWarning() << "DecodedAudioStore:" << wavPath << "is not a PCM WAV file";
+        return view;
+    }
+    view.m_path   = wavPath;
+    view.m_format = layout.format;
+    view.m_data   = bytes + layout.dataOffset;
+    view.m_size   = layout.dataSize;
+    registerMapping(wavPath, file);
+    view.m_file   = std::move(file);
+    return view;
+}
+
+QString DecodedAudioStore::lookup(const QString &source, Precision precision)
+{
+    const CacheDirectory &dir = dirFor(precision);
+    const QString key = keyFor(source);
+    if (!dir.touch(key)) {
+        qInfo() << "[DecodedAudioStore] miss —" << source;
+        return {};
+    }
+    const QString path = dir.entryPath(key);
+    qInfo() << "[DecodedAudioStore] hit —" << path;
+    return path;
+}
+
+QString DecodedAudioStore::stagingPathFor(const QString &source, Precision precision) const
+{
+    return dirFor(precision).stagingPathFor(keyFor(source));
+}
+
+DecodedAudioStore::View DecodedAudioStore::insert(const QString &source, const QString &stagingPath,
+                                                  Precision precision)
+{
+    const CacheDirectory &dir = dirFor(precision);
+    const QString key = keyFor(source);
+    const QString err = dir.commit(key, stagingPath);
+    if (!err.isEmpty()) {
+        qWarning() << "DecodedAudioStore: cannot commit the decode of" << source << "—" << err;
+        return {};
+    }
+    const QString finalPath = dir.entryPath(key);
+    dir.evict(finalPath, isMapped);
+    return map(finalPath);
+}
+
+DecodedAudioStore::View DecodedAudioStore::open(const QString &source, Precision precision,
+                                                const std::atomic<bool> *cancelled)
+{
+    // Held across the decode: whoever waited on it finds the entry the
+    // first caller just committed
+    QMutexLocker lock(&m_decodeMutex);
+
+    // An entry of the wrong layout (e.g. copied in by hand) counts as
+    // unreadable
+    auto fits = [precision](const View &view) {
+        const QAudioFormat f = view.format();
+        if (precision == Precision::Int16)
+            return f.sampleFormat() == QAudioFormat::Int16;
+        return f.sampleFormat() == QAudioFormat::Float && f.sampleRate() == 44100
+            && f.channelCount() == 2;
+    };
+    const QString hit = lookup(source, precision);
+    if (!hit.isEmpty()) {
+        View view = map(hit);
+        if (view.isValid() && fits(view))
+            return view;
+        QFile::remove(hit);   // unreadable — decode it again below
+    }
+
+#ifdef WAKKAQT_FFMPEG_NATIVE
+    const QString staging = stagingPathFor(source, precision);
+    if (staging.isEmpty())
+        return {};
+    const bool decoded = precision == Precision::Float
+        ? FFmpegNative::extractFloatAudio(source, staging, cancelled)
+        : FFmpegNative::extractAudio(source, staging, 0, {}, cancelled);
+    if (!decoded) {
+        QFile::remove(staging);
+        return {};
+    }
+    return insert(source, staging, precision);
+#else
+    Q_UNUSED(cancelled);
+    qWarning() << "DecodedAudioStore: no native FFmpeg in this build to decode" << source;
+    return {};
+#endif
+}
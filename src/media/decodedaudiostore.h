@@ -0,0 +1,140 @@
+#ifndef DECODEDAUDIOSTORE_H
+#define DECODEDAUDIOSTORE_H
+
+#include "cachedirectory.h"
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+class QFile;
+
+// Each source decoded to PCM once, for every consumer that reads it.
+// Loading a source used to decode it for the visualizer, and the recorder
+// then copied that file for its AudioAmplifier, which read the copy whole;
+// renderVideo() decoded the backing track again for the mix, and
+// VocalSeparator decoded its input into memory on every run. Now
+// AudioVizMediaPlayer decodes it into this store when the source is
+// loaded and holds a read-only mapping of the entry (View); the recorder
+// takes a copy of that View for the take instead of a copy of the file,
+// and AudioAmplifier maps the same entry. renderVideo() and VocalSeparator
+// map the source's Float entry instead: the final mix and the separator's
+// input want full precision, not the 16-bit samples playback gets.
+//
+// An entry some View still maps is never evicted, so a holder can hand
+// its path on — to AudioAmplifier, to the library's session save — for as
+// long as it holds the View.
+//
+// One "<key>.wav" per source and precision, in a plain RIFF/WAVE container
+// so the rate and layout travel with the samples: Int16 stereo at the
+// source's own sample rate under ~/.WakkaQt/cache/decoded/, float32 stereo
+// at 44.1 kHz under its f32/ subdirectory. The key is the source's
+// identity — absolute path, size and modification time — the same way
+// RenderVideoCache keys its inputs. Same commit and eviction mechanics as
+// that cache, too (CacheDirectory), each precision its own directory under
+// its own maxBytes: written through a uniquely named sibling, moved into
+// place with commitPartialOverFinal(), LRU by mtime refreshed on every
+// hit, entries unused for kMaxAgeDays dropped on the next insert.
+class DecodedAudioStore
+{
+public:
+    static constexpr qint64 kDefaultMaxBytes = qint64(2) << 30;
+    static constexpr int    kMaxAgeDays      = 14;
+
+    enum class Precision {
+        Int16,   // the source's rate — playback, the take, AudioAmplifier
+        Float    // 44.1 kHz — renderVideo()'s mix, VocalSeparator's input
+    };
+
+    // A read-only mapping of one decoded WAV's samples. Copies share the
+    // mapping, which lives until the last of them goes; until then the
+    // store leaves the file where it is.
+    class View
+    {
+    public:
+        bool isValid() const { return m_file != nullptr; }
+        QString path() const { return m_path; }
+        QAudioFormat format() const { return m_format; }
+
+        // Interleaved samples, `size()` bytes of them
+        const char *data() const { return m_data; }
+        qint64 size() const { return m_size; }
+        qint64 frames() const;
+
+        // The samples as a QByteArray that doesn't own them: valid only
+        // while this View (or a copy of it) is alive, and never detach()ed
+        // into a private copy unless written to.
+        QByteArray bytes() const;
+
+        // Hints that [offset, offset + bytes) of data() won't be read again
+        // soon, so a pass streaming through a long entry doesn't leave all
+        // of it resident. Harmless to other holders: the pages are read back
+        // from the file when touched. Only whole pages go; a no-op where the
+        // platform has no madvise().
+        void releasePages(qint64 offset, qint64 bytes) const;
+
+    private:
+        friend class DecodedAudioStore;
+        std::shared_ptr<QFile> m_file;
+        QString      m_path;
+        QAudioFormat m_format;
+        const char  *m_data = nullptr;
+        qint64       m_size = 0;
+    };
+
+    explicit DecodedAudioStore(const QString &root = cacheRoot(),
+                               qint64 maxBytes = kDefaultMaxBytes);
+
+    // The process-wide store under cacheRoot()
+    static DecodedAudioStore &instance();
+
+    // ~/.WakkaQt/cache/decoded (or WAKKAQT_DECODED_CACHE_OVERRIDE)
+    static QString cacheRoot();
+
+    // Empty if source doesn't exist
+    static QString keyFor(const QString &source);
+
+    // Maps any uncompressed PCM/IEEE-float WAV file; invalid if it isn't one
+    // or can't be opened.
+    static View map(const QString &wavPath);
+
+    // Source's entry of that precision, decoding it first on a miss (and
+    // that only in a WAKKAQT_FFMPEG_NATIVE build). Decodes are serialized,
+    // so two callers asking for the same source at once decode it once.
+    // Invalid if the source can't be decoded or `cancelled` is set on the
+    // way.
+    View open(const QString &source, Precision precision = Precision::Int16,
+              const std::atomic<bool> *cancelled = nullptr);
+
+    // Where a decoder outside this class (the ffmpeg CLI, in a build without
+    // WAKKAQT_FFMPEG_NATIVE) writes source's entry-to-be, for insert() to
+    // commit. Empty if source doesn't exist or the directory can't be made.
+    QString stagingPathFor(const QString &source, Precision precision = Precision::Int16) const;
+
+    // Commits the WAV at stagingPath as source's entry, evicts, and maps
+    // it. Invalid if the commit fails; either way stagingPath is gone.
+    View insert(const QString &source, const QString &stagingPath,
+                Precision precision = Precision::Int16);
+
+    // The path of source's entry on a hit, marked most recently used; empty
+    // on a miss — never decodes.
+    QString lookup(const QString &source, Precision precision = Precision::Int16);
+
+    // Both precisions together; maxBytes() caps each of them
+    qint64 sizeBytes() const { return m_dir.sizeBytes() + m_floatDir.sizeBytes(); }
+    qint64 maxBytes() const { return m_dir.maxBytes(); }
+
+private:
+    const CacheDirectory &dirFor(Precision precision) const;
+
+    CacheDirectory m_dir;
+    CacheDirectory m_floatDir;
+    QMutex         m_decodeMutex;
+};
+
+#endif // DECODEDAUDIOSTORE_H
@@ -1,7 +1,10 @@
 #ifdef WAKKAQT_FFMPEG_NATIVE
 
 #include "ffmpegnative.h"
-#include "complexes.h"
+#include "decodedaudiostore.h"
+#include "wavfile.h"
+#include "pitchdetector.h"
+#include "pitchtrack.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -12,22 +15,34 @@ extern "C" {
 #include <libavutil/opt.h>
 #include <libavutil/channel_layout.h>
 #include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
 #include <libavutil/audio_fifo.h>
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
 }
 
 #include <QByteArray>
+#include <QVector>
 #include <QFile>
 #include <QFileInfo>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
 #include <clocale>
 #include <QDebug>
 #include <algorithm>
 #include <vector>
+#include <deque>
+#include <utility>
 #include <cstring>
 #include <cmath>
 #include <string>
 #include <mutex>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <thread>
+#include <future>
+#include <chrono>
 
 namespace FFmpegNative {
 
@@ -108,133 +123,269 @@ bool hasVideoStream(const QString &filePath)
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-// extractAudio — decode + resample to 44100 Hz / stereo or mono / Int16 WAV
+// AudioReader
 // ─────────────────────────────────────────────────────────────────────────────
 
-bool extractAudio(const QString &input, const QString &output,
-                  qint64 offsetMs, const QString &filterStr,
-                  const std::atomic<bool> *cancelled)
-{
-    AVFormatContext *fmtCtx = nullptr;
-    if (avformat_open_input(&fmtCtx, input.toUtf8().constData(), nullptr, nullptr) < 0) {
-        qWarning() << "FFmpegNative::extractAudio: cannot open" << input;
-        return false;
+struct AudioReader::Impl {
+    AVFormatContext *fmt = nullptr;
+    AVCodecContext  *ctx = nullptr;
+    SwrContext      *swr = nullptr;
+    AVPacket        *pkt = nullptr;
+    AVFrame         *frm = nullptr;
+    int            streamIdx  = -1;
+    int            outRate    = 0;
+    int            outCh      = 0;
+    AVSampleFormat outFmt     = AV_SAMPLE_FMT_NONE;
+    int            frameBytes = 0;
+    qint64 startMs = 0;
+    qint64 silence = 0;    // output frames of leading silence still to emit
+    qint64 skipOut = 0;    // output frames still to drop, where the seek failed
+    qint64 trimTo  = -1;   // source sample the seek aimed at; -1 once reached
+    qint64 srcPos  = -1;   // source sample of the next decoded frame; -1 until known
+    std::vector<uint8_t> pending;           // converted output the caller had no room for
+    size_t pendingPos = 0;
+    std::vector<const uint8_t *> planes;    // the trimmed frame's plane pointers
+    bool eof = false, flushed = false;
+
+    ~Impl()
+    {
+        av_frame_free(&frm);
+        av_packet_free(&pkt);
+        swr_free(&swr);
+        avcodec_free_context(&ctx);
+        avformat_close_input(&fmt);
     }
-    avformat_find_stream_info(fmtCtx, nullptr);
 
-    const int audioIdx = av_find_best_stream(fmtCtx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-    if (audioIdx < 0) {
-        qWarning() << "FFmpegNative::extractAudio: no audio stream in" << input;
-        avformat_close_input(&fmtCtx);
-        return false;
+    bool open(const QString &path, const Format &format, qint64 startAtMs)
+    {
+        if (avformat_open_input(&fmt, path.toUtf8().constData(), nullptr, nullptr) < 0)
+            return false;
+        avformat_find_stream_info(fmt, nullptr);
+        streamIdx = av_find_best_stream(fmt, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (streamIdx < 0)
+            return false;
+        const AVStream *st = fmt->streams[streamIdx];
+        const AVCodec *dec = avcodec_find_decoder(st->codecpar->codec_id);
+        if (!dec)
+            return false;
+        ctx = avcodec_alloc_context3(dec);
+        if (!ctx || avcodec_parameters_to_context(ctx, st->codecpar) < 0
+            || avcodec_open2(ctx, dec, nullptr) < 0)
+            return false;
+
+        outRate = format.sampleRate > 0 ? format.sampleRate
+                : ctx->sample_rate > 0  ? ctx->sample_rate : 44100;
+        outCh   = format.channels == 1 ? 1 : 2;
+        outFmt  = format.sampleFormat == SampleFormat::Int16 ? AV_SAMPLE_FMT_S16 : AV_SAMPLE_FMT_FLT;
+        frameBytes = outCh * av_get_bytes_per_sample(outFmt);
+
+        AVChannelLayout srcCL, dstCL;
+        av_channel_layout_copy(&srcCL, &ctx->ch_layout);
+        if (srcCL.nb_channels == 0)
+            av_channel_layout_default(&srcCL, std::max(1, st->codecpar->ch_layout.nb_channels));
+        av_channel_layout_from_mask(&dstCL, outCh == 1 ? AV_CH_LAYOUT_MONO : AV_CH_LAYOUT_STEREO);
+        swr_alloc_set_opts2(&swr, &dstCL, outFmt, outRate,
+                            &srcCL, ctx->sample_fmt, ctx->sample_rate, 0, nullptr);
+        av_channel_layout_uninit(&srcCL);
+        av_channel_layout_uninit(&dstCL);
+        pkt = av_packet_alloc();
+        frm = av_frame_alloc();
+        if (!swr || swr_init(swr) < 0 || !pkt || !frm) {
+            swr_free(&swr);   // isOpen() is swr != nullptr
+            return false;
+        }
+
+        startMs = startAtMs;
+        if (startMs < 0)
+            silence = -startMs * outRate / 1000;
+        else if (startMs > 0)
+            seek(startMs);
+        return true;
     }
 
-    AVStream *audioStream = fmtCtx->streams[audioIdx];
-    const AVCodec *dec = avcodec_find_decoder(audioStream->codecpar->codec_id);
-    if (!dec) { avformat_close_input(&fmtCtx); return false; }
+    // To just before ms, for convertFrame() to trim the rest of the way.
+    // Where the container can't seek, decodes from 0 and drops output.
+    void seek(qint64 ms)
+    {
+        const AVStream *st = fmt->streams[streamIdx];
+        const int64_t origin = st->start_time != AV_NOPTS_VALUE ? st->start_time : 0;
+        const int64_t ts = origin + av_rescale_q(ms, AVRational{1, 1000}, st->time_base);
+        if (ctx->sample_rate > 0 && av_seek_frame(fmt, streamIdx, ts, AVSEEK_FLAG_BACKWARD) >= 0) {
+            avcodec_flush_buffers(ctx);
+            trimTo = ms * ctx->sample_rate / 1000;
+        } else {
+            skipOut = ms * outRate / 1000;
+        }
+    }
 
-    AVCodecContext *decCtx = avcodec_alloc_context3(dec);
-    avcodec_parameters_to_context(decCtx, audioStream->codecpar);
-    if (avcodec_open2(decCtx, dec, nullptr) < 0) {
-        avcodec_free_context(&decCtx);
-        avformat_close_input(&fmtCtx);
-        return false;
+    // Resamples nb source samples (data null: the resampler's tail) into
+    // dst when all of it is sure to fit in `room` frames, into `pending`
+    // otherwise. Returns the frames that went to dst.
+    int convert(const uint8_t **data, int nb, uint8_t *dst, int room)
+    {
+        const int maxOut = swr_get_out_samples(swr, nb);
+        if (maxOut <= 0)
+            return 0;
+        const bool direct = maxOut <= room && skipOut == 0;
+        uint8_t *out = dst;
+        if (!direct) {
+            pending.resize(size_t(maxOut) * frameBytes);   // within capacity after the first few
+            out = pending.data();
+        }
+        const int got = std::max(0, swr_convert(swr, &out, maxOut, data, nb));
+        if (direct)
+            return got;
+        const int skipped = int(std::min<qint64>(skipOut, got));
+        skipOut -= skipped;
+        pending.resize(size_t(got) * frameBytes);
+        pendingPos = size_t(skipped) * frameBytes;
+        return 0;
+    }
+
+    // convert() for the frame in frm, less whatever of it precedes the
+    // seek target
+    int convertFrame(uint8_t *dst, int room)
+    {
+        const uint8_t **data = const_cast<const uint8_t **>(frm->extended_data);
+        int nb = frm->nb_samples;
+        if (trimTo >= 0) {
+            if (srcPos < 0) {
+                const AVStream *st = fmt->streams[streamIdx];
+                const int64_t pts = frm->best_effort_timestamp;
+                const int64_t origin = st->start_time != AV_NOPTS_VALUE ? st->start_time : 0;
+                srcPos = (pts == AV_NOPTS_VALUE) ? trimTo
+                       : av_rescale_q(pts - origin, st->time_base, AVRational{1, ctx->sample_rate});
+            }
+            const int drop = int(std::clamp<qint64>(trimTo - srcPos, 0, nb));
+            srcPos += nb;
+            if (srcPos >= trimTo)
+                trimTo = -1;
+            if (drop == nb)
+                return 0;
+            if (drop > 0) {
+                const AVSampleFormat sf = AVSampleFormat(frm->format);
+                const bool planar = av_sample_fmt_is_planar(sf);
+                const int nch = frm->ch_layout.nb_channels;
+                planes.assign(data, data + (planar ? nch : 1));
+                for (const uint8_t *&plane : planes)
+                    plane += size_t(drop) * av_get_bytes_per_sample(sf) * (planar ? 1 : nch);
+                data = planes.data();
+                nb  -= drop;
+            }
+        }
+        return convert(data, nb, dst, room);
     }
 
-    const bool wantMono = filterStr.contains("mono", Qt::CaseInsensitive);
-    // Preserve the source sample rate so the VocalEnhancer pipeline runs at native
-    // quality. Callers that mix multiple streams handle resampling themselves.
-    const int   outRate  = (decCtx->sample_rate > 0) ? decCtx->sample_rate : 44100;
-    const int   outCh    = wantMono ? 1 : 2;
-    const uint64_t outMask = wantMono ? AV_CH_LAYOUT_MONO : AV_CH_LAYOUT_STEREO;
-
-    SwrContext *swr = nullptr;
-    AVChannelLayout inCL, outCL;
-    av_channel_layout_copy(&inCL, &decCtx->ch_layout);
-    if (inCL.nb_channels == 0)
-        av_channel_layout_default(&inCL, std::max(1, (int)audioStream->codecpar->ch_layout.nb_channels));
-    av_channel_layout_from_mask(&outCL, outMask);
-
-    if (swr_alloc_set_opts2(&swr, &outCL, AV_SAMPLE_FMT_S16, outRate,
-                             &inCL, decCtx->sample_fmt, decCtx->sample_rate,
-                             0, nullptr) < 0 || swr_init(swr) < 0) {
-        qWarning() << "FFmpegNative::extractAudio: swr_init failed";
-        av_channel_layout_uninit(&inCL);
-        av_channel_layout_uninit(&outCL);
-        avcodec_free_context(&decCtx);
-        avformat_close_input(&fmtCtx);
-        return false;
+    // Decodes the next frame into dst (see convert()). Returns the frames
+    // written to dst, possibly 0, or -1 once decoder and resampler are
+    // both drained.
+    int decodeInto(uint8_t *dst, int room)
+    {
+        for (;;) {
+            if (flushed)
+                return -1;
+            if (avcodec_receive_frame(ctx, frm) == 0) {
+                const int got = convertFrame(dst, room);
+                av_frame_unref(frm);
+                return got;
+            }
+            if (eof) {
+                flushed = true;
+                return convert(nullptr, 0, dst, room);
+            }
+            if (av_read_frame(fmt, pkt) < 0) {
+                avcodec_send_packet(ctx, nullptr);   // drain the decoder
+                eof = true;
+                continue;
+            }
+            if (pkt->stream_index == streamIdx)
+                avcodec_send_packet(ctx, pkt);
+            av_packet_unref(pkt);
+        }
     }
-    av_channel_layout_uninit(&inCL);
-    av_channel_layout_uninit(&outCL);
+};
 
-    QByteArray pcmData;
-    pcmData.reserve(outRate * outCh * sizeof(int16_t) * 60);
+AudioReader::AudioReader(const QString &path, const Format &format, qint64 startMs)
+    : d(new Impl)
+{
+    d->open(path, format, startMs);
+}
 
-    const qint64 skipSamples = offsetMs > 0 ? offsetMs * outRate / 1000 : 0;
-    qint64 totalSamples = 0;
+AudioReader::~AudioReader() = default;
 
-    AVPacket *pkt   = av_packet_alloc();
-    AVFrame  *frame = av_frame_alloc();
+bool AudioReader::isOpen() const   { return d->swr != nullptr; }
+int AudioReader::sampleRate() const  { return d->outRate; }
+int AudioReader::channels() const    { return d->outCh; }
+int AudioReader::bytesPerFrame() const { return d->frameBytes; }
 
-    bool wasCancelled = false;
-    while (av_read_frame(fmtCtx, pkt) >= 0) {
-        if (cancelled && cancelled->load()) { wasCancelled = true; av_packet_unref(pkt); break; }
-        if (pkt->stream_index != audioIdx) { av_packet_unref(pkt); continue; }
-        if (avcodec_send_packet(decCtx, pkt) < 0)  { av_packet_unref(pkt); continue; }
-        av_packet_unref(pkt);
+double AudioReader::durationSec() const
+{
+    if (!isOpen() || d->fmt->duration == AV_NOPTS_VALUE || d->fmt->duration <= 0)
+        return 0.0;
+    return std::max(0.0, double(d->fmt->duration) / AV_TIME_BASE - d->startMs / 1000.0);
+}
 
-        while (avcodec_receive_frame(decCtx, frame) == 0) {
-            const int outN = (int)av_rescale_rnd(
-                swr_get_delay(swr, decCtx->sample_rate) + frame->nb_samples,
-                outRate, decCtx->sample_rate, AV_ROUND_UP);
-            std::vector<uint8_t> tmp(outN * outCh * sizeof(int16_t));
-            uint8_t *ptr = tmp.data();
-            const int got = swr_convert(swr, &ptr, outN,
-                                        (const uint8_t**)frame->data, frame->nb_samples);
-            if (got > 0) {
-                const int bytes = got * outCh * (int)sizeof(int16_t);
-                if (totalSamples + got > skipSamples) {
-                    const qint64 skipLocal = std::max<qint64>(0, skipSamples - totalSamples);
-                    const int skipBytes = (int)skipLocal * outCh * (int)sizeof(int16_t);
-                    pcmData.append(reinterpret_cast<const char*>(ptr + skipBytes),
-                                   bytes - skipBytes);
-                }
-                totalSamples += got;
-            }
-            av_frame_unref(frame);
+int AudioReader::read(void *dst, int frames)
+{
+    if (!isOpen() || frames <= 0)
+        return 0;
+    uint8_t *out = static_cast<uint8_t *>(dst);
+    const size_t fb = size_t(d->frameBytes);
+
+    // Silence is all-zero bytes in both output formats
+    int done = int(std::min<qint64>(d->silence, frames));
+    memset(out, 0, done * fb);
+    d->silence -= done;
+
+    while (done < frames) {
+        const size_t avail = (d->pending.size() - d->pendingPos) / fb;
+        if (avail > 0) {
+            const int n = int(std::min<size_t>(avail, size_t(frames - done)));
+            memcpy(out + done * fb, d->pending.data() + d->pendingPos, n * fb);
+            d->pendingPos += n * fb;
+            done += n;
+            continue;
         }
+        const int got = d->decodeInto(out + done * fb, frames - done);
+        if (got < 0)
+            break;
+        done += got;
     }
-    // Flush resampler (skipped on cancellation — the output would be discarded anyway)
-    if (!wasCancelled) {
-        const int outN = (int)swr_get_delay(swr, outRate) + 1024;
-        std::vector<uint8_t> tmp(outN * outCh * sizeof(int16_t));
-        uint8_t *ptr = tmp.data();
-        const int got = swr_convert(swr, &ptr, outN, nullptr, 0);
-        if (got > 0)
-            pcmData.append(reinterpret_cast<const char*>(ptr),
-                           got * outCh * (int)sizeof(int16_t));
-    }
+    return done;
+}
 
-    av_frame_free(&frame);
-    av_packet_free(&pkt);
-    swr_free(&swr);
-    avcodec_free_context(&decCtx);
-    avformat_close_input(&fmtCtx);
+// ─────────────────────────────────────────────────────────────────────────────
+// extractAudio — decode + resample to 44100 Hz / stereo or mono / Int16 WAV
+// ─────────────────────────────────────────────────────────────────────────────
 
-    if (wasCancelled) {
-        qDebug() << "FFmpegNative::extractAudio: cancelled for" << input;
+bool extractAudio(const QString &input, const QString &output,
+                  qint64 offsetMs, const QString &filterStr,
+                  const std::atomic<bool> *cancelled)
+{
+    // Preserve the source sample rate so the VocalEnhancer pipeline runs at native
+    // quality. Callers that mix multiple streams handle resampling themselves.
+    AudioReader::Format format;
+    format.sampleRate   = 0;
+    format.channels     = filterStr.contains("mono", Qt::CaseInsensitive) ? 1 : 2;
+    format.sampleFormat = AudioReader::SampleFormat::Int16;
+    AudioReader reader(input, format, std::max<qint64>(0, offsetMs));
+    if (!reader.isOpen()) {
+        qWarning() << "FFmpegNative::extractAudio: cannot open an audio stream in" << input;
         return false;
     }
 
-    if (pcmData.isEmpty()) {
-        qWarning() << "FFmpegNative::extractAudio: empty PCM for" << input;
+    QByteArray pcmData;
+    if (!reader.readAll(pcmData, cancelled)) {
+        if (cancelled && cancelled->load())
+            qDebug() << "FFmpegNative::extractAudio: cancelled for" << input;
+        else
+            qWarning() << "FFmpegNative::extractAudio: empty PCM for" << input;
         return false;
     }
 
     QAudioFormat afmt;
-    afmt.setSampleRate(outRate);
-    afmt.setChannelCount(outCh);
+    afmt.setSampleRate(reader.sampleRate());
+    afmt.setChannelCount(reader.channels());
     afmt.setSampleFormat(QAudioFormat::Int16);
 
     QFile outFile(output);
@@ -248,90 +399,83 @@ bool extractAudio(const QString &input, const QString &output,
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-// renderVideo helpers
+// extractFloatAudio — decode + resample to 44100 Hz / stereo / float32 WAV
 // ─────────────────────────────────────────────────────────────────────────────
 
-// Decode entire audio track to float PCM (44100 Hz, stereo).
-// Applies volume, and if offsetMs > 0, skips that many ms from the start.
-// If offsetMs < 0, the caller should prepend silence after the fact.
-static QVector<float> decodeAudioToFloat(const QString &path, qint64 offsetMs, double volume,
-                                         const std::atomic<bool> *cancelled = nullptr)
+bool extractFloatAudio(const QString &input, const QString &output,
+                       const std::atomic<bool> *cancelled)
 {
-    AVFormatContext *fmt = nullptr;
-    if (avformat_open_input(&fmt, path.toUtf8().constData(), nullptr, nullptr) < 0)
-        return {};
-    avformat_find_stream_info(fmt, nullptr);
-
-    const int audioIdx = av_find_best_stream(fmt, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-    if (audioIdx < 0) { avformat_close_input(&fmt); return {}; }
-
-    const AVCodec *dec = avcodec_find_decoder(fmt->streams[audioIdx]->codecpar->codec_id);
-    if (!dec) { avformat_close_input(&fmt); return {}; }
-    AVCodecContext *ctx = avcodec_alloc_context3(dec);
-    avcodec_parameters_to_context(ctx, fmt->streams[audioIdx]->codecpar);
-    avcodec_open2(ctx, dec, nullptr);
-
-    SwrContext *swr = nullptr;
-    AVChannelLayout srcCL, dstCL;
-    av_channel_layout_copy(&srcCL, &ctx->ch_layout);
-    if (srcCL.nb_channels == 0) av_channel_layout_default(&srcCL, 1);
-    av_channel_layout_from_mask(&dstCL, AV_CH_LAYOUT_STEREO);
-    swr_alloc_set_opts2(&swr, &dstCL, AV_SAMPLE_FMT_FLT, 44100,
-                         &srcCL, ctx->sample_fmt, ctx->sample_rate, 0, nullptr);
-    swr_init(swr);
-    av_channel_layout_uninit(&srcCL);
-    av_channel_layout_uninit(&dstCL);
-
-    const qint64 skipSamples = (offsetMs > 0) ? offsetMs * 44100 / 1000 : 0;
-    qint64 totalSamples = 0;
-    QVector<float> pcm;
-    pcm.reserve(44100 * 2 * 60);
+    AudioReader reader(input, AudioReader::Format{});
+    if (!reader.isOpen()) {
+        qWarning() << "FFmpegNative::extractFloatAudio: cannot open an audio stream in" << input;
+        return false;
+    }
 
-    AVPacket *pkt = av_packet_alloc();
-    AVFrame  *frm = av_frame_alloc();
+    QAudioFormat afmt;
+    afmt.setSampleRate(reader.sampleRate());
+    afmt.setChannelCount(reader.channels());
+    afmt.setSampleFormat(QAudioFormat::Float);
 
-    bool wasCancelled = false;
-    while (av_read_frame(fmt, pkt) >= 0) {
-        if (cancelled && cancelled->load()) { wasCancelled = true; av_packet_unref(pkt); break; }
-        if (pkt->stream_index != audioIdx) { av_packet_unref(pkt); continue; }
-        if (avcodec_send_packet(ctx, pkt) < 0) { av_packet_unref(pkt); continue; }
-        av_packet_unref(pkt);
+    QFile outFile(output);
+    if (!outFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "FFmpegNative::extractFloatAudio: cannot write" << output;
+        return false;
+    }
+    // Placeholder sizes, patched below once the length is known — the same
+    // 44-byte layout AudioRecorder streams a take behind
+    writeWavHeader(outFile, afmt, 0, QByteArray());
 
-        while (avcodec_receive_frame(ctx, frm) == 0) {
-            const int outN = (int)av_rescale_rnd(
-                swr_get_delay(swr, ctx->sample_rate) + frm->nb_samples,
-                44100, ctx->sample_rate, AV_ROUND_UP);
-            QVector<float> tmp(outN * 2);
-            uint8_t *ptr = reinterpret_cast<uint8_t*>(tmp.data());
-            const int got = swr_convert(swr, &ptr, outN,
-                                        (const uint8_t**)frm->data, frm->nb_samples);
-            if (got > 0) {
-                const int startIdx = (totalSamples < skipSamples)
-                    ? (int)std::min<qint64>(skipSamples - totalSamples, got) * 2 : 0;
-                for (int i = startIdx; i < got * 2; ++i)
-                    pcm.append(tmp[i] * float(volume));
-                totalSamples += got;
-            }
-            av_frame_unref(frm);
+    constexpr int kBlock = 65536;   // frames per read(): the cancellation granularity
+    std::vector<float> block(size_t(kBlock) * reader.channels());
+    qint64 dataSize = 0;
+    for (;;) {
+        if (cancelled && cancelled->load()) {
+            qDebug() << "FFmpegNative::extractFloatAudio: cancelled for" << input;
+            return false;
         }
+        const int got = reader.read(block.data(), kBlock);
+        if (got == 0)
+            break;
+        const qint64 bytes = qint64(got) * reader.bytesPerFrame();
+        if (outFile.write(reinterpret_cast<const char *>(block.data()), bytes) != bytes) {
+            qWarning() << "FFmpegNative::extractFloatAudio: cannot write" << output << outFile.errorString();
+            return false;
+        }
+        dataSize += bytes;
     }
-    // Flush (skipped on cancellation — the caller only wants a clean bail-out)
-    if (!wasCancelled) {
-        const int outN = (int)swr_get_delay(swr, 44100) + 1024;
-        QVector<float> tmp(outN * 2);
-        uint8_t *ptr = reinterpret_cast<uint8_t*>(tmp.data());
-        const int got = swr_convert(swr, &ptr, outN, nullptr, 0);
-        if (got > 0)
-            for (int i = 0; i < got * 2; ++i)
-                pcm.append(tmp[i] * float(volume));
+    if (dataSize == 0) {
+        qWarning() << "FFmpegNative::extractFloatAudio: empty PCM for" << input;
+        return false;
+    }
+    if (dataSize > qint64(0xFFFFFFFFu) - 36) {   // past what a RIFF size field holds
+        qWarning() << "FFmpegNative::extractFloatAudio:" << input << "is too long for a WAV file";
+        return false;
     }
 
-    av_frame_free(&frm);
-    av_packet_free(&pkt);
-    swr_free(&swr);
-    avcodec_free_context(&ctx);
-    avformat_close_input(&fmt);
-    return wasCancelled ? QVector<float>{} : pcm;
+    const quint32 chunkSize     = quint32(dataSize + 36);
+    const quint32 subchunk2Size = quint32(dataSize);
+    if (!outFile.seek(4)
+        || outFile.write(reinterpret_cast<const char *>(&chunkSize), sizeof(chunkSize)) != sizeof(chunkSize)
+        || !outFile.seek(40)
+        || outFile.write(reinterpret_cast<const char *>(&subchunk2Size), sizeof(subchunk2Size)) != sizeof(subchunk2Size)) {
+        qWarning() << "FFmpegNative::extractFloatAudio: cannot finish" << output << outFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// renderVideo helpers
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Decode entire audio track to float PCM (44100 Hz, stereo). Empty on
+// failure or once `cancelled` is set.
+static QVector<float> decodeAudioToFloat(const QString &path,
+                                         const std::atomic<bool> *cancelled = nullptr)
+{
+    QVector<float> pcm;
+    AudioReader(path, AudioReader::Format{}).readAll(pcm, cancelled);
+    return pcm;
 }
 
 // Apply an avfilter chain (e.g. "deesser,speechnorm,...") to float stereo 44100 PCM.
@@ -611,122 +755,49 @@ static void drawGlyph(AVFrame *f, int x, int y, char c,
     }
 }
 
-static double yinDetect(const float *samples, int n, int sampleRate)
-{
-    const int W = std::min(n / 2, 512);
-    if (W < 32) return -1.0;
-
-    std::vector<double> d(W, 0.0);
-    for (int tau = 1; tau < W; ++tau)
-        for (int j = 0; j < W; ++j) {
-            const double diff = samples[j] - samples[j + tau];
-            d[tau] += diff * diff;
-        }
-
-    std::vector<double> cmnd(W);
-    cmnd[0] = 1.0;
-    double runSum = 0.0;
-    for (int tau = 1; tau < W; ++tau) {
-        runSum += d[tau];
-        cmnd[tau] = (runSum > 0.0) ? d[tau] * tau / runSum : 1.0;
-    }
-
-    const double thresh = 0.10;
-    for (int tau = 2; tau < W - 1; ++tau) {
-        if (cmnd[tau] < thresh && cmnd[tau] <= cmnd[tau-1] && cmnd[tau] <= cmnd[tau+1]) {
-            const double s0 = cmnd[tau-1], s1 = cmnd[tau], s2 = cmnd[tau+1];
-            const double denom = 2.0 * s1 - s0 - s2;
-            const double adj = (denom != 0.0) ? 0.5 * (s2 - s0) / denom : 0.0;
-            const double tauF = tau + adj;
-            if (tauF > 0.5) return double(sampleRate) / tauF;
-            break;
-        }
-    }
-    return -1.0;
-}
-
-static QVector<PitchPoint> analyzePitch(const QString &audioPath)
+// The overlay's own analysis of a recording, for when the enhancer's isn't
+// available (see pitchPointsFromSidecar()). Gives up, returning nothing, once
+// `cancelled` is set.
+static QVector<PitchPoint> analyzePitch(const QString &audioPath,
+                                        const std::atomic<bool> *cancelled)
 {
-    AVFormatContext *fmt = nullptr;
-    if (avformat_open_input(&fmt, audioPath.toUtf8().constData(), nullptr, nullptr) < 0)
-        return {};
-    avformat_find_stream_info(fmt, nullptr);
-
-    const int audioIdx = av_find_best_stream(fmt, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-    if (audioIdx < 0) { avformat_close_input(&fmt); return {}; }
-
-    const AVCodec *dec = avcodec_find_decoder(fmt->streams[audioIdx]->codecpar->codec_id);
-    if (!dec) { avformat_close_input(&fmt); return {}; }
-    AVCodecContext *ctx = avcodec_alloc_context3(dec);
-    avcodec_parameters_to_context(ctx, fmt->streams[audioIdx]->codecpar);
-    avcodec_open2(ctx, dec, nullptr);
-
-    SwrContext *swr = nullptr;
-    AVChannelLayout srcCL, dstCL;
-    av_channel_layout_copy(&srcCL, &ctx->ch_layout);
-    if (srcCL.nb_channels == 0) av_channel_layout_default(&srcCL, 1);
-    av_channel_layout_default(&dstCL, 1); // mono output
-    swr_alloc_set_opts2(&swr, &dstCL, AV_SAMPLE_FMT_FLT, 44100,
-                         &srcCL, ctx->sample_fmt, ctx->sample_rate, 0, nullptr);
-    swr_init(swr);
-    av_channel_layout_uninit(&srcCL);
-    av_channel_layout_uninit(&dstCL);
-
+    AudioReader::Format format;
+    format.channels = 1;
     QVector<float> mono;
-    mono.reserve(44100 * 60);
-
-    AVPacket *pkt = av_packet_alloc();
-    AVFrame  *frm = av_frame_alloc();
-    while (av_read_frame(fmt, pkt) >= 0) {
-        if (pkt->stream_index != audioIdx) { av_packet_unref(pkt); continue; }
-        if (avcodec_send_packet(ctx, pkt) < 0) { av_packet_unref(pkt); continue; }
-        av_packet_unref(pkt);
-        while (avcodec_receive_frame(ctx, frm) == 0) {
-            const int outN = (int)av_rescale_rnd(
-                swr_get_delay(swr, ctx->sample_rate) + frm->nb_samples,
-                44100, ctx->sample_rate, AV_ROUND_UP);
-            QVector<float> tmp(outN);
-            uint8_t *ptr = reinterpret_cast<uint8_t*>(tmp.data());
-            const int got = swr_convert(swr, &ptr, outN,
-                                        (const uint8_t**)frm->data, frm->nb_samples);
-            if (got > 0) {
-                const int oldSz = mono.size();
-                mono.resize(oldSz + got);
-                memcpy(mono.data() + oldSz, tmp.constData(), got * sizeof(float));
-            }
-            av_frame_unref(frm);
-        }
-    }
-    {
-        const int outN = (int)swr_get_delay(swr, 44100) + 1024;
-        QVector<float> tmp(outN);
-        uint8_t *ptr = reinterpret_cast<uint8_t*>(tmp.data());
-        const int got = swr_convert(swr, &ptr, outN, nullptr, 0);
-        if (got > 0) {
-            const int oldSz = mono.size();
-            mono.resize(oldSz + got);
-            memcpy(mono.data() + oldSz, tmp.constData(), got * sizeof(float));
-        }
-    }
-    av_frame_free(&frm);
-    av_packet_free(&pkt);
-    swr_free(&swr);
-    avcodec_free_context(&ctx);
-    avformat_close_input(&fmt);
-
-    if (mono.isEmpty()) return {};
+    if (!AudioReader(audioPath, format).readAll(mono, cancelled))
+        return {};
 
     constexpr int kSR  = 44100;
     constexpr int kHop = kSR * 80 / 1000; // 80 ms hop
     constexpr int kWin = 2048;
 
+    // YIN over the first half of each window (lags up to 512 samples), strict
+    // 0.10 threshold and no global-minimum fallback: the overlay would rather
+    // show nothing than a wrong note.
+    PitchDetector::Params yin;
+    yin.sampleRate      = kSR;
+    yin.maxWindow       = kWin / 2;
+    yin.minWindow       = kWin / 2;
+    yin.minHz           = 60.0;
+    yin.maxHz           = 1600.0;
+    yin.threshold       = 0.10;
+    yin.fallbackMaxCmnd = 0.0;
+    yin.silenceRms      = 0.0;
+    yin.loudestBlock    = false;
+    yin.minValidHz      = 60.0;
+    yin.maxValidHz      = 1600.0;
+    const PitchDetector detector(yin);
+    const QVector<PitchDetector::Result> frames =
+        detector.analyseFrames(SampleSpan<float>(mono), kWin, kHop);
+
     QVector<PitchPoint> result;
+    result.reserve(frames.size());
     double smoothHz = 0.0, smoothCents = 0.0;
     bool hadVoice = false;
 
-    for (int pos = 0; pos + kWin <= mono.size(); pos += kHop) {
-        const int64_t ms = int64_t(pos) * 1000 / kSR;
-        const double hz  = yinDetect(mono.constData() + pos, kWin, kSR);
+    for (int f = 0; f < frames.size(); ++f) {
+        const int64_t ms = int64_t(f) * kHop * 1000 / kSR;
+        const double hz  = frames[f].hz;
 
         PitchPoint pp;
         pp.ms = ms;
@@ -758,6 +829,38 @@ static QVector<PitchPoint> analyzePitch(const QString &audioPath)
     return result;
 }
 
+// The enhancer's pitch track for rawVocalPath (see PitchTrack) as overlay
+// points on the raw recording's timeline, like analyzePitch() gives; empty
+// when there's no usable sidecar. Cents are measured against the note the
+// enhancer corrected towards, so in a scale mode the overlay shows the same
+// target the correction pulled to.
+static QVector<PitchPoint> pitchPointsFromSidecar(const QString &rawVocalPath)
+{
+    PitchTrack track;
+    if (!PitchTrack::load(PitchTrack::sidecarPathFor(rawVocalPath), rawVocalPath, &track)
+        || track.isEmpty())
+        return {};
+
+    QVector<PitchPoint> result;
+    result.reserve(track.frames.size() + 1);
+    if (track.originMs > 0)   // the enhancer never saw what came before its trim
+        result.append(PitchPoint{0, 0.0, 0.0, 0, 0, false});
+    for (const PitchTrack::Frame &f : track.frames) {
+        PitchPoint pp{track.originMs + f.ms, 0.0, 0.0, 0, 0, false};
+        if (f.hz > 0.0f && f.targetMidi >= 0) {
+            const double targetHz = 440.0 * std::pow(2.0, (f.targetMidi - 69) / 12.0);
+            pp.hz      = f.hz;
+            pp.cents   = 1200.0 * std::log2(f.hz / targetHz);
+            pp.noteIdx = f.targetMidi % 12;
+            pp.octave  = f.targetMidi / 12 - 1;
+            pp.valid   = true;
+        }
+        result.append(pp);
+    }
+    qInfo() << "FFmpegNative: pitch overlay from the enhancer's track," << track.frames.size() << "frames";
+    return result;
+}
+
 static void paintPitchOverlay(AVFrame *frame, int64_t lookupMs,
                                const QVector<PitchPoint> &pitches)
 {
@@ -856,8 +959,9 @@ static void paintPitchOverlay(AVFrame *frame, int64_t lookupMs,
 
 std::vector<float> decodeToFloatStereo(const QString &filePath, const std::atomic<bool> *cancelled)
 {
-    const QVector<float> q = decodeAudioToFloat(filePath, 0, 1.0, cancelled);
-    return std::vector<float>(q.constBegin(), q.constEnd());
+    std::vector<float> pcm;
+    AudioReader(filePath, AudioReader::Format{}).readAll(pcm, cancelled);
+    return pcm;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -1128,7 +1232,7 @@ bool transcodeAudio(const QString &input, const QString &output,
                     const std::atomic<bool> *cancelled)
 {
     if (progressCb) progressCb(0);
-    const QVector<float>   floatPcm = decodeAudioToFloat(input, 0, 1.0, cancelled);
+    const QVector<float>   floatPcm = decodeAudioToFloat(input, cancelled);
     if (floatPcm.isEmpty()) {
         qWarning() << "FFmpegNative::transcodeAudio: decode failed or cancelled for" << input;
         return false;
@@ -1212,7 +1316,7 @@ bool muxVideoWithAudio(const QString &videoSrc, const QString &audioSrc,
     }
 
     // Decode audio source
-    const QVector<float> floatPcm = decodeAudioToFloat(audioSrc, 0, 1.0, cancelled);
+    const QVector<float> floatPcm = decodeAudioToFloat(audioSrc, cancelled);
     if (floatPcm.isEmpty()) {
         qWarning() << "FFmpegNative::muxVideoWithAudio: cannot decode audio from"
                    << audioSrc << "(or cancelled)";
@@ -1439,21 +1543,41 @@ static inline float softClip(float x)
 // Video effects (VideoEffectProcessor) — shared by live preview and render
 // ─────────────────────────────────────────────────────────────────────────────
 
-// Builds a "buffer → <filterChain> → format=<pixFmt> → buffersink" graph.
-// Mirrors applyAudioFilter()'s pattern (see above) for video frames instead
-// of PCM. Returns false (with *graph left null) if the chain can't be built —
-// e.g. a frei0r plugin the chain references isn't installed on this machine.
+// Slice threads for an effect graph. libavfilter would pick one per core by
+// itself; past about 8 the slices of a 1080p frame are too thin to pay for
+// the hand-off, and the render's scale and encode stages want cores too.
+static int effectGraphThreads()
+{
+    return std::clamp(int(std::thread::hardware_concurrency()), 1, 8);
+}
+
+// Builds a "buffer → <filterChain> → format=<outFmt> → buffersink" graph,
+// outFmt defaulting to the source's pixFmt. Mirrors applyAudioFilter()'s
+// pattern (see above) for video frames instead of PCM. Returns false (with
+// *graph left null) if the chain can't be built — e.g. a frei0r plugin the
+// chain references isn't installed on this machine. `threads` slice threads
+// for the filters that support slice threading (curves, eq, scale, ...);
+// frei0r and temporal filters run on the calling thread regardless. The
+// source reads frame pts in `timeBase`.
 static bool buildVideoFilterGraph(AVFilterGraph **graph, AVFilterContext **srcCtx,
                                    AVFilterContext **sinkCtx, const QString &filterChain,
-                                   int width, int height, AVPixelFormat pixFmt)
+                                   int width, int height, AVPixelFormat pixFmt, int threads,
+                                   AVPixelFormat outFmt = AV_PIX_FMT_NONE,
+                                   AVRational timeBase = {1, 25})
 {
+    if (outFmt == AV_PIX_FMT_NONE)
+        outFmt = pixFmt;
     *graph = avfilter_graph_alloc();
     if (!*graph)
         return false;
+    // Only honoured if set before the first filter is created
+    (*graph)->nb_threads  = std::max(1, threads);
+    (*graph)->thread_type = AVFILTER_THREAD_SLICE;
 
     const QByteArray srcParams = QStringLiteral(
-        "video_size=%1x%2:pix_fmt=%3:time_base=1/25:pixel_aspect=1/1")
-        .arg(width).arg(height).arg(int(pixFmt)).toUtf8();
+        "video_size=%1x%2:pix_fmt=%3:time_base=%4/%5:pixel_aspect=1/1")
+        .arg(width).arg(height).arg(int(pixFmt))
+        .arg(timeBase.num).arg(timeBase.den).toUtf8();
 
     bool ok = (avfilter_graph_create_filter(srcCtx, avfilter_get_by_name("buffer"),
                    "in", srcParams.constData(), nullptr, *graph) >= 0)
@@ -1462,8 +1586,8 @@ static bool buildVideoFilterGraph(AVFilterGraph **graph, AVFilterContext **srcCt
 
     if (ok) {
         const QString fullChain = filterChain.isEmpty()
-            ? QStringLiteral("format=pix_fmts=%1").arg(int(pixFmt))
-            : filterChain + QStringLiteral(",format=pix_fmts=%1").arg(int(pixFmt));
+            ? QStringLiteral("format=pix_fmts=%1").arg(int(outFmt))
+            : filterChain + QStringLiteral(",format=pix_fmts=%1").arg(int(outFmt));
 
         // Force "C" locale so avfilter parses decimal points correctly regardless
         // of the system locale (e.g. "0.5" would fail on German/French locales).
@@ -1493,7 +1617,8 @@ bool VideoEffectProcessor::isChainAvailable(const QString &filterChain)
         return true;
     AVFilterGraph *graph = nullptr;
     AVFilterContext *srcCtx = nullptr, *sinkCtx = nullptr;
-    const bool ok = buildVideoFilterGraph(&graph, &srcCtx, &sinkCtx, filterChain, 16, 16, AV_PIX_FMT_BGRA);
+    const bool ok = buildVideoFilterGraph(&graph, &srcCtx, &sinkCtx, filterChain, 16, 16,
+                                          AV_PIX_FMT_BGRA, 1);
     if (graph) avfilter_graph_free(&graph);
     return ok;
 }
@@ -1507,6 +1632,9 @@ struct VideoEffectProcessor::Impl {
     QString chain;
     int width = 0;
     int height = 0;
+    AVPixelFormat pixFmt = AV_PIX_FMT_NONE;
+    AVPixelFormat outFmt = AV_PIX_FMT_NONE;
+    AVRational timeBase{1, 25};
     int64_t pts = 0;
     bool chainBroken = false; // avoid retrying/re-warning every single frame
 
@@ -1518,6 +1646,50 @@ struct VideoEffectProcessor::Impl {
         if (graph)    avfilter_graph_free(&graph);
         srcCtx = sinkCtx = nullptr;
     }
+
+    // (Re)builds the graph if the chain or the frames changed since the
+    // last call. False while the chain can't be built.
+    bool configure(const QString &filterChain, int w, int h, AVPixelFormat fmt,
+                   AVPixelFormat out = AV_PIX_FMT_NONE, AVRational tb = {1, 25}) {
+        if (graph || chainBroken) {
+            if (filterChain == chain && w == width && h == height && fmt == pixFmt
+                && out == outFmt && av_cmp_q(tb, timeBase) == 0)
+                return !chainBroken;
+        }
+        teardown();
+        chain    = filterChain;
+        width    = w;
+        height   = h;
+        pixFmt   = fmt;
+        outFmt   = out;
+        timeBase = tb;
+        pts      = 0;
+        chainBroken = !buildVideoFilterGraph(&graph, &srcCtx, &sinkCtx, filterChain,
+                                             w, h, fmt, effectGraphThreads(), out, tb);
+        if (chainBroken) {
+            qWarning() << "FFmpegNative: video effect chain failed to build, passing through:" << filterChain;
+            return false;
+        }
+        inFrame  = av_frame_alloc();
+        outFrame = av_frame_alloc();
+        return true;
+    }
+
+    // Appends every frame the sink has ready, pts moved from the sink's
+    // time base (a filter may change it — fps, minterpolate) to the source's
+    void drainSink(std::vector<AVFrame *> &out) {
+        const AVRational sinkTb = av_buffersink_get_time_base(sinkCtx);
+        for (;;) {
+            AVFrame *f = av_frame_alloc();
+            if (!f || av_buffersink_get_frame(sinkCtx, f) < 0) {
+                av_frame_free(&f);
+                return;
+            }
+            if (f->pts != AV_NOPTS_VALUE)
+                f->pts = av_rescale_q(f->pts, sinkTb, timeBase);
+            out.push_back(f);
+        }
+    }
 };
 
 VideoEffectProcessor::VideoEffectProcessor() : d(new Impl) {}
@@ -1532,25 +1704,7 @@ QImage VideoEffectProcessor::process(const QImage &frame, const QString &filterC
     if (src.isNull())
         return frame;
 
-    const bool needsRebuild = (filterChain != d->chain)
-                            || (src.width() != d->width) || (src.height() != d->height);
-    if (needsRebuild) {
-        d->teardown();
-        d->chain  = filterChain;
-        d->width  = src.width();
-        d->height = src.height();
-        d->pts    = 0;
-        d->chainBroken = !buildVideoFilterGraph(&d->graph, &d->srcCtx, &d->sinkCtx,
-                                                 filterChain, d->width, d->height, AV_PIX_FMT_BGRA);
-        if (d->chainBroken)
-            qWarning() << "FFmpegNative: video effect chain failed to build, passing through:" << filterChain;
-        else {
-            d->inFrame  = av_frame_alloc();
-            d->outFrame = av_frame_alloc();
-        }
-    }
-
-    if (d->chainBroken)
+    if (!d->configure(filterChain, src.width(), src.height(), AV_PIX_FMT_BGRA))
         return frame;
 
     d->inFrame->format = AV_PIX_FMT_BGRA;
@@ -1579,6 +1733,377 @@ QImage VideoEffectProcessor::process(const QImage &frame, const QString &filterC
     return result;
 }
 
+void VideoEffectProcessor::filter(AVFrame *frame, const QString &filterChain,
+                                  AVRational timeBase, std::vector<AVFrame *> &out)
+{
+    if (!frame) {
+        // End of stream: out with what the graph held back, then start over
+        // on the next frame — a flushed graph takes no more input
+        if (d->graph && av_buffersrc_add_frame(d->srcCtx, nullptr) >= 0)
+            d->drainSink(out);
+        d->teardown();
+        d->chainBroken = false;
+        return;
+    }
+    if (filterChain.isEmpty()
+        || !d->configure(filterChain, frame->width, frame->height, AVPixelFormat(frame->format),
+                         AV_PIX_FMT_NONE, timeBase)) {
+        out.push_back(frame);
+        return;
+    }
+
+    // Handed over outright rather than with AV_BUFFERSRC_FLAG_KEEP_REF: with
+    // a second reference outstanding, in-place filters (curves, eq, lut, ...)
+    // would have to copy the whole frame before writing to it
+    if (av_buffersrc_add_frame(d->srcCtx, frame) < 0) {
+        if (frame->buf[0])   // refused before it was taken: pass it through
+            out.push_back(frame);
+        else
+            av_frame_free(&frame);
+        return;
+    }
+    av_frame_free(&frame);   // just the empty shell now
+    d->drainSink(out);
+}
+
+// The QVideoFrame pixel formats libavfilter takes as they are, plane for
+// plane — the ones Qt's FFmpeg backend decodes webcam recordings into. YV12
+// is YUV420P with its chroma planes the other way round (see processFrame()).
+static AVPixelFormat avPixelFormatFor(QVideoFrameFormat::PixelFormat fmt)
+{
+    switch (fmt) {
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YV12:     return AV_PIX_FMT_YUV420P;
+    case QVideoFrameFormat::Format_YUV422P:  return AV_PIX_FMT_YUV422P;
+    case QVideoFrameFormat::Format_NV12:     return AV_PIX_FMT_NV12;
+    case QVideoFrameFormat::Format_NV21:     return AV_PIX_FMT_NV21;
+    case QVideoFrameFormat::Format_YUYV:     return AV_PIX_FMT_YUYV422;
+    case QVideoFrameFormat::Format_UYVY:     return AV_PIX_FMT_UYVY422;
+    case QVideoFrameFormat::Format_P010:     return AV_PIX_FMT_P010LE;
+    case QVideoFrameFormat::Format_Y8:       return AV_PIX_FMT_GRAY8;
+    case QVideoFrameFormat::Format_BGRA8888: return AV_PIX_FMT_BGRA;
+    case QVideoFrameFormat::Format_BGRX8888: return AV_PIX_FMT_BGR0;
+    case QVideoFrameFormat::Format_RGBA8888: return AV_PIX_FMT_RGBA;
+    case QVideoFrameFormat::Format_RGBX8888: return AV_PIX_FMT_RGB0;
+    case QVideoFrameFormat::Format_ARGB8888: return AV_PIX_FMT_ARGB;
+    case QVideoFrameFormat::Format_XRGB8888: return AV_PIX_FMT_0RGB;
+    case QVideoFrameFormat::Format_ABGR8888: return AV_PIX_FMT_ABGR;
+    case QVideoFrameFormat::Format_XBGR8888: return AV_PIX_FMT_0BGR;
+    default:                                 return AV_PIX_FMT_NONE;
+    }
+}
+
+// buf[0]'s free callback for a frame wrapped around a mapped QVideoFrame:
+// the planes stay mapped until libavfilter drops its last reference
+static void unmapVideoFrame(void *opaque, uint8_t *)
+{
+    auto *mapped = static_cast<QVideoFrame *>(opaque);
+    mapped->unmap();
+    delete mapped;
+}
+
+// QImage cleanup for an image wrapping a sink frame
+static void freeWrappedFrame(void *frame)
+{
+    AVFrame *f = static_cast<AVFrame *>(frame);
+    av_frame_free(&f);
+}
+
+bool VideoEffectProcessor::acceptsFrame(const QVideoFrame &frame)
+{
+    return frame.isValid() && frame.handleType() == QVideoFrame::NoHandle
+        && avPixelFormatFor(frame.pixelFormat()) != AV_PIX_FMT_NONE;
+}
+
+QImage VideoEffectProcessor::processFrame(const QVideoFrame &frame, const QString &filterChain,
+                                          int maxDim)
+{
+    if (!acceptsFrame(frame))
+        return {};
+    const int w = frame.width();
+    const int h = frame.height();
+
+    // The downscale runs first, so the effects only ever see preview-sized
+    // frames. fast_bilinear: this is a preview, and the render scales on
+    // its own anyway.
+    QString chain = filterChain;
+    if (maxDim > 0 && (w > maxDim || h > maxDim)) {
+        const double s = double(maxDim) / std::max(w, h);
+        const QString scale = QStringLiteral("scale=%1:%2:flags=fast_bilinear")
+            .arg(std::max(1, int(std::lround(w * s))))
+            .arg(std::max(1, int(std::lround(h * s))));
+        chain = chain.isEmpty() ? scale : scale + ',' + chain;
+    }
+    if (!d->configure(chain, w, h, avPixelFormatFor(frame.pixelFormat()), AV_PIX_FMT_BGRA))
+        return {};
+
+    // The AVFrame points straight at the mapped planes; the mapping (and
+    // the QVideoFrame reference keeping the decoder's buffer alive) goes
+    // with the buffer's last reference. Read-only, so an in-place filter
+    // copies rather than writing into the decoder's memory — scale, when
+    // there is one, has written a fresh frame by then anyway.
+    auto *mapped = new QVideoFrame(frame);
+    if (!mapped->map(QVideoFrame::ReadOnly)) {
+        delete mapped;
+        return {};
+    }
+    AVFrame *in = av_frame_alloc();
+    if (in)
+        in->buf[0] = av_buffer_create(mapped->bits(0), mapped->mappedBytes(0),
+                                      unmapVideoFrame, mapped, AV_BUFFER_FLAG_READONLY);
+    if (!in || !in->buf[0]) {
+        av_frame_free(&in);
+        mapped->unmap();
+        delete mapped;
+        return {};
+    }
+
+    const bool swapChroma = frame.pixelFormat() == QVideoFrameFormat::Format_YV12;
+    for (int p = 0; p < std::min(mapped->planeCount(), AV_NUM_DATA_POINTERS); ++p) {
+        const int plane = (swapChroma && p > 0) ? 3 - p : p;
+        in->data[p]     = mapped->bits(plane);
+        in->linesize[p] = mapped->bytesPerLine(plane);
+    }
+    in->format = d->pixFmt;
+    in->width  = w;
+    in->height = h;
+    in->pts    = d->pts++;
+
+    const QVideoFrameFormat surface = frame.surfaceFormat();
+    switch (surface.colorRange()) {
+    case QVideoFrameFormat::ColorRange_Full:  in->color_range = AVCOL_RANGE_JPEG; break;
+    case QVideoFrameFormat::ColorRange_Video: in->color_range = AVCOL_RANGE_MPEG; break;
+    default: break;
+    }
+    switch (surface.colorSpace()) {
+    case QVideoFrameFormat::ColorSpace_BT601:  in->colorspace = AVCOL_SPC_BT470BG;    break;
+    case QVideoFrameFormat::ColorSpace_BT709:  in->colorspace = AVCOL_SPC_BT709;      break;
+    case QVideoFrameFormat::ColorSpace_BT2020: in->colorspace = AVCOL_SPC_BT2020_NCL; break;
+    default: break;
+    }
+
+    const int added = av_buffersrc_add_frame(d->srcCtx, in);
+    av_frame_free(&in);   // the mapping with it, if the graph didn't take it
+    if (added < 0)
+        return {};
+
+    AVFrame *out = av_frame_alloc();
+    if (!out || av_buffersink_get_frame(d->sinkCtx, out) < 0) {
+        av_frame_free(&out);
+        return {};
+    }
+    // No copy: the image is the sink's frame, whose buffer goes back to the
+    // graph's pool once the last QImage sharing it is gone
+    return QImage(out->data[0], out->width, out->height, out->linesize[0],
+                  QImage::Format_ARGB32, freeWrappedFrame, out);
+}
+
+// Frames of one format and size carved out of a shared AVBufferPool, so the
+// render's scale stage doesn't allocate (and the allocator doesn't page in)
+// a fresh full-size frame for every frame of the video: a frame the encoder
+// is done with hands its buffer straight back for the next one. get() is
+// safe to call from several threads; the pool outlives this object until
+// the last of its frames is freed.
+class VideoFramePool
+{
+public:
+    VideoFramePool(AVPixelFormat fmt, int width, int height)
+        : m_fmt(fmt), m_width(width), m_height(height)
+    {
+        // Rows padded to 64 bytes, like av_frame_get_buffer() does, for
+        // swscale's and the encoders' SIMD
+        ptrdiff_t linesizes[4] = {};
+        if (av_image_fill_linesizes(m_linesize, fmt, FFALIGN(width, 64)) < 0)
+            return;
+        for (int i = 0; i < 4; ++i)
+            linesizes[i] = m_linesize[i];
+        size_t sizes[4] = {};
+        if (av_image_fill_plane_sizes(sizes, fmt, height, linesizes) < 0)
+            return;
+        size_t total = 0;
+        for (int i = 0; i < 4; ++i) {
+            m_planeSize[i] = FFALIGN(sizes[i], 64);
+            total += m_planeSize[i];
+        }
+        m_pool = av_buffer_pool_init(total + AV_INPUT_BUFFER_PADDING_SIZE, nullptr);
+    }
+    ~VideoFramePool() { av_buffer_pool_uninit(&m_pool); }
+    VideoFramePool(const VideoFramePool &) = delete;
+    VideoFramePool &operator=(const VideoFramePool &) = delete;
+
+    // A frame with its planes laid out over one pooled buffer; falls back
+    // to av_frame_get_buffer() if the pool couldn't be set up. Null on OOM.
+    AVFrame *get()
+    {
+        AVFrame *f = av_frame_alloc();
+        if (!f)
+            return nullptr;
+        f->format = m_fmt;
+        f->width  = m_width;
+        f->height = m_height;
+        if (!m_pool) {
+            if (av_frame_get_buffer(f, 0) < 0)
+                av_frame_free(&f);
+            return f;
+        }
+        f->buf[0] = av_buffer_pool_get(m_pool);
+        if (!f->buf[0]) {
+            av_frame_free(&f);
+            return nullptr;
+        }
+        uint8_t *p = f->buf[0]->data;
+        for (int i = 0; i < 4 && m_planeSize[i]; ++i) {
+            f->data[i]     = p;
+            f->linesize[i] = m_linesize[i];
+            p += m_planeSize[i];
+        }
+        return f;
+    }
+
+private:
+    AVPixelFormat  m_fmt;
+    int            m_width;
+    int            m_height;
+    int            m_linesize[4]  = {};
+    size_t         m_planeSize[4] = {};
+    AVBufferPool  *m_pool = nullptr;
+};
+
+// Scale threads per render; 0 = pick from the core count (see renderVideo())
+static std::atomic<int> s_renderScaleWorkers{0};
+
+void setRenderScaleWorkers(int workers)
+{
+    s_renderScaleWorkers.store(std::max(0, workers));
+}
+
+// Hand-off between renderVideo()'s video stages (decode → scale → effect/
+// overlay → encode), each on its own thread. Every frame carries the
+// sequence number the decoder gave it, in presentation order; pop() hands
+// frames out strictly in that order, so the parallel scale stage can finish
+// them in any order without the encoder ever seeing one early. Bounded by
+// a window rather than a count: push() waits while its frame is `capacity`
+// or more ahead of the next one due out, which bounds what's buffered and
+// can't deadlock — the frame that's due is always let in.
+class OrderedFrameQueue
+{
+public:
+    explicit OrderedFrameQueue(int capacity) : m_capacity(capacity) {}
+    ~OrderedFrameQueue()
+    {
+        for (auto &entry : m_frames)
+            av_frame_free(&entry.second);
+    }
+    OrderedFrameQueue(const OrderedFrameQueue &) = delete;
+    OrderedFrameQueue &operator=(const OrderedFrameQueue &) = delete;
+
+    // Takes ownership of frame. False (frame freed) once aborted.
+    bool push(int64_t seq, AVFrame *frame)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_aborted || seq < m_nextOut + m_capacity; });
+        if (m_aborted) {
+            av_frame_free(&frame);
+            return false;
+        }
+        m_frames.emplace(seq, frame);
+        m_cv.notify_all();
+        return true;
+    }
+
+    // The next frame in sequence, once it's arrived. False when aborted, or
+    // once closed with nothing left.
+    bool pop(int64_t &seq, AVFrame *&frame)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] {
+            return m_aborted || (m_closed && m_frames.empty())
+                || (!m_frames.empty() && m_frames.begin()->first == m_nextOut);
+        });
+        if (m_aborted || m_frames.empty())
+            return false;
+        seq   = m_frames.begin()->first;
+        frame = m_frames.begin()->second;
+        m_frames.erase(m_frames.begin());
+        ++m_nextOut;
+        m_cv.notify_all();
+        return true;
+    }
+
+    // No more pushes are coming
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_cv.notify_all();
+    }
+
+    // Wakes and fails every waiter, now and from here on
+    void abort()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_aborted = true;
+        m_cv.notify_all();
+    }
+
+private:
+    const int m_capacity;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<int64_t, AVFrame*> m_frames;
+    int64_t m_nextOut = 0;
+    bool    m_closed  = false;
+    bool    m_aborted = false;
+};
+
+// Smart render probe: opens `path` (the webcam recording, or a cached video
+// — see RenderVideoReuse) if its video stream can go into the output as-is —
+// already mainW×mainH, and in a codec the output container takes (H.264
+// into .mp4/.mkv, VP8/VP9 into .webm, ...). Returns nullptr (and a full
+// decode/re-encode it is) otherwise. The caller owns the context;
+// *streamIdx is the stream to copy.
+static AVFormatContext *openVideoForStreamCopy(const QString &path,
+                                               const AVOutputFormat *ofmt,
+                                               int mainW, int mainH, int *streamIdx)
+{
+    AVFormatContext *fmt = nullptr;
+    if (avformat_open_input(&fmt, path.toUtf8().constData(), nullptr, nullptr) < 0)
+        return nullptr;
+    avformat_find_stream_info(fmt, nullptr);
+    const int idx = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (idx < 0) { avformat_close_input(&fmt); return nullptr; }
+
+    const AVCodecParameters *par = fmt->streams[idx]->codecpar;
+    if (par->width != mainW || par->height != mainH
+        || avformat_query_codec(ofmt, par->codec_id, FF_COMPLIANCE_NORMAL) != 1) {
+        avformat_close_input(&fmt);
+        return nullptr;
+    }
+    *streamIdx = idx;
+    return fmt;
+}
+
+// Keyframe-alignment correction for a webcam seeked to videoOffsetMs > 0:
+// avformat_seek_file snaps to the nearest keyframe BEFORE the requested
+// position. After PTS normalization the first video frame lands at output
+// PTS=0 but its content is from T_kf_ms, while the audio was trimmed at
+// exactly videoOffsetMs. The difference (videoOffsetMs - T_kf_ms), in outTB,
+// must be added to every video PTS so the streams are sample-accurate.
+// Shared by the re-encode and stream-copy paths so both land the video at
+// the same place.
+static int64_t keyframeSeekCorrection(int64_t firstSrcPts, AVRational inputTB,
+                                      qint64 videoOffsetMs, AVRational outTB)
+{
+    if (videoOffsetMs <= 0)
+        return 0;
+    // T_kf_ms: where the keyframe actually landed (ms)
+    const int64_t T_kf_ms = static_cast<int64_t>(firstSrcPts * av_q2d(inputTB) * 1000.0);
+    qDebug() << "FFmpegNative: seekTarget=" << videoOffsetMs
+             << "ms  keyframeLanded=" << T_kf_ms
+             << "ms  correction=" << (videoOffsetMs - T_kf_ms) << "ms";
+    return av_rescale_q(videoOffsetMs - T_kf_ms, AVRational{1, 1000}, outTB);
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // renderVideo
 // ─────────────────────────────────────────────────────────────────────────────
@@ -1594,7 +2119,8 @@ bool renderVideo(const QString &audioPath,
                  const QString &rawVocalPath,
                  const std::atomic<bool> *cancelled,
                  std::function<void(double)> progressCb,
-                 const QString &videoEffectChain)
+                 const QString &videoEffectChain,
+                 const RenderVideoReuse &videoReuse)
 {
     const QString ext = QFileInfo(outputPath).suffix().toLower();
     const bool audioOnlyOut = (ext == "mp3" || ext == "wav" ||
@@ -1605,55 +2131,108 @@ bool renderVideo(const QString &audioPath,
     const int mainW = rp.value(0, "1280").toInt();
     const int mainH = rp.value(1, "720").toInt();
 
-    // ── Step 1: Load vocal audio with volume and offset applied ───────────────
-    QVector<float> vocalPCM = decodeAudioToFloat(audioPath,
-                                                  std::max<qint64>(0, audioOffsetMs),
-                                                  vocalVolume);
-    if (vocalPCM.isEmpty()) {
+    // ── Pitch overlay data ────────────────────────────────────────────────────
+    // The enhancer's analysis when PreviewDialog left it next to the raw
+    // vocal. Otherwise the overlay analyses the recording itself, on its own
+    // thread from here on, so that overlaps opening the inputs and setting up
+    // the muxer and encoders instead of holding up the first video frame.
+    // Not wanted when the video is remuxed from videoReuse.readFrom — the
+    // overlay is already in those pixels.
+    //
+    // The analysis watches pitchStop rather than `cancelled`: any return
+    // before Step 4 collects it (a setup failure) sets it on the way out, so
+    // the future's destructor doesn't sit out a whole-take analysis, and
+    // Step 4 passes a cancellation on while it waits.
+    QVector<PitchPoint> pitchData;
+    std::atomic<bool> pitchStop{false};
+    std::future<QVector<PitchPoint>> pitchAnalysis;
+    struct StopOnExit {
+        std::atomic<bool> &flag;
+        ~StopOnExit() { flag = true; }
+    } stopPitchOnExit{pitchStop};   // after pitchAnalysis: runs before its destructor
+    if (!rawVocalPath.isEmpty() && !audioOnlyOut) {
+        pitchData = pitchPointsFromSidecar(rawVocalPath);
+        if (pitchData.isEmpty() && videoReuse.readFrom.isEmpty())
+            pitchAnalysis = std::async(std::launch::async, analyzePitch, rawVocalPath, &pitchStop);
+    }
+
+    // ── Step 1: Open the audio sources ────────────────────────────────────────
+    // Nothing is held in memory up front: the vocal decoder and the playback
+    // are pulled a block at a time by the mixer below, which is pulled by
+    // the audio encoder, which is pulled by the muxer as video packets come
+    // out (see pumpAudioUntil()). What's resident is a few blocks of PCM plus
+    // the encoders' own lookahead, not the song. A negative audioOffsetMs
+    // comes out of the vocal reader as leading silence.
+    AudioReader vocal(audioPath, AudioReader::Format{}, audioOffsetMs);
+    if (!vocal.isOpen()) {
         qWarning() << "FFmpegNative::renderVideo: failed to decode vocal audio";
         return false;
     }
-    // If offset is negative, prepend silence
-    if (audioOffsetMs < 0) {
-        const int silenceLen = (int)((-audioOffsetMs) * 44100LL / 1000) * 2;
-        QVector<float> silence(silenceLen, 0.0f);
-        silence += vocalPCM;
-        vocalPCM = std::move(silence);
-    }
-
-    // ── Step 2: Load playback audio ───────────────────────────────────────────
-    QVector<float> playbackPCM = decodeAudioToFloat(playbackPath, 0, 1.0);
+    // The playback is the backing track's Float DecodedAudioStore entry,
+    // mapped: decoded by the first render of a song (or a separation of the
+    // same file) rather than by every render, and already in the mix's
+    // format. Each block's pages are released once mixed, so a long song
+    // isn't left resident. Decoded here only if the store can't provide it.
+    const DecodedAudioStore::View playbackView = playbackPath.isEmpty()
+        ? DecodedAudioStore::View()
+        : DecodedAudioStore::instance().open(playbackPath, DecodedAudioStore::Precision::Float,
+                                             cancelled);
+    if (cancelled && cancelled->load())
+        return false;
+    std::unique_ptr<AudioReader> playbackReader;
+    if (!playbackView.isValid())
+        playbackReader.reset(new AudioReader(playbackPath, AudioReader::Format{}));
+    const auto *playbackPcm = reinterpret_cast<const float *>(playbackView.data());
+    qint64 playbackPos = 0;   // frames of playbackView mixed so far
 
-    // ── Step 3: Mix vocals with untouched playback ──────────────────────────────
+    // ── Step 2: Block mixer ───────────────────────────────────────────────────
     // audioPath (tunedRecorded) already went through the audio-masterization
     // filter chain upstream, before VocalEnhancer ran on it, so no filtering
-    // happens here — just mixing with the original, unaltered playback.
-    const int mixLen = std::max(vocalPCM.size(), playbackPCM.size());
-    if (mixLen <= 0) return false;
-    QVector<float> mixedPCM(mixLen, 0.0f);
-    for (int i = 0; i < mixLen; ++i) {
-        const float v = (i < vocalPCM.size())    ? vocalPCM[i]    : 0.0f;
-        const float p = (i < playbackPCM.size()) ? playbackPCM[i] : 0.0f;
-        mixedPCM[i] = softClip(v + p);
-    }
-    vocalPCM.clear(); vocalPCM.squeeze();
-    playbackPCM.clear(); playbackPCM.squeeze();
-
-    // ── Step 4: Convert final mix to S16 ────────────────────────────────────────
-    QVector<int16_t> finalAudio(mixedPCM.size());
-    for (int i = 0; i < mixedPCM.size(); ++i)
-        finalAudio[i] = int16_t(std::clamp(mixedPCM[i] * 32767.f, -32768.f, 32767.f));
-    mixedPCM.clear(); mixedPCM.squeeze();
-
-    if (finalAudio.isEmpty()) {
+    // happens here — just mixing with the original, unaltered playback, then
+    // the final S16 conversion. Runs until the longer of the two ends.
+    constexpr int kMixBlock = 4096;
+    std::vector<float>   vocalBlock(kMixBlock * 2), playbackBlock(kMixBlock * 2);
+    std::vector<int16_t> mixBlock(kMixBlock * 2);
+    const float vocalGain = float(vocalVolume);
+    auto mixNextBlock = [&]() -> int {
+        const int nv = vocal.read(vocalBlock.data(), kMixBlock);
+        const float *pb = playbackBlock.data();
+        int np = 0;
+        if (playbackView.isValid()) {
+            np = int(std::min<qint64>(kMixBlock, playbackView.frames() - playbackPos));
+            pb = playbackPcm + playbackPos * 2;
+        } else if (playbackReader->isOpen()) {
+            np = playbackReader->read(playbackBlock.data(), kMixBlock);
+        }
+        const int n = std::max(nv, np);
+        for (int i = 0; i < n * 2; ++i) {
+            const float v = (i < nv * 2) ? vocalBlock[i] * vocalGain : 0.0f;
+            const float p = (i < np * 2) ? pb[i] : 0.0f;
+            mixBlock[i] = int16_t(std::clamp(softClip(v + p) * 32767.f, -32768.f, 32767.f));
+        }
+        if (playbackView.isValid() && np > 0) {
+            const qint64 frameBytes = 2 * qint64(sizeof(float));
+            playbackView.releasePages(playbackPos * frameBytes, qint64(np) * frameBytes);
+            playbackPos += np;
+        }
+        return n;
+    };
+
+    // Mix the first block now, so an input that yields no audio at all fails
+    // before an output file is created; the encoder consumes it first.
+    int primedFrames = mixNextBlock();
+    if (primedFrames == 0) {
         qWarning() << "FFmpegNative::renderVideo: audio pipeline produced no output";
         return false;
     }
 
-    // Total duration from audio for progress reporting
-    const double totalDurSec = double(finalAudio.size() / 2) / 44100.0;
+    // Total duration for progress reporting
+    const double playbackSec = playbackView.isValid()
+        ? double(playbackView.frames()) / playbackView.format().sampleRate()
+        : playbackReader->durationSec();
+    const double totalDurSec = std::max(vocal.durationSec(), playbackSec);
 
-    // ── Step 5: Set up output muxer ───────────────────────────────────────────
+    // ── Step 3: Set up output muxer ───────────────────────────────────────────
     AVFormatContext *outFmt = nullptr;
     avformat_alloc_output_context2(&outFmt, nullptr, nullptr,
                                    outputPath.toUtf8().constData());
@@ -1731,18 +2310,45 @@ bool renderVideo(const QString &audioPath,
     // ── Video encoder (if needed) ─────────────────────────────────────────────
     AVStream       *videoOutSt    = nullptr;
     AVCodecContext *videoEncCtx   = nullptr;
-    SwsContext     *swsCtx        = nullptr;
-    AVFrame        *videoEncFrame = nullptr;
     AVBufferRef    *vaapiDevCtx   = nullptr; // non-null when VAAPI hw encoder is active
     bool            vaapiEnabled  = false;
-    AVPixelFormat   videoSwPixFmt = AV_PIX_FMT_YUV420P; // sw frame format fed to sws/encoder
+    const AVPixelFormat videoSwPixFmt = AV_PIX_FMT_YUV420P; // sw frame format fed to sws/encoder
     SwsContext     *vaapiConvCtx  = nullptr; // YUV420P→NV12 converter for VAAPI upload
     AVFrame        *vaapiNV12Frame = nullptr; // NV12 intermediate frame for VAAPI upload
 
-    if (!audioOnlyOut) {
+    // Smart render: with no effect, no pitch overlay and a webcam stream that
+    // already fits the output, nothing would touch the pixels — decoding and
+    // re-encoding would only cost time and a generation of quality. Its
+    // packets are remuxed instead (Step 4), and only the mix is encoded.
+    // Same for a previous render's video handed in as videoReuse.readFrom,
+    // except that its timestamps are final already.
+    AVFormatContext *copyFmt = nullptr;
+    int  copyVidIdx = -1;
+    bool copyIsReuse = false;
+    if (!audioOnlyOut && !videoReuse.readFrom.isEmpty()) {
+        copyFmt = openVideoForStreamCopy(videoReuse.readFrom, outFmt->oformat,
+                                         mainW, mainH, &copyVidIdx);
+        copyIsReuse = (copyFmt != nullptr);
+        if (!copyFmt)
+            qWarning() << "FFmpegNative::renderVideo: cached video unusable, rendering the webcam:"
+                       << videoReuse.readFrom;
+    }
+    if (!copyFmt && !audioOnlyOut && videoEffectChain.isEmpty() && rawVocalPath.isEmpty())
+        copyFmt = openVideoForStreamCopy(webcamPath, outFmt->oformat, mainW, mainH, &copyVidIdx);
+    if (copyFmt) {
+        const AVStream *inSt = copyFmt->streams[copyVidIdx];
+        videoOutSt = avformat_new_stream(outFmt, nullptr);
+        avcodec_parameters_copy(videoOutSt->codecpar, inSt->codecpar);
+        videoOutSt->codecpar->codec_tag = 0;   // let the muxer pick its own tag
+        videoOutSt->time_base = inSt->time_base;
+        qDebug() << "renderVideo: stream-copying" << (copyIsReuse ? "cached" : "webcam")
+                 << "video (" << avcodec_get_name(inSt->codecpar->codec_id) << ")";
+    }
+
+    if (!audioOnlyOut && !copyFmt) {
         // Try hardware encoders first (NVENC → VAAPI → V4L2 M2M), then fall
         // back to software H264/VP9.
-        // The sw frame pipeline (sws_scale, paintPitchOverlay, videoEncFrame)
+        // The sw frame pipeline (sws_scale, effect graph, paintPitchOverlay)
         // ALWAYS uses YUV420P — paintPitchOverlay assumes 3 separate planes and
         // would segfault if given NV12 (data[2] is nullptr in 2-plane formats).
         // VAAPI uses sw_format=YUV420P so av_hwframe_transfer_data converts
@@ -1844,6 +2450,12 @@ bool renderVideo(const QString &audioPath,
                 ctx->bit_rate  = 5000000;
                 if (vidCodecId == AV_CODEC_ID_H264)
                     av_opt_set(ctx->priv_data, "preset", "medium", 0);
+                else
+                    av_opt_set(ctx->priv_data, "row-mt", "1", 0);
+                // One thread per core; libvpx-vp9 needs row-mt on top to
+                // use them at these resolutions
+                ctx->thread_count = 0;
+                ctx->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
                 if (outFmt->oformat->flags & AVFMT_GLOBALHEADER)
                     ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
                 if (avcodec_open2(ctx, enc, nullptr) >= 0) {
@@ -1861,12 +2473,6 @@ bool renderVideo(const QString &audioPath,
             videoOutSt = avformat_new_stream(outFmt, videoEnc);
             avcodec_parameters_from_context(videoOutSt->codecpar, videoEncCtx);
             videoOutSt->time_base = videoEncCtx->time_base;
-
-            videoEncFrame = av_frame_alloc();
-            videoEncFrame->format = videoSwPixFmt;
-            videoEncFrame->width  = mainW;
-            videoEncFrame->height = mainH;
-            av_frame_get_buffer(videoEncFrame, 0);
         }
     }
 
@@ -1879,10 +2485,10 @@ bool renderVideo(const QString &audioPath,
             if (encSwr) swr_free(&encSwr);
             avcodec_free_context(&audioEncCtx);
             if (videoEncCtx)    avcodec_free_context(&videoEncCtx);
-            if (videoEncFrame)  av_frame_free(&videoEncFrame);
             if (vaapiNV12Frame) av_frame_free(&vaapiNV12Frame);
             if (vaapiConvCtx)   sws_freeContext(vaapiConvCtx);
             if (vaapiDevCtx)    av_buffer_unref(&vaapiDevCtx);
+            if (copyFmt)        avformat_close_input(&copyFmt);
             avformat_free_context(outFmt);
             return false;
         }
@@ -1894,22 +2500,64 @@ bool renderVideo(const QString &audioPath,
         if (encSwr) swr_free(&encSwr);
         avcodec_free_context(&audioEncCtx);
         if (videoEncCtx)    avcodec_free_context(&videoEncCtx);
-        if (videoEncFrame)  av_frame_free(&videoEncFrame);
         if (vaapiNV12Frame) av_frame_free(&vaapiNV12Frame);
         if (vaapiConvCtx)   sws_freeContext(vaapiConvCtx);
         if (vaapiDevCtx)    av_buffer_unref(&vaapiDevCtx);
+        if (copyFmt)        avformat_close_input(&copyFmt);
         avformat_free_context(outFmt);
         return false;
     }
 
-    bool wasCancelled = false;
+    // A second, video-only muxer for videoReuse.writeTo, fed the same encoded
+    // packets as the output. Matroska takes any codec. The encoder's global
+    // header is what lets the copy be remuxed later on its own, so an encoder
+    // opened without one (the output container didn't ask for it) is simply
+    // not cached.
+    AVFormatContext *reuseFmt = nullptr;
+    AVStream        *reuseSt  = nullptr;
+    bool             reuseOk  = true;
+    if (videoEncCtx && videoOutSt && !videoReuse.writeTo.isEmpty()
+        && (videoEncCtx->flags & AV_CODEC_FLAG_GLOBAL_HEADER)) {
+        avformat_alloc_output_context2(&reuseFmt, nullptr, "matroska",
+                                       videoReuse.writeTo.toUtf8().constData());
+        if (reuseFmt) {
+            reuseSt = avformat_new_stream(reuseFmt, nullptr);
+            avcodec_parameters_copy(reuseSt->codecpar, videoOutSt->codecpar);
+            reuseSt->codecpar->codec_tag = 0;
+            reuseSt->time_base = videoOutSt->time_base;
+            if (avio_open(&reuseFmt->pb, videoReuse.writeTo.toUtf8().constData(),
+                          AVIO_FLAG_WRITE) < 0
+                || avformat_write_header(reuseFmt, nullptr) < 0)
+                reuseOk = false;
+        }
+        if (!reuseFmt || !reuseOk)
+            qWarning() << "FFmpegNative::renderVideo: cannot write reusable video to"
+                       << videoReuse.writeTo << "— rendering without it";
+    }
+    // Trailer (if keep) and close; a copy that isn't kept is removed
+    auto finishReuse = [&](bool keep) {
+        if (!reuseFmt) return;
+        if (keep) av_write_trailer(reuseFmt);
+        if (reuseFmt->pb) avio_closep(&reuseFmt->pb);
+        avformat_free_context(reuseFmt);
+        reuseFmt = nullptr;
+        if (!keep) QFile::remove(videoReuse.writeTo);
+    };
+    if (!reuseOk)
+        finishReuse(false);
 
-    // Audio packets are collected here and written interleaved with video so
-    // that players can seek to any position and find both streams together.
-    // Writing all audio before any video (the naive approach) produces files
-    // where players show no video from the start, or no audio after a seek.
-    std::vector<AVPacket*> audioPacketQueue;
-    size_t audioQueueIdx = 0;
+    bool wasCancelled = false;
+    bool videoFailed  = false;   // a stage gave up mid-render; the output is unusable
+
+    // Audio packets are encoded only as far ahead as the muxer needs them and
+    // written interleaved with video, so that players can seek to any
+    // position and find both streams together. (Writing all audio before any
+    // video produces files where players show no video from the start, or no
+    // audio after a seek — and used to mean holding every encoded audio
+    // packet of the song in memory first.)
+    std::deque<AVPacket*> audioPacketQueue;
+    int64_t lastQueuedDtsAV = INT64_MIN;   // AV_TIME_BASE units
+    bool    audioFlushed    = false;       // encoder drained; nothing more will come
 
     // Collect one encoded audio frame into audioPacketQueue (no writes yet).
     auto collectAudioPacket = [&](AVFrame *af) {
@@ -1919,24 +2567,106 @@ bool renderVideo(const QString &audioPath,
             if (avcodec_receive_packet(audioEncCtx, pkt) < 0) { av_packet_free(&pkt); break; }
             av_packet_rescale_ts(pkt, audioEncCtx->time_base, audioOutSt->time_base);
             pkt->stream_index = audioOutSt->index;
+            lastQueuedDtsAV = av_rescale_q(pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts,
+                                           audioOutSt->time_base, AV_TIME_BASE_Q);
             audioPacketQueue.push_back(pkt);
         }
     };
 
     // Write buffered audio packets whose DTS is <= untilAV (AV_TIME_BASE units).
     auto drainAudioUpTo = [&](int64_t untilAV) {
-        while (audioQueueIdx < audioPacketQueue.size()) {
-            AVPacket *ap = audioPacketQueue[audioQueueIdx];
+        while (!audioPacketQueue.empty()) {
+            AVPacket *ap = audioPacketQueue.front();
             const int64_t dtsAV = av_rescale_q(
                 ap->dts != AV_NOPTS_VALUE ? ap->dts : ap->pts,
                 audioOutSt->time_base, AV_TIME_BASE_Q);
             if (dtsAV > untilAV) break;
             av_write_frame(outFmt, ap);
-            av_packet_free(&audioPacketQueue[audioQueueIdx++]);
+            av_packet_free(&ap);
+            audioPacketQueue.pop_front();
+        }
+    };
+
+    // ── Audio encoder FIFO ────────────────────────────────────────────────────
+    const int frameSize = (audioEncCtx->frame_size > 0) ? audioEncCtx->frame_size : 1024;
+    int64_t audioPts = 0;
+
+    // Push N samples of S16 into the fifo, converting format if needed
+    auto pushToFifo = [&](const int16_t *src, int n) {
+        if (encSwr) {
+            // Convert S16 → encoder format/rate
+            const int maxOut = (int)swr_get_out_samples(encSwr, n);
+            std::vector<std::vector<uint8_t>> planeBufs;
+            std::vector<uint8_t*> ptrs;
+            const bool planar = av_sample_fmt_is_planar(audioEncCtx->sample_fmt);
+            const int planes = planar ? 2 : 1;
+            // Packed (non-planar) formats interleave both channels into the
+            // single plane, so that buffer needs 2x the per-channel size.
+            const int samplesPerPlane = planar ? 1 : 2;
+            for (int p = 0; p < planes; ++p) {
+                planeBufs.emplace_back((size_t)maxOut * samplesPerPlane * av_get_bytes_per_sample(audioEncCtx->sample_fmt) + 16);
+                ptrs.push_back(planeBufs.back().data());
+            }
+            const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src);
+            const int got = swr_convert(encSwr, ptrs.data(), maxOut, &srcPtr, n);
+            if (got > 0)
+                av_audio_fifo_write(fifo, reinterpret_cast<void**>(ptrs.data()), got);
+        } else {
+            // S16 packed — write directly
+            void *ptr = const_cast<int16_t*>(src);
+            av_audio_fifo_write(fifo, &ptr, n);
+        }
+    };
+
+    // Mixes one more block into the fifo and encodes every whole frame it
+    // completes. Once both sources have ended, encodes the fifo's remainder
+    // and flushes the encoder instead, setting audioFlushed.
+    auto encodeNextAudioBlock = [&]() {
+        const int n = primedFrames > 0 ? std::exchange(primedFrames, 0) : mixNextBlock();
+        const bool last = (n == 0);
+        if (!last)
+            pushToFifo(mixBlock.data(), n);
+
+        while (av_audio_fifo_size(fifo) >= frameSize ||
+               (last && av_audio_fifo_size(fifo) > 0))
+        {
+            const int read = std::min(frameSize, av_audio_fifo_size(fifo));
+            AVFrame *af = av_frame_alloc();
+            af->format      = audioEncCtx->sample_fmt;
+            af->nb_samples  = read;
+            af->sample_rate = audioEncCtx->sample_rate;
+            af->pts         = audioPts;
+            av_channel_layout_copy(&af->ch_layout, &audioEncCtx->ch_layout);
+            av_frame_get_buffer(af, 0);
+            av_audio_fifo_read(fifo, reinterpret_cast<void**>(af->data), read);
+            collectAudioPacket(af);
+            av_frame_free(&af);
+            audioPts += read;
+        }
+        if (last) {
+            collectAudioPacket(nullptr);
+            audioFlushed = true;
+        }
+    };
+
+    // Encodes audio until some packet lies past untilAV (or the audio runs
+    // out), then writes everything up to untilAV — called with each video
+    // packet's DTS, so audio is produced just ahead of the video it's
+    // interleaved with. Audio-only output calls it once with INT64_MAX.
+    auto pumpAudioUntil = [&](int64_t untilAV) {
+        while (!audioFlushed && lastQueuedDtsAV <= untilAV) {
+            if (cancelled && cancelled->load()) { wasCancelled = true; return; }
+            encodeNextAudioBlock();
+            drainAudioUpTo(untilAV);
+
+            // Audio-only output: progress is the audio itself
+            if (audioOnlyOut && progressCb && totalDurSec > 0)
+                progressCb(std::min(1.0, double(audioPts) / audioEncCtx->sample_rate / totalDurSec));
         }
+        drainAudioUpTo(untilAV);
     };
 
-    // Encode one video frame, draining buffered audio up to its DTS first.
+    // Encode one video frame, writing audio up to each packet's DTS first.
     // VAAPI path: convert the YUV420P sw frame to NV12 (what Intel VAAPI needs),
     // then upload to a VAAPI surface via av_hwframe_transfer_data.
     auto flushVideoWithInterleave = [&](AVFrame *vframe) {
@@ -1965,7 +2695,16 @@ bool renderVideo(const QString &audioPath,
                 const int64_t videoDtsAV = av_rescale_q(
                     pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts,
                     videoOutSt->time_base, AV_TIME_BASE_Q);
-                drainAudioUpTo(videoDtsAV);
+                pumpAudioUntil(videoDtsAV);
+                if (reuseFmt && reuseOk) {
+                    AVPacket *reusePkt = av_packet_clone(pkt);
+                    if (reusePkt) {
+                        av_packet_rescale_ts(reusePkt, videoOutSt->time_base, reuseSt->time_base);
+                        reusePkt->stream_index = reuseSt->index;
+                        reuseOk = av_write_frame(reuseFmt, reusePkt) >= 0;
+                        av_packet_free(&reusePkt);
+                    }
+                }
                 av_write_frame(outFmt, pkt);
                 av_packet_unref(pkt);
             }
@@ -1974,93 +2713,72 @@ bool renderVideo(const QString &audioPath,
         if (hwFrame) av_frame_free(&hwFrame);
     };
 
-    // ── Step 6: Encode audio ──────────────────────────────────────────────────
-    {
-        const int frameSize = (audioEncCtx->frame_size > 0) ? audioEncCtx->frame_size : 1024;
-        const int totalSamplesIn = finalAudio.size() / 2; // per-channel sample count
-        int samplesWritten = 0;
-        int64_t audioPts = 0;
-
-        // Helper: push N samples of S16 into the fifo, converting format if needed
-        auto pushToFifo = [&](const int16_t *src, int n) {
-            if (encSwr) {
-                // Convert S16 → encoder format/rate
-                const int maxOut = (int)swr_get_out_samples(encSwr, n);
-                std::vector<std::vector<uint8_t>> planeBufs;
-                std::vector<uint8_t*> ptrs;
-                const bool planar = av_sample_fmt_is_planar(audioEncCtx->sample_fmt);
-                const int planes = planar ? 2 : 1;
-                // Packed (non-planar) formats interleave both channels into the
-                // single plane, so that buffer needs 2x the per-channel size.
-                const int samplesPerPlane = planar ? 1 : 2;
-                for (int p = 0; p < planes; ++p) {
-                    planeBufs.emplace_back((size_t)maxOut * samplesPerPlane * av_get_bytes_per_sample(audioEncCtx->sample_fmt) + 16);
-                    ptrs.push_back(planeBufs.back().data());
-                }
-                const uint8_t *srcPtr = reinterpret_cast<const uint8_t*>(src);
-                const int got = swr_convert(encSwr, ptrs.data(), maxOut, &srcPtr, n);
-                if (got > 0)
-                    av_audio_fifo_write(fifo, reinterpret_cast<void**>(ptrs.data()), got);
-            } else {
-                // S16 packed — write directly
-                void *ptr = const_cast<int16_t*>(src);
-                av_audio_fifo_write(fifo, &ptr, n);
-            }
-        };
-
-        while (samplesWritten < totalSamplesIn || av_audio_fifo_size(fifo) > 0) {
-            if (cancelled && cancelled->load()) { wasCancelled = true; break; }
+    // ── Step 4: Encode video, pulling audio along ─────────────────────────────
+    if (copyFmt) {
+        // Smart render: the same seek and the same timestamp arithmetic as the
+        // decode thread below, applied to packets instead of frames — so the
+        // video lands exactly where a re-encode would have put it. A reused
+        // video already went through all that: it's copied as it is (zero
+        // as its origin, no seek, no delay).
+        const bool shiftTimestamps = !copyIsReuse;
+        if (shiftTimestamps && videoOffsetMs > 0) {
+            const int64_t ts = videoOffsetMs * AV_TIME_BASE / 1000;
+            avformat_seek_file(copyFmt, -1, INT64_MIN, ts, ts + 2*AV_TIME_BASE, 0);
+        }
+        const AVRational inputTB = copyFmt->streams[copyVidIdx]->time_base;
+        const AVRational outTB   = videoOutSt->time_base;   // as the muxer settled it
+        const int64_t videoDelayTb = (shiftTimestamps && videoOffsetMs < 0)
+            ? av_rescale_q(-videoOffsetMs, AVRational{1, 1000}, outTB)
+            : 0;
+        int64_t firstSrcPts      = shiftTimestamps ? AV_NOPTS_VALUE : 0;
+        int64_t seekCorrectionTb = 0;
 
-            // Feed audio data into fifo
-            if (samplesWritten < totalSamplesIn) {
-                const int batch = std::min(frameSize * 4, totalSamplesIn - samplesWritten);
-                pushToFifo(finalAudio.constData() + samplesWritten * 2, batch);
-                samplesWritten += batch;
+        AVPacket *pkt = av_packet_alloc();
+        while (av_read_frame(copyFmt, pkt) >= 0) {
+            if (cancelled && cancelled->load()) { wasCancelled = true; av_packet_unref(pkt); break; }
+            // Nothing before the first keyframe is decodable on its own
+            if (pkt->stream_index != copyVidIdx
+                || (firstSrcPts == AV_NOPTS_VALUE
+                    && (!(pkt->flags & AV_PKT_FLAG_KEY) || pkt->pts == AV_NOPTS_VALUE))) {
+                av_packet_unref(pkt);
+                continue;
             }
-
-            // Drain fifo in frameSize chunks
-            while (av_audio_fifo_size(fifo) >= frameSize ||
-                   (samplesWritten >= totalSamplesIn && av_audio_fifo_size(fifo) > 0))
-            {
-                const int read = std::min(frameSize, av_audio_fifo_size(fifo));
-                if (read <= 0) break;
-
-                AVFrame *af = av_frame_alloc();
-                af->format      = audioEncCtx->sample_fmt;
-                af->nb_samples  = read;
-                af->sample_rate = audioEncCtx->sample_rate;
-                af->pts         = audioPts;
-                av_channel_layout_copy(&af->ch_layout, &audioEncCtx->ch_layout);
-                av_frame_get_buffer(af, 0);
-                av_audio_fifo_read(fifo, reinterpret_cast<void**>(af->data), read);
-                collectAudioPacket(af);
-                av_frame_free(&af);
-                audioPts += read;
-
-                // Audio phase: 0–10% if video follows, 0–100% for audio-only output
-                if (progressCb && totalDurSec > 0) {
-                    const double frac = std::min(1.0, double(audioPts) / audioEncCtx->sample_rate / totalDurSec);
-                    progressCb(audioOnlyOut ? frac : 0.1 * frac);
-                }
+            if (firstSrcPts == AV_NOPTS_VALUE) {
+                firstSrcPts = pkt->pts;
+                seekCorrectionTb = keyframeSeekCorrection(firstSrcPts, inputTB,
+                                                          videoOffsetMs, outTB);
             }
-        }
-        // Flush audio encoder
-        collectAudioPacket(nullptr);
-    }
-    finalAudio.clear(); finalAudio.squeeze();
-
-    // For audio-only output there is no video to interleave with, so write
-    // all buffered audio packets now.
-    if (audioOnlyOut || !videoEncCtx) {
-        drainAudioUpTo(INT64_MAX);
-        audioPacketQueue.clear();
-    }
+            const int64_t relPts = (pkt->pts != AV_NOPTS_VALUE)
+                                   ? pkt->pts - firstSrcPts : AV_NOPTS_VALUE;
+            if (pkt->pts != AV_NOPTS_VALUE)
+                pkt->pts = av_rescale_q(pkt->pts - firstSrcPts, inputTB, outTB)
+                           + videoDelayTb + seekCorrectionTb;
+            if (pkt->dts != AV_NOPTS_VALUE)
+                pkt->dts = av_rescale_q(pkt->dts - firstSrcPts, inputTB, outTB)
+                           + videoDelayTb + seekCorrectionTb;
+            pkt->duration     = av_rescale_q(pkt->duration, inputTB, outTB);
+            pkt->stream_index = videoOutSt->index;
+            pkt->pos          = -1;
+
+            pumpAudioUntil(av_rescale_q(pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts,
+                                        outTB, AV_TIME_BASE_Q));
+            if (wasCancelled) { av_packet_unref(pkt); break; }
+            av_write_frame(outFmt, pkt);
+            av_packet_unref(pkt);
 
-    // ── Step 7: Encode video ──────────────────────────────────────────────────
-    if (videoEncCtx && videoOutSt && videoEncFrame) {
-        QVector<PitchPoint> pitchData;
-        if (!rawVocalPath.isEmpty())
-            pitchData = analyzePitch(rawVocalPath);
+            if (progressCb && totalDurSec > 0 && relPts != AV_NOPTS_VALUE)
+                progressCb(std::min(1.0, av_q2d(inputTB) * double(relPts) / totalDurSec));
+        }
+        av_packet_free(&pkt);
+    } else if (videoEncCtx && videoOutSt) {
+        if (pitchAnalysis.valid()) {
+            while (pitchAnalysis.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+                if (cancelled && cancelled->load())
+                    pitchStop = true;
+            pitchData = pitchAnalysis.get();
+        }
+        else if (pitchData.isEmpty() && !rawVocalPath.isEmpty())   // the reuse fell through
+            pitchData = analyzePitch(rawVocalPath, cancelled);
 
         AVFormatContext *webcamFmt = nullptr;
         AVCodecContext  *webcamDec = nullptr;
@@ -2083,27 +2801,20 @@ bool renderVideo(const QString &audioPath,
                     webcamDec = avcodec_alloc_context3(vdec);
                     avcodec_parameters_to_context(webcamDec,
                         webcamFmt->streams[webcamVidIdx]->codecpar);
+                    // Frame threads are what let decoding keep up with the
+                    // parallel stages below; they hold back a few frames,
+                    // which the end-of-stream flush collects.
+                    webcamDec->thread_count = 0;
+                    webcamDec->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
                     avcodec_open2(webcamDec, vdec, nullptr);
                 }
             }
         }
 
         if (webcamDec) {
-            // Create swscale: webcam native format → YUV420P at mainW×mainH
-            swsCtx = sws_getContext(webcamDec->width, webcamDec->height,
-                                     webcamDec->pix_fmt,
-                                     mainW, mainH,
-                                     AV_PIX_FMT_YUV420P,
-                                     SWS_BICUBIC, nullptr, nullptr, nullptr);
-
             // Input timebase — used to convert frame PTS to seconds for progress
             const AVRational inputTB = webcamFmt->streams[webcamVidIdx]->time_base;
 
-            AVPacket *pkt        = av_packet_alloc();
-            AVFrame  *frm        = av_frame_alloc();
-            int64_t  firstSrcPts = AV_NOPTS_VALUE; // normalize video PTS to start at 0
-            int64_t  fallbackPts = 0;
-
             // When videoOffsetMs < 0 the webcam was not seeked; instead delay the
             // video stream so it starts |videoOffsetMs| ms into the output — matching
             // how the audio gets an equivalent silence prepend.
@@ -2111,41 +2822,55 @@ bool renderVideo(const QString &audioPath,
                 ? av_rescale_q(-videoOffsetMs, AVRational{1, 1000}, videoEncCtx->time_base)
                 : 0;
 
-            // Keyframe-alignment correction: avformat_seek_file snaps to the nearest
-            // keyframe BEFORE the requested position.  After PTS normalization the
-            // first video frame lands at output PTS=0 but its content is from
-            // T_kf_ms, while the audio was trimmed at exactly videoOffsetMs.
-            // The difference (videoOffsetMs - T_kf_ms) must be added to every
-            // video PTS so the streams are sample-accurate.
-            // This is computed once the first decoded frame reveals firstSrcPts.
+            // Optional video effect (Vertigo, Technicolor, ...) — the same
+            // VideoEffectProcessor the preview uses, so its graph is built on
+            // the first frame and reused for every one after. Renders without
+            // the effect if the chain can't be built (e.g. a frei0r plugin
+            // referenced by it isn't installed on this machine).
+            VideoEffectProcessor effects;
+
+            // Every scaled frame comes out of this pool and, once encoded,
+            // goes back into it
+            VideoFramePool scaledFrames(videoSwPixFmt, mainW, mainH);
+
+            // ── Staged pipeline ───────────────────────────────────────────────
+            //   decode        (1 thread)  → decoded
+            //   scale         (N threads) → scaled     frames finish in any order
+            //   effect+pitch  (1 thread)  → ready      in order: effects like
+            //                                          Vertigo blend each frame
+            //                                          with the ones before it
+            //   encode + mux  (this thread, also pulling audio — see
+            //                  pumpAudioUntil(); the muxer is only ever
+            //                  touched from here)
+            // Frames travel with pts already in videoEncCtx->time_base and
+            // best_effort_timestamp holding the zero-based source pts (relPts)
+            // the overlay and progress need. The effect graph runs in that
+            // time base too, so a frame it adds or holds back comes out with
+            // a pts of its own; the frames it still holds when the webcam
+            // ends are flushed out before `ready` closes. Cancellation: the
+            // decoder stops feeding (the rest drains), or this thread aborts
+            // every queue.
+            const int scaleWorkers = s_renderScaleWorkers.load() > 0
+                ? s_renderScaleWorkers.load()
+                : std::clamp(int(std::thread::hardware_concurrency()) / 2, 1, 4);
+            OrderedFrameQueue decoded(scaleWorkers * 2 + 2);
+            OrderedFrameQueue scaled(scaleWorkers * 2 + 2);
+            OrderedFrameQueue ready(4);
+
+            // See keyframeSeekCorrection(); the decoder computes it once the
+            // first decoded frame reveals firstSrcPts, before that frame is
+            // queued — so any stage that has popped a frame can read it.
             int64_t seekCorrectionTb = 0; // set after first frame when videoOffsetMs > 0
 
-            // Optional video effect (Vertigo, Technicolor, ...) — the graph is
-            // built once here and reused for every frame; see
-            // buildVideoFilterGraph() near the top of this file. Falls back to
-            // rendering without the effect if the chain can't be built (e.g. a
-            // frei0r plugin referenced by it isn't installed on this machine).
-            AVFilterGraph *effectGraph = nullptr;
-            AVFilterContext *effectSrcCtx = nullptr, *effectSinkCtx = nullptr;
-            AVFrame *effectSrcFrame = nullptr, *effectOutFrame = nullptr;
-            if (!videoEffectChain.isEmpty()) {
-                if (buildVideoFilterGraph(&effectGraph, &effectSrcCtx, &effectSinkCtx,
-                                           videoEffectChain, mainW, mainH, AV_PIX_FMT_YUV420P)) {
-                    effectSrcFrame = av_frame_alloc();
-                    effectOutFrame = av_frame_alloc();
-                } else {
-                    qWarning() << "FFmpegNative: video effect chain failed to build, rendering without it:"
-                               << videoEffectChain;
-                }
-            }
+            std::thread decodeThread([&]() {
+                AVPacket *pkt        = av_packet_alloc();
+                AVFrame  *frm        = av_frame_alloc();
+                int64_t  firstSrcPts = AV_NOPTS_VALUE; // normalize video PTS to start at 0
+                int64_t  fallbackPts = 0;
+                int64_t  seq         = 0;
 
-            while (av_read_frame(webcamFmt, pkt) >= 0) {
-                if (cancelled && cancelled->load()) { wasCancelled = true; av_packet_unref(pkt); break; }
-                if (pkt->stream_index != webcamVidIdx) { av_packet_unref(pkt); continue; }
-                if (avcodec_send_packet(webcamDec, pkt) < 0) { av_packet_unref(pkt); continue; }
-                av_packet_unref(pkt);
-
-                while (avcodec_receive_frame(webcamDec, frm) == 0) {
+                // Stamps frm with its output timing and hands it to the scalers
+                auto emitFrame = [&]() -> bool {
                     const int64_t srcPts = frm->pts;
 
                     // Record first valid PTS so we can zero-base all subsequent frames.
@@ -2153,83 +2878,203 @@ bool renderVideo(const QString &audioPath,
                     // it directly while audio starts at 0 causes A/V desync.
                     if (firstSrcPts == AV_NOPTS_VALUE && srcPts != AV_NOPTS_VALUE) {
                         firstSrcPts = srcPts;
-                        if (videoOffsetMs > 0) {
-                            // T_kf_ms: where the keyframe actually landed (ms)
-                            const int64_t T_kf_ms = static_cast<int64_t>(
-                                firstSrcPts * av_q2d(inputTB) * 1000.0);
-                            seekCorrectionTb = av_rescale_q(
-                                videoOffsetMs - T_kf_ms,
-                                AVRational{1, 1000},
-                                videoEncCtx->time_base);
-                            qDebug() << "FFmpegNative: seekTarget=" << videoOffsetMs
-                                     << "ms  keyframeLanded=" << T_kf_ms
-                                     << "ms  correction=" << (videoOffsetMs - T_kf_ms) << "ms";
-                        }
+                        seekCorrectionTb = keyframeSeekCorrection(firstSrcPts, inputTB,
+                                                                  videoOffsetMs,
+                                                                  videoEncCtx->time_base);
                     }
                     const int64_t relPts = (srcPts != AV_NOPTS_VALUE && firstSrcPts != AV_NOPTS_VALUE)
                                           ? srcPts - firstSrcPts
                                           : AV_NOPTS_VALUE;
 
-                    sws_scale(swsCtx,
-                              (const uint8_t * const*)frm->data, frm->linesize,
-                              0, webcamDec->height,
-                              videoEncFrame->data, videoEncFrame->linesize);
-                    av_frame_unref(frm);
-
-                    if (effectGraph) {
-                        av_frame_ref(effectSrcFrame, videoEncFrame);
-                        effectSrcFrame->pts = fallbackPts; // graph only needs a monotonic pts
-                        if (av_buffersrc_add_frame(effectSrcCtx, effectSrcFrame) >= 0
-                            && av_buffersink_get_frame(effectSinkCtx, effectOutFrame) >= 0) {
-                            av_frame_copy(videoEncFrame, effectOutFrame);
-                            av_frame_unref(effectOutFrame);
+                    AVFrame *out = av_frame_alloc();
+                    av_frame_move_ref(out, frm);
+                    out->pts = (relPts != AV_NOPTS_VALUE)
+                        ? av_rescale_q(relPts, inputTB, videoEncCtx->time_base) + videoDelayTb + seekCorrectionTb
+                        : fallbackPts + videoDelayTb + seekCorrectionTb;
+                    out->best_effort_timestamp = relPts;
+                    fallbackPts = out->pts - videoDelayTb - seekCorrectionTb
+                                  + av_rescale_q(1, inputTB, videoEncCtx->time_base);
+                    return decoded.push(seq++, out);
+                };
+
+                bool ok = true, draining = false;
+                while (ok && !draining) {
+                    if (cancelled && cancelled->load()) break;
+                    if (av_read_frame(webcamFmt, pkt) < 0) {
+                        // End of file: collect what the frame threads still hold
+                        avcodec_send_packet(webcamDec, nullptr);
+                        draining = true;
+                    } else {
+                        if (pkt->stream_index == webcamVidIdx)
+                            avcodec_send_packet(webcamDec, pkt);
+                        av_packet_unref(pkt);
+                    }
+                    while (ok && avcodec_receive_frame(webcamDec, frm) == 0)
+                        ok = emitFrame();
+                }
+                av_frame_free(&frm);
+                av_packet_free(&pkt);
+                decoded.close();
+            });
+
+            std::atomic<int>  liveScalers{scaleWorkers};
+            std::atomic<bool> scaleFailed{false};
+            std::vector<std::thread> scaleThreads;
+            for (int w = 0; w < scaleWorkers; ++w) {
+                scaleThreads.emplace_back([&]() {
+                    // swscale contexts aren't shareable between threads; one each
+                    SwsContext *sws = nullptr;
+                    int64_t seq;
+                    AVFrame *src;
+                    while (decoded.pop(seq, src)) {
+                        AVFrame *dst = scaledFrames.get();
+                        if (!dst) {   // out of memory: stop the pipeline
+                            av_frame_free(&src);
+                            decoded.abort();
+                            scaled.abort();
+                            break;
+                        }
+                        dst->pts                   = src->pts;
+                        dst->best_effort_timestamp = src->best_effort_timestamp;
+                        // Webcam native format → YUV420P at mainW×mainH
+                        sws = sws_getCachedContext(sws, src->width, src->height,
+                                                   AVPixelFormat(src->format),
+                                                   mainW, mainH, videoSwPixFmt,
+                                                   SWS_BICUBIC, nullptr, nullptr, nullptr);
+                        if (!sws) {
+                            // dst holds whatever the pool last had in it.
+                            // Dropping it would leave a hole in the sequence
+                            // the queues wait on, so the render stops here.
+                            qWarning() << "FFmpegNative::renderVideo: cannot scale"
+                                       << av_get_pix_fmt_name(AVPixelFormat(src->format))
+                                       << src->width << "x" << src->height << "frames";
+                            av_frame_free(&src);
+                            av_frame_free(&dst);
+                            scaleFailed = true;
+                            decoded.abort();
+                            scaled.abort();
+                            ready.abort();
+                            break;
                         }
-                        av_frame_unref(effectSrcFrame);
+                        sws_scale(sws, (const uint8_t * const*)src->data, src->linesize,
+                                  0, src->height, dst->data, dst->linesize);
+                        av_frame_free(&src);
+                        if (!scaled.push(seq, dst))
+                            break;
                     }
+                    sws_freeContext(sws);
+                    if (--liveScalers == 0)
+                        scaled.close();
+                });
+            }
 
-                    if (!pitchData.isEmpty() && relPts != AV_NOPTS_VALUE) {
+            std::thread effectThread([&]() {
+                // Overlay, then on to the encoder; false once it's aborted
+                int64_t readySeq = 0;   // counts the frames that leave the effect
+                auto deliver = [&](AVFrame *frame) -> bool {
+                    // The graph may still hold this frame's buffer (temporal
+                    // effects keep the last few): paint on a private copy
+                    const int64_t relPts = frame->best_effort_timestamp;
+                    if (!pitchData.isEmpty() && relPts != AV_NOPTS_VALUE
+                        && av_frame_make_writable(frame) >= 0) {
                         const int64_t frameMs = (int64_t)(av_q2d(inputTB) * double(relPts) * 1000.0);
                         const int64_t lookupMs = std::max<int64_t>(0, frameMs + audioOffsetMs);
-                        paintPitchOverlay(videoEncFrame, lookupMs, pitchData);
+                        paintPitchOverlay(frame, lookupMs, pitchData);
                     }
-
-                    videoEncFrame->pts = (relPts != AV_NOPTS_VALUE)
-                        ? av_rescale_q(relPts, inputTB, videoEncCtx->time_base) + videoDelayTb + seekCorrectionTb
-                        : fallbackPts + videoDelayTb + seekCorrectionTb;
-                    fallbackPts = videoEncFrame->pts - videoDelayTb - seekCorrectionTb
-                                  + av_rescale_q(1, inputTB, videoEncCtx->time_base);
-
-                    flushVideoWithInterleave(videoEncFrame);
-
-                    // Video = 10–100%: progress from normalized frame time / total audio duration
-                    if (progressCb && totalDurSec > 0 && relPts != AV_NOPTS_VALUE) {
-                        const double frameSec = av_q2d(inputTB) * double(relPts);
-                        progressCb(0.1 + 0.9 * std::min(1.0, frameSec / totalDurSec));
+                    return ready.push(readySeq++, frame);
+                };
+                // Frames out of the graph carry the pts it gave them, in
+                // videoEncCtx->time_base: a frame it made (or held back) has
+                // no input of its own to take relPts from, so it's worked
+                // back from the pts as the decoder stamped it
+                std::vector<AVFrame *> filtered;
+                auto deliverFiltered = [&]() -> bool {
+                    bool ok = true;
+                    for (AVFrame *f : filtered) {
+                        if (!ok) {
+                            av_frame_free(&f);
+                            continue;
+                        }
+                        f->best_effort_timestamp = (f->pts != AV_NOPTS_VALUE)
+                            ? av_rescale_q(f->pts - videoDelayTb - seekCorrectionTb,
+                                           videoEncCtx->time_base, inputTB)
+                            : AV_NOPTS_VALUE;
+                        ok = deliver(f);
+                    }
+                    filtered.clear();
+                    return ok;
+                };
+
+                int64_t seq;
+                AVFrame *frame;
+                bool ok = true;
+                while (ok && scaled.pop(seq, frame)) {
+                    if (videoEffectChain.isEmpty()) {
+                        ok = deliver(frame);
+                        continue;
                     }
+                    effects.filter(frame, videoEffectChain, videoEncCtx->time_base, filtered);
+                    ok = deliverFiltered();
+                }
+                // End of the webcam: out with what the effect held back
+                if (ok && !videoEffectChain.isEmpty()) {
+                    effects.filter(nullptr, videoEffectChain, videoEncCtx->time_base, filtered);
+                    deliverFiltered();
+                }
+                ready.close();
+            });
+
+            int64_t seq;
+            AVFrame *frame;
+            while (ready.pop(seq, frame)) {
+                const int64_t relPts = frame->best_effort_timestamp;
+                if (!wasCancelled)
+                    flushVideoWithInterleave(frame);
+                av_frame_free(&frame);
+                if (wasCancelled || (cancelled && cancelled->load())) {
+                    wasCancelled = true;
+                    decoded.abort();
+                    scaled.abort();
+                    ready.abort();
+                    break;
                 }
-            }
-            flushVideoWithInterleave(nullptr);
-
-            if (effectSrcFrame) av_frame_free(&effectSrcFrame);
-            if (effectOutFrame) av_frame_free(&effectOutFrame);
-            if (effectGraph)    avfilter_graph_free(&effectGraph);
 
-            av_frame_free(&frm);
-            av_packet_free(&pkt);
-            sws_freeContext(swsCtx);
+                // Audio is encoded alongside, so progress is just normalized frame time / total audio duration
+                if (progressCb && totalDurSec > 0 && relPts != AV_NOPTS_VALUE) {
+                    const double frameSec = av_q2d(inputTB) * double(relPts);
+                    progressCb(std::min(1.0, frameSec / totalDurSec));
+                }
+            }
+            decodeThread.join();
+            for (std::thread &t : scaleThreads)
+                t.join();
+            effectThread.join();
+            // The decoder stops early on cancellation, so the pipeline can
+            // also just run dry
+            if (cancelled && cancelled->load())
+                wasCancelled = true;
+            videoFailed = scaleFailed.load();
+
+            if (!videoFailed)
+                flushVideoWithInterleave(nullptr);
         }
 
         if (webcamDec) avcodec_free_context(&webcamDec);
         if (webcamFmt) avformat_close_input(&webcamFmt);
     }
 
-    // Write any audio that extends past the end of the video track.
-    drainAudioUpTo(INT64_MAX);
+    // Write any audio that extends past the end of the video track — or all
+    // of it, for audio-only output.
+    if (!wasCancelled && !videoFailed)
+        pumpAudioUntil(INT64_MAX);
+    for (AVPacket *ap : audioPacketQueue)
+        av_packet_free(&ap);
     audioPacketQueue.clear();
 
     // ── Finalize ──────────────────────────────────────────────────────────────
-    if (!wasCancelled)
+    if (!wasCancelled && !videoFailed)
         av_write_trailer(outFmt);
+    finishReuse(!wasCancelled && !videoFailed && reuseOk);
 
     if (!(outFmt->oformat->flags & AVFMT_NOFILE))
         avio_closep(&outFmt->pb);
@@ -2238,16 +3083,20 @@ bool renderVideo(const QString &audioPath,
     if (encSwr)         swr_free(&encSwr);
     avcodec_free_context(&audioEncCtx);
     if (videoEncCtx)    avcodec_free_context(&videoEncCtx);
-    if (videoEncFrame)  av_frame_free(&videoEncFrame);
     if (vaapiNV12Frame) av_frame_free(&vaapiNV12Frame);
     if (vaapiConvCtx)   sws_freeContext(vaapiConvCtx);
     if (vaapiDevCtx)    av_buffer_unref(&vaapiDevCtx);
+    if (copyFmt)        avformat_close_input(&copyFmt);
     avformat_free_context(outFmt);
 
     if (wasCancelled) {
         qDebug() << "FFmpegNative::renderVideo: aborted";
         return false;
     }
+    if (videoFailed) {
+        qWarning() << "FFmpegNative::renderVideo: video pipeline failed";
+        return false;
+    }
     if (progressCb) progressCb(1.0);
     qDebug() << "FFmpegNative::renderVideo: done →" << outputPath;
     return true;
@@ -8,6 +8,11 @@
 #include <functional>
 #include <atomic>
 #include <vector>
+#include <algorithm>
+
+struct AVFrame;
+struct AVRational;
+class QVideoFrame;
 
 namespace FFmpegNative {
 
@@ -17,6 +22,83 @@ double getDuration(const QString &filePath);
 /// Returns true when the file contains at least one valid video stream.
 bool hasVideoStream(const QString &filePath);
 
+/// Pull-based decoder behind every audio decode in FFmpegNative: the best
+/// audio stream of `path`, resampled to one interleaved output format and
+/// handed out a block at a time (read()) or whole (readAll()). Buffers are
+/// reused across reads — a converted frame goes straight into the caller's
+/// block when it fits, into one scratch buffer that only ever grows when it
+/// doesn't — so decoding a file allocates a fixed handful of times however
+/// long it is.
+class AudioReader {
+public:
+    enum class SampleFormat { Float, Int16 };
+    struct Format {
+        int          sampleRate   = 44100;  // 0 = the stream's own rate
+        int          channels     = 2;      // 1 (mono) or 2 (stereo)
+        SampleFormat sampleFormat = SampleFormat::Float;
+    };
+
+    /// startMs > 0 starts that far into the stream: a seek, with the frame
+    /// it lands in trimmed to the sample, rather than decoding and
+    /// discarding everything before it (decode-and-discard only where the
+    /// container can't seek). startMs < 0 starts with that much silence.
+    AudioReader(const QString &path, const Format &format, qint64 startMs = 0);
+    ~AudioReader();
+    AudioReader(const AudioReader &) = delete;
+    AudioReader &operator=(const AudioReader &) = delete;
+
+    bool isOpen() const;
+    int sampleRate() const;      // the output's, once open
+    int channels() const;
+    int bytesPerFrame() const;
+
+    /// Output length in seconds from the container's duration, startMs
+    /// included (0 when the container doesn't say). An estimate: it sizes
+    /// readAll()'s buffer and progress bars, nothing that must be exact.
+    double durationSec() const;
+
+    /// Fills dst with up to `frames` interleaved frames; fewer only at the
+    /// end of the stream, and 0 from then on.
+    int read(void *dst, int frames);
+
+    /// Replaces `out` with the rest of the stream — `out` being a QByteArray,
+    /// or a QVector or std::vector of the output sample type — sized once from
+    /// durationSec() and decoded straight into; it only grows again if the
+    /// container understated its length. False, with `out` cleared, when
+    /// `cancelled` is set on the way or nothing decodes at all.
+    template <typename Container>
+    bool readAll(Container &out, const std::atomic<bool> *cancelled = nullptr)
+    {
+        constexpr int kBlock = 65536;   // frames per read(): the cancellation granularity
+        const qsizetype perFrame = bytesPerFrame() / qsizetype(sizeof(out[0]));
+        if (!isOpen() || perFrame <= 0) {
+            out.clear();
+            return false;
+        }
+        qsizetype used = 0;
+        out.resize((qsizetype(durationSec() * sampleRate()) + kBlock) * perFrame);
+        for (;;) {
+            if (cancelled && cancelled->load()) {
+                out.clear();
+                return false;
+            }
+            if (qsizetype(out.size()) - used < qsizetype(kBlock) * perFrame)
+                out.resize(qsizetype(out.size()) + std::max<qsizetype>(qsizetype(out.size()) / 2,
+                                                                        qsizetype(kBlock) * perFrame));
+            const int got = read(out.data() + used, kBlock);
+            if (got == 0)
+                break;
+            used += got * perFrame;
+        }
+        out.resize(used);
+        return used > 0;
+    }
+
+private:
+    struct Impl;
+    QScopedPointer<Impl> d;
+};
+
 /// Decode media file to interleaved float32 stereo PCM at 44100 Hz.
 /// Returns an empty vector on error, or if cancelled becomes true mid-decode.
 std::vector<float> decodeToFloatStereo(const QString &filePath,
@@ -53,6 +135,14 @@ bool extractAudio(const QString &input, const QString &output,
                   const QString &filterStr = {},
                   const std::atomic<bool> *cancelled = nullptr);
 
+/// Decodes `input` to interleaved float32 stereo at 44100 Hz — the format
+/// renderVideo() mixes and VocalSeparator separates in — and writes it to
+/// `output` as an IEEE-float WAV, a block at a time, so the song is never
+/// resident. False on failure or when `cancelled` is set on the way; the
+/// caller removes whatever was written then.
+bool extractFloatAudio(const QString &input, const QString &output,
+                       const std::atomic<bool> *cancelled = nullptr);
+
 /// Applies a libavfilter audio chain (e.g. "deesser,speechnorm,...") to
 /// interleaved Int16 PCM at the given sample rate/channel count, returning
 /// filtered PCM in the same layout. Falls back to returning `pcmS16`
@@ -61,10 +151,13 @@ QByteArray applyFilterChainS16(const QByteArray &pcmS16, int sampleRate, int cha
                                const QString &filterChain);
 
 /// Live, stateful video-effect filter (frei0r/curves/etc. via libavfilter),
-/// meant for real-time preview. The underlying filter graph is rebuilt only
-/// when the chain or frame size actually changes — rebuilding per frame is
-/// too slow for real-time playback, especially for frei0r-backed effects
-/// that reload and reinitialize the plugin from scratch on every build.
+/// used by the real-time preview and by renderVideo()'s effect stage. The
+/// underlying filter graph is rebuilt only when the chain, frame size or
+/// pixel format actually changes — rebuilding per frame is too slow for
+/// real-time playback, especially for frei0r-backed effects that reload and
+/// reinitialize the plugin from scratch on every build. The graph runs
+/// libavfilter's slice threading, one thread per core (up to 8), for the
+/// filters that support it.
 class VideoEffectProcessor {
 public:
     VideoEffectProcessor();
@@ -79,6 +172,35 @@ public:
     /// unmodified until reconfigured with a working chain.
     QImage process(const QImage &frame, const QString &filterChain);
 
+    /// Frame-level form of process() for callers that already hold decoded
+    /// frames, in any pixel format. Takes ownership of `frame` — pass one
+    /// nothing else references, so in-place filters needn't copy it — and
+    /// appends to `out` every frame the buffersink has ready after it, as
+    /// they are, no copies: none while the graph holds frames back (tmix,
+    /// minterpolate, ...), several when a filter adds frames. `frame` itself
+    /// goes to `out`, unfiltered, when the chain is empty or broken. The
+    /// graph reads frame->pts in `timeBase` — keep it monotonic — and each
+    /// frame out carries its own pts in that same time base, made by the
+    /// graph, not copied from the latest input. A null `frame` ends the
+    /// stream: the frames still held back are flushed into `out`, and the
+    /// next frame starts a fresh graph. The caller owns everything in `out`.
+    void filter(AVFrame *frame, const QString &filterChain, AVRational timeBase,
+                std::vector<AVFrame *> &out);
+
+    /// Live-preview form: filters a decoded QVideoFrame straight from its
+    /// mapped planes in their own pixel format, with the downscale to fit
+    /// `maxDim` (0 = none) done first inside the graph, and returns a 32-bit
+    /// ARGB image that wraps the graph's output frame rather than a copy of
+    /// it — the frame is freed with the last QImage sharing it. No toImage()
+    /// or QImage conversion anywhere on the way. Null if !acceptsFrame(frame)
+    /// or the chain can't be built; the caller shows the frame unfiltered,
+    /// as process() would.
+    QImage processFrame(const QVideoFrame &frame, const QString &filterChain, int maxDim);
+
+    /// Whether processFrame() can take `frame`: in CPU memory (not a GPU
+    /// texture) and in a pixel format libavfilter reads as it is.
+    static bool acceptsFrame(const QVideoFrame &frame);
+
     /// Quick availability probe: tries to build (and immediately tear down) a
     /// throwaway graph for `filterChain`. Used to decide whether an effect
     /// should be offered in the UI at all on this machine.
@@ -89,8 +211,27 @@ private:
     QScopedPointer<Impl> d;
 };
 
+/// Reuse of a previous render's encoded video across renders that only
+/// change audio (see RenderVideoCache, which owns the files). Both paths are
+/// ignored for audio-only output.
+struct RenderVideoReuse {
+    /// Video-only file written by an earlier render's writeTo: remuxed, with
+    /// its timestamps as they are, in place of rendering the webcam. Falls
+    /// back to a full render if it can't be opened or doesn't fit the output.
+    QString readFrom;
+    /// Also write the encoded video stream here (Matroska, video only) when
+    /// the webcam gets rendered. Left unwritten when nothing is encoded —
+    /// a stream copy or a readFrom hit — and removed on failure.
+    QString writeTo;
+};
+
 /// Full render: vocal audio + webcam video + playback media → final mix.
 /// progressCb is invoked with 0.0–1.0 progress values on the calling thread.
+/// With no effect chain and no rawVocalPath, a webcam stream that's already
+/// `resolution` and in a codec the output container accepts is remuxed
+/// rather than re-encoded; only the mixed audio is encoded then.
+/// The pitch overlay for rawVocalPath comes from the enhancer's PitchTrack
+/// sidecar next to it when there is one, from analysing it otherwise.
 bool renderVideo(const QString &audioPath,          ///< enhanced+mastered vocal audio (WAV)
                  const QString &webcamPath,         ///< webcam recording
                  const QString &playbackPath,       ///< original karaoke playback
@@ -102,7 +243,13 @@ bool renderVideo(const QString &audioPath,          ///< enhanced+mastered vocal
                  const QString &rawVocalPath = {},  ///< raw vocal for pitch overlay (optional)
                  const std::atomic<bool> *cancelled = nullptr, ///< set true to abort
                  std::function<void(double)> progressCb = {},
-                 const QString &videoEffectChain = {}); ///< libavfilter chain applied to webcam frames (empty = none)
+                 const QString &videoEffectChain = {}, ///< libavfilter chain applied to webcam frames (empty = none)
+                 const RenderVideoReuse &videoReuse = {});
+
+/// Scale threads the next renderVideo() runs: 0 (the default) is half the
+/// cores, 1 to 4; any other count is used as given. For the thread-scaling
+/// benchmark (bench_renderscale); thread-safe.
+void setRenderScaleWorkers(int workers);
 
 } // namespace FFmpegNative
 
@@ -36,6 +36,7 @@ MainWindow::MainWindow(QWidget *parent)
     chooseInputAction = new QAction("Choose Input Devices", this);
     singAction = new QAction("SING", this);
     libraryAction = new QAction("Session Library", this);
+    batchSeparationAction = new QAction("Batch Backing Tracks…", this);
     QAction *exitAction = new QAction("Exit", this);
     menuBar->setFont(QApplication::font());
     
@@ -47,6 +48,7 @@ MainWindow::MainWindow(QWidget *parent)
     fileMenu->addAction(singAction);
     fileMenu->addSeparator();
     fileMenu->addAction(libraryAction);
+    fileMenu->addAction(batchSeparationAction);
     fileMenu->addAction(exitAction);
     
     menuBar->addMenu(fileMenu);
@@ -363,6 +365,7 @@ MainWindow::MainWindow(QWidget *parent)
     connect(backingTrackButton, &QPushButton::clicked, this, &MainWindow::generateBackingTrack);
     connect(libraryButton, &QPushButton::clicked, this, &MainWindow::openLibrary);
     connect(libraryAction, &QAction::triggered, this, &MainWindow::openLibrary);
+    connect(batchSeparationAction, &QAction::triggered, this, &MainWindow::batchBackingTracks);
     connect(previewCheckbox, &QCheckBox::toggled, this, &MainWindow::onPreviewCheckboxToggled);
     connect(vizCheckbox, &QCheckBox::toggled, this, &MainWindow::onVizCheckboxToggled);
 
@@ -916,9 +919,11 @@ bool MainWindow::trySetState(State next)
 
 // Removes the active per-restore workspace directory (if any) and repoints
 // webcamRecorded/audioRecorded/extractedTmpPlayback back to their canonical
-// /tmp paths. Safe to call even when no restore workspace is active.
+// /tmp paths, releasing the take's hold on its DecodedAudioStore entry.
+// Safe to call even when no restore workspace is active.
 void MainWindow::clearRestoreWorkspace()
 {
+    m_takePlayback = DecodedAudioStore::View();
     if (!m_activeRestoreWorkspaceDir.isEmpty()) {
         QDir(m_activeRestoreWorkspaceDir).removeRecursively();
         m_activeRestoreWorkspaceDir.clear();
@@ -931,12 +936,13 @@ void MainWindow::closeEvent(QCloseEvent *event)
     const bool renderActive = m_renderJob && m_renderJob->isActive();
     const bool separationActive = m_separationJob && m_separationJob->isActive();
     const bool downloadActive = m_modelDownloadJob && m_modelDownloadJob->isActive();
+    const bool batchActive = m_batchSeparationJob && m_batchSeparationJob->isRunning();
 
     int response = QMessageBox::question(
         this,
         "The show must go on!",
-        (renderActive || separationActive || downloadActive)
-            ? "A render, backing-track export, or model download is currently in progress. "
+        (renderActive || separationActive || downloadActive || batchActive)
+            ? "A render, backing-track export, batch separation, or model download is currently in progress. "
               "Closing now will abort it.\n"
               "Are you really really sure you want to leave?"
             : "Are you really really sure you want to leave?",
@@ -971,6 +977,13 @@ void MainWindow::closeEvent(QCloseEvent *event)
         m_separationJob->waitForFinished();
     }
 
+    // The batch's running items go back to pending in its queue file, so
+    // the next batch (GUI or --separate-batch) resumes them
+    if (batchActive) {
+        m_batchSeparationJob->cancel();
+        m_batchSeparationJob->waitForFinished();
+    }
+
     if (downloadActive) {
         m_modelDownloadJob->cancel();
         m_modelDownloadJob->waitForFinished();
@@ -12,11 +12,13 @@
 #include "renderjob.h"
 #include "vocalseparationjob.h"
 #include "modeldownloadjob.h"
+#include "batchseparationjob.h"
 
 #include <QWidget>
 #include <QFutureWatcher>
 #include <atomic>
 #include <memory>
+#include <functional>
 #include <QVideoWidget>
 #include <QVideoSink>
 #include <QVideoFrame>
@@ -205,6 +207,11 @@ private:
     QString m_activeRestoreWorkspaceDir;
     void clearRestoreWorkspace();
 
+    // The current take's backing track: extractedTmpPlayback is this View's
+    // path, and holding it keeps the store from evicting the file until the
+    // next recording or restore (clearRestoreWorkspace()) lets go.
+    DecodedAudioStore::View m_takePlayback;
+
     QProgressBar *progressBar;
     int totalDuration;
 
@@ -226,6 +233,11 @@ private:
     // QObject child-destruction take it down on close is already safe.
     ModelDownloadJob *m_modelDownloadJob = nullptr;
 
+    // Owns the queue behind batchBackingTracks(). closeEvent() cancels and
+    // waits on it like m_separationJob; the unfinished items stay queued on
+    // disk for the next batch.
+    BatchSeparationJob *m_batchSeparationJob = nullptr;
+
     QVideoWidget *videoWidget;
     
     AudioVisualizerWidget *vizUpperLeft;
@@ -246,6 +258,7 @@ private:
     QAction *chooseInputAction;
     QAction *singAction;
     QAction *libraryAction;
+    QAction *batchSeparationAction;
 
     QPushButton *singButton;
     QPushButton *abortButton;
@@ -338,6 +351,12 @@ private:
     // so it can run either immediately (model already present) or from
     // ModelDownloadJob::finished's success branch (model just downloaded).
     void runVocalSeparation();
+    // Asks before the one-time model download, then calls onReady once the
+    // model is in place (shared by both backing-track flows).
+    void downloadModelThen(std::function<void()> onReady);
+    // File ▸ Batch Backing Tracks — see mainwindowSeparatorMgr.cpp
+    void batchBackingTracks();
+    void runBatchSeparation();
 
     // Everything needed to (re)run or recover a VocalSeparationJob export —
     // bundled so handleExportFailure()'s recovery choices (Try Again, Save
@@ -228,27 +228,16 @@ void MainWindow::stopRecording() {
 
 
 
-                QString sourceFilePath = extractedPlayback;
-                QString destinationFilePath = extractedTmpPlayback;
-
-                QFile sourceFile(sourceFilePath);
-                bool playbackCopyOk = false;
-
-                if (sourceFile.exists()) {
-                    // Check if the destination file exists
-                    if (QFile::exists(destinationFilePath) && !QFile::remove(destinationFilePath)) {
-                        qWarning() << "Failed to remove existing file:" << destinationFilePath;
-                    } else if (QFile::copy(sourceFilePath, destinationFilePath)) {
-                        qDebug() << "File copied successfully to" << destinationFilePath;
-                        playbackCopyOk = true;
-                    } else {
-                        qWarning() << "Failed to copy file to" << destinationFilePath;
-                    }
+                // The take's backing track is the song's DecodedAudioStore
+                // entry, which the player already maps. Holding a View of
+                // it keeps the store from evicting it while this take is
+                // current, so the preview and the library save can read it
+                // by path — no copy of our own.
+                m_takePlayback = vizPlayer ? vizPlayer->playbackView() : DecodedAudioStore::View();
+                if (m_takePlayback.isValid()) {
+                    extractedTmpPlayback = m_takePlayback.path();
                 } else {
-                    qWarning() << "Source file does not exist:" << sourceFilePath;
-                }
-
-                if (!playbackCopyOk) {
+                    qWarning() << "Playback audio of" << currentVideoFile << "is not decoded yet";
                     qWarning() << "*FAILURE* Could not prepare playback audio for render.";
                     logUI("Recording ERROR: failed to prepare playback audio for render.");
                     setBanner("Recording ERROR: could not prepare playback audio.");
@@ -257,7 +246,7 @@ void MainWindow::stopRecording() {
                     chooseInputButton->setEnabled(true);
                     chooseInputAction->setEnabled(true);
                     QMessageBox::critical(this, "Recording Error",
-                        "The extracted playback audio could not be copied.\n"
+                        "The playback audio has not been decoded yet.\n"
                         "Rendering cannot continue for this recording.");
                     return;
                 }
@@ -92,7 +92,7 @@ void MainWindow::mixAndRender(double vocalVolume, qint64 manualOffset, const QSt
     // apply the same shift to both streams so their relative timing is preserved:
     //
     //   manualOffset > 0  →  trim manualOffset ms from the start of both audio
-    //                        (decodeAudioToFloat skip) and video (avformat_seek_file).
+    //                        (StreamingAudioDecoder skip) and video (avformat_seek_file).
     //   manualOffset < 0  →  prepend |manualOffset| ms of silence to audio AND delay
     //                        the video stream by the same |manualOffset| ms.
     //                        Both files are read from t=0; their pre-roll content lands
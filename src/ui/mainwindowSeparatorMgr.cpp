@@ -3,6 +3,8 @@
 #include "vocalseparator.h"
 #include "vocalseparationjob.h"
 #include "modeldownloadjob.h"
+#include "batchseparationjob.h"
+#include "sessionrepository.h"
 
 #include <QDialog>
 #include <QProgressBar>
@@ -16,7 +18,11 @@
 #include <QPointer>
 #include <QProcess>
 #include <QSaveFile>
+#include <QHash>
+#include <QInputDialog>
+#include <QThread>
 #include <functional>
+#include <memory>
 
 namespace {
 
@@ -72,7 +78,13 @@ void MainWindow::generateBackingTrack() {
         runVocalSeparation();
         return;
     }
+    downloadModelThen([this]() { runVocalSeparation(); });
+}
 
+// Offers the one-time model download and runs onReady once it's in place.
+// Called with State::Separating already held; drops back to Idle itself if
+// the user declines or the download fails or is aborted.
+void MainWindow::downloadModelThen(std::function<void()> onReady) {
     auto btn = QMessageBox::question(
         this,
         "Download MDX-Net Model",
@@ -104,7 +116,7 @@ void MainWindow::generateBackingTrack() {
 
     QPointer<QDialog> dlDlgGuard(dl.dialog);
     connect(m_modelDownloadJob, &ModelDownloadJob::finished, this,
-            [this, dlDlgGuard](bool success, bool cancelled, QString errorMessage) {
+            [this, dlDlgGuard, onReady](bool success, bool cancelled, QString errorMessage) {
         if (dlDlgGuard) {
             dlDlgGuard->accept();
             dlDlgGuard->deleteLater();
@@ -120,7 +132,7 @@ void MainWindow::generateBackingTrack() {
         }
 
         logUI("MDX-Net model downloaded to " + VocalSeparator::modelPath());
-        runVocalSeparation();
+        onReady();
     });
 
     m_modelDownloadJob->start(VocalSeparator::modelUrl(), VocalSeparator::modelPath(),
@@ -452,3 +464,187 @@ void MainWindow::promptSaveInstrumentalAsWav(const ExportRecoveryContext &ctx, c
         handleExportFailure(ctx, priorError);
     }
 }
+
+// File ▸ Batch Backing Tracks: separates a whole folder, or every session
+// in the library, into "<name>.instrumental.wav" files via
+// BatchSeparationJob. The queue persists in ~/.WakkaQt/batch/, so a batch
+// aborted here (or from a headless --separate-batch run) is offered for
+// resuming the next time. Holds State::Separating for the whole batch, like
+// a single generateBackingTrack().
+void MainWindow::batchBackingTracks() {
+    if (!trySetState(State::Separating))
+        return;
+    vizPlayer->stop();
+
+    if (VocalSeparator::modelExists()) {
+        runBatchSeparation();
+        return;
+    }
+    downloadModelThen([this]() { runBatchSeparation(); });
+}
+
+void MainWindow::runBatchSeparation() {
+    if (m_batchSeparationJob) {
+        m_batchSeparationJob->deleteLater();
+        m_batchSeparationJob = nullptr;
+    }
+    m_batchSeparationJob = new BatchSeparationJob(BatchSeparationJob::defaultQueuePath(), this);
+
+    QString loadError;
+    if (!m_batchSeparationJob->load(&loadError)) {
+        logUI(loadError);
+        if (m_batchSeparationJob->isLockedElsewhere()) {
+            // A headless --separate-batch run; its queue isn't ours to edit
+            QMessageBox::critical(this, "Batch Backing Tracks", loadError);
+            trySetState(State::Idle);
+            return;
+        }
+        QMessageBox::warning(this, "Batch Backing Tracks",
+                             loadError + "\n\nStarting with an empty queue.");
+    }
+
+    int unfinished = 0;
+    for (const BatchSeparationJob::Item &item : m_batchSeparationJob->items())
+        unfinished += (item.state != BatchSeparationJob::ItemState::Done);
+
+    bool resume = false;
+    if (unfinished > 0) {
+        const auto btn = QMessageBox::question(this, "Batch Backing Tracks",
+            QString("%1 item(s) from an earlier batch haven't finished.\n"
+                    "Resume them (failed ones are retried)?").arg(unfinished),
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        resume = (btn == QMessageBox::Yes);
+        if (resume)
+            m_batchSeparationJob->retryFailed();
+    }
+
+    if (!resume) {
+        // Completed and abandoned items from before would only clutter the
+        // progress count of the new batch
+        m_batchSeparationJob->clearFinished();
+
+        QMessageBox sourceBox(this);
+        sourceBox.setWindowTitle("Batch Backing Tracks");
+        sourceBox.setText("Generate backing tracks for which songs?");
+        QPushButton *folderBtn  = sourceBox.addButton("A Folder…", QMessageBox::ActionRole);
+        QPushButton *libraryBtn = sourceBox.addButton("The Session Library", QMessageBox::ActionRole);
+        sourceBox.addButton(QMessageBox::Cancel);
+        sourceBox.exec();
+
+        QStringList inputs;
+        if (sourceBox.clickedButton() == folderBtn) {
+            const QString dir = QFileDialog::getExistingDirectory(this, "Songs Folder", QDir::homePath());
+            if (!dir.isEmpty())
+                inputs = BatchSeparationJob::scanFolder(dir);
+        } else if (sourceBox.clickedButton() == libraryBtn) {
+            SessionRepository repo;
+            inputs = BatchSeparationJob::libraryInputs(repo.loadAll());
+        } else {
+            trySetState(State::Idle);
+            return;
+        }
+        if (inputs.isEmpty()) {
+            trySetState(State::Idle);
+            QMessageBox::information(this, "Batch Backing Tracks", "No media files found.");
+            return;
+        }
+
+        const QString outDir = QFileDialog::getExistingDirectory(this,
+            "Save Backing Tracks To", QDir::homePath());
+        if (outDir.isEmpty()) {
+            trySetState(State::Idle);
+            return;
+        }
+        m_batchSeparationJob->enqueue(inputs, outDir);
+    }
+
+    // Memory isn't what limits this: the spectrogram is streamed a chunk
+    // batch at a time, so a worker holds its song's decoded samples and the
+    // instrumental being built (about 20 MB a minute each) plus one batch of
+    // chunks. CPU is. Every worker runs the one ONNX session, whose intra-op
+    // threads were already tuned to the whole machine, so workers mostly
+    // overlap one song's decode and STFT with another's inference — more
+    // than a couple rarely pays off, and more than the cores never does.
+    bool ok = false;
+    const int workers = QInputDialog::getInt(this, "Batch Backing Tracks",
+        "Songs to separate at the same time:", 1, 1,
+        qBound(1, QThread::idealThreadCount(), 8), 1, &ok);
+    if (!ok) {
+        trySetState(State::Idle);
+        return;
+    }
+    m_batchSeparationJob->setWorkerCount(workers);
+
+    const int total = m_batchSeparationJob->items().size();
+    auto prog = makeAbortableProgressDialog(this, "Batch Backing Tracks",
+        "Loading the separation model…", 420,
+        [this]() { if (m_batchSeparationJob) m_batchSeparationJob->cancel(); });
+    prog.bar->setRange(0, total * 100);
+    QPointer<QDialog> progDlgGuard(prog.dialog);
+    QPointer<QLabel> label(prog.dialog->findChild<QLabel *>());
+
+    // Overall bar = finished items plus the running ones' own progress
+    auto itemPct = std::make_shared<QHash<int, int>>();
+    auto refresh = [this, bar = prog.bar, label, itemPct, total]() {
+        int sum = 0, done = 0;
+        const QList<BatchSeparationJob::Item> items = m_batchSeparationJob->items();
+        for (int i = 0; i < items.size(); ++i) {
+            if (items[i].state == BatchSeparationJob::ItemState::Done
+                || items[i].state == BatchSeparationJob::ItemState::Failed) {
+                sum += 100;
+                ++done;
+            } else {
+                sum += itemPct->value(i, 0);
+            }
+        }
+        bar->setValue(sum);
+        if (label)
+            label->setText(QString("Separated %1 of %2 songs…").arg(done).arg(total));
+    };
+
+    connect(m_batchSeparationJob, &BatchSeparationJob::itemStarted, this,
+            [this, itemPct, refresh](int index, QString inputFile) {
+        itemPct->insert(index, 0);
+        logUI("Batch: separating " + QFileInfo(inputFile).fileName());
+        refresh();
+    });
+    connect(m_batchSeparationJob, &BatchSeparationJob::itemProgress, this,
+            [itemPct, refresh](int index, int pct) {
+        itemPct->insert(index, pct);
+        refresh();
+    });
+    connect(m_batchSeparationJob, &BatchSeparationJob::itemFinished, this,
+            [this, refresh](int, QString outputPath) {
+        logUI("Batch: saved " + outputPath);
+        refresh();
+    });
+    connect(m_batchSeparationJob, &BatchSeparationJob::itemFailed, this,
+            [this, refresh](int index, QString error) {
+        logUI("Batch: failed " + m_batchSeparationJob->items().value(index).inputFile + " — " + error);
+        refresh();
+    });
+    connect(m_batchSeparationJob, &BatchSeparationJob::batchError, this, [this](QString error) {
+        logUI("Batch: " + error);
+        QMessageBox::critical(this, "Batch Backing Tracks", error);
+    });
+    connect(m_batchSeparationJob, &BatchSeparationJob::finished, this,
+            [this, progDlgGuard](int done, int failed, bool cancelled) {
+        if (progDlgGuard) {
+            progDlgGuard->accept();
+            progDlgGuard->deleteLater();
+        }
+        trySetState(State::Idle);
+        const QString summary = QString("Batch finished: %1 backing track(s) saved, %2 failed%3.")
+            .arg(done).arg(failed).arg(cancelled ? ", the rest left for next time" : "");
+        logUI(summary);
+        if (cancelled)
+            return;
+        if (failed > 0)
+            QMessageBox::warning(this, "Batch Backing Tracks",
+                                 summary + "\nSee the log for why each one failed.");
+        else
+            QMessageBox::information(this, "Batch Backing Tracks", summary);
+    });
+
+    m_batchSeparationJob->start();
+}
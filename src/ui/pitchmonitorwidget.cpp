@@ -14,6 +14,16 @@ PitchMonitorWidget::PitchMonitorWidget(int sampleRate, QWidget *parent)
     setMinimumSize(320, 48);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     setToolTip("Real-time pitch monitor — shows the note you are currently singing");
+
+    PitchDetector::Params yin;
+    yin.sampleRate = m_sampleRate;
+    yin.maxWindow  = 2048;
+    yin.minWindow  = 512;
+    yin.minHz      = 60.0;
+    yin.maxHz      = 1100.0;
+    yin.threshold  = 0.12;
+    yin.silenceRms = 5e-4;
+    m_yin.reset(new PitchDetector(yin));
 }
 
 void PitchMonitorWidget::reset()
@@ -42,17 +52,17 @@ void PitchMonitorWidget::onAudioChunk(const QVector<qint16> &samples)
             m_accumulator = m_accumulator.mid(m_accumulator.size() - kMaxAcc);
     }
 
-    // Run detection when we have >= 2048 samples
+    // Run detection when we have >= 2048 samples — straight off the
+    // accumulator (no copy); with the FFT detector this holds the lock for
+    // well under a millisecond.
     constexpr int kDetWin = 2048;
-    QVector<double> buf;
+    double hz = 0.0;
     {
         QMutexLocker lk(&m_mutex);
         if (m_accumulator.size() < kDetWin) return;
-        buf = m_accumulator;
+        hz = m_yin->detect(SampleSpan<double>(m_accumulator));
     }
 
-    const double hz = detectPitchYIN(buf);
-
     {
         QMutexLocker lk(&m_mutex);
         m_detectedHz = hz;
@@ -68,80 +78,6 @@ void PitchMonitorWidget::onAudioChunk(const QVector<qint16> &samples)
     QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
 }
 
-// ── YIN pitch detection ─────────────────────────────────────────────────────
-
-double PitchMonitorWidget::detectPitchYIN(const QVector<double> &data) const
-{
-    const int W = std::min<int>(data.size(), 2048);
-    if (W < 512) return 0.0;
-
-    const int minTau = std::max(2, int(double(m_sampleRate) / 1100.0));
-    const int maxTau = std::min(W / 2, int(double(m_sampleRate) / 60.0));
-    if (minTau >= maxTau) return 0.0;
-
-    // Find highest-RMS block of W samples
-    int bestStart = 0;
-    double bestRms = 0.0;
-    for (int i = 0; i + W <= int(data.size()); i += W / 4) {
-        double rms = 0.0;
-        for (int j = 0; j < W; ++j) rms += data[i+j] * data[i+j];
-        rms = std::sqrt(rms / W);
-        if (rms > bestRms) { bestRms = rms; bestStart = i; }
-    }
-    if (bestRms < 5e-4) return 0.0; // silence
-
-    const int half = W / 2;
-
-    // Step 1: Difference function
-    QVector<double> d(maxTau + 1, 0.0);
-    for (int tau = 1; tau <= maxTau; ++tau) {
-        double sum = 0.0;
-        for (int j = 0; j < half; ++j) {
-            const double diff = data[bestStart + j] - data[bestStart + j + tau];
-            sum += diff * diff;
-        }
-        d[tau] = sum;
-    }
-
-    // Step 2: CMND
-    QVector<double> cmnd(maxTau + 1, 1.0);
-    double cumSum = 0.0;
-    for (int tau = 1; tau <= maxTau; ++tau) {
-        cumSum += d[tau];
-        cmnd[tau] = (cumSum > 1e-12) ? d[tau] * tau / cumSum : 1.0;
-    }
-
-    // Step 3: First tau below threshold
-    constexpr double kThresh = 0.12;
-    int bestTau = -1;
-    for (int tau = minTau; tau < maxTau; ++tau) {
-        if (cmnd[tau] < kThresh) {
-            while (tau + 1 <= maxTau && cmnd[tau+1] <= cmnd[tau]) ++tau;
-            bestTau = tau;
-            break;
-        }
-    }
-    if (bestTau < 1) {
-        int minIdx = minTau;
-        for (int tau = minTau+1; tau <= maxTau; ++tau)
-            if (cmnd[tau] < cmnd[minIdx]) minIdx = tau;
-        if (cmnd[minIdx] > 0.50) return 0.0;
-        bestTau = minIdx;
-    }
-
-    // Step 4: Parabolic interpolation
-    double refined = double(bestTau);
-    if (bestTau > minTau && bestTau < maxTau) {
-        const double y0 = cmnd[bestTau-1], y1 = cmnd[bestTau], y2 = cmnd[bestTau+1];
-        const double den = y0 - 2.0*y1 + y2;
-        if (std::abs(den) > 1e-12)
-            refined = bestTau + 0.5*(y0 - y2) / den;
-    }
-
-    const double freq = double(m_sampleRate) / std::max(refined, 1.0);
-    return (freq > 50.0 && freq < 1200.0) ? freq : 0.0;
-}
-
 // ── Note name conversion ────────────────────────────────────────────────────
 
 PitchMonitorWidget::NoteInfo PitchMonitorWidget::hzToNote(double hz)
@@ -5,8 +5,11 @@
 #include <QTimer>
 #include <QVector>
 #include <QMutex>
+#include <QScopedPointer>
 #include <QString>
 
+#include "pitchdetector.h"
+
 // Real-time pitch monitor shown during recording.
 // Receives audio chunks from SndWidget::audioChunkReady(), runs YIN pitch
 // detection, and displays the current note, octave, and cents deviation.
@@ -27,9 +30,6 @@ protected:
     void paintEvent(QPaintEvent *event) override;
 
 private:
-    // YIN pitch detection on a mono Int16 buffer — returns Hz or 0 if unvoiced
-    double detectPitchYIN(const QVector<double> &data) const;
-
     // Convert Hz to note name + octave + cents deviation
     struct NoteInfo { QString name; int octave; double cents; bool valid; };
     static NoteInfo hzToNote(double hz);
@@ -37,6 +37,9 @@ private:
     int     m_sampleRate;
     QMutex  m_mutex;
 
+    // Shared FFT YIN (60–1100 Hz); plans made once in the constructor
+    QScopedPointer<PitchDetector> m_yin;
+
     // Accumulate incoming samples until we have enough for detection
     QVector<double> m_accumulator;
 
@@ -1,6 +1,7 @@
 #include "complexes.h"
 #include "previewdialog.h"
 #include "audioamplifier.h"
+#include "pitchtrack.h"
 #ifdef WAKKAQT_FFMPEG_NATIVE
 #include "ffmpegnative.h"
 #endif
@@ -336,7 +337,9 @@ PreviewDialog::PreviewDialog(qint64 offset, QWidget *parent)
     m_effectWatcher = new QFutureWatcher<QImage>(this);
     connect(m_effectWatcher, &QFutureWatcher<QImage>::finished, this, [this]() {
         m_effectFrameInFlight = false;
-        videoRama->setImage(m_effectWatcher->result());
+        const QImage image = m_effectWatcher->result();
+        if (!image.isNull())
+            videoRama->setImage(image);
     });
 #endif
 
@@ -753,28 +756,31 @@ void PreviewDialog::updateVideoEffectChain()
 // handing mediaPlayer straight to a QVideoWidget) so the selected effect can
 // be applied before the frame reaches the screen — same filter chain used
 // for the final render, so preview and output match.
-void PreviewDialog::onVideoFrame(const QVideoFrame &frame)
+// Downscale before filtering (never before the final render, which
+// stays at full resolution via ffmpegnative.cpp's own separate pass).
+// Effect filter cost scales with pixel count, and the preview widget is
+// a fraction of a typical 1080p webcam frame's size, so there's no
+// visible quality loss here and a large real reduction in per-frame CPU
+// work — the main cause of the software-render stutter.
+static constexpr int kMaxPreviewDim = 720;
+
+// The frame as a QImage no larger than kMaxPreviewDim. FastTransformation
+// (nearest-neighbor) instead of smooth scaling since this frame is about
+// to be filtered and re-scaled again at paint time anyway.
+static QImage previewImage(const QVideoFrame &frame)
 {
-    if (!frame.isValid())
-        return;
-
     QImage image = frame.toImage();
-    if (image.isNull())
-        return;
-
-    // Downscale before filtering (never before the final render, which
-    // stays at full resolution via ffmpegnative.cpp's own separate pass).
-    // Effect filter cost scales with pixel count, and the preview widget is
-    // a fraction of a typical 1080p webcam frame's size, so there's no
-    // visible quality loss here and a large real reduction in per-frame CPU
-    // work — the main cause of the software-render stutter. FastTransformation
-    // (nearest-neighbor) instead of smooth scaling since this frame is about
-    // to be filtered and re-scaled again at paint time anyway.
-    constexpr int kMaxPreviewDim = 720;
     if (image.width() > kMaxPreviewDim || image.height() > kMaxPreviewDim) {
         image = image.scaled(kMaxPreviewDim, kMaxPreviewDim,
                               Qt::KeepAspectRatio, Qt::FastTransformation);
     }
+    return image;
+}
+
+void PreviewDialog::onVideoFrame(const QVideoFrame &frame)
+{
+    if (!frame.isValid())
+        return;
 
 #ifdef WAKKAQT_FFMPEG_NATIVE
     if (!m_videoEffectChain.isEmpty() && videoEffectProcessor) {
@@ -785,18 +791,39 @@ void PreviewDialog::onVideoFrame(const QVideoFrame &frame)
         // the next one starts, so the single Impl/AVFilterGraph it owns is
         // never accessed from two threads at once despite living on a
         // worker thread while in flight.
-        if (!m_effectFrameInFlight) {
+        if (m_effectFrameInFlight)
+            return;
+        FFmpegNative::VideoEffectProcessor *processor = videoEffectProcessor.data();
+        const QString chain = m_videoEffectChain;
+
+        // A frame in CPU memory goes to the graph as the decoder left it:
+        // its planes mapped, scaled and filtered in one pass, and shown as
+        // an image wrapping the graph's output — no toImage(), no ARGB
+        // conversion, no copy. A GPU texture, or a pixel format libavfilter
+        // can't read as it is, still goes through toImage() here.
+        if (FFmpegNative::VideoEffectProcessor::acceptsFrame(frame)) {
             m_effectFrameInFlight = true;
-            FFmpegNative::VideoEffectProcessor *processor = videoEffectProcessor.data();
-            const QString chain = m_videoEffectChain;
-            m_effectWatcher->setFuture(QtConcurrent::run([processor, image, chain]() {
-                return processor->process(image, chain);
+            m_effectWatcher->setFuture(QtConcurrent::run([processor, frame, chain]() {
+                const QImage filtered = processor->processFrame(frame, chain, kMaxPreviewDim);
+                return filtered.isNull() ? previewImage(frame) : filtered;
             }));
+            return; // display happens in m_effectWatcher's finished callback
         }
+
+        const QImage image = previewImage(frame);
+        if (image.isNull())
+            return;
+        m_effectFrameInFlight = true;
+        m_effectWatcher->setFuture(QtConcurrent::run([processor, image, chain]() {
+            return processor->process(image, chain);
+        }));
         return; // display happens in m_effectWatcher's finished callback
     }
 #endif
 
+    const QImage image = previewImage(frame);
+    if (image.isNull())
+        return;
     videoRama->setImage(image);
 }
 
@@ -857,6 +884,15 @@ void PreviewDialog::onVocalsEnhanced(QByteArray tunedData)
             audioFile.close();
         }
 
+        // Leave the enhancer's pitch analysis next to the raw vocal, where
+        // the render's pitch overlay looks for it before analysing anew.
+        // extract() trimmed a positive offset off the start; a negative one
+        // trims nothing.
+        PitchTrack track = previewJob->enhancer()->lastPitchTrack();
+        track.originMs = std::max<qint64>(0, audioOffset);
+        if (!track.isEmpty())
+            track.save(PitchTrack::sidecarPathFor(audioFilePath), audioFilePath);
+
         amplifier->setAudioData(tunedData);
         amplifier->setAudioOffset(newOffset);
         amplifier->start();
@@ -0,0 +1,160 @@
+#include "ffmpegnative.h"
+#include "wavfile.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+// Not a test: how renderVideo()'s re-encode scales with the number of scale
+// threads (setRenderScaleWorkers()) on this machine. A 640x360 webcam
+// stand-in is upscaled to 1080p through the "null" effect chain, so every
+// frame takes the full staged path — decode, scale, effect, encode — and
+// only the scale stage's width changes between rows. Built with the tests
+// but not registered with ctest, since the numbers are the machine's. Run
+// by hand, all rows or one:
+//
+//   ./bench_renderscale
+//   ./bench_renderscale throughput:4
+//
+// Each row reports frames per second of the whole render and its speedup
+// over one scale thread. Once the encoder (or the decoder) is the slowest
+// stage, more scale threads stop paying.
+class BenchRenderScale : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int kSeconds = 10;
+    static constexpr int kFps     = 25;
+
+    QTemporaryDir m_dir;
+    double m_oneWorkerFps = 0.0;
+
+    QString path(const QString &name) const { return m_dir.filePath(name); }
+
+    // kSeconds of MPEG-4 Part 2 (in every FFmpeg build) with a little detail
+    // in each frame, so the scaler has real work and the encoder something
+    // other than flat planes
+    static bool writeWebcam(const QString &file)
+    {
+        const AVCodec *enc = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+        AVFormatContext *fmt = nullptr;
+        avformat_alloc_output_context2(&fmt, nullptr, nullptr, file.toUtf8().constData());
+        if (!enc || !fmt) { avformat_free_context(fmt); return false; }
+
+        AVCodecContext *ctx = avcodec_alloc_context3(enc);
+        ctx->width = 640;  ctx->height = 360;
+        ctx->pix_fmt   = AV_PIX_FMT_YUV420P;
+        ctx->time_base = {1, kFps};
+        ctx->framerate = {kFps, 1};
+        ctx->gop_size  = 12;
+        if (fmt->oformat->flags & AVFMT_GLOBALHEADER)
+            ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        AVStream *st = avformat_new_stream(fmt, nullptr);
+        bool ok = avcodec_open2(ctx, enc, nullptr) >= 0
+               && avcodec_parameters_from_context(st->codecpar, ctx) >= 0
+               && avio_open(&fmt->pb, file.toUtf8().constData(), AVIO_FLAG_WRITE) >= 0;
+        st->time_base = ctx->time_base;
+        ok = ok && avformat_write_header(fmt, nullptr) >= 0;
+
+        AVFrame  *frame = av_frame_alloc();
+        AVPacket *pkt   = av_packet_alloc();
+        frame->format = ctx->pix_fmt;  frame->width = ctx->width;  frame->height = ctx->height;
+        ok = ok && av_frame_get_buffer(frame, 0) >= 0;
+        const int frames = kSeconds * kFps;
+        for (int i = 0; ok && i <= frames; ++i) {
+            AVFrame *in = nullptr;
+            if (i < frames) {
+                ok = av_frame_make_writable(frame) >= 0;
+                for (int y = 0; y < ctx->height; ++y)
+                    for (int x = 0; x < ctx->width; ++x)
+                        frame->data[0][y * frame->linesize[0] + x] = uint8_t((x ^ y) + 3 * i);
+                for (int p = 1; p < 3; ++p)
+                    for (int y = 0; y < ctx->height / 2; ++y)
+                        memset(frame->data[p] + y * frame->linesize[p], 128, ctx->width / 2);
+                frame->pts = i;
+                in = frame;
+            }
+            ok = ok && avcodec_send_frame(ctx, in) >= 0;
+            while (ok && avcodec_receive_packet(ctx, pkt) >= 0) {
+                av_packet_rescale_ts(pkt, ctx->time_base, st->time_base);
+                pkt->stream_index = st->index;
+                ok = av_interleaved_write_frame(fmt, pkt) >= 0;
+            }
+        }
+        ok = ok && av_write_trailer(fmt) >= 0;
+
+        av_packet_free(&pkt);
+        av_frame_free(&frame);
+        avcodec_free_context(&ctx);
+        if (fmt->pb) avio_closep(&fmt->pb);
+        avformat_free_context(fmt);
+        return ok;
+    }
+
+    static bool writeSilence(const QString &file)
+    {
+        QAudioFormat fmt;
+        fmt.setSampleRate(44100);
+        fmt.setChannelCount(2);
+        fmt.setSampleFormat(QAudioFormat::Int16);
+        const QByteArray pcm(kSeconds * 44100 * 4, '\0');
+        QFile f(file);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        writeWavHeader(f, fmt, pcm.size(), pcm);
+        return true;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        QVERIFY(writeWebcam(path("webcam.mp4")));
+        QVERIFY(writeSilence(path("vocal.wav")));
+        QVERIFY(writeSilence(path("playback.wav")));
+    }
+
+    void cleanupTestCase() { FFmpegNative::setRenderScaleWorkers(0); }
+
+    void throughput_data()
+    {
+        QTest::addColumn<int>("workers");
+        for (int workers : {1, 2, 4, 8})
+            QTest::newRow(QByteArray::number(workers).constData()) << workers;
+    }
+
+    void throughput()
+    {
+        QFETCH(int, workers);
+        FFmpegNative::setRenderScaleWorkers(workers);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("out.mp4"), 1.0,
+                                          0, 0, "1920x1080", QString(), nullptr, {}, "null"));
+        const qint64 ns = timer.nsecsElapsed();
+
+        const double fps = kSeconds * kFps * 1e9 / double(std::max<qint64>(1, ns));
+        if (workers == 1)
+            m_oneWorkerFps = fps;
+        QTest::setBenchmarkResult(fps, QTest::FramesPerSecond);
+        qInfo().noquote() << QString("%1 scale thread(s): %2 fps at 1920x1080%3")
+                                 .arg(workers).arg(fps, 0, 'f', 1)
+                                 .arg(m_oneWorkerFps > 0.0
+                                      ? QString(", %1x one thread").arg(fps / m_oneWorkerFps, 0, 'f', 2)
+                                      : QString());
+    }
+};
+
+QTEST_MAIN(BenchRenderScale)
+#include "bench_renderscale.moc"
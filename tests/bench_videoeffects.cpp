@@ -0,0 +1,114 @@
+#include "ffmpegnative.h"
+#include "complexes.h"
+
+#include <QTest>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+// Not a test: how many 1080p frames per second each of videoEffectPresets
+// (at its default settings) gets through on this machine's CPU, through the
+// same VideoEffectProcessor::filter() path renderVideo()'s effect stage
+// uses — YUV420P in, slice-threaded graph, sink frame out. Built with the
+// tests but not registered with ctest, since the numbers are the machine's.
+// Run by hand, all presets or one:
+//
+//   ./bench_videoeffects
+//   ./bench_videoeffects throughput:sepia
+//
+// Each row reports frames per second of the filter alone. An effect that
+// stays above 30 keeps up with a 1080p30 render: decode, scale and encode
+// run alongside it on threads of their own.
+class BenchVideoEffects : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int kWidth  = 1920;
+    static constexpr int kHeight = 1080;
+    static constexpr int kFrames = 60;
+
+    // A gradient that moves a little every frame, so temporal effects
+    // (trails, ghosting) have something to blend
+    static AVFrame *sourceFrame(int i)
+    {
+        AVFrame *f = av_frame_alloc();
+        f->format = AV_PIX_FMT_YUV420P;
+        f->width  = kWidth;
+        f->height = kHeight;
+        f->pts    = i;
+        if (av_frame_get_buffer(f, 0) < 0) {
+            av_frame_free(&f);
+            return nullptr;
+        }
+        for (int y = 0; y < kHeight; ++y)
+            for (int x = 0; x < kWidth; ++x)
+                f->data[0][y * f->linesize[0] + x] = uint8_t((x + y + 4 * i) & 0xFF);
+        for (int p = 1; p < 3; ++p)
+            for (int y = 0; y < kHeight / 2; ++y)
+                memset(f->data[p] + y * f->linesize[p], p == 1 ? 100 + i % 50 : 150, kWidth / 2);
+        return f;
+    }
+
+private slots:
+    void throughput_data()
+    {
+        QTest::addColumn<QString>("chain");
+        for (const VideoEffectPreset &preset : videoEffectPresets) {
+            QVector<double> defaults;
+            for (const VideoEffectParam &param : preset.params)
+                defaults << param.defaultValue;
+            QTest::newRow(preset.id.toUtf8().constData()) << preset.buildFilterChain(defaults);
+        }
+    }
+
+    void throughput()
+    {
+        QFETCH(QString, chain);
+        if (!FFmpegNative::VideoEffectProcessor::isChainAvailable(chain))
+            QSKIP("Chain can't be built here (frei0r plugin not installed?)");
+
+        FFmpegNative::VideoEffectProcessor fx;
+        std::vector<AVFrame *> out;
+        auto freeOut = [&out] {
+            for (AVFrame *f : out)
+                av_frame_free(&f);
+            out.clear();
+        };
+        // The first frame builds the graph (and loads any frei0r plugin):
+        // that's a one-off per render, not throughput
+        fx.filter(sourceFrame(0), chain, AVRational{1, 25}, out);
+        freeOut();
+
+        // Source frames are made outside the timing; each is handed over
+        // unshared, as the render's scale stage does
+        qint64 filterNs = 0;
+        QElapsedTimer timer;
+        for (int i = 1; i <= kFrames; ++i) {
+            AVFrame *in = sourceFrame(i);
+            QVERIFY(in);
+            timer.start();
+            fx.filter(in, chain, AVRational{1, 25}, out);
+            filterNs += timer.nsecsElapsed();
+            QVERIFY(!out.empty());
+            freeOut();
+        }
+        fx.filter(nullptr, chain, AVRational{1, 25}, out);
+        freeOut();
+
+        const double fps = kFrames * 1e9 / double(std::max<qint64>(1, filterNs));
+        QTest::setBenchmarkResult(fps, QTest::FramesPerSecond);
+        qInfo().noquote() << QString("%1: %2 fps at %3x%4%5")
+                                 .arg(QTest::currentDataTag()).arg(fps, 0, 'f', 1)
+                                 .arg(kWidth).arg(kHeight)
+                                 .arg(fps >= 30.0 ? "" : " — below real time");
+    }
+};
+
+QTEST_MAIN(BenchVideoEffects)
+#include "bench_videoeffects.moc"
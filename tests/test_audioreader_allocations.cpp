@@ -0,0 +1,114 @@
+#include "ffmpegnative.h"
+#include "wavfile.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Every C++ heap allocation in this executable goes through the operators
+// below, so a test can count the ones its own thread makes between two
+// points. FFmpeg's av_malloc() isn't C++ and isn't counted: this is about
+// the buffers AudioReader and its callers manage themselves. Its own TU
+// (and executable), since replacing the global operators is program-wide.
+static std::atomic<qint64> s_allocations{0};
+static thread_local bool   s_counting = false;
+
+void *operator new(std::size_t size)
+{
+    if (s_counting)
+        ++s_allocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) { return ::operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+// AudioReader::readAll() sizes its output once from the container's
+// duration and decodes straight into it, with one scratch buffer for the
+// resampler reused from frame to frame — so decoding a file takes the same
+// handful of allocations however long it is. A per-frame vector or an
+// output grown by appending would show up here as a count that follows the
+// length.
+class TestAudioReaderAllocations : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    QString path(const QString &name) const { return m_dir.filePath(name); }
+
+    // `seconds` of a 48 kHz stereo Int16 sine: the reader resamples it to
+    // its 44.1 kHz default, the path every real source takes
+    static bool writeSine(const QString &file, int seconds)
+    {
+        QAudioFormat fmt;
+        fmt.setSampleRate(48000);
+        fmt.setChannelCount(2);
+        fmt.setSampleFormat(QAudioFormat::Int16);
+        QByteArray pcm(qsizetype(seconds) * 48000 * 4, '\0');
+        auto *s = reinterpret_cast<qint16 *>(pcm.data());
+        for (qsizetype i = 0; i < qsizetype(seconds) * 48000; ++i)
+            s[2 * i] = s[2 * i + 1] = qint16(8000.0 * std::sin(2.0 * M_PI * 440.0 * i / 48000.0));
+        QFile f(file);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        writeWavHeader(f, fmt, pcm.size(), pcm);
+        return true;
+    }
+
+    // Allocations made opening `file` and reading all of it; -1 on failure
+    static qint64 allocationsToReadAll(const QString &file, qsizetype &samples)
+    {
+        std::vector<float> out;
+        s_allocations = 0;
+        s_counting = true;
+        bool ok;
+        {
+            FFmpegNative::AudioReader reader(file, FFmpegNative::AudioReader::Format{});
+            ok = reader.readAll(out);
+        }
+        s_counting = false;
+        samples = qsizetype(out.size());
+        return ok ? s_allocations.load() : -1;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        QVERIFY(writeSine(path("short.wav"), 2));
+        QVERIFY(writeSine(path("long.wav"), 120));
+    }
+
+    void readAll_allocationsDontGrowWithLength()
+    {
+        qsizetype shortSamples = 0, longSamples = 0;
+        const qint64 shortCount = allocationsToReadAll(path("short.wav"), shortSamples);
+        const qint64 longCount  = allocationsToReadAll(path("long.wav"), longSamples);
+        QVERIFY(shortCount >= 0);
+        QVERIFY(longCount >= 0);
+        QVERIFY(std::abs(shortSamples - 2 * 44100 * 2) < 2 * 1024);
+        QVERIFY(std::abs(longSamples - 120 * 44100 * 2) < 2 * 1024);
+
+        qInfo() << "allocations: 2 s" << shortCount << "— 120 s" << longCount;
+        // 60 times the frames, the same buffers. Two spare: the output for a
+        // duration estimate that came out a block short, the resampler's
+        // scratch buffer for a frame larger than any in the short file.
+        QVERIFY2(longCount <= shortCount + 2,
+                 qPrintable(QString("2 s took %1 allocations, 120 s took %2")
+                            .arg(shortCount).arg(longCount)));
+    }
+};
+
+QTEST_MAIN(TestAudioReaderAllocations)
+#include "test_audioreader_allocations.moc"
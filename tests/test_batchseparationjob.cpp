@@ -0,0 +1,317 @@
+#include "batchseparationjob.h"
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QHash>
+#include <QLockFile>
+#include <QMutex>
+#include <QThread>
+
+// Drives BatchSeparationJob through VocalSeparationJob's separate-engine
+// seam, so what's under test is the queue itself — which items run, where
+// their outputs land, what survives an interruption — not the separator.
+// Every test gets its own queue file and SeparationCache root under a
+// QTemporaryDir, and the inputs within a test have distinct content, so a
+// cache hit can never stand in for an engine call the test expects to see.
+class TestBatchSeparationJob : public QObject
+{
+    Q_OBJECT
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+
+    // Engine calls per input file name, across every worker thread
+    QMutex m_callsMutex;
+    QHash<QString, int> m_calls;
+
+    static bool writeFile(const QString &path, const QByteArray &content)
+    {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly)) return false;
+        return f.write(content) == content.size();
+    }
+
+    static QByteArray readFile(const QString &path)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+        return f.readAll();
+    }
+
+    QString path(const QString &name) const { return m_dir->filePath(name); }
+    QString queuePath() const { return path("queue/queue.json"); }
+
+    // Writes n inputs "song<i>.mp4" with distinct content
+    QStringList makeInputs(int n)
+    {
+        QStringList inputs;
+        for (int i = 0; i < n; ++i) {
+            const QString p = path(QString("in/song%1.mp4").arg(i));
+            if (!writeFile(p, "song " + QByteArray::number(i)))
+                return {};
+            inputs << p;
+        }
+        return inputs;
+    }
+
+    // "Separates" by copying the input's bytes into the workspace, so each
+    // output can be checked against the input it came from. Inputs named
+    // in `failing` fail; ones named in `blocking` run until cancelled.
+    VocalSeparationJob::SeparateEngine engine(const QStringList &failing = {},
+                                              const QStringList &blocking = {})
+    {
+        return [this, failing, blocking](const QString &inputFile, const QString &workspaceDir,
+                                         const std::function<void(int)> &progressFn,
+                                         QString &errorOut,
+                                         const std::atomic<bool> *cancelled) -> QString {
+            const QString name = QFileInfo(inputFile).fileName();
+            {
+                QMutexLocker lock(&m_callsMutex);
+                ++m_calls[name];
+            }
+            progressFn(50);
+            if (blocking.contains(name)) {
+                while (!cancelled->load())
+                    QThread::msleep(5);
+                errorOut = "Cancelled";
+                return QString();
+            }
+            if (failing.contains(name)) {
+                errorOut = "cannot decode " + name;
+                return QString();
+            }
+            const QString out = workspaceDir + "/instrumental.wav";
+            if (!writeFile(out, readFile(inputFile)))
+                return QString();
+            progressFn(100);
+            return out;
+        };
+    }
+
+    int calls(const QString &name)
+    {
+        QMutexLocker lock(&m_callsMutex);
+        return m_calls.value(name);
+    }
+
+private slots:
+    void init()
+    {
+        m_dir.reset(new QTemporaryDir);
+        QVERIFY(m_dir->isValid());
+        // Per test: the inputs of one test are byte-identical to the last's
+        qputenv("WAKKAQT_SEPARATION_CACHE_OVERRIDE", path("cache").toUtf8());
+        QMutexLocker lock(&m_callsMutex);
+        m_calls.clear();
+    }
+    void cleanup() { m_dir.reset(); }
+
+    void scanFolder_findsMediaOnly()
+    {
+        QVERIFY(writeFile(path("lib/a.mp4"), "a"));
+        QVERIFY(writeFile(path("lib/cover.jpg"), "jpg"));
+        QVERIFY(writeFile(path("lib/lyrics.txt"), "la la"));
+        QVERIFY(writeFile(path("lib/sub/b.wav"), "b"));
+
+        QCOMPARE(BatchSeparationJob::scanFolder(path("lib")),
+                 (QStringList{path("lib/a.mp4"), path("lib/sub/b.wav")}));
+        QCOMPARE(BatchSeparationJob::scanFolder(path("lib"), false),
+                 QStringList{path("lib/a.mp4")});
+    }
+
+    // The same input twice is one item; two inputs with the same base name
+    // from different folders must not write the same output
+    void enqueue_skipsDuplicatesAndNumbersNameClashes()
+    {
+        QVERIFY(writeFile(path("a/song.mp4"), "a"));
+        QVERIFY(writeFile(path("b/song.mp4"), "b"));
+
+        BatchSeparationJob job(queuePath());
+        QCOMPARE(job.enqueue({path("a/song.mp4"), path("b/song.mp4"), path("a/song.mp4")},
+                             path("out")), 2);
+        QCOMPARE(job.enqueue({path("a/song.mp4")}, path("out")), 0);
+
+        const QList<BatchSeparationJob::Item> items = job.items();
+        QCOMPARE(items.size(), 2);
+        QCOMPARE(items[0].outputPath, path("out/song.instrumental.wav"));
+        QCOMPARE(items[1].outputPath, path("out/song (2).instrumental.wav"));
+
+        // ...and the queue is already on disk
+        BatchSeparationJob reloaded(queuePath());
+        QVERIFY(reloaded.load());
+        QCOMPARE(reloaded.items().size(), 2);
+    }
+
+    void run_twoWorkers_writesEveryOutput()
+    {
+        const QStringList inputs = makeInputs(5);
+        QCOMPARE(inputs.size(), 5);
+
+        BatchSeparationJob job(queuePath());
+        job.setSeparateEngineForTesting(engine());
+        job.setWorkerCount(2);
+        QCOMPARE(job.enqueue(inputs, path("out")), 5);
+
+        QSignalSpy finishedSpy(&job, &BatchSeparationJob::finished);
+        QSignalSpy itemFinishedSpy(&job, &BatchSeparationJob::itemFinished);
+        job.start();
+        QVERIFY(finishedSpy.wait(10000));
+        QCOMPARE(finishedSpy.first(), (QVariantList{5, 0, false}));
+        QCOMPARE(itemFinishedSpy.size(), 5);
+        QVERIFY(!job.isRunning());
+
+        for (int i = 0; i < 5; ++i) {
+            QCOMPARE(readFile(path(QString("out/song%1.instrumental.wav").arg(i))),
+                     "song " + QByteArray::number(i));
+            QCOMPARE(calls(QString("song%1.mp4").arg(i)), 1);
+        }
+        // Only the outputs — no staging sidecars left behind
+        QCOMPARE(QDir(path("out")).entryList(QDir::Files).size(), 5);
+    }
+
+    void run_failedItemIsReportedAndTheRestContinue()
+    {
+        const QStringList inputs = makeInputs(3);
+        BatchSeparationJob job(queuePath());
+        job.setSeparateEngineForTesting(engine({"song1.mp4"}));
+        QCOMPARE(job.enqueue(inputs, path("out")), 3);
+
+        QSignalSpy finishedSpy(&job, &BatchSeparationJob::finished);
+        QSignalSpy itemFailedSpy(&job, &BatchSeparationJob::itemFailed);
+        job.start();
+        QVERIFY(finishedSpy.wait(10000));
+        QCOMPARE(finishedSpy.first(), (QVariantList{2, 1, false}));
+        QCOMPARE(itemFailedSpy.size(), 1);
+        QCOMPARE(itemFailedSpy.first().at(0).toInt(), 1);
+        QCOMPARE(itemFailedSpy.first().at(1).toString(), QString("cannot decode song1.mp4"));
+
+        QVERIFY(QFile::exists(path("out/song0.instrumental.wav")));
+        QVERIFY(!QFile::exists(path("out/song1.instrumental.wav")));
+        QVERIFY(QFile::exists(path("out/song2.instrumental.wav")));
+
+        // The failure (and why) is persisted, and retryFailed() re-arms it
+        BatchSeparationJob reloaded(queuePath());
+        QVERIFY(reloaded.load());
+        QCOMPARE(reloaded.items()[1].state, BatchSeparationJob::ItemState::Failed);
+        QCOMPARE(reloaded.items()[1].error, QString("cannot decode song1.mp4"));
+        reloaded.retryFailed();
+        QCOMPARE(reloaded.items()[1].state, BatchSeparationJob::ItemState::Pending);
+    }
+
+    // Cancelling mid-item leaves it pending; a new job on the same queue
+    // file picks up from there without re-running what already finished
+    void cancel_thenResumeFromTheQueueFile()
+    {
+        const QStringList inputs = makeInputs(3);
+        {
+            BatchSeparationJob job(queuePath());
+            job.setSeparateEngineForTesting(engine({}, {"song1.mp4"}));
+            QCOMPARE(job.enqueue(inputs, path("out")), 3);
+
+            QSignalSpy finishedSpy(&job, &BatchSeparationJob::finished);
+            // Once song1's separation is under way, so it's cancelled in flight
+            connect(&job, &BatchSeparationJob::itemProgress, &job, [&job](int index, int) {
+                if (index == 1)
+                    job.cancel();
+            });
+            job.start();
+            QVERIFY(finishedSpy.wait(10000));
+            QCOMPARE(finishedSpy.first(), (QVariantList{1, 0, true}));
+        }
+
+        BatchSeparationJob resumed(queuePath());
+        QVERIFY(resumed.load());
+        QCOMPARE(resumed.items()[0].state, BatchSeparationJob::ItemState::Done);
+        QCOMPARE(resumed.items()[1].state, BatchSeparationJob::ItemState::Pending);
+        QCOMPARE(resumed.items()[2].state, BatchSeparationJob::ItemState::Pending);
+
+        resumed.setSeparateEngineForTesting(engine());
+        QSignalSpy finishedSpy(&resumed, &BatchSeparationJob::finished);
+        resumed.start();
+        QVERIFY(finishedSpy.wait(10000));
+        QCOMPARE(finishedSpy.first(), (QVariantList{3, 0, false}));
+
+        QCOMPARE(calls("song0.mp4"), 1);
+        QCOMPARE(calls("song1.mp4"), 2);   // the cancelled attempt, then the real one
+        QCOMPARE(calls("song2.mp4"), 1);
+        for (int i = 0; i < 3; ++i)
+            QVERIFY(QFile::exists(path(QString("out/song%1.instrumental.wav").arg(i))));
+    }
+
+    // Another process holding the queue locks out loading, every edit and
+    // running — and none of them touch the file
+    void refusedWhileAnotherProcessHoldsTheQueue()
+    {
+        const QStringList inputs = makeInputs(2);
+        BatchSeparationJob job(queuePath());
+        job.setSeparateEngineForTesting(engine());
+        QCOMPARE(job.enqueue({inputs[0]}, path("out")), 1);
+        const QByteArray saved = readFile(queuePath());
+
+        QLockFile otherProcess(queuePath() + ".lock");
+        QVERIFY(otherProcess.tryLock(0));
+        QVERIFY(job.isLockedElsewhere());
+
+        QString err;
+        QVERIFY(!BatchSeparationJob(queuePath()).load(&err));
+        QVERIFY(err.contains("already working"));
+        QCOMPARE(job.enqueue({inputs[1]}, path("out")), 0);
+        job.retryFailed();
+        job.clearFinished();
+        QCOMPARE(readFile(queuePath()), saved);
+
+        QSignalSpy errorSpy(&job, &BatchSeparationJob::batchError);
+        QSignalSpy finishedSpy(&job, &BatchSeparationJob::finished);
+        job.start();
+        QCOMPARE(errorSpy.size(), 1);
+        QCOMPARE(finishedSpy.size(), 1);
+        QCOMPARE(finishedSpy.first(), (QVariantList{0, 0, false}));
+        QCOMPARE(calls("song0.mp4"), 0);
+        QCOMPARE(readFile(queuePath()), saved);
+    }
+
+    // A second job (a headless run next to the GUI's) can't slip items into
+    // the queue of a running batch only for that batch's next save to drop
+    // them; once the run is over, its edit goes through and survives.
+    void enqueue_duringAnotherJobsRunIsRefusedNotLost()
+    {
+        const QStringList inputs = makeInputs(2);
+        BatchSeparationJob running(queuePath());
+        running.setSeparateEngineForTesting(engine({}, {"song0.mp4"}));
+        QCOMPARE(running.enqueue({inputs[0]}, path("out")), 1);
+        QSignalSpy progressSpy(&running, &BatchSeparationJob::itemProgress);
+        QSignalSpy finishedSpy(&running, &BatchSeparationJob::finished);
+        running.start();
+        QVERIFY(progressSpy.wait(10000));
+
+        BatchSeparationJob headless(queuePath());
+        QVERIFY(!headless.load());
+        QCOMPARE(headless.enqueue({inputs[1]}, path("out")), 0);
+
+        running.cancel();
+        QVERIFY(finishedSpy.wait(10000));
+
+        QVERIFY(headless.load());
+        QCOMPARE(headless.enqueue({inputs[1]}, path("out")), 1);
+        BatchSeparationJob reloaded(queuePath());
+        QVERIFY(reloaded.load());
+        QCOMPARE(reloaded.items().size(), 2);
+    }
+
+    void load_malformedQueueIsAnErrorNotACrash()
+    {
+        QVERIFY(writeFile(queuePath(), "{ not json"));
+        BatchSeparationJob job(queuePath());
+        QString err;
+        QVERIFY(!job.load(&err));
+        QVERIFY(!err.isEmpty());
+        QVERIFY(job.items().isEmpty());
+    }
+};
+
+QTEST_MAIN(TestBatchSeparationJob)
+#include "test_batchseparationjob.moc"
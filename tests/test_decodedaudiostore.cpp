@@ -0,0 +1,211 @@
+#include "decodedaudiostore.h"
+#include "wavfile.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <cstdlib>
+
+// Real files under a QTemporaryDir, like test_rendervideocache. The sources
+// are small WAVs, so a decode is FFmpegNative::extractAudio() passing the
+// samples straight through: the entry has to hold exactly what went in.
+class TestDecodedAudioStore : public QObject
+{
+    Q_OBJECT
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+
+    QString path(const QString &name) const { return m_dir->filePath(name); }
+
+    // A second of a stereo Int16 ramp at 22050 Hz, the two channels apart
+    static QByteArray rampPcm(int seed)
+    {
+        QByteArray pcm(22050 * 2 * 2, '\0');
+        auto *s = reinterpret_cast<qint16 *>(pcm.data());
+        for (int i = 0; i < 22050; ++i) {
+            s[2 * i]     = qint16((i * 7 + seed) % 20000 - 10000);
+            s[2 * i + 1] = qint16((i * 3 + seed) % 20000 - 10000);
+        }
+        return pcm;
+    }
+
+    static bool writeWav(const QString &file, const QByteArray &pcm)
+    {
+        QAudioFormat fmt;
+        fmt.setSampleRate(22050);
+        fmt.setChannelCount(2);
+        fmt.setSampleFormat(QAudioFormat::Int16);
+        QFile f(file);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        writeWavHeader(f, fmt, pcm.size(), pcm);
+        return true;
+    }
+
+    static void setMtime(const QString &file, const QDateTime &when)
+    {
+        QFile f(file);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        QVERIFY(f.setFileTime(when, QFileDevice::FileModificationTime));
+    }
+
+private slots:
+    void init()
+    {
+        m_dir.reset(new QTemporaryDir);
+        QVERIFY(m_dir->isValid());
+    }
+    void cleanup() { m_dir.reset(); }
+
+    void keyFor_followsTheSourcesIdentity()
+    {
+        QVERIFY(writeWav(path("song.wav"), rampPcm(0)));
+        setMtime(path("song.wav"), QDateTime::currentDateTimeUtc().addSecs(-600));
+        const QString before = DecodedAudioStore::keyFor(path("song.wav"));
+        QCOMPARE(before.size(), 64);
+        QCOMPARE(DecodedAudioStore::keyFor(path("song.wav")), before);
+
+        QVERIFY(writeWav(path("song.wav"), rampPcm(1)));   // same size, newer mtime
+        QVERIFY(DecodedAudioStore::keyFor(path("song.wav")) != before);
+        QVERIFY(DecodedAudioStore::keyFor(path("missing.wav")).isEmpty());
+    }
+
+    void map_pointsIntoTheFile()
+    {
+        const QByteArray pcm = rampPcm(0);
+        QVERIFY(writeWav(path("song.wav"), pcm));
+
+        const DecodedAudioStore::View view = DecodedAudioStore::map(path("song.wav"));
+        QVERIFY(view.isValid());
+        QCOMPARE(view.format().sampleRate(), 22050);
+        QCOMPARE(view.format().channelCount(), 2);
+        QCOMPARE(view.frames(), qint64(22050));
+        const QByteArray bytes = view.bytes();
+        QVERIFY(bytes.constData() == view.data());   // not a copy
+        QCOMPARE(bytes, pcm);
+
+        QFile junk(path("junk.wav"));
+        QVERIFY(junk.open(QIODevice::WriteOnly));
+        junk.write("not a wav file at all");
+        junk.close();
+        QVERIFY(!DecodedAudioStore::map(path("junk.wav")).isValid());
+        QVERIFY(!DecodedAudioStore::map(path("missing.wav")).isValid());
+    }
+
+    void open_decodesOnceThenHits()
+    {
+        const QByteArray pcm = rampPcm(0);
+        QVERIFY(writeWav(path("song.wav"), pcm));
+        DecodedAudioStore store(path("store"));
+        QVERIFY(store.lookup(path("song.wav")).isEmpty());
+
+        const DecodedAudioStore::View first = store.open(path("song.wav"));
+        QVERIFY(first.isValid());
+        QCOMPARE(first.path(), path("store/" + DecodedAudioStore::keyFor(path("song.wav")) + ".wav"));
+        QCOMPARE(first.format().sampleFormat(), QAudioFormat::Int16);
+        QCOMPARE(first.format().sampleRate(), 22050);
+        QCOMPARE(first.bytes(), pcm);
+
+        const QDateTime decodedAt = QFileInfo(first.path()).lastModified();
+        const DecodedAudioStore::View second = store.open(path("song.wav"));
+        QCOMPARE(second.path(), first.path());
+        QCOMPARE(store.lookup(path("song.wav")), first.path());
+        QCOMPARE(QDir(path("store")).entryList(QDir::Files).size(), 1);   // no staging left
+        QCOMPARE(store.sizeBytes(), QFileInfo(first.path()).size());
+        QVERIFY(QFileInfo(first.path()).lastModified() >= decodedAt);
+    }
+
+    // The render mix and the separator's entry: its own file, float32
+    // stereo at 44.1 kHz whatever the source's rate, decoded once like the
+    // Int16 one
+    void openFloat_decodesTo44100FloatBesideTheInt16Entry()
+    {
+        const QByteArray pcm = rampPcm(0);
+        QVERIFY(writeWav(path("song.wav"), pcm));
+        DecodedAudioStore store(path("store"));
+        const auto Float = DecodedAudioStore::Precision::Float;
+
+        const DecodedAudioStore::View f = store.open(path("song.wav"), Float);
+        QVERIFY(f.isValid());
+        QCOMPARE(f.path(), path("store/f32/" + DecodedAudioStore::keyFor(path("song.wav")) + ".wav"));
+        QCOMPARE(f.format().sampleFormat(), QAudioFormat::Float);
+        QCOMPARE(f.format().sampleRate(), 44100);
+        QCOMPARE(f.format().channelCount(), 2);
+        QVERIFY(std::abs(f.frames() - 44100) < 64);
+        QVERIFY(store.lookup(path("song.wav")).isEmpty());   // no Int16 entry made
+
+        // Released pages come back from the file unchanged
+        const QByteArray before(f.data(), f.size());
+        f.releasePages(0, f.size());
+        QVERIFY(f.bytes() == before);
+
+        QCOMPARE(store.open(path("song.wav"), Float).path(), f.path());
+        QCOMPARE(store.lookup(path("song.wav"), Float), f.path());
+        QVERIFY(store.open(path("song.wav")).isValid());
+        QCOMPARE(store.sizeBytes(),
+                 QFileInfo(f.path()).size() + QFileInfo(store.lookup(path("song.wav"))).size());
+    }
+
+    void open_missingSourceIsInvalid()
+    {
+        DecodedAudioStore store(path("store"));
+        QVERIFY(!store.open(path("missing.wav")).isValid());
+    }
+
+    // Over the cap, an entry a View still maps stays put — its holder may
+    // have handed the path on — and goes once the last View is released
+    void open_evictsOverCapOnlyOnceUnmapped()
+    {
+        const QByteArray pcmA = rampPcm(0);
+        QVERIFY(writeWav(path("a.wav"), pcmA));
+        QVERIFY(writeWav(path("b.wav"), rampPcm(5)));
+        QVERIFY(writeWav(path("c.wav"), rampPcm(9)));
+        DecodedAudioStore store(path("store"), pcmA.size() + pcmA.size() / 2);
+
+        QString aPath;
+        {
+            const DecodedAudioStore::View a = store.open(path("a.wav"));
+            QVERIFY(a.isValid());
+            aPath = a.path();
+            setMtime(aPath, QDateTime::currentDateTimeUtc().addSecs(-100));
+            QVERIFY(store.open(path("b.wav")).isValid());
+
+            QVERIFY(QFile::exists(aPath));
+            QCOMPARE(store.lookup(path("a.wav")), aPath);
+            QCOMPARE(a.bytes(), pcmA);
+            setMtime(aPath, QDateTime::currentDateTimeUtc().addSecs(-100));
+        }
+
+        QVERIFY(store.open(path("c.wav")).isValid());
+        QVERIFY(!QFile::exists(aPath));
+        QVERIFY(store.lookup(path("a.wav")).isEmpty());
+    }
+
+    // The path a build without native FFmpeg fills through the CLI
+    void insert_commitsAStagedDecode()
+    {
+        const QByteArray pcm = rampPcm(3);
+        QVERIFY(writeWav(path("song.wav"), pcm));
+        DecodedAudioStore store(path("store"));
+
+        const QString staging = store.stagingPathFor(path("song.wav"));
+        QVERIFY(!staging.isEmpty());
+        QVERIFY(staging != store.stagingPathFor(path("song.wav")));
+        QVERIFY(writeWav(staging, pcm));
+
+        const DecodedAudioStore::View view = store.insert(path("song.wav"), staging);
+        QVERIFY(view.isValid());
+        QVERIFY(!QFile::exists(staging));
+        QCOMPARE(store.lookup(path("song.wav")), view.path());
+        QCOMPARE(view.bytes(), pcm);
+
+        QVERIFY(store.stagingPathFor(path("missing.wav")).isEmpty());
+    }
+};
+
+QTEST_MAIN(TestDecodedAudioStore)
+#include "test_decodedaudiostore.moc"
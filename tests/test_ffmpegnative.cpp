@@ -0,0 +1,641 @@
+#include "ffmpegnative.h"
+#include "decodedaudiostore.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QtEndian>
+#include <QVector>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
+
+// Renders through FFmpegNative::renderVideo() on synthetic WAVs written
+// here, so the inputs are exactly known: mono 8 kHz sines, resampled by the
+// render to 44.1 kHz stereo like any real recording. Audio-only outputs keep
+// the mixer tests independent of which video encoders this machine has; the
+// smart-render tests need one for their re-encode reference and skip without.
+class TestFFmpegNative : public QObject
+{
+    Q_OBJECT
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+    QTemporaryDir                 m_storeDir;   // the renders' DecodedAudioStore
+
+    static constexpr int kRate = 8000;
+
+    // Streams a mono S16 WAV of `seconds` of sine at `hz` (amplitude 0 for
+    // silence) in small blocks — writing a long input must not itself raise
+    // the peak RSS the streaming test measures.
+    static bool writeSineWav(const QString &path, double seconds, double hz, double amplitude)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly)) return false;
+        const quint32 frames = quint32(seconds * kRate);
+        const quint32 dataBytes = frames * 2;
+
+        QByteArray header(44, '\0');
+        char *h = header.data();
+        auto put32 = [h](int at, quint32 v) { qToLittleEndian(v, h + at); };
+        auto put16 = [h](int at, quint16 v) { qToLittleEndian(v, h + at); };
+        memcpy(h, "RIFF", 4);      put32(4, 36 + dataBytes);
+        memcpy(h + 8, "WAVEfmt ", 8);
+        put32(16, 16);             put16(20, 1);  put16(22, 1);
+        put32(24, kRate);          put32(28, kRate * 2);
+        put16(32, 2);              put16(34, 16);
+        memcpy(h + 36, "data", 4); put32(40, dataBytes);
+        if (f.write(header) != header.size()) return false;
+
+        QByteArray block;
+        for (quint32 i = 0; i < frames; ) {
+            block.resize(int(std::min<quint32>(frames - i, 32768)) * 2);
+            qint16 *s = reinterpret_cast<qint16 *>(block.data());
+            for (int k = 0; k < block.size() / 2; ++k, ++i)
+                s[k] = qint16(amplitude * 32767.0 * std::sin(2.0 * M_PI * hz * i / kRate));
+            if (f.write(block) != block.size()) return false;
+        }
+        return true;
+    }
+
+    // RMS of both channels over [fromSec, toSec) of 44.1 kHz stereo PCM
+    static double rms(const std::vector<float> &pcm, double fromSec, double toSec)
+    {
+        const size_t from = size_t(fromSec * 44100) * 2;
+        const size_t to   = std::min(pcm.size(), size_t(toSec * 44100) * 2);
+        double sum = 0.0;
+        for (size_t i = from; i < to; ++i)
+            sum += double(pcm[i]) * pcm[i];
+        return to > from ? std::sqrt(sum / double(to - from)) : 0.0;
+    }
+
+    static qint64 peakRssBytes()
+    {
+#ifdef Q_OS_WIN
+        return -1;
+#else
+        struct rusage ru {};
+        getrusage(RUSAGE_SELF, &ru);
+#  ifdef Q_OS_MACOS
+        return qint64(ru.ru_maxrss);          // bytes on macOS
+#  else
+        return qint64(ru.ru_maxrss) * 1024;   // KiB on Linux
+#  endif
+#endif
+    }
+
+    // A stand-in webcam recording: `seconds` of 25 fps MPEG-4 Part 2 (built
+    // into every FFmpeg, unlike libx264) in .mp4, a keyframe every 12 frames
+    // so a seek has somewhere other than 0 to land.
+    static bool writeTestVideo(const QString &path, int w, int h, double seconds)
+    {
+        const AVCodec *enc = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+        AVFormatContext *fmt = nullptr;
+        avformat_alloc_output_context2(&fmt, nullptr, nullptr, path.toUtf8().constData());
+        if (!enc || !fmt) { avformat_free_context(fmt); return false; }
+
+        AVCodecContext *ctx = avcodec_alloc_context3(enc);
+        ctx->width = w;  ctx->height = h;
+        ctx->pix_fmt      = AV_PIX_FMT_YUV420P;
+        ctx->time_base    = {1, 25};
+        ctx->framerate    = {25, 1};
+        ctx->gop_size     = 12;
+        ctx->max_b_frames = 0;
+        if (fmt->oformat->flags & AVFMT_GLOBALHEADER)
+            ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        AVStream *st = avformat_new_stream(fmt, nullptr);
+        bool ok = avcodec_open2(ctx, enc, nullptr) >= 0
+               && avcodec_parameters_from_context(st->codecpar, ctx) >= 0
+               && avio_open(&fmt->pb, path.toUtf8().constData(), AVIO_FLAG_WRITE) >= 0;
+        st->time_base = ctx->time_base;
+        ok = ok && avformat_write_header(fmt, nullptr) >= 0;
+
+        AVFrame  *frame = av_frame_alloc();
+        AVPacket *pkt   = av_packet_alloc();
+        frame->format = ctx->pix_fmt;  frame->width = w;  frame->height = h;
+        ok = ok && av_frame_get_buffer(frame, 0) >= 0;
+        const int frames = int(seconds * 25);
+        for (int i = 0; ok && i <= frames; ++i) {
+            AVFrame *in = nullptr;
+            if (i < frames) {
+                ok = av_frame_make_writable(frame) >= 0;
+                for (int plane = 0; plane < 3; ++plane)   // brightness ramps with time
+                    memset(frame->data[plane], plane == 0 ? (i * 7) % 220 + 16 : 128,
+                           size_t(frame->linesize[plane]) * (plane == 0 ? h : h / 2));
+                frame->pts = i;
+                in = frame;
+            }
+            ok = ok && avcodec_send_frame(ctx, in) >= 0;
+            while (ok && avcodec_receive_packet(ctx, pkt) >= 0) {
+                av_packet_rescale_ts(pkt, ctx->time_base, st->time_base);
+                pkt->stream_index = st->index;
+                ok = av_interleaved_write_frame(fmt, pkt) >= 0;
+            }
+        }
+        ok = ok && av_write_trailer(fmt) >= 0;
+
+        av_packet_free(&pkt);
+        av_frame_free(&frame);
+        avcodec_free_context(&ctx);
+        if (fmt->pb) avio_closep(&fmt->pb);
+        avformat_free_context(fmt);
+        return ok;
+    }
+
+    struct VideoTrack {
+        AVCodecID codec     = AV_CODEC_ID_NONE;   // NONE: no video stream
+        double    startSec  = 0.0;                // earliest presentation time
+        int       packets   = 0;
+    };
+
+    static VideoTrack videoTrack(const QString &path)
+    {
+        VideoTrack t;
+        AVFormatContext *fmt = nullptr;
+        if (avformat_open_input(&fmt, path.toUtf8().constData(), nullptr, nullptr) < 0)
+            return t;
+        avformat_find_stream_info(fmt, nullptr);
+        const int idx = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (idx >= 0) {
+            const AVStream *st = fmt->streams[idx];
+            t.codec = st->codecpar->codec_id;
+            int64_t minPts = INT64_MAX;
+            AVPacket *pkt = av_packet_alloc();
+            while (av_read_frame(fmt, pkt) >= 0) {
+                if (pkt->stream_index == idx) {
+                    ++t.packets;
+                    if (pkt->pts != AV_NOPTS_VALUE)
+                        minPts = std::min(minPts, pkt->pts);
+                }
+                av_packet_unref(pkt);
+            }
+            av_packet_free(&pkt);
+            if (minPts != INT64_MAX)
+                t.startSec = minPts * av_q2d(st->time_base);
+        }
+        avformat_close_input(&fmt);
+        return t;
+    }
+
+    // Mean luma of every frame of path's video stream, in presentation
+    // order; empty without one
+    static QVector<double> frameLumas(const QString &path)
+    {
+        QVector<double> lumas;
+        AVFormatContext *fmt = nullptr;
+        if (avformat_open_input(&fmt, path.toUtf8().constData(), nullptr, nullptr) < 0)
+            return lumas;
+        avformat_find_stream_info(fmt, nullptr);
+        const int idx = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        const AVCodec *dec = idx >= 0
+            ? avcodec_find_decoder(fmt->streams[idx]->codecpar->codec_id) : nullptr;
+        AVCodecContext *ctx = dec ? avcodec_alloc_context3(dec) : nullptr;
+        if (ctx && avcodec_parameters_to_context(ctx, fmt->streams[idx]->codecpar) >= 0
+            && avcodec_open2(ctx, dec, nullptr) >= 0) {
+            AVPacket *pkt = av_packet_alloc();
+            AVFrame  *frm = av_frame_alloc();
+            auto collect = [&]() {
+                while (avcodec_receive_frame(ctx, frm) >= 0) {
+                    double sum = 0.0;
+                    for (int y = 0; y < frm->height; ++y)
+                        for (int x = 0; x < frm->width; ++x)
+                            sum += frm->data[0][y * frm->linesize[0] + x];
+                    lumas << sum / (double(frm->width) * frm->height);
+                    av_frame_unref(frm);
+                }
+            };
+            while (av_read_frame(fmt, pkt) >= 0) {
+                if (pkt->stream_index == idx && avcodec_send_packet(ctx, pkt) >= 0)
+                    collect();
+                av_packet_unref(pkt);
+            }
+            avcodec_send_packet(ctx, nullptr);
+            collect();
+            av_frame_free(&frm);
+            av_packet_free(&pkt);
+        }
+        avcodec_free_context(&ctx);
+        avformat_close_input(&fmt);
+        return lumas;
+    }
+
+    QString path(const QString &name) const { return m_dir->filePath(name); }
+
+private slots:
+    // Before anything opens DecodedAudioStore::instance(), which reads it once
+    void initTestCase()
+    {
+        QVERIFY(m_storeDir.isValid());
+        qputenv("WAKKAQT_DECODED_CACHE_OVERRIDE", m_storeDir.path().toUtf8());
+    }
+
+    void init() { m_dir.reset(new QTemporaryDir); QVERIFY(m_dir->isValid()); }
+    void cleanup()
+    {
+        FFmpegNative::setRenderScaleWorkers(0);
+        m_dir.reset();
+    }
+
+    // The mix runs to the longer track, and a negative vocal offset delays
+    // the vocal by exactly that much rather than trimming anything.
+    void renderVideo_audioOnly_mixesToLongerTrackWithOffset()
+    {
+        QVERIFY(writeSineWav(path("vocal.wav"), 1.0, 440.0, 0.5));
+        QVERIFY(writeSineWav(path("playback.wav"), 3.0, 220.0, 0.0)); // silent backing
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), QString(), path("playback.wav"),
+                                          path("out.wav"), 1.0, -500, 0, "1280x720"));
+
+        const std::vector<float> out = FFmpegNative::decodeToFloatStereo(path("out.wav"));
+        QVERIFY(std::abs(qint64(out.size() / 2) - 3 * 44100) < 64);
+        QVERIFY(rms(out, 0.0, 0.45) < 1e-3);    // delayed...
+        QVERIFY(rms(out, 0.55, 1.45) > 0.2);    // ...vocal...
+        QVERIFY(rms(out, 1.55, 3.0) < 1e-3);    // ...then just the silent backing
+    }
+
+    // The backing track is mixed from its Float store entry, not decoded
+    // again: silence the entry's samples and the next render of the same
+    // playback is silent where only the playback plays.
+    void renderVideo_mixesPlaybackFromItsFloatStoreEntry()
+    {
+        QVERIFY(writeSineWav(path("vocal.wav"), 1.0, 440.0, 0.5));
+        QVERIFY(writeSineWav(path("playback.wav"), 2.0, 220.0, 0.5));
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), QString(), path("playback.wav"),
+                                          path("first.wav"), 1.0, 0, 0, "1280x720"));
+        QVERIFY(rms(FFmpegNative::decodeToFloatStereo(path("first.wav")), 1.1, 1.9) > 0.2);
+
+        const QString entry = DecodedAudioStore::instance().lookup(
+            path("playback.wav"), DecodedAudioStore::Precision::Float);
+        QVERIFY(!entry.isEmpty());
+        {
+            const DecodedAudioStore::View view = DecodedAudioStore::map(entry);
+            QVERIFY(view.isValid());
+            QCOMPARE(view.format().sampleFormat(), QAudioFormat::Float);
+            QCOMPARE(view.format().sampleRate(), 44100);
+            QVERIFY(std::abs(view.frames() - 2 * 44100) < 64);
+            QFile f(entry);
+            QVERIFY(f.open(QIODevice::ReadWrite));
+            QVERIFY(f.seek(f.size() - view.size()));
+            QCOMPARE(f.write(QByteArray(view.size(), '\0')), view.size());
+        }
+
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), QString(), path("playback.wav"),
+                                          path("second.wav"), 1.0, 0, 0, "1280x720"));
+        QVERIFY(rms(FFmpegNative::decodeToFloatStereo(path("second.wav")), 1.1, 1.9) < 1e-3);
+    }
+
+    // Memory must follow the block size, not the song: a 30-minute render
+    // used to hold four full-length PCM copies (over 600 MB each as float
+    // stereo) plus every encoded audio packet at once.
+    void renderVideo_thirtyMinutes_peakMemoryStaysBounded()
+    {
+        if (peakRssBytes() < 0)
+            QSKIP("No peak-RSS query on this platform");
+
+        QVERIFY(writeSineWav(path("vocal.wav"), 30 * 60.0, 440.0, 0.25));
+        QVERIFY(writeSineWav(path("playback.wav"), 30 * 60.0 + 5.0, 220.0, 0.25));
+
+        const qint64 before = peakRssBytes();
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), QString(), path("playback.wav"),
+                                          path("out.flac"), 1.0, 250, 0, "1280x720"));
+        const qint64 grewBy = peakRssBytes() - before;
+
+        QVERIFY(std::abs(FFmpegNative::getDuration(path("out.flac")) - (30 * 60.0 + 5.0)) < 1.0);
+        qInfo() << "peak RSS grew by" << grewBy / (1024 * 1024) << "MiB";
+        QVERIFY2(grewBy < qint64(64) << 20,
+                 qPrintable(QString("peak RSS grew by %1 MiB").arg(grewBy >> 20)));
+    }
+
+    // Smart render must put the video exactly where the full decode/re-encode
+    // path does, through both offset corrections: the delay for a negative
+    // videoOffsetMs, and for a positive one the seek plus the keyframe it
+    // actually landed on (700 ms falls between the 480 ms and 960 ms ones).
+    // The "null" effect chain changes no pixels but forces the re-encode.
+    void renderVideo_streamCopy_matchesReencodeTiming_data()
+    {
+        QTest::addColumn<qint64>("videoOffsetMs");
+        QTest::newRow("delayed")  << qint64(-300);
+        QTest::newRow("aligned")  << qint64(0);
+        QTest::newRow("seeked")   << qint64(700);
+    }
+    void renderVideo_streamCopy_matchesReencodeTiming()
+    {
+        QFETCH(qint64, videoOffsetMs);
+        QVERIFY(writeTestVideo(path("webcam.mp4"), 320, 240, 3.0));
+        QVERIFY(writeSineWav(path("vocal.wav"), 3.0, 440.0, 0.5));
+        QVERIFY(writeSineWav(path("playback.wav"), 3.0, 220.0, 0.5));
+
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("copy.mp4"), 1.0,
+                                          videoOffsetMs, videoOffsetMs, "320x240"));
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("reencode.mp4"), 1.0,
+                                          videoOffsetMs, videoOffsetMs, "320x240",
+                                          QString(), nullptr, {}, "null"));
+
+        const VideoTrack copy = videoTrack(path("copy.mp4"));
+        const VideoTrack reencode = videoTrack(path("reencode.mp4"));
+        if (reencode.codec == AV_CODEC_ID_NONE)
+            QSKIP("No video encoder on this machine for the re-encode reference");
+
+        QCOMPARE(copy.codec, AV_CODEC_ID_MPEG4);     // remuxed, not re-encoded
+        QVERIFY(reencode.codec != AV_CODEC_ID_MPEG4);
+        QVERIFY2(std::abs(copy.startSec - reencode.startSec) < 0.02,
+                 qPrintable(QString("copy starts at %1 s, re-encode at %2 s")
+                            .arg(copy.startSec).arg(reencode.startSec)));
+        QVERIFY(std::abs(copy.packets - reencode.packets) <= 1);
+        if (videoOffsetMs <= 0)
+            QVERIFY(std::abs(copy.startSec - (-videoOffsetMs) / 1000.0) < 0.02);
+
+        // The mix is the same either way
+        QVERIFY(std::abs(FFmpegNative::getDuration(path("copy.mp4"))
+                         - FFmpegNative::getDuration(path("reencode.mp4"))) < 0.1);
+    }
+
+    // A render that encodes video keeps a copy for RenderVideoReuse; a later
+    // render that only changes audio remuxes it and must come out with the
+    // same video, at the same place, the delay for the offset included once.
+    void renderVideo_reusedVideo_matchesTheRenderThatWroteIt()
+    {
+        QVERIFY(writeTestVideo(path("webcam.mp4"), 320, 240, 2.0));
+        QVERIFY(writeSineWav(path("vocal.wav"), 2.0, 440.0, 0.5));
+        QVERIFY(writeSineWav(path("playback.wav"), 2.0, 220.0, 0.5));
+
+        FFmpegNative::RenderVideoReuse write;
+        write.writeTo = path("reuse.mkv");
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("first.mp4"), 1.0,
+                                          -300, -300, "320x240", QString(), nullptr, {},
+                                          "null", write));
+        const VideoTrack first = videoTrack(path("first.mp4"));
+        if (first.codec == AV_CODEC_ID_NONE)
+            QSKIP("No video encoder on this machine");
+        if (!QFile::exists(path("reuse.mkv")))
+            QSKIP("The encoder this machine picked has no global header to cache");
+
+        FFmpegNative::RenderVideoReuse read;
+        read.readFrom = path("reuse.mkv");
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("again.mp4"), 0.5,
+                                          -300, -300, "320x240", QString(), nullptr, {},
+                                          "null", read));
+        const VideoTrack again = videoTrack(path("again.mp4"));
+        QCOMPARE(again.codec, first.codec);
+        QCOMPARE(again.packets, first.packets);
+        QVERIFY2(std::abs(again.startSec - first.startSec) < 0.002,
+                 qPrintable(QString("reused video starts at %1 s, original at %2 s")
+                            .arg(again.startSec).arg(first.startSec)));
+        QVERIFY(std::abs(first.startSec - 0.3) < 0.02);
+
+        // A reuse file that doesn't fit the output is a full render, not a failure
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("bigger.mp4"), 1.0,
+                                          0, 0, "640x360", QString(), nullptr, {},
+                                          "null", read));
+        QCOMPARE(videoTrack(path("bigger.mp4")).codec, first.codec);
+    }
+
+    // The "null" chain sends every frame through the staged re-encode —
+    // decode, parallel scale, effect, encode — without changing a pixel, so
+    // what comes out has to be the webcam's frames, each once and in order,
+    // however the four scale workers happened to finish them. Cancelled at
+    // half way, the same render has to stop within a few frames and fail,
+    // not hang on one of its queues.
+    void renderVideo_nullEffect_keepsFrameOrderAndCancels()
+    {
+        FFmpegNative::setRenderScaleWorkers(4);
+        QVERIFY(writeTestVideo(path("webcam.mp4"), 320, 240, 4.0));
+        QVERIFY(writeSineWav(path("vocal.wav"), 4.0, 440.0, 0.5));
+        QVERIFY(writeSineWav(path("playback.wav"), 4.0, 220.0, 0.5));
+
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("out.mp4"), 1.0,
+                                          0, 0, "640x480", QString(), nullptr, {}, "null"));
+        const QVector<double> lumas = frameLumas(path("out.mp4"));
+        if (lumas.isEmpty())
+            QSKIP("No video encoder on this machine");
+        QCOMPARE(lumas.size(), 100);
+        for (int i = 0; i < lumas.size(); ++i) {
+            const double expected = (i * 7) % 220 + 16;   // writeTestVideo()'s ramp
+            QVERIFY2(std::abs(lumas[i] - expected) < 3.0,
+                     qPrintable(QString("frame %1: luma %2, expected %3")
+                                .arg(i).arg(lumas[i]).arg(expected)));
+        }
+
+        std::atomic<bool> cancel{false};
+        double lastProgress = 0.0;
+        auto progress = [&](double p) {
+            lastProgress = p;
+            if (p >= 0.5)
+                cancel = true;
+        };
+        QVERIFY(!FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                           path("playback.wav"), path("cancelled.mp4"), 1.0,
+                                           0, 0, "640x480", QString(), &cancel, progress,
+                                           "null"));
+        QVERIFY(cancel.load());
+        QVERIFY2(lastProgress < 0.6, qPrintable(QString("progress ran on to %1").arg(lastProgress)));
+    }
+
+    // Any mismatch with the output falls back to the re-encode
+    void renderVideo_resolutionMismatch_reencodes()
+    {
+        QVERIFY(writeTestVideo(path("webcam.mp4"), 320, 240, 1.0));
+        QVERIFY(writeSineWav(path("vocal.wav"), 1.0, 440.0, 0.5));
+        QVERIFY(writeSineWav(path("playback.wav"), 1.0, 220.0, 0.5));
+        QVERIFY(FFmpegNative::renderVideo(path("vocal.wav"), path("webcam.mp4"),
+                                          path("playback.wav"), path("out.mp4"), 1.0,
+                                          0, 0, "640x360"));
+        const VideoTrack t = videoTrack(path("out.mp4"));
+        if (t.codec == AV_CODEC_ID_NONE)
+            QSKIP("No video encoder on this machine");
+        QVERIFY(t.codec != AV_CODEC_ID_MPEG4);
+    }
+
+    // A start offset is a seek plus a trim to the sample: what comes out
+    // must be what decoding from 0 and dropping the offset gives, bar the
+    // resampler's first few dozen frames of filter warm-up
+    void audioReader_seekedStartMatchesDecodeAndDiscard()
+    {
+        QVERIFY(writeSineWav(path("vocal.wav"), 3.0, 440.0, 0.5));
+        const std::vector<float> full = FFmpegNative::decodeToFloatStereo(path("vocal.wav"));
+        QVERIFY(!full.empty());
+
+        FFmpegNative::AudioReader reader(path("vocal.wav"), FFmpegNative::AudioReader::Format{}, 1250);
+        QVERIFY(reader.isOpen());
+        std::vector<float> seeked;
+        QVERIFY(reader.readAll(seeked));
+
+        const size_t skip = size_t(1250 * 44100 / 1000) * 2;
+        QVERIFY(std::abs(qint64(seeked.size()) - qint64(full.size() - skip)) < 64 * 2);
+        double worst = 0.0;
+        for (size_t i = 512 * 2; i < std::min(seeked.size(), full.size() - skip) - 512 * 2; ++i)
+            worst = std::max(worst, double(std::abs(seeked[i] - full[skip + i])));
+        QVERIFY2(worst < 1e-3, qPrintable(QString("max difference %1").arg(worst)));
+    }
+
+    // At the source rate nothing is resampled, so small read() blocks (more
+    // than one per decoded packet) hand back exactly the file's samples,
+    // after exactly the leading silence a negative start asks for
+    void audioReader_blockReadsAtSourceRateWithLeadingSilence()
+    {
+        QVERIFY(writeSineWav(path("vocal.wav"), 1.0, 440.0, 0.5));
+        FFmpegNative::AudioReader::Format format;
+        format.sampleRate   = 0;
+        format.channels     = 1;
+        format.sampleFormat = FFmpegNative::AudioReader::SampleFormat::Int16;
+
+        QVector<qint16> whole;
+        QVERIFY(FFmpegNative::AudioReader(path("vocal.wav"), format).readAll(whole));
+        QCOMPARE(whole.size(), qsizetype(kRate));
+
+        FFmpegNative::AudioReader reader(path("vocal.wav"), format, -250);
+        QCOMPARE(reader.sampleRate(), kRate);
+        QCOMPARE(reader.bytesPerFrame(), 2);
+        QVector<qint16> blocks;
+        qint16 block[300];
+        for (int got; (got = reader.read(block, 300)) > 0; )
+            for (int i = 0; i < got; ++i)
+                blocks.append(block[i]);
+        QCOMPARE(reader.read(block, 300), 0);
+
+        const int silence = kRate / 4;
+        QCOMPARE(blocks.size(), qsizetype(silence + kRate));
+        QVERIFY(std::all_of(blocks.cbegin(), blocks.cbegin() + silence,
+                            [](qint16 v) { return v == 0; }));
+        QVERIFY(std::equal(whole.cbegin(), whole.cend(), blocks.cbegin() + silence));
+    }
+
+    // Grey 64x48 YUV420P at luma `y`, stamped with pts
+    static AVFrame *greyFrame(int y, int64_t pts)
+    {
+        AVFrame *f = av_frame_alloc();
+        f->format = AV_PIX_FMT_YUV420P;
+        f->width  = 64;
+        f->height = 48;
+        f->pts    = pts;
+        if (av_frame_get_buffer(f, 0) < 0)
+            av_frame_free(&f);
+        else
+            for (int p = 0; p < 3; ++p)
+                memset(f->data[p], p == 0 ? y : 128, size_t(f->linesize[p]) * (p == 0 ? 48 : 24));
+        return f;
+    }
+
+    static void freeFrames(std::vector<AVFrame *> &frames)
+    {
+        for (AVFrame *f : frames)
+            av_frame_free(&f);
+        frames.clear();
+    }
+
+    // The render's effect stage: the sink's frame comes back filtered, and
+    // chains that can't filter hand the very same frame back untouched
+    void videoEffectFilter_returnsTheSinkFrameOrPassesThrough()
+    {
+        FFmpegNative::VideoEffectProcessor fx;
+        const AVRational tb{1, 25};
+        std::vector<AVFrame *> out;
+
+        AVFrame *in = greyFrame(40, 0);
+        QVERIFY(in);
+        fx.filter(in, QString(), tb, out);
+        QCOMPARE(out.size(), size_t(1));
+        QCOMPARE(out[0], in);
+        out.clear();
+        fx.filter(in, "no_such_filter", tb, out);
+        QCOMPARE(out.size(), size_t(1));
+        QCOMPARE(out[0], in);
+        QCOMPARE(int(in->data[0][0]), 40);
+        freeFrames(out);
+
+        fx.filter(greyFrame(40, 0), "negate", tb, out);
+        QCOMPARE(out.size(), size_t(1));
+        QCOMPARE(out[0]->width, 64);
+        QCOMPARE(AVPixelFormat(out[0]->format), AV_PIX_FMT_YUV420P);
+        QVERIFY(out[0]->data[0][0] > 128);   // dark grey negated (exact value depends on the range)
+        freeFrames(out);
+    }
+
+    // Filters that hold frames back or add frames of their own: "reverse"
+    // keeps everything until the end of the stream, "fps" doubles the rate.
+    // Every frame has to come out — the held-back ones on the flush — each
+    // with the pts the graph gave it, in the caller's time base.
+    void videoEffectFilter_flushesHeldFramesWithTheirOwnPts()
+    {
+        const AVRational tb{1, 90000};
+        std::vector<AVFrame *> out;
+        {
+            FFmpegNative::VideoEffectProcessor fx;
+            for (int i = 0; i < 5; ++i) {
+                fx.filter(greyFrame(20 + 30 * i, i * 3600), "reverse", tb, out);
+                QVERIFY(out.empty());
+            }
+            fx.filter(nullptr, "reverse", tb, out);
+            QCOMPARE(out.size(), size_t(5));
+            for (int i = 0; i < 5; ++i) {
+                QCOMPARE(out[i]->pts, int64_t(i) * 3600);
+                QVERIFY(std::abs(out[i]->data[0][0] - (20 + 30 * (4 - i))) <= 1);
+            }
+            freeFrames(out);
+
+            // A flushed graph starts afresh on the next frame
+            fx.filter(greyFrame(20, 0), "reverse", tb, out);
+            fx.filter(nullptr, "reverse", tb, out);
+            QCOMPARE(out.size(), size_t(1));
+            freeFrames(out);
+        }
+        {
+            FFmpegNative::VideoEffectProcessor fx;
+            for (int i = 0; i < 4; ++i)   // 25 fps in
+                fx.filter(greyFrame(40, i * 3600), "fps=50", tb, out);
+            fx.filter(nullptr, "fps=50", tb, out);
+            QVERIFY2(out.size() >= 7, qPrintable(QString::number(out.size())));
+            for (size_t k = 0; k < out.size(); ++k)
+                QCOMPARE(out[k]->pts, int64_t(k) * 1800);
+            freeFrames(out);
+        }
+    }
+
+    // The live preview's path: an NV12 frame straight from its planes,
+    // downscaled in the graph, back as an image that wraps the graph's
+    // output — and stays valid after the processor (graph and all) is gone
+    void videoEffectProcessFrame_scalesFiltersAndOutlivesTheGraph()
+    {
+        QVideoFrame frame(QVideoFrameFormat(QSize(1280, 720), QVideoFrameFormat::Format_NV12));
+        QVERIFY(frame.map(QVideoFrame::WriteOnly));
+        memset(frame.bits(0), 40, size_t(frame.mappedBytes(0)));
+        memset(frame.bits(1), 128, size_t(frame.mappedBytes(1)));
+        frame.unmap();
+
+        QVERIFY(FFmpegNative::VideoEffectProcessor::acceptsFrame(frame));
+        QVERIFY(!FFmpegNative::VideoEffectProcessor::acceptsFrame(QVideoFrame()));
+
+        QImage image;
+        {
+            FFmpegNative::VideoEffectProcessor fx;
+            QVERIFY(fx.processFrame(frame, "no_such_filter", 720).isNull());
+            image = fx.processFrame(frame, "negate", 720);
+        }
+        QVERIFY(!image.isNull());
+        QCOMPARE(image.size(), QSize(720, 405));
+        QCOMPARE(image.format(), QImage::Format_ARGB32);
+        QVERIFY(qGray(image.pixel(360, 200)) > 128);   // dark grey negated
+    }
+};
+
+QTEST_MAIN(TestFFmpegNative)
+#include "test_ffmpegnative.moc"
@@ -0,0 +1,142 @@
+#include "fftplanregistry.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <cmath>
+
+// FftPlanRegistry hands one plan per (size, direction, precision) to every
+// enhancer, detector and STFT in the process, and persists what the planner
+// measured so the next launch can skip it. Pinned down here: plans really
+// are shared per key, they transform correctly on the caller's own buffers
+// (the only way anyone runs them), and the wisdom file round-trips both
+// precisions — or is shrugged off when it's garbage, since a stale file from
+// another FFTW build must never cost more than a replan.
+class TestFftPlanRegistry : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    QString wisdomFile() const { return m_dir.filePath("fftw.wisdom"); }
+
+private slots:
+    // Measure instead of the app's Patient default keeps this fast; the
+    // registry code paths are the same either way.
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        FftPlanRegistry::setEffort(FftPlanRegistry::Effort::Measure);
+        FftPlanRegistry::setWisdomPath(wisdomFile());
+    }
+
+    void sameKey_returnsSamePlan()
+    {
+        using Dir = FftPlanRegistry::Direction;
+        const fftw_plan fwd = FftPlanRegistry::plan(1024, Dir::Forward);
+        QVERIFY(fwd);
+        QCOMPARE(FftPlanRegistry::plan(1024, Dir::Forward), fwd);
+        QVERIFY(FftPlanRegistry::plan(1024, Dir::Inverse) != fwd);
+        QVERIFY(FftPlanRegistry::plan(2048, Dir::Forward) != fwd);
+        QVERIFY(FftPlanRegistry::planF(1024, Dir::Forward));
+        QCOMPARE(FftPlanRegistry::planF(1024, Dir::Forward),
+                 FftPlanRegistry::planF(1024, Dir::Forward));
+        QVERIFY(!FftPlanRegistry::plan(0, Dir::Forward));
+    }
+
+    // r2c then c2r on buffers the plan was never made on gives N·x back
+    void roundTrip_onCallerBuffers()
+    {
+        using Dir = FftPlanRegistry::Direction;
+        const int n = 1536;   // not a power of two, like the separator's n_fft
+        double*       x    = fftw_alloc_real(n);
+        double*       y    = fftw_alloc_real(n);
+        fftw_complex* spec = fftw_alloc_complex(n / 2 + 1);
+        for (int i = 0; i < n; ++i)
+            x[i] = std::sin(0.013 * i) + 0.25 * std::cos(0.31 * i);
+
+        fftw_execute_dft_r2c(FftPlanRegistry::plan(n, Dir::Forward), x, spec);
+        fftw_execute_dft_c2r(FftPlanRegistry::plan(n, Dir::Inverse), spec, y);
+        double maxErr = 0.0;
+        for (int i = 0; i < n; ++i)
+            maxErr = std::max(maxErr, std::abs(y[i] / n - x[i]));
+        fftw_free(x);
+        fftw_free(y);
+        fftw_free(spec);
+        QVERIFY2(maxErr < 1e-12, qPrintable(QString("round-trip error %1").arg(maxErr)));
+    }
+
+    // Measured plans land in the file, both precisions; after FFTW forgets
+    // everything, pointing the registry at the file brings them back without
+    // measuring again.
+    void wisdom_roundTripsBothPrecisions()
+    {
+        using Dir = FftPlanRegistry::Direction;
+        QVERIFY(FftPlanRegistry::plan(1800, Dir::Forward));
+        QVERIFY(FftPlanRegistry::planF(1800, Dir::Forward));
+
+        QFile f(wisdomFile());
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        const QByteArray saved = f.readAll();
+        QVERIFY(saved.contains("fftw_wisdom"));
+        QVERIFY(saved.contains("fftwf_wisdom"));
+
+        fftw_forget_wisdom();
+        fftwf_forget_wisdom();
+        FftPlanRegistry::setWisdomPath(wisdomFile());
+        QVERIFY(FftPlanRegistry::plan(1801, Dir::Forward));   // any new key triggers the import
+
+        double*       in  = fftw_alloc_real(1800);
+        fftw_complex* out = fftw_alloc_complex(901);
+        const fftw_plan fromWisdom =
+            fftw_plan_dft_r2c_1d(1800, in, out, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+        QVERIFY(fromWisdom);
+        fftw_destroy_plan(fromWisdom);
+        fftw_free(in);
+        fftw_free(out);
+    }
+
+    // At Patient effort a size the wisdom doesn't have is measured on the
+    // spot — the first plan of a size can come from the GUI thread — and
+    // searched patiently in the background, whose wisdom lands in the file.
+    // A small size, so the patient search is quick.
+    void patientEffort_measuresNowAndSearchesPatientlyInTheBackground()
+    {
+        FftPlanRegistry::setEffort(FftPlanRegistry::Effort::Patient);
+        const fftw_plan p = FftPlanRegistry::plan(96, FftPlanRegistry::Direction::Forward);
+        FftPlanRegistry::setEffort(FftPlanRegistry::Effort::Measure);
+        QVERIFY(p);
+        FftPlanRegistry::waitForPatientPass();
+
+        fftw_forget_wisdom();
+        fftwf_forget_wisdom();
+        FftPlanRegistry::setWisdomPath(wisdomFile());
+        QVERIFY(FftPlanRegistry::plan(97, FftPlanRegistry::Direction::Forward));   // re-imports
+
+        double*       in  = fftw_alloc_real(96);
+        fftw_complex* out = fftw_alloc_complex(49);
+        const fftw_plan patient =
+            fftw_plan_dft_r2c_1d(96, in, out, FFTW_PATIENT | FFTW_WISDOM_ONLY);
+        QVERIFY(patient);
+        fftw_destroy_plan(patient);
+        fftw_free(in);
+        fftw_free(out);
+    }
+
+    void garbageWisdom_isIgnored()
+    {
+        const QString path = m_dir.filePath("garbage.wisdom");
+        QFile f(path);
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write("(fftw-0.0 fftw_wisdom #x0 (nonsense)) not wisdom ((at all)");
+        f.close();
+
+        FftPlanRegistry::setWisdomPath(path);
+        QVERIFY(FftPlanRegistry::plan(1900, FftPlanRegistry::Direction::Inverse));
+        FftPlanRegistry::setWisdomPath(wisdomFile());
+    }
+};
+
+QTEST_MAIN(TestFftPlanRegistry)
+#include "test_fftplanregistry.moc"
@@ -0,0 +1,109 @@
+#include "pitchtrack.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QScopedPointer>
+#include <QFile>
+
+// The sidecar the render overlay reads in place of its own analysis. What
+// matters is that it reads back exactly what was written, and that it never
+// reads back at all for a recording other than the one it was written for —
+// the live recording's path is reused by every take.
+class TestPitchTrack : public QObject
+{
+    Q_OBJECT
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+
+    static bool writeFile(const QString &path, const QByteArray &content)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        return f.write(content) == content.size();
+    }
+
+    QString path(const QString &name) const { return m_dir->filePath(name); }
+
+    static PitchTrack sampleTrack()
+    {
+        PitchTrack t;
+        t.originMs = 1250;
+        t.frames.append({0,   0.0f,    0.12f, -1});
+        t.frames.append({80,  219.5f,  0.91f, 57});
+        t.frames.append({160, 246.94f, 0.77f, 59});
+        return t;
+    }
+
+private slots:
+    void init()
+    {
+        m_dir.reset(new QTemporaryDir);
+        QVERIFY(m_dir->isValid());
+    }
+    void cleanup() { m_dir.reset(); }
+
+    void sidecarPathFor_replacesTheExtension()
+    {
+        QCOMPARE(PitchTrack::sidecarPathFor("/tmp/WakkaQt_tmp_recording.wav"),
+                 QString("/tmp/WakkaQt_tmp_recording.pitch"));
+        QCOMPARE(PitchTrack::sidecarPathFor("/a/b/audio.wav"), QString("/a/b/audio.pitch"));
+    }
+
+    void saveAndLoad_roundTrips()
+    {
+        QVERIFY(writeFile(path("audio.wav"), QByteArray(200000, 'a')));
+        const PitchTrack written = sampleTrack();
+        QVERIFY(written.save(path("audio.pitch"), path("audio.wav")));
+
+        PitchTrack read;
+        QVERIFY(PitchTrack::load(path("audio.pitch"), path("audio.wav"), &read));
+        QCOMPARE(read.originMs, written.originMs);
+        QCOMPARE(read.frames.size(), written.frames.size());
+        for (int i = 0; i < written.frames.size(); ++i) {
+            QCOMPARE(read.frames[i].ms,         written.frames[i].ms);
+            QCOMPARE(read.frames[i].hz,         written.frames[i].hz);
+            QCOMPARE(read.frames[i].confidence, written.frames[i].confidence);
+            QCOMPARE(read.frames[i].targetMidi, written.frames[i].targetMidi);
+        }
+    }
+
+    // A new take at the same path, even one of the same size, is a miss —
+    // including a change past the hashed head
+    void load_otherRecordingIsRejected()
+    {
+        QByteArray take(200000, 'a');
+        QVERIFY(writeFile(path("audio.wav"), take));
+        QVERIFY(sampleTrack().save(path("audio.pitch"), path("audio.wav")));
+
+        take[take.size() - 10] = 'b';
+        QVERIFY(writeFile(path("audio.wav"), take));
+        PitchTrack read = sampleTrack();
+        read.originMs = -1;
+        QVERIFY(!PitchTrack::load(path("audio.pitch"), path("audio.wav"), &read));
+        QCOMPARE(read.originMs, qint64(-1));   // untouched
+
+        QVERIFY(!PitchTrack::load(path("audio.pitch"), path("missing.wav"), &read));
+    }
+
+    void load_truncatedOrForeignFileIsRejected()
+    {
+        QVERIFY(writeFile(path("audio.wav"), "vocal"));
+        QVERIFY(sampleTrack().save(path("audio.pitch"), path("audio.wav")));
+        QFile f(path("audio.pitch"));
+        QVERIFY(f.open(QIODevice::ReadWrite));
+        QVERIFY(f.resize(f.size() - 5));
+        f.close();
+
+        PitchTrack read;
+        QVERIFY(!PitchTrack::load(path("audio.pitch"), path("audio.wav"), &read));
+        QVERIFY(writeFile(path("other.pitch"), QByteArray(64, 'x')));
+        QVERIFY(!PitchTrack::load(path("other.pitch"), path("audio.wav"), &read));
+        QVERIFY(!PitchTrack::load(path("missing.pitch"), path("audio.wav"), &read));
+        QVERIFY(read.isEmpty());
+    }
+};
+
+QTEST_MAIN(TestPitchTrack)
+#include "test_pitchtrack.moc"
@@ -0,0 +1,98 @@
+#include "previewjob.h"
+#include "fftplanregistry.h"
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QAudioFormat>
+#include <QtMath>
+
+// PreviewJob::enhance() hands the tuned take on a block at a time through
+// enhancedBlock() while the enhancer runs, then whole through enhanced().
+// The contract a streaming consumer relies on: blocks arrive in order, all
+// of them before enhanced(), and together they are exactly its result.
+class TestPreviewJob : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Seconds of a vibrato'd harmonic tone after half a second of silence,
+    // 44100 Hz stereo Int16 — the same material test_vocalenhancer uses
+    static QByteArray synthVocalTone(double seconds)
+    {
+        const int sr = 44100;
+        const int frames = int(sr * seconds);
+        QByteArray pcm(frames * 2 * int(sizeof(qint16)), 0);
+        qint16 *out = reinterpret_cast<qint16 *>(pcm.data());
+        double phase = 0.0;
+        for (int i = 0; i < frames; ++i) {
+            const double t = double(i) / sr;
+            phase += 2.0 * M_PI * (214.0 + 5.0 * qSin(2.0 * M_PI * 5.5 * t)) / sr;
+            const double v = (t > 0.5 ? 0.25 : 0.0) * (qSin(phase) + 0.5 * qSin(2.0 * phase));
+            out[2 * i] = out[2 * i + 1] = qint16(qRound(v * 32767.0));
+        }
+        return pcm;
+    }
+
+    static QAudioFormat format()
+    {
+        QAudioFormat fmt;
+        fmt.setSampleRate(44100);
+        fmt.setChannelCount(2);
+        fmt.setSampleFormat(QAudioFormat::Int16);
+        return fmt;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        FftPlanRegistry::setWisdomPath(QString());
+        FftPlanRegistry::setEffort(FftPlanRegistry::Effort::Measure);
+    }
+
+    void enhance_blocksArriveInOrderAndMakeUpTheResult()
+    {
+        PreviewJob job;
+        // Queued to this thread like any GUI consumer's slot, so the list is
+        // only ever touched here
+        QList<QByteArray> blocks;
+        bool enhancedSeen = false;
+        int blocksAfterEnhanced = 0;
+        connect(&job, &PreviewJob::enhancedBlock, this, [&](const QByteArray &block) {
+            if (enhancedSeen)
+                ++blocksAfterEnhanced;
+            blocks.append(block);
+        }, Qt::QueuedConnection);
+        QSignalSpy enhancedSpy(&job, &PreviewJob::enhanced);
+        connect(&job, &PreviewJob::enhanced, this, [&]() { enhancedSeen = true; });
+
+        const QByteArray pcm = synthVocalTone(4.0);
+        QVERIFY(job.enhance(pcm, format(), PreviewJob::EnhanceParams{}));
+        QVERIFY(!job.enhance(pcm, format(), PreviewJob::EnhanceParams{}));   // one run at a time
+        QVERIFY(enhancedSpy.wait(60000));
+        QCoreApplication::processEvents();
+
+        const QByteArray tuned = enhancedSpy.at(0).at(0).toByteArray();
+        QCOMPARE(tuned.size(), pcm.size());
+        QVERIFY2(blocks.size() >= 3, qPrintable(QString("%1 block(s)").arg(blocks.size())));
+        QCOMPARE(blocksAfterEnhanced, 0);
+        QByteArray joined;
+        for (const QByteArray &b : blocks)
+            joined.append(b);
+        QVERIFY(joined == tuned);
+    }
+
+    // A cancelled run still finishes, with an empty result — what
+    // PreviewDialog checks to tell it from a finished take
+    void cancelEnhance_deliversEmpty()
+    {
+        PreviewJob job;
+        QSignalSpy enhancedSpy(&job, &PreviewJob::enhanced);
+        QVERIFY(job.enhance(synthVocalTone(8.0), format(), PreviewJob::EnhanceParams{}));
+        job.cancelEnhance();
+        QVERIFY(enhancedSpy.wait(60000));
+        QVERIFY(enhancedSpy.at(0).at(0).toByteArray().isEmpty());
+    }
+};
+
+QTEST_MAIN(TestPreviewJob)
+#include "test_previewjob.moc"
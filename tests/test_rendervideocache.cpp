@@ -0,0 +1,156 @@
+#include "rendervideocache.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+
+// Same approach as test_separationcache: real files under a QTemporaryDir.
+// What differs is the key — identity and settings rather than content — and
+// that entries also expire by age, since a new take orphans the old ones.
+class TestRenderVideoCache : public QObject
+{
+    Q_OBJECT
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+
+    static bool writeFile(const QString &path, const QByteArray &content)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        return f.write(content) == content.size();
+    }
+
+    static void setMtime(const QString &path, const QDateTime &when)
+    {
+        QFile f(path);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        QVERIFY(f.setFileTime(when, QFileDevice::FileModificationTime));
+    }
+
+    QString path(const QString &name) const { return m_dir->filePath(name); }
+
+    // Stages `bytes` for key, as a render would, and commits it
+    QString insertBytes(RenderVideoCache &cache, const QString &key, const QByteArray &bytes)
+    {
+        const QString staging = cache.stagingPathFor(key);
+        if (staging.isEmpty() || !writeFile(staging, bytes))
+            return "cannot stage";
+        return cache.insert(key, staging);
+    }
+
+private slots:
+    void init()
+    {
+        m_dir.reset(new QTemporaryDir);
+        QVERIFY(m_dir->isValid());
+    }
+    void cleanup() { m_dir.reset(); }
+
+    void keyFor_changesWithSettingsAndInputs()
+    {
+        QVERIFY(writeFile(path("webcam.mkv"), "take one"));
+        QVERIFY(writeFile(path("vocal.wav"), "raw"));
+        const QString base = RenderVideoCache::keyFor({path("webcam.mkv")}, "resolution=1280x720");
+        QCOMPARE(base.size(), 64);
+        QCOMPARE(RenderVideoCache::keyFor({path("webcam.mkv")}, "resolution=1280x720"), base);
+        QVERIFY(RenderVideoCache::keyFor({path("webcam.mkv")}, "resolution=1920x1080") != base);
+        QVERIFY(RenderVideoCache::keyFor({path("webcam.mkv"), path("vocal.wav")},
+                                         "resolution=1280x720") != base);
+    }
+
+    // The recordings live at fixed paths that every take overwrites: the
+    // same path with a new recording in it must not hit the old entry
+    void keyFor_rewrittenInputIsANewKey()
+    {
+        QVERIFY(writeFile(path("webcam.mkv"), "take one"));
+        setMtime(path("webcam.mkv"), QDateTime::currentDateTimeUtc().addSecs(-600));
+        const QString before = RenderVideoCache::keyFor({path("webcam.mkv")}, "s");
+
+        QVERIFY(writeFile(path("webcam.mkv"), "take two"));   // same size, newer mtime
+        QVERIFY(RenderVideoCache::keyFor({path("webcam.mkv")}, "s") != before);
+    }
+
+    void keyFor_missingInputIsEmpty()
+    {
+        QVERIFY(RenderVideoCache::keyFor({path("missing.mkv")}, "s").isEmpty());
+    }
+
+    void lookup_missThenHitAfterInsert()
+    {
+        RenderVideoCache cache(path("cache"));
+        const QString key = QString(64, QChar('a'));
+        QVERIFY(cache.lookup(key).isEmpty());
+
+        const QString staging = cache.stagingPathFor(key);
+        QVERIFY(staging.endsWith(".mkv"));   // the renderer picks its muxer by extension
+        QVERIFY(writeFile(staging, "video"));
+        QCOMPARE(cache.insert(key, staging), QString());
+        QVERIFY(!QFile::exists(staging));
+
+        QCOMPARE(cache.lookup(key), path("cache/" + key + ".mkv"));
+        QCOMPARE(QDir(path("cache")).entryList(QDir::Files), QStringList{key + ".mkv"});
+        QCOMPARE(cache.sizeBytes(), qint64(5));
+    }
+
+    // Two renders of the same key racing: the second commit is dropped,
+    // staging file included
+    void insert_existingKeyDiscardsTheStagingFile()
+    {
+        RenderVideoCache cache(path("cache"));
+        const QString key = QString(64, QChar('b'));
+        QCOMPARE(insertBytes(cache, key, "first"), QString());
+        const QString staging = cache.stagingPathFor(key);
+        QVERIFY(writeFile(staging, "second"));
+        QCOMPARE(cache.insert(key, staging), QString());
+        QVERIFY(!QFile::exists(staging));
+        QCOMPARE(cache.sizeBytes(), qint64(5));
+    }
+
+    void insert_evictsLeastRecentlyUsedOverCap()
+    {
+        RenderVideoCache cache(path("cache"), 250);
+        const QString k1 = QString(64, QChar('1'));
+        const QString k2 = QString(64, QChar('2'));
+        const QString k3 = QString(64, QChar('3'));
+
+        QCOMPARE(insertBytes(cache, k1, QByteArray(100, 'x')), QString());
+        QCOMPARE(insertBytes(cache, k2, QByteArray(100, 'x')), QString());
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        setMtime(path("cache/" + k1 + ".mkv"), now.addSecs(-200));
+        setMtime(path("cache/" + k2 + ".mkv"), now.addSecs(-100));
+
+        QVERIFY(!cache.lookup(k1).isEmpty());   // k2 is now the least recently used
+        QCOMPARE(insertBytes(cache, k3, QByteArray(100, 'x')), QString());
+
+        QVERIFY(QFile::exists(path("cache/" + k1 + ".mkv")));
+        QVERIFY(!QFile::exists(path("cache/" + k2 + ".mkv")));
+        QVERIFY(QFile::exists(path("cache/" + k3 + ".mkv")));
+    }
+
+    // Under the cap, but unused for longer than kMaxAgeDays: gone
+    void insert_dropsExpiredEntriesAndStaleStaging()
+    {
+        RenderVideoCache cache(path("cache"));
+        const QString old = QString(64, QChar('c'));
+        QCOMPARE(insertBytes(cache, old, "old take"), QString());
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        setMtime(path("cache/" + old + ".mkv"), now.addDays(-RenderVideoCache::kMaxAgeDays - 1));
+
+        const QString orphan = path("cache/" + QString(64, QChar('0')) + ".partial-dead.mkv");
+        QVERIFY(writeFile(orphan, QByteArray(1000, 'x')));
+        setMtime(orphan, now.addDays(-2));
+        QCOMPARE(cache.sizeBytes(), qint64(8));   // staging files never count
+
+        QCOMPARE(insertBytes(cache, QString(64, QChar('d')), "new take"), QString());
+        QVERIFY(!QFile::exists(path("cache/" + old + ".mkv")));
+        QVERIFY(!QFile::exists(orphan));
+        QCOMPARE(cache.sizeBytes(), qint64(8));
+    }
+};
+
+QTEST_MAIN(TestRenderVideoCache)
+#include "test_rendervideocache.moc"
@@ -0,0 +1,284 @@
+#include "separationcache.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+
+// SeparationCache's contract is about on-disk state — which key a file
+// maps to, which entries survive an insert over the cap, that nothing
+// half-written is ever visible under an entry's name — so every test here
+// works on real files under a QTemporaryDir, never a mocked filesystem.
+class TestSeparationCache : public QObject
+{
+    Q_OBJECT
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+
+    static bool writeFile(const QString &path, const QByteArray &content)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly))
+            return false;
+        return f.write(content) == content.size();
+    }
+
+    static QByteArray readFile(const QString &path)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return f.readAll();
+    }
+
+    static void setMtime(const QString &path, const QDateTime &when)
+    {
+        QFile f(path);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        QVERIFY(f.setFileTime(when, QFileDevice::FileModificationTime));
+    }
+
+    // Deterministic, non-repeating bytes — 12 MiB, far more than the 32
+    // sampled blocks of a huge input would cover.
+    static QByteArray bigContent()
+    {
+        QByteArray b(12 << 20, Qt::Uninitialized);
+        quint32 x = 0x12345678u;
+        for (char &c : b) {
+            x = x * 1664525u + 1013904223u;
+            c = char(x >> 24);
+        }
+        return b;
+    }
+
+    QString path(const QString &name) const { return m_dir->filePath(name); }
+
+    // Keys come from the cache under test, which remembers content hashes
+    QString keyFor(const QString &inputFile, const QString &modelSha,
+                   const QString &variant = QString()) const
+    {
+        return SeparationCache(path("cache")).keyFor(inputFile, modelSha, variant);
+    }
+
+private slots:
+    void init()
+    {
+        m_dir.reset(new QTemporaryDir);
+        QVERIFY(m_dir->isValid());
+        SeparationCache::resetStats();
+    }
+    void cleanup() { m_dir.reset(); }
+
+    void keyFor_dependsOnContentNotPath()
+    {
+        QVERIFY(writeFile(path("a.mp4"), "same bytes"));
+        QVERIFY(writeFile(path("renamed copy.mp4"), "same bytes"));
+        QVERIFY(writeFile(path("b.mp4"), "other bytes"));
+
+        const QString a = keyFor(path("a.mp4"), "abc");
+        QCOMPARE(a.size(), 64);
+        QCOMPARE(keyFor(path("a.mp4"), "abc"), a);
+        QCOMPARE(keyFor(path("renamed copy.mp4"), "abc"), a);
+        QVERIFY(keyFor(path("b.mp4"), "abc") != a);
+    }
+
+    void keyFor_changesWithModelAndVariant()
+    {
+        QVERIFY(writeFile(path("a.mp4"), "same bytes"));
+        const QString base = keyFor(path("a.mp4"), "abc", "trim:0.25");
+        QVERIFY(keyFor(path("a.mp4"), "abd", "trim:0.25") != base);
+        QVERIFY(keyFor(path("a.mp4"), "abc", "crossfade:0.125") != base);
+        // The model hash is compared case-insensitively, like verifyFile()
+        QCOMPARE(keyFor(path("a.mp4"), "ABC", "trim:0.25"), base);
+    }
+
+    void keyFor_unreadableInputIsEmpty()
+    {
+        QVERIFY(keyFor(path("missing.mp4"), "abc").isEmpty());
+    }
+
+    // Below kWholeFileHashBytes every byte counts: a same-length file that
+    // differs only between where the samples of a huge input would fall
+    // must not collide, and neither must the start, the end or the length.
+    void keyFor_hashSeesEveryByteAndLength()
+    {
+        const QByteArray big = bigContent();
+        QVERIFY(writeFile(path("big.mp4"), big));
+        const QString base = keyFor(path("big.mp4"), "abc");
+
+        QByteArray head = big; head[0] = char(head[0] ^ 1);
+        QVERIFY(writeFile(path("head.mp4"), head));
+        QVERIFY(keyFor(path("head.mp4"), "abc") != base);
+
+        QByteArray mid = big; mid[big.size() / 2 + 12345] = char(mid[big.size() / 2 + 12345] ^ 1);
+        QVERIFY(writeFile(path("mid.mp4"), mid));
+        QVERIFY(keyFor(path("mid.mp4"), "abc") != base);
+
+        QByteArray tail = big; tail[tail.size() - 1] = char(tail[tail.size() - 1] ^ 1);
+        QVERIFY(writeFile(path("tail.mp4"), tail));
+        QVERIFY(keyFor(path("tail.mp4"), "abc") != base);
+
+        QVERIFY(writeFile(path("longer.mp4"), big + 'x'));
+        QVERIFY(keyFor(path("longer.mp4"), "abc") != base);
+    }
+
+    // Past kWholeFileHashBytes only samples are read, so the mtime goes into
+    // the key: touching the file changes it, putting the time back restores
+    // it. Sparse, so the test writes almost nothing.
+    void keyFor_hugeInputKeysOnMtime()
+    {
+        QFile f(path("huge.mp4"));
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        QVERIFY(f.resize(SeparationCache::kWholeFileHashBytes + (qint64(1) << 20)));
+        f.close();
+
+        const QDateTime then = QDateTime::currentDateTimeUtc().addDays(-3);
+        setMtime(path("huge.mp4"), then);
+        const QString base = keyFor(path("huge.mp4"), "abc");
+        QCOMPARE(base.size(), 64);
+
+        setMtime(path("huge.mp4"), then.addSecs(60));
+        QVERIFY(keyFor(path("huge.mp4"), "abc") != base);
+
+        setMtime(path("huge.mp4"), then);
+        QCOMPARE(keyFor(path("huge.mp4"), "abc"), base);
+    }
+
+    // A repeat lookup of an unchanged file only stats it: bytes changed
+    // behind the cache's back with the size and mtime put back aren't
+    // noticed — by design — while a new mtime rehashes.
+    void keyFor_remembersTheContentHashByPathSizeAndMtime()
+    {
+        QVERIFY(writeFile(path("a.mp4"), "same bytes"));
+        QVERIFY(writeFile(path("b.mp4"), "diff bytes"));
+        const QDateTime then = QDateTime::currentDateTimeUtc().addDays(-1);
+        setMtime(path("a.mp4"), then);
+        const QString a = keyFor(path("a.mp4"), "abc");
+        const QString b = keyFor(path("b.mp4"), "abc");
+        QVERIFY(a != b);
+        QCOMPARE(QDir(path("cache/hashes")).entryList(QDir::Files).size(), 2);
+
+        QVERIFY(writeFile(path("a.mp4"), "diff bytes"));
+        setMtime(path("a.mp4"), then);
+        QCOMPARE(keyFor(path("a.mp4"), "abc"), a);
+
+        setMtime(path("a.mp4"), then.addSecs(1));
+        QCOMPARE(keyFor(path("a.mp4"), "abc"), b);
+    }
+
+    // A hit's file is the caller's own: the entry going afterwards (an
+    // eviction, another instance) leaves it whole
+    void fetch_hitOutlivesTheEntry()
+    {
+        SeparationCache cache(path("cache"));
+        QVERIFY(writeFile(path("in.mp4"), "song"));
+        QVERIFY(writeFile(path("instrumental.wav"), "separated"));
+        const QString key = keyFor(path("in.mp4"), "abc");
+        QCOMPARE(cache.insert(key, path("instrumental.wav")), QString());
+
+        QVERIFY(cache.fetch(key, path("out.wav")));
+        QVERIFY(!QFileInfo(path("out.wav")).isSymLink());
+        QVERIFY(QFile::remove(path("cache/" + key + ".wav")));
+        QCOMPARE(readFile(path("out.wav")), QByteArray("separated"));
+        QVERIFY(!cache.fetch(key, path("out2.wav")));
+    }
+
+    void fetch_missThenHitAfterInsert()
+    {
+        SeparationCache cache(path("cache"));
+        QVERIFY(writeFile(path("in.mp4"), "song"));
+        QVERIFY(writeFile(path("instrumental.wav"), "separated"));
+        const QString key = keyFor(path("in.mp4"), "abc");
+
+        QVERIFY(!cache.fetch(key, path("out1.wav")));
+        QVERIFY(!QFile::exists(path("out1.wav")));
+
+        QCOMPARE(cache.insert(key, path("instrumental.wav")), QString());
+        QVERIFY(QFile::exists(path("instrumental.wav"))); // the caller's file is left alone
+
+        QVERIFY(cache.fetch(key, path("out2.wav")));
+        QCOMPARE(readFile(path("out2.wav")), QByteArray("separated"));
+
+        const SeparationCache::Stats s = SeparationCache::stats();
+        QCOMPARE(s.misses, quint64(1));
+        QCOMPARE(s.hits, quint64(1));
+        QCOMPARE(s.insertions, quint64(1));
+        QCOMPARE(s.evictions, quint64(0));
+    }
+
+    // Nothing but committed entries may be left in the directory after an
+    // insert — no staging file, no backup sidecar.
+    void insert_leavesOnlyTheCommittedEntry()
+    {
+        SeparationCache cache(path("cache"));
+        QVERIFY(writeFile(path("instrumental.wav"), "separated"));
+        const QString key = QString(64, QChar('a'));
+
+        QCOMPARE(cache.insert(key, path("instrumental.wav")), QString());
+        QCOMPARE(cache.insert(key, path("instrumental.wav")), QString()); // already there: no-op
+        QCOMPARE(QDir(path("cache")).entryList(QDir::Files),
+                 QStringList{key + ".wav"});
+        QCOMPARE(SeparationCache::stats().insertions, quint64(1));
+        QCOMPARE(cache.sizeBytes(), qint64(9));
+    }
+
+    void insert_evictsLeastRecentlyUsedOverCap()
+    {
+        // Room for two 100-byte entries, not three
+        SeparationCache cache(path("cache"), 250);
+        QVERIFY(writeFile(path("instrumental.wav"), QByteArray(100, 'x')));
+        const QString k1 = QString(64, QChar('1'));
+        const QString k2 = QString(64, QChar('2'));
+        const QString k3 = QString(64, QChar('3'));
+
+        QCOMPARE(cache.insert(k1, path("instrumental.wav")), QString());
+        QCOMPARE(cache.insert(k2, path("instrumental.wav")), QString());
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        setMtime(path("cache/" + k1 + ".wav"), now.addSecs(-200));
+        setMtime(path("cache/" + k2 + ".wav"), now.addSecs(-100));
+
+        // A hit on k1 makes k2 the least recently used...
+        QVERIFY(cache.fetch(k1, path("out.wav")));
+        // ...so k2 is what goes when k3 pushes the total over the cap
+        QCOMPARE(cache.insert(k3, path("instrumental.wav")), QString());
+
+        QVERIFY(QFile::exists(path("cache/" + k1 + ".wav")));
+        QVERIFY(!QFile::exists(path("cache/" + k2 + ".wav")));
+        QVERIFY(QFile::exists(path("cache/" + k3 + ".wav")));
+        QCOMPARE(cache.sizeBytes(), qint64(200));
+        QCOMPARE(SeparationCache::stats().evictions, quint64(1));
+    }
+
+    // An entry bigger than the whole cap still goes in — evicting the one
+    // thing just paid for would make the insert pointless.
+    void insert_neverEvictsTheEntryJustInserted()
+    {
+        SeparationCache cache(path("cache"), 50);
+        QVERIFY(writeFile(path("instrumental.wav"), QByteArray(100, 'x')));
+        const QString key = QString(64, QChar('f'));
+        QCOMPARE(cache.insert(key, path("instrumental.wav")), QString());
+        QVERIFY(QFile::exists(path("cache/" + key + ".wav")));
+    }
+
+    // A staging file orphaned by a crash mid-insert is swept by the next
+    // insert once it's clearly abandoned, and never counted as an entry.
+    void insert_sweepsStaleStagingFiles()
+    {
+        SeparationCache cache(path("cache"));
+        QVERIFY(QDir().mkpath(path("cache")));
+        const QString orphan = path("cache/" + QString(64, QChar('0')) + ".partial-dead.wav");
+        QVERIFY(writeFile(orphan, QByteArray(1000, 'x')));
+        QCOMPARE(cache.sizeBytes(), qint64(0));
+        setMtime(orphan, QDateTime::currentDateTimeUtc().addSecs(-7200));
+
+        QVERIFY(writeFile(path("instrumental.wav"), "separated"));
+        QCOMPARE(cache.insert(QString(64, QChar('b')), path("instrumental.wav")), QString());
+        QVERIFY(!QFile::exists(orphan));
+    }
+};
+
+QTEST_MAIN(TestSeparationCache)
+#include "test_separationcache.moc"
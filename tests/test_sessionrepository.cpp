@@ -1,5 +1,6 @@
 #include "sessionrepository.h"
 #include "complexes.h"
+#include "pitchtrack.h"
 
 #include <QTest>
 #include <QTemporaryDir>
@@ -123,6 +124,31 @@ private slots:
         QDir(restored.workspaceDir).removeRecursively();
     }
 
+    // The enhancer's pitch track rides along with audio.wav and still
+    // matches the restored copy, so a restored render needn't re-analyse
+    void saveAndRestore_carriesThePitchTrack()
+    {
+        QVERIFY(writeValidWav(audioRecorded));
+        QVERIFY(writeValidWav(extractedTmpPlayback));
+        PitchTrack track;
+        track.originMs = 40;
+        track.frames.append({0, 220.0f, 0.9f, 57});
+        QVERIFY(track.save(PitchTrack::sidecarPathFor(audioRecorded), audioRecorded));
+
+        SessionRepository repo;
+        const SaveResult saved = repo.saveSession(SessionSnapshot());
+        QVERIFY2(saved.ok, qPrintable(saved.error));
+        const RestoreResult restored = repo.restoreSession(saved.sessionId);
+        QVERIFY2(restored.ok, qPrintable(restored.error));
+
+        PitchTrack read;
+        QVERIFY(PitchTrack::load(PitchTrack::sidecarPathFor(restored.audioPath),
+                                 restored.audioPath, &read));
+        QCOMPARE(read.originMs, qint64(40));
+        QCOMPARE(read.frames.size(), 1);
+        QDir(restored.workspaceDir).removeRecursively();
+    }
+
     void restoreSession_corruptAudioWav_isRejected()
     {
         QVERIFY(writeValidWav(audioRecorded));
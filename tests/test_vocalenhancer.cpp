@@ -1,8 +1,52 @@
 #include "vocalenhancer.h"
+#include "fftplanregistry.h"
 
 #include <QTest>
 #include <QAudioFormat>
 #include <QScopedPointer>
+#include <QtMath>
+
+// A couple of seconds of a slightly-flat, vibrato'd harmonic tone (plus
+// leading silence, so the gate has something to learn its noise floor from)
+// in the 44100 Hz / stereo / Int16 layout initTestCase() configures.
+static QByteArray synthVocalTone(double seconds)
+{
+    const int sr = 44100;
+    const int frames = int(sr * seconds);
+    QByteArray pcm(frames * 2 * int(sizeof(qint16)), 0);
+    qint16 *out = reinterpret_cast<qint16 *>(pcm.data());
+    double phase = 0.0;
+    for (int i = 0; i < frames; ++i) {
+        const double t = double(i) / sr;
+        const double f0 = 214.0 + 5.0 * qSin(2.0 * M_PI * 5.5 * t);
+        phase += 2.0 * M_PI * f0 / sr;
+        const double env = t > 0.5 ? 0.25 : 0.0;
+        const double v = env * (qSin(phase) + 0.5 * qSin(2.0 * phase));
+        out[2 * i] = out[2 * i + 1] = qint16(qRound(v * 32767.0));
+    }
+    return pcm;
+}
+
+// synthVocalTone() with the right channel scaled by `rightGain` — a source
+// panned toward the left.
+static QByteArray pannedVocalTone(double seconds, double rightGain)
+{
+    QByteArray pcm = synthVocalTone(seconds);
+    qint16 *s = reinterpret_cast<qint16 *>(pcm.data());
+    for (qsizetype i = 0; i + 1 < pcm.size() / qsizetype(sizeof(qint16)); i += 2)
+        s[i + 1] = qint16(qRound(s[i] * rightGain));
+    return pcm;
+}
+
+static double channelRms(const QByteArray &pcm, int channel)
+{
+    const qint16 *s = reinterpret_cast<const qint16 *>(pcm.constData());
+    const qsizetype frames = pcm.size() / qsizetype(2 * sizeof(qint16));
+    double sum = 0.0;
+    for (qsizetype f = 0; f < frames; ++f)
+        sum += double(s[2 * f + channel]) * s[2 * f + channel];
+    return frames > 0 ? std::sqrt(sum / frames) : 0.0;
+}
 
 // VocalEnhancer's DSP internals (pitch detection, LPC, phase vocoder) are
 // private and only reachable through enhance(), whose correctness depends on
@@ -12,6 +56,9 @@
 // values are already in-range (see e.g. maxCorrectionCents/maxRatio math in
 // correctPitchChunk()), so a knob that silently stopped clamping would send
 // out-of-range values straight into that math instead of failing loudly here.
+// The tests that do run it (streaming, precision, stereo, stage cache) use
+// a synthetic tone and compare runs with each other, never with reference
+// audio.
 class TestVocalEnhancer : public QObject
 {
     Q_OBJECT
@@ -20,17 +67,26 @@ private:
     QScopedPointer<VocalEnhancer> m_enh;
 
 private slots:
-    // FFTW plan creation (FFTW_MEASURE) happens once in the constructor —
-    // shared across all test functions in this class instead of paying that
-    // cost per test slot. None of the tests below mutate anything the
-    // others depend on (each sets its own knob and reads it straight back).
+    // One enhancer for the whole class: its FFT plans come from
+    // FftPlanRegistry, which only plans each size once anyway, but the
+    // constructor's buffers and the stage cache are worth sharing. The
+    // tests do share its state — knobs, reverb mix, precision, stereo mode,
+    // the stage cache limit — so a test that depends on one sets it itself,
+    // and one that changes a mode or the cache limit puts it back before it
+    // returns.
     void initTestCase()
     {
+        // In-memory wisdom only (never the user's ~/.WakkaQt), and the
+        // quicker Measure planning these tests always used
+        FftPlanRegistry::setWisdomPath(QString());
+        FftPlanRegistry::setEffort(FftPlanRegistry::Effort::Measure);
+
         QAudioFormat fmt;
         fmt.setSampleRate(44100);
         fmt.setChannelCount(2);
         fmt.setSampleFormat(QAudioFormat::Int16);
         m_enh.reset(new VocalEnhancer(fmt));
+        m_enh->setStageCacheLimit(VocalEnhancer::kPreviewStageCacheBytes);   // as PreviewJob does
     }
 
     void pitchCorrectionAmount_isClampedTo0_1()
@@ -102,6 +158,215 @@ private slots:
         m_enh->setScalePreset("not_a_real_scale", 3);
         QCOMPARE(m_enh->getScaleName(), QString("Chromatic"));
     }
+
+    // enhance() is just begin()/process()/finish() over the whole buffer, and
+    // every streaming stage keys its frames and gain updates off absolute
+    // sample positions — so feeding the same take in small, frame-misaligned
+    // pieces (as PreviewJob does in ~1 s blocks) must reproduce enhance()'s
+    // output byte for byte, not merely "about the same length".
+    void streaming_matchesWholeBufferRegardlessOfBlockSize()
+    {
+        m_enh->setReverbMix(0.2);
+        const QByteArray input = synthVocalTone(2.5);
+
+        const QByteArray whole = m_enh->enhance(input);
+        QCOMPARE(whole.size(), input.size());
+
+        m_enh->clearStageCache();   // run the real stages again, not a replay
+        m_enh->begin(m_enh->measureInput(input));
+        QByteArray streamed;
+        for (qsizetype off = 0; off < input.size(); off += 1001) // odd size: splits frames
+            streamed.append(m_enh->process(input.mid(off, 1001)));
+        streamed.append(m_enh->finish());
+
+        QCOMPARE(streamed.size(), whole.size());
+        QVERIFY(streamed == whole);
+    }
+
+    // The float path only changes rounding inside the gate and phase-vocoder
+    // frames (same algorithm, same frame grid). Each kernel on its own stays
+    // within ~85–100 dB of its double twin, but end to end the pitch map's
+    // dead zone is a hard threshold: a vibrato that grazes it can start or
+    // stop correcting one detection earlier on a sub-LSB difference, which
+    // caps the whole-chain match in the mid-50s dB on this tone. 45 dB keeps
+    // margin for FFTW picking different codelets on other CPUs while still
+    // failing on any real divergence (a wrong bin, a lost phase wrap), which
+    // lands at 20 dB or worse. Kept short: over minutes the float phase
+    // accumulators drift slowly, lowering the number without being audible.
+    void floatPrecision_tracksDoublePathWithin45dB()
+    {
+        QCOMPARE(m_enh->getPrecision(), VocalEnhancer::defaultPrecision());
+        const VocalEnhancer::Precision saved = m_enh->getPrecision();
+        m_enh->setReverbMix(0.2);
+        const QByteArray input = synthVocalTone(4.0);
+
+        m_enh->setPrecision(VocalEnhancer::Precision::Double);
+        const QByteArray ref = m_enh->enhance(input);
+        m_enh->setPrecision(VocalEnhancer::Precision::Float);
+        const QByteArray f32 = m_enh->enhance(input);
+        m_enh->setPrecision(saved);
+
+        QCOMPARE(f32.size(), ref.size());
+        const qint16 *a = reinterpret_cast<const qint16 *>(ref.constData());
+        const qint16 *b = reinterpret_cast<const qint16 *>(f32.constData());
+        const qsizetype n = ref.size() / qsizetype(sizeof(qint16));
+        double signal = 0.0, noise = 0.0;
+        for (qsizetype i = 0; i < n; ++i) {
+            signal += double(a[i]) * a[i];
+            noise  += double(a[i] - b[i]) * (a[i] - b[i]);
+        }
+        QVERIFY(signal > 0.0);
+        const double snrDb = 10.0 * std::log10(signal / std::max(noise, 1.0));
+        QVERIFY2(snrDb >= 45.0, qPrintable(QString("float vs double SNR %1 dB").arg(snrDb, 0, 'f', 1)));
+    }
+
+    // Stereo mode applies the mid signal's gate mask and phase rotation to
+    // each channel instead of copying one mono result to both, so a source
+    // panned left has to come out panned the same way (the downmix returned
+    // identical channels). The channels only part ways through the
+    // per-channel exciter and limiter, a few percent at most.
+    void preserveStereo_keepsPannedSourcePanned()
+    {
+        const bool saved = m_enh->getPreserveStereo();
+        m_enh->setReverbMix(0.0);
+        const QByteArray input = pannedVocalTone(3.0, 0.5);
+
+        m_enh->setPreserveStereo(true);
+        const QByteArray stereo = m_enh->enhance(input);
+        m_enh->setPreserveStereo(false);
+        const QByteArray mono = m_enh->enhance(input);
+        m_enh->setPreserveStereo(saved);
+
+        QCOMPARE(stereo.size(), input.size());
+        const double ratio = channelRms(stereo, 1) / channelRms(stereo, 0);
+        QVERIFY2(std::abs(ratio - 0.5) < 0.03, qPrintable(QString("R/L %1").arg(ratio)));
+        QCOMPARE(channelRms(mono, 1), channelRms(mono, 0));
+    }
+
+    // With identical channels the mid is each channel, so stereo mode has
+    // to reproduce the mono path: the only difference is that the phase
+    // vocoder rotates each channel's own spectrum instead of resynthesising
+    // |X|·e^{iφ}, which is the same thing up to rounding.
+    void preserveStereo_matchesMonoPathOnCentredInput()
+    {
+        const bool saved = m_enh->getPreserveStereo();
+        m_enh->setReverbMix(0.0);   // the reverb tanks are deliberately different per channel
+        const QByteArray input = synthVocalTone(3.0);
+
+        m_enh->setPreserveStereo(true);
+        const QByteArray stereo = m_enh->enhance(input);
+        m_enh->setPreserveStereo(false);
+        const QByteArray mono = m_enh->enhance(input);
+        m_enh->setPreserveStereo(saved);
+
+        QCOMPARE(stereo.size(), mono.size());
+        const qint16 *a = reinterpret_cast<const qint16 *>(mono.constData());
+        const qint16 *b = reinterpret_cast<const qint16 *>(stereo.constData());
+        const qsizetype n = mono.size() / qsizetype(sizeof(qint16));
+        double signal = 0.0, noise = 0.0;
+        for (qsizetype i = 0; i < n; ++i) {
+            signal += double(a[i]) * a[i];
+            noise  += double(a[i] - b[i]) * (a[i] - b[i]);
+        }
+        QVERIFY(signal > 0.0);
+        const double snrDb = 10.0 * std::log10(signal / std::max(noise, 1.0));
+        QVERIFY2(snrDb >= 50.0, qPrintable(QString("stereo vs mono SNR %1 dB").arg(snrDb, 0, 'f', 1)));
+    }
+
+    // Re-enhancing the same take after touching only the reverb replays the
+    // cached pitch-corrected signal; after touching only the tuning it
+    // replays the cached gate output and pitch detections. Either way the
+    // stages after the cached one see exactly the samples a cold run would
+    // feed them, so the output has to match a cold run bit for bit.
+    void stageCache_replayMatchesColdRun()
+    {
+        const double savedAmount = m_enh->getPitchCorrectionAmount();
+        const QByteArray input = synthVocalTone(3.0);
+        auto cold = [this, &input] {
+            m_enh->clearStageCache();
+            return m_enh->enhance(input);
+        };
+
+        m_enh->setReverbMix(0.1);
+        m_enh->enhance(input);
+        m_enh->setReverbMix(0.3);
+        const QByteArray reverbOnly = m_enh->enhance(input);
+        QVERIFY(m_enh->getBanner().contains("cached"));
+        QVERIFY(reverbOnly == cold());
+
+        m_enh->setPitchCorrectionAmount(savedAmount > 0.5 ? 0.2 : 0.8);
+        const QByteArray pitchOnly = m_enh->enhance(input);
+        QVERIFY(m_enh->getBanner().contains("cached"));
+        QVERIFY(pitchOnly == cold());
+
+        // A different take, or no cache at all, runs every stage
+        m_enh->setStageCacheLimit(0);
+        m_enh->enhance(input);
+        QVERIFY(!m_enh->getBanner().contains("cached"));
+        m_enh->setStageCacheLimit(VocalEnhancer::kPreviewStageCacheBytes);
+        m_enh->setPitchCorrectionAmount(savedAmount);
+    }
+
+    // Outside the preview nothing replays the stages, so an enhancer that
+    // wasn't asked to cache them doesn't record them either
+    void stageCache_isOffUnlessEnabled()
+    {
+        QAudioFormat fmt;
+        fmt.setSampleRate(44100);
+        fmt.setChannelCount(2);
+        fmt.setSampleFormat(QAudioFormat::Int16);
+        VocalEnhancer enh(fmt);
+        QCOMPARE(enh.getStageCacheLimit(), qint64(0));
+
+        const QByteArray input = synthVocalTone(1.5);
+        enh.setReverbMix(0.1);
+        enh.enhance(input);
+        enh.setReverbMix(0.3);
+        enh.enhance(input);
+        QVERIFY(!enh.getBanner().contains("cached"));
+    }
+
+    // The track the render overlay reads instead of analysing again: silent
+    // lead-in unvoiced, the tone voiced near its pitch with a target note to
+    // match, and the same track from a replay that skips the pitch stage.
+    void lastPitchTrack_followsTheTakeAndSurvivesReplay()
+    {
+        const QByteArray input = synthVocalTone(3.0);
+        m_enh->setScalePreset("chromatic");
+        m_enh->clearStageCache();
+        m_enh->setReverbMix(0.1);
+        m_enh->enhance(input);
+        const PitchTrack cold = m_enh->lastPitchTrack();
+        QVERIFY(cold.frames.size() > 20);   // ~80 ms apart over 3 s
+        QCOMPARE(cold.originMs, qint64(0));
+
+        int voiced = 0;
+        for (int i = 0; i < cold.frames.size(); ++i) {
+            const PitchTrack::Frame &f = cold.frames[i];
+            if (i > 0)
+                QVERIFY(f.ms > cold.frames[i - 1].ms);
+            if (f.ms < 300) {
+                QCOMPARE(f.hz, 0.0f);
+            } else if (f.ms > 1000 && f.ms < 2500) {
+                QVERIFY2(f.hz > 200.0f && f.hz < 228.0f, qPrintable(QString::number(f.hz)));
+                const double midi = 69.0 + 12.0 * std::log2(f.hz / 440.0);   // chromatic: the nearest note
+                QVERIFY(std::abs(f.targetMidi - midi) <= 0.501);
+                ++voiced;
+            }
+        }
+        QVERIFY(voiced > 10);
+
+        m_enh->setReverbMix(0.3);
+        m_enh->enhance(input);
+        QVERIFY(m_enh->getBanner().contains("cached"));
+        const PitchTrack replayed = m_enh->lastPitchTrack();
+        QCOMPARE(replayed.frames.size(), cold.frames.size());
+        for (int i = 0; i < cold.frames.size(); ++i) {
+            QCOMPARE(replayed.frames[i].ms, cold.frames[i].ms);
+            QCOMPARE(replayed.frames[i].hz, cold.frames[i].hz);
+            QCOMPARE(replayed.frames[i].targetMidi, cold.frames[i].targetMidi);
+        }
+    }
 };
 
 QTEST_MAIN(TestVocalEnhancer)
@@ -21,6 +21,7 @@ class TestVocalSeparationJob : public QObject
 
 private:
     QScopedPointer<QTemporaryDir> m_dir;
+    QTemporaryDir m_cacheDir; // SeparationCache root for the whole run — never ~/.WakkaQt
 
     static bool writeFile(const QString &path, const QByteArray &content)
     {
@@ -62,6 +63,12 @@ private:
     }
 
 private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_cacheDir.isValid());
+        qputenv("WAKKAQT_SEPARATION_CACHE_OVERRIDE", m_cacheDir.path().toUtf8());
+    }
+
     void init() { m_dir.reset(new QTemporaryDir); QVERIFY(m_dir->isValid()); }
     void cleanup() { m_dir.reset(); }
 
@@ -124,6 +131,54 @@ private slots:
         QVERIFY(args.at(1).toBool()); // wasCancelled=true
     }
 
+    // A second separation of the same (real, readable) input is served from
+    // SeparationCache: separated() still fires with the right bytes in a
+    // fresh workspace, but the engine never runs. "input.mp4" in the other
+    // tests doesn't exist, so it gets no cache key and they always run it.
+    void separate_repeatedInput_isServedFromCache()
+    {
+        const QString input = m_dir->filePath("song.mp4");
+        QVERIFY(writeFile(input, "karaoke source"));
+
+        int engineCalls = 0;
+        auto engine = [&engineCalls](const QString &, const QString &workspaceDir,
+                                     const std::function<void(int)> &, QString &,
+                                     const std::atomic<bool> *) -> QString {
+            ++engineCalls;
+            const QString path = workspaceDir + "/instrumental.wav";
+            QFile f(path);
+            if (!f.open(QIODevice::WriteOnly)) return QString();
+            f.write("separated once");
+            return path;
+        };
+
+        QString firstPath;
+        {
+            VocalSeparationJob job;
+            job.setSeparateEngineForTesting(engine);
+            QSignalSpy separatedSpy(&job, &VocalSeparationJob::separated);
+            job.separate(input);
+            QVERIFY(separatedSpy.wait(5000));
+            firstPath = separatedSpy.takeFirst().at(0).toString();
+            job.discardWorkspace();
+        }
+        QCOMPARE(engineCalls, 1);
+
+        VocalSeparationJob job;
+        job.setSeparateEngineForTesting(engine);
+        QSignalSpy separatedSpy(&job, &VocalSeparationJob::separated);
+        job.separate(input);
+        QVERIFY(separatedSpy.wait(5000));
+        const QString secondPath = separatedSpy.takeFirst().at(0).toString();
+
+        QCOMPARE(engineCalls, 1);
+        QVERIFY(secondPath != firstPath); // a private copy, not the cache entry itself
+        QByteArray content;
+        QVERIFY(readFile(secondPath, &content));
+        QCOMPARE(content, QByteArray("separated once"));
+        job.discardWorkspace();
+    }
+
     void export_success_commitsToSavePathAndDiscardsWorkspace()
     {
         VocalSeparationJob job;
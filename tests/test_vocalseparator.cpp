@@ -0,0 +1,330 @@
+#include "vocalseparator.h"
+#include "fftplanregistry.h"
+
+#include <QTest>
+#include <QtGlobal>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+#ifdef Q_OS_LINUX
+#  include <unistd.h>
+#endif
+
+// VocalSeparator::runChunked() is separate()'s STFT → model → iSTFT core,
+// with the ONNX session swapped for a plain function — so what it does to
+// the audio, and how much memory it needs, can be checked without the
+// 60 MB model file or an ONNX Runtime build. Geometry is Inst_HQ_3's
+// (bins 3073 → n_fft 6144, dim_t 256, hop 1024), the one separate() runs.
+
+static constexpr int kBins = 3073;
+static constexpr int kDimT = 256;
+static constexpr int kHop  = 1024;
+
+static std::vector<float> stereoSignal(double seconds)
+{
+    const int n = int(seconds * 44100);
+    std::vector<float> x(size_t(n) * 2);
+    unsigned r = 1;
+    for (int i = 0; i < n; ++i) {
+        r = r * 1103515245u + 12345u;
+        const float noise = float((r >> 9) & 0xffff) / 65536.f - 0.5f;
+        x[2 * i]     = 0.3f * std::sin(0.05f * i)  + 0.05f * noise;
+        x[2 * i + 1] = 0.2f * std::sin(0.031f * i) - 0.04f * noise;
+    }
+    return x;
+}
+
+// SNR of `out` against `ref`, in dB
+static double snrDb(const std::vector<float> &ref, const std::vector<float> &out)
+{
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        signal += double(ref[i]) * ref[i];
+        noise  += double(ref[i] - out[i]) * (ref[i] - out[i]);
+    }
+    return 10.0 * std::log10(signal / std::max(noise, 1e-30));
+}
+
+// Current resident set in bytes (0 where /proc isn't available)
+static qint64 residentBytes()
+{
+#ifdef Q_OS_LINUX
+    std::ifstream statm("/proc/self/statm");
+    qint64 pages = 0, resident = 0;
+    if (statm >> pages >> resident)
+        return resident * sysconf(_SC_PAGESIZE);
+#endif
+    return 0;
+}
+
+class TestVocalSeparator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        FftPlanRegistry::setWisdomPath(QString());   // never touch ~/.WakkaQt from a test
+        FftPlanRegistry::setEffort(FftPlanRegistry::Effort::Measure);
+    }
+
+    // Periodic Hann analysis/synthesis with squared-window normalisation
+    // reconstructs perfectly, so an identity model must hand the input back
+    // up to the float rounding of the spectrogram — including across every
+    // chunk seam and the zero-padded ends.
+    void identityModel_reconstructsInput()
+    {
+        const std::vector<float> in = stereoSignal(7.3);   // last chunk is partial
+        const size_t tile = size_t(4) * kBins * kDimT;
+        QString err;
+        int lastProgress = -1;
+        const std::vector<float> out = VocalSeparator::runChunked(
+            in, kBins, kDimT, kHop,
+            [tile](const float *x, float *y) { std::copy(x, x + tile, y); },
+            [&](int p) { lastProgress = p; }, err);
+
+        QVERIFY2(err.isEmpty(), qPrintable(err));
+        QCOMPARE(out.size(), in.size());
+        QCOMPARE(lastProgress, 100);
+        const double snr = snrDb(in, out);
+        QVERIFY2(snr >= 100.0, qPrintable(QString("reconstruction SNR %1 dB").arg(snr, 0, 'f', 1)));
+    }
+
+    // The crossfade ramps sum to one, so an identity model reconstructs
+    // just as well when every frame is blended from two chunks
+    void identityModel_crossfadeReconstructsInput()
+    {
+        const std::vector<float> in = stereoSignal(7.3);
+        const size_t tile = size_t(4) * kBins * kDimT;
+        QString err;
+        const std::vector<float> out = VocalSeparator::runChunked(
+            in, kBins, kDimT, kHop,
+            [tile](const float *x, float *y) { std::copy(x, x + tile, y); },
+            nullptr, err, nullptr, MdxChunking::fast());
+
+        QVERIFY2(err.isEmpty(), qPrintable(err));
+        QCOMPARE(out.size(), in.size());
+        const double snr = snrDb(in, out);
+        QVERIFY2(snr >= 100.0, qPrintable(QString("reconstruction SNR %1 dB").arg(snr, 0, 'f', 1)));
+    }
+
+    // Batching only changes how many chunks reach the model per call, not
+    // what happens to them: with a model that isn't the identity (a
+    // per-element gain, so a chunk handed over in the wrong slot or with
+    // stale overlap columns shows up) the output must match batch 1 exactly,
+    // for either blend — Crossfade carries its tail across group edges.
+    void batchedModel_matchesOneChunkAtATime()
+    {
+        const std::vector<float> in = stereoSignal(30.0);   // 7 chunks with Trim, 6 with Crossfade
+        const size_t tile = size_t(4) * kBins * kDimT;
+        auto gain = [tile](const float *x, float *y, int count) {
+            for (int c = 0; c < count; ++c)
+                for (size_t i = 0; i < tile; ++i)
+                    y[c * tile + i] = x[c * tile + i] * (1.f + 0.1f * float((i * 7) % 13) / 13.f);
+        };
+
+        for (const MdxChunking &chunking : {MdxChunking::quality(), MdxChunking::fast()}) {
+            QString err;
+            std::vector<int> counts1, countsN;
+            const std::vector<float> one = VocalSeparator::runChunked(
+                in, kBins, kDimT, kHop,
+                VocalSeparator::BatchModel([&](const float *x, float *y, int n) { counts1.push_back(n); gain(x, y, n); }),
+                1, nullptr, err, nullptr, chunking);
+            QVERIFY2(err.isEmpty(), qPrintable(err));
+            int lastProgress = -1;
+            const std::vector<float> batched = VocalSeparator::runChunked(
+                in, kBins, kDimT, kHop,
+                VocalSeparator::BatchModel([&](const float *x, float *y, int n) { countsN.push_back(n); gain(x, y, n); }),
+                4, [&](int p) { lastProgress = p; }, err, nullptr, chunking);
+            QVERIFY2(err.isEmpty(), qPrintable(err));
+
+            QCOMPARE(lastProgress, 100);
+            const int chunks = int(counts1.size());
+            QVERIFY(chunks > 4 && chunks % 4 != 0);   // two groups, the last a partial one
+            QCOMPARE(int(countsN.size()), (chunks + 3) / 4);
+            QVERIFY(std::all_of(countsN.begin(), countsN.end() - 1, [](int n) { return n == 4; }));
+            QCOMPARE(countsN.back(), chunks % 4);
+            QVERIFY(one == batched);
+        }
+    }
+
+    // Quality regression for the fast preset, with two stand-in models
+    // for what goes wrong at chunk edges. One is exact in the middle of its
+    // window and increasingly wrong towards either edge (frames attenuated
+    // and smeared into their neighbour), like a real model short of
+    // context: Fast must keep that error far below anything a separator is
+    // judged on. The other is exact everywhere but applies a slightly
+    // different gain per call, like a model that reads each chunk's level
+    // a little differently: the seam is then a level step, and Fast's
+    // crossfade must make it no more abrupt than Quality's hard cut —
+    // while saving Run calls.
+    void chunking_fastPresetKeepsSeamsClean()
+    {
+        const std::vector<float> in = stereoSignal(30.0);
+        const MdxChunking quality = MdxChunking::quality();
+        const MdxChunking fast    = MdxChunking::fast();
+
+        auto edgeDegraded = [](const float *x, float *y) {
+            for (size_t row = 0; row < size_t(4) * kBins; ++row) {
+                const float *r = x + row * kDimT;
+                float       *o = y + row * kDimT;
+                for (int t = 0; t < kDimT; ++t) {
+                    const int   edge = std::min(t, kDimT - 1 - t);
+                    const float err  = 0.6f * std::exp(-edge / 4.f);
+                    const float nb   = r[t == 0 ? 1 : t - 1];
+                    o[t] = (1.f - err) * r[t] + 0.5f * err * nb;
+                }
+            }
+        };
+        auto run = [&](const MdxChunking &chunking, const VocalSeparator::ChunkModel &model) {
+            QString err;
+            return VocalSeparator::runChunked(in, kBins, kDimT, kHop, model, nullptr, err,
+                                              nullptr, chunking);
+        };
+
+        const double fastSnr = snrDb(in, run(fast, edgeDegraded));
+        QVERIFY2(fastSnr >= 50.0, qPrintable(QString("fast SNR %1 dB").arg(fastSnr, 0, 'f', 1)));
+
+        // Largest change in output/input level between neighbouring hops
+        auto worstLevelStep = [&](const MdxChunking &chunking, int &calls) {
+            calls = 0;
+            const size_t tile = size_t(4) * kBins * kDimT;
+            const std::vector<float> out = run(chunking, [&](const float *x, float *y) {
+                const float gain = (calls++ % 2) ? 1.1f : 0.9f;
+                for (size_t i = 0; i < tile; ++i)
+                    y[i] = gain * x[i];
+            });
+            double worst = 0.0, prev = -1.0;
+            for (size_t w = 0; (w + 1) * 2 * kHop <= in.size(); ++w) {
+                double eIn = 0.0, eOut = 0.0;
+                for (size_t i = w * 2 * kHop; i < (w + 1) * 2 * kHop; ++i) {
+                    eIn  += double(in[i]) * in[i];
+                    eOut += double(out[i]) * out[i];
+                }
+                const double level = std::sqrt(eOut / std::max(eIn, 1e-30));
+                if (prev >= 0.0) worst = std::max(worst, std::abs(level - prev));
+                prev = level;
+            }
+            return worst;
+        };
+        int qualityCalls = 0, fastCalls = 0;
+        const double qualityStep = worstLevelStep(quality, qualityCalls);
+        const double fastStep    = worstLevelStep(fast, fastCalls);
+        qDebug() << "quality:" << qualityCalls << "calls, level step" << qualityStep
+                 << "| fast:" << fastCalls << "calls, level step" << fastStep
+                 << "| fast SNR" << fastSnr << "dB";
+
+        QVERIFY2(fastCalls < qualityCalls,
+                 qPrintable(QString("fast made %1 calls vs %2").arg(fastCalls).arg(qualityCalls)));
+        QVERIFY2(fastStep <= qualityStep,
+                 qPrintable(QString("fast level step %1 vs quality %2").arg(fastStep).arg(qualityStep)));
+    }
+
+    // The spectrogram used to be built whole, twice (model input and
+    // output): 4·bins·frames floats each, ~500 MB apiece for three minutes.
+    // Now only the chunk tiles are live (two in, two out while packing and
+    // unpacking overlap inference), so what runChunked() holds beyond its
+    // output audio must not depend on how long the input is. Sampled from
+    // inside the model call, where the pipeline is at its fullest.
+    void residentSpectrogram_doesNotGrowWithInputLength()
+    {
+#ifndef Q_OS_LINUX
+        QSKIP("needs /proc/self/statm");
+#endif
+        const size_t tile = size_t(4) * kBins * kDimT;
+        auto overhead = [tile](double seconds) {
+            const std::vector<float> in = stereoSignal(seconds);
+            const qint64 outBytes = qint64(in.size() * sizeof(float));
+            const qint64 before   = residentBytes();
+            qint64 peak = before;
+            QString err;
+            VocalSeparator::runChunked(
+                in, kBins, kDimT, kHop,
+                [&](const float *x, float *y) {
+                    std::copy(x, x + tile, y);
+                    peak = std::max(peak, residentBytes());
+                },
+                nullptr, err);
+            return peak - before - outBytes;
+        };
+
+        overhead(5.0);   // warm-up: plans, allocator arenas
+        const qint64 shortRun = overhead(20.0);
+        const qint64 longRun  = overhead(180.0);
+        const qint64 tileBytes = qint64(tile * sizeof(float));
+        QVERIFY2(longRun < 6 * tileBytes,
+                 qPrintable(QString("180 s input held %1 MB beyond its output").arg(longRun >> 20)));
+        QVERIFY2(longRun - shortRun < tileBytes,
+                 qPrintable(QString("grew %1 MB from 20 s to 180 s").arg((longRun - shortRun) >> 20)));
+    }
+
+    void cancellation_returnsEmpty()
+    {
+        const std::vector<float> in = stereoSignal(10.0);
+        const size_t tile = size_t(4) * kBins * kDimT;
+        std::atomic<bool> cancelled{false};
+        int calls = 0;
+        QString err;
+        const std::vector<float> out = VocalSeparator::runChunked(
+            in, kBins, kDimT, kHop,
+            [&](const float *x, float *y) {
+                std::copy(x, x + tile, y);
+                if (++calls == 2) cancelled = true;
+            },
+            nullptr, err, &cancelled);
+        QVERIFY(out.empty());
+        QCOMPARE(err, QString("Cancelled"));
+        QCOMPARE(calls, 2);
+    }
+
+    // separate() no longer re-hashes the model on every call: a verified
+    // hash is trusted while the file's size and mtime are unchanged. Proven
+    // here by swapping the bytes behind its back with both kept — still
+    // "verified", i.e. the file wasn't read — and then by touching the
+    // mtime, which must bring the real check (and its failure) back.
+    void verifiedHash_isCachedBySizeAndMtime()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath("model.onnx");
+        const QByteArray good(4096, 'a'), bad(4096, 'b');
+        const QString sha = QString::fromLatin1(
+            QCryptographicHash::hash(good, QCryptographicHash::Sha256).toHex());
+        {
+            QFile f(path);
+            QVERIFY(f.open(QIODevice::WriteOnly));
+            f.write(good);
+        }
+
+        QVERIFY(!VocalSeparator::verifyFileCached(path, QString(64, QChar('0'))));
+        QVERIFY(!QFile::exists(path + ".verified"));
+        QVERIFY(VocalSeparator::verifyFileCached(path, sha));
+        QVERIFY(QFile::exists(path + ".verified"));
+
+        const QDateTime mtime = QFileInfo(path).lastModified();
+        {
+            QFile f(path);
+            QVERIFY(f.open(QIODevice::WriteOnly));
+            f.write(bad);
+            QVERIFY(f.setFileTime(mtime, QFileDevice::FileModificationTime));
+        }
+        QVERIFY(VocalSeparator::verifyFileCached(path, sha));
+
+        {
+            QFile f(path);
+            QVERIFY(f.open(QIODevice::ReadOnly));   // setFileTime() needs an open file
+            QVERIFY(f.setFileTime(mtime.addSecs(10), QFileDevice::FileModificationTime));
+        }
+        QVERIFY(!VocalSeparator::verifyFileCached(path, sha));
+        QVERIFY(!QFile::exists(path + ".verified"));
+    }
+};
+
+QTEST_MAIN(TestVocalSeparator)
+#include "test_vocalseparator.moc"
@@ -88,6 +88,25 @@ private slots:
         QCOMPARE(result.samples, QByteArray(16, '\x33'));
     }
 
+    // What DecodedAudioStore maps by: the same walk, reporting where the
+    // samples are instead of copying them out
+    void layout_pointsAtTheDataChunkWithoutCopying()
+    {
+        const QByteArray pcm(40, '\x55');
+        const QByteArray wav = makeMinimalWav(2, 48000, 16, pcm);
+        QVERIFY(!wav.isEmpty());
+
+        const WavLayout layout = parseWavLayout(wav.constData(), wav.size());
+
+        QVERIFY(layout.isValid());
+        QCOMPARE(layout.dataOffset, qint64(44));
+        QCOMPARE(layout.dataSize, qint64(pcm.size()));
+        QCOMPARE(wav.mid(layout.dataOffset, layout.dataSize), pcm);
+        QCOMPARE(layout.format.sampleRate(), 48000);
+        QCOMPARE(layout.format.channelCount(), 2);
+        QVERIFY(!parseWavLayout(wav.constData(), 20).isValid());
+    }
+
     void notRiff_isRejected()
     {
         QVERIFY(!parseWavPcm(QByteArray("not a wav file at all")).isValid());